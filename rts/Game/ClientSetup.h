@@ -27,6 +27,12 @@ public:
 	//! if this client is the server player, the port over which we accept incoming connections
 	int hostPort;
 
+	//! frame to fast-forward demo playback to, using keyframes when available
+	int demoSeekFrame = 0;
+
+	//! if non-empty, replay the demo as fast as possible and write sim timings here (see CSimBenchmark)
+	std::string benchmarkFile;
+
 	bool isHost;
 
 	std::string showServerName;
@@ -15,6 +15,7 @@
 #include "GlobalUnsynced.h"
 #include "LoadScreen.h"
 #include "SelectedUnitsHandler.h"
+#include "SimBenchmark.h"
 #include "WaitCommandsAI.h"
 #include "WordCompletion.h"
 #include "IVideoCapturing.h"
@@ -50,6 +51,7 @@
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/UniformConstants.h"
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
+#include "Rendering/Textures/Bitmap.h"
 #include "Rendering/Textures/NamedTextures.h"
 #include "Lua/LuaGaia.h"
 #include "Lua/LuaHandle.h"
@@ -121,6 +123,8 @@
 #include "System/SpringMath.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/DemoKeyframes.h"
+#include "System/LoadSave/DemoReader.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Misc.h"
@@ -130,6 +134,7 @@
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/SpringThreading.h"
 #include "System/LoadLock.h"
 
 #include "System/Misc/TracyDefs.h"
@@ -214,6 +219,9 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(jobDispatcher),
 	CR_IGNORED(worldDrawer),
 	CR_IGNORED(saveFileHandler),
+	CR_IGNORED(demoKeyframeIndex),
+	CR_IGNORED(writtenDemoKeyframes),
+	CR_IGNORED(demoKeyframeInterval),
 	CR_IGNORED(gameInputReceiver),
 
 	// Post Load
@@ -249,6 +257,14 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 
 	speedControl = configHandler->GetInt("SpeedControl");
 
+	if (gameSetup->hostDemo && gameServer != nullptr && gameServer->GetDemoReader() != nullptr) {
+		if ((demoKeyframeInterval = configHandler->GetInt("DemoKeyframeInterval")) > 0) {
+			demoKeyframeIndex = std::make_unique<CDemoKeyframeIndex>(gameSetup->demoName, gameServer->GetDemoReader()->GetFileHeader());
+			demoKeyframeIndex->Load();
+			writtenDemoKeyframes = std::make_shared<WrittenDemoKeyframes>();
+		}
+	}
+
 	playerRoster.SetSortTypeByCode((PlayerRoster::SortType)configHandler->GetInt("ShowPlayerInfo"));
 
 	CInputReceiver::guiAlpha = configHandler->GetFloat("GuiOpacity");
@@ -1239,6 +1255,9 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 			gu->simFPS = (gs->frameNum - lsf) / (diffMilliSecs * 0.001f);
 			lsft = currentTime;
 			lsf = gs->frameNum;
+
+			// release cold bitmap memory if above TextureMemBudget
+			CBitmap::TrimPool();
 		}
 	}
 
@@ -1684,12 +1703,20 @@ void CGame::SimFrame() {
 
 	FrameMarkStart(tracingSimFrameName);
 
+	// damage dealt between frames (e.g. by synced Lua messages) still belongs
+	// to the previous one, deliver it before the frame number moves on
+	eventHandler.FlushBatchedEvents();
+
 	// note: starts at -1, first actual frame is 0
 	gs->frameNum += 1;
 #ifdef SYNC_HISTORY
 	CSyncChecker::NewGameFrame();
 #endif
 	lastFrameTime = spring_gettime();
+
+	if (simBenchmark.IsEnabled())
+		simBenchmark.PreSimFrame();
+
 	// This is not very ideal, as the timeoffset of each new draw frame is also calculated from this
 	// with a strange side effect: if the timeOffset was a high number, like 0.9, then this will force the next draw frame to have an offset of 0.0x
 	// What this means, is that in the case where we have frames to spare, and and over rendering, then the following can happen at 60hz:
@@ -1799,10 +1826,14 @@ void CGame::SimFrame() {
 
 	eventHandler.DbgTimingInfo(TIMING_SIM, lastFrameTime, lastSimFrameTime);
 
+	if (simBenchmark.IsEnabled())
+		simBenchmark.PostSimFrame(gs->frameNum, lastSimFrameTime - lastFrameTime);
+
 	FrameMarkEnd(tracingSimFrameName);
 
 	#ifdef HEADLESS
-	{
+	// benchmarks run unthrottled
+	if (!simBenchmark.IsEnabled()) {
 		const float msecMaxSimFrameTime = 1000.0f / (GAME_SPEED * gs->wantedSpeedFactor);
 		const float msecDifSimFrameTime = (lastSimFrameTime - lastFrameTime).toMilliSecsf();
 		// multiply by 0.5 to give unsynced code some execution time (50% of our sleep-budget)
@@ -1822,6 +1853,68 @@ void CGame::SimFrame() {
 }
 
 
+struct CGame::WrittenDemoKeyframes {
+	spring::mutex mutex;
+	std::vector<DemoKeyframe> keyframes;
+};
+
+bool CGame::WriteDemoKeyframe()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (demoKeyframeInterval <= 0)
+		return false;
+
+	IndexWrittenDemoKeyframes();
+
+	if (gs->frameNum <= 0 || (gs->frameNum % demoKeyframeInterval) != 0)
+		return false;
+
+	// where the server's demo-reader was when it sent us this frame
+	const DemoStreamPos streamPos = gameServer->PopDemoStreamPos(gs->frameNum);
+
+	if (streamPos.frameNum != gs->frameNum)
+		return false;
+	// already have this one, e.g. when playback was resumed from it
+	if (demoKeyframeIndex->FindNearest(gs->frameNum - 1, gs->frameNum) != nullptr)
+		return false;
+	// do not replace a save requested by the user, skip this keyframe instead
+	if (!globalSaveFileData.name.empty())
+		return false;
+
+	DemoKeyframe keyframe;
+	keyframe.pos = streamPos;
+	keyframe.saveFile = demoKeyframeIndex->GetSaveFileName(gs->frameNum);
+
+	// written by the main loop like any other save; the keyframe is only
+	// indexed once the savegame has been renamed into place by its writer
+	globalSaveFileData.name = keyframe.saveFile;
+	globalSaveFileData.args = "-y";
+	globalSaveFileData.onWritten = [written = writtenDemoKeyframes, keyframe](bool success) {
+		if (!success)
+			return;
+
+		std::lock_guard<spring::mutex> lck(written->mutex);
+		written->keyframes.push_back(keyframe);
+	};
+
+	return true;
+}
+
+void CGame::IndexWrittenDemoKeyframes()
+{
+	std::vector<DemoKeyframe> keyframes;
+
+	{
+		std::lock_guard<spring::mutex> lck(writtenDemoKeyframes->mutex);
+		keyframes.swap(writtenDemoKeyframes->keyframes);
+	}
+
+	for (const DemoKeyframe& keyframe: keyframes) {
+		demoKeyframeIndex->Append(keyframe);
+	}
+}
+
+
 void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool timeout)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -2042,6 +2135,15 @@ void CGame::StartSkip(int toFrame) {
 
 void CGame::EndSkip() {
 	RECOIL_DETAILED_TRACY_ZONE;
+	// all demo frames have been simulated once the server's end-marker arrives
+	if (simBenchmark.IsEnabled()) {
+		if (!simBenchmark.WriteResults(gameSetup->demoName))
+			spring::exitCode = spring::EXIT_CODE_FAILURE;
+
+		simBenchmark.Kill();
+		gu->globalQuit = true;
+	}
+
 	#if 0 // FIXME
 	skipping = false;
 
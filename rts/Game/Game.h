@@ -4,6 +4,7 @@
 #define _GAME_H
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,6 +19,7 @@
 class LuaParser;
 class ILoadSaveHandler;
 class ChatMessage;
+class CDemoKeyframeIndex;
 
 
 class CGame : public CGameController
@@ -146,6 +148,8 @@ private:
 	void UpdateNumQueuedSimFrames();
 	void UpdateNetMessageProcessingTimeLeft();
 	void SimFrame();
+	bool WriteDemoKeyframe();
+	void IndexWrittenDemoKeyframes();
 	void StartPlaying();
 
 public:
@@ -223,6 +227,13 @@ private:
 	/// for reloading the savefile
 	ILoadSaveHandler* saveFileHandler;
 
+	/// savegame keyframes written while watching a demo, see DemoKeyframeInterval
+	std::unique_ptr<CDemoKeyframeIndex> demoKeyframeIndex;
+	/// keyframes whose savegame was written by a background thread, not yet indexed
+	struct WrittenDemoKeyframes;
+	std::shared_ptr<WrittenDemoKeyframes> writtenDemoKeyframes;
+	int demoKeyframeInterval = 0;
+
 	CGameInputReceiver gameInputReceiver;
 
 	std::atomic<bool> loadDone = {false};
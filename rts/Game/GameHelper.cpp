@@ -38,6 +38,7 @@
 #include "Sim/Weapons/Weapon.h"
 #include "System/EventHandler.h"
 #include "System/SpringMath.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/Sound/ISoundChannels.h"
 
 #include "System/Misc/TracyDefs.h"
@@ -53,6 +54,10 @@ void CGameHelper::Init()
 		wdVec.clear();
 		wdVec.reserve(32);
 	}
+	for (auto& visitMarks: targetVisitMarks) {
+		visitMarks.marks.clear();
+		visitMarks.markNum = 0;
+	}
 }
 
 void CGameHelper::Kill()
@@ -654,41 +659,148 @@ namespace {
 
 
 
-size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
-{
-	const CUnit*  weaponOwner = weapon->owner;
-	const CUnit* lastAttacker = ((weaponOwner->lastAttackFrame + 200) <= gs->frameNum) ? weaponOwner->lastAttacker : nullptr;
+namespace {
+	/**
+	 * Priority scoring shared by GenerateWeaponTargets and GenerateWeaponTargetCandidates;
+	 * does not modify any sim state, but Score calls into the owner's script when the
+	 * weapon has a TargetWeight function (CWeapon::hasTargetWeight)
+	 */
+	struct WeaponTargetScorer {
+	public:
+		explicit WeaponTargetScorer(const CWeapon* w, const CUnit* avoidUnit)
+			: weapon(w)
+			, weaponOwner(w->owner)
+			, weaponDef(w->weaponDef)
+			, weaponDmg(w->damages)
+			, avoidUnit(avoidUnit)
+			, lastAttacker(((weaponOwner->lastAttackFrame + 200) <= gs->frameNum) ? weaponOwner->lastAttacker : nullptr)
+			, ownerPos(weaponOwner->pos)
+			, worldMainDir(w->weaponDir)
+		{
+			const float minMapHeight = std::max(0.0f, readMap->GetCurrMinHeight());
+
+			aimPosHeight = w->aimFromPos.y;
+
+			// how much damage the weapon deals over 1 second
+			secDamage = weaponDmg->GetDefault() * w->salvoSize / w->reloadTime * GAME_SPEED;
+			heightMod = weaponDef->heightmod;
+
+			weaponAimAdjustPriority = w->weaponAimAdjustPriority;
+
+			baseRange = w->range;
+			rangeBoost = w->autoTargetRangeBoost;
+			// find theoretical maximum range based on height above lowest point on map
+			// const float scanRadius = weapon->GetRange2D(rangeBoost, (minMapHeight - aimPosHeight) * heightMod);
+			scanRadius = baseRange + rangeBoost + (aimPosHeight - minMapHeight) * heightMod;
+
+			paralyzer = (weaponDmg->paralyzeDamageTime != 0);
+		}
 
-	const      WeaponDef* weaponDef = weapon->weaponDef;
-	const DynDamageArray* weaponDmg = weapon->damages;
+		/// @return false if <targetUnit> can not be auto-targeted, its priority otherwise
+		bool Score(CUnit* targetUnit, float& targetPriority) const {
+			// [0] := default, [1,2,3,4,5,6] := target is {avoidee, in bad category, crashing, last attacker, paralyzed, outside unboosted range}
+			constexpr float tgtPriorityMults[] = {1.0f, 10.0f, 100.0f, 1000.0f, 0.5f, 4.0f, 100000.0f};
 
-	const float3& ownerPos = weaponOwner->pos;
-	const float3 testPos;
+			if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
+				return false;
 
-	const float aimPosHeight = weapon->aimFromPos.y;
-	const float minMapHeight = std::max(0.0f, readMap->GetCurrMinHeight());
+			const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
 
-	// how much damage the weapon deals over 1 second
-	const float secDamage = weaponDmg->GetDefault() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
-	const float heightMod = weaponDef->heightmod;
+			float3 targetPos;
 
-	const float3 worldMainDir = weapon->weaponDir;
-	const float weaponAimAdjustPriority = weapon->weaponAimAdjustPriority;
+			targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
 
-	const float  baseRange = weapon->range;
-	const float rangeBoost = weapon->autoTargetRangeBoost;
-	// find theoretical maximum range based on height above lowest point on map
-	// const float scanRadius = weapon->GetRange2D(rangeBoost, (minMapHeight - aimPosHeight) * heightMod);
-	const float scanRadius = baseRange + rangeBoost + (aimPosHeight - minMapHeight) * heightMod;
+			if (targetLOSState & LOS_INLOS) {
+				targetPos = targetUnit->aimPos;
+			} else if (targetLOSState & LOS_INRADAR) {
+				targetPos = weapon->GetUnitPositionWithError(targetUnit);
+				targetPriority *= tgtPriorityMults[1];
+			} else {
+				return false;
+			}
+
+			const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
+			const float sqDist2D = ownerPos.SqDistance2D(targetPos);
+
+			if (sqDist2D > Square(modRange))
+				return false;
+
+			const float3 worldTargetDir = (targetPos - ownerPos).SafeNormalize();
+			const float angleOffset =  (1.f - worldMainDir.dot(worldTargetDir));
+			const float angleMod = angleOffset * weaponAimAdjustPriority + 1.f;
+
+			// Strengthen focus towards the front, desire should weaken quadratically rather
+			// than linearly otherwise target distance can too easily cause units to choose a
+			// target that requires turning around to fire at.
+			const float angleMul = angleMod*angleMod;
+
+			const float dist2D = math::sqrt(sqDist2D);
+			const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
+			const float damageMul = std::max(0.0001f, weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple);
 
-	// [0] := default, [1,2,3,4,5,6] := target is {avoidee, in bad category, crashing, last attacker, paralyzed, outside unboosted range}
-	constexpr float tgtPriorityMults[] = {1.0f, 10.0f, 100.0f, 1000.0f, 0.5f, 4.0f, 100000.0f};
+			targetPriority *= angleMul;
+			targetPriority *= rangeMul;
+			targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
 
-	const bool paralyzer = (weaponDmg->paralyzeDamageTime != 0);
+			if (targetLOSState & LOS_INLOS) {
+				targetPriority *= (secDamage + targetUnit->health);
+
+				if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
+					targetPriority *= tgtPriorityMults[5];
+
+				if (weapon->hasTargetWeight)
+					targetPriority *= weapon->TargetWeight(targetUnit);
+
+			} else {
+				targetPriority *= (secDamage + 10000.0f);
+			}
+
+			if (targetLOSState & LOS_PREVLOS) {
+				targetPriority /= (damageMul * targetUnit->power);
+				targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
+				targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
+				targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
+			}
+
+			return true;
+		}
+
+	public:
+		const CWeapon* weapon;
+		const CUnit* weaponOwner;
+
+		const      WeaponDef* weaponDef;
+		const DynDamageArray* weaponDmg;
+
+		const CUnit* avoidUnit;
+		const CUnit* lastAttacker;
+
+		const float3& ownerPos;
+		const float3 testPos;
+		const float3 worldMainDir;
+
+		float aimPosHeight;
+		float secDamage;
+		float heightMod;
+		float weaponAimAdjustPriority;
+		float baseRange;
+		float rangeBoost;
+		float scanRadius;
+
+		bool paralyzer;
+	};
+}
+
+
+size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	const WeaponTargetScorer scorer(weapon, avoidUnit);
+
+	const CUnit* weaponOwner = weapon->owner;
 
 	// copy on purpose since the below calls lua
 	QuadFieldQuery qfQuery;
-	quadField.GetQuads(qfQuery, ownerPos, scanRadius);
+	quadField.GetQuads(qfQuery, scorer.ownerPos, scorer.scanRadius);
 
 	targets.clear();
 	targets.reserve(32);
@@ -708,72 +820,77 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 
 				targetUnit->tempNum = tempNum;
 
-				if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
+				float targetPriority = 1.0f;
+
+				if (!scorer.Score(targetUnit, targetPriority))
 					continue;
 
-				const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
+				const bool allowTarget = eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, scorer.weaponDef->id, &targetPriority);
 
-				float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
-				float3 targetPos;
+				// Lua call may have changed tempNum, so needs to be set again
+				targetUnit->tempNum = tempNum;
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPos = targetUnit->aimPos;
-				} else if (targetLOSState & LOS_INRADAR) {
-					targetPos = weapon->GetUnitPositionWithError(targetUnit);
-					targetPriority *= tgtPriorityMults[1];
-				} else {
+				if (!allowTarget)
 					continue;
-				}
 
-				const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
-				const float sqDist2D = ownerPos.SqDistance2D(targetPos);
+				targets.emplace_back(targetPriority, targetUnit);
+			}
+		}
+	}
 
-				if (sqDist2D > Square(modRange))
-					continue;
+	std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
+	return (targets.size());
+}
 
-				const float3 worldTargetDir = (targetPos - ownerPos).SafeNormalize();
-				const float angleOffset =  (1.f - worldMainDir.dot(worldTargetDir));
-				const float angleMod = angleOffset * weaponAimAdjustPriority + 1.f;
+size_t CGameHelper::GenerateWeaponTargetCandidates(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	// scripted target weights can not be evaluated off the main thread
+	assert(!weapon->hasTargetWeight);
 
-				// Strengthen focus towards the front, desire should weaken quadratically rather
-				// than linearly otherwise target distance can too easily cause units to choose a
-				// target that requires turning around to fire at.
-				const float angleMul = angleMod*angleMod;
+	const WeaponTargetScorer scorer(weapon, avoidUnit);
 
-				const float dist2D = math::sqrt(sqDist2D);
-				const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
-				const float damageMul = std::max(0.0001f, weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple);
+	const CUnit* weaponOwner = weapon->owner;
+	const int threadNum = ThreadPool::GetThreadNum();
 
-				targetPriority *= angleMul;
-				targetPriority *= rangeMul;
-				targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = threadNum;
+	quadField.GetQuads(qfQuery, scorer.ownerPos, scorer.scanRadius);
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPriority *= (secDamage + targetUnit->health);
+	targets.clear();
+	targets.reserve(32);
 
-					if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
-						targetPriority *= tgtPriorityMults[5];
+	// units can live in multiple quads; CSolidObject::tempNum is shared by all threads
+	// so duplicates are filtered through per-thread marks instead, indexed by unit-ID
+	TargetVisitMarks& visitMarks = helper->targetVisitMarks[threadNum];
 
-					if (weapon->hasTargetWeight)
-						targetPriority *= weapon->TargetWeight(targetUnit);
+	if (visitMarks.marks.size() != unitHandler.MaxUnits()) {
+		visitMarks.marks.clear();
+		visitMarks.marks.resize(unitHandler.MaxUnits(), 0);
+		visitMarks.markNum = 0;
+	}
+	if ((++visitMarks.markNum) == std::numeric_limits<int>::max()) {
+		std::fill(visitMarks.marks.begin(), visitMarks.marks.end(), 0);
+		visitMarks.markNum = 1;
+	}
 
-				} else {
-					targetPriority *= (secDamage + 10000.0f);
-				}
+	const int markNum = visitMarks.markNum;
 
-				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power);
-					targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
-					targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
-					targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
-				}
+	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+		if (teamHandler.Ally(weaponOwner->allyteam, t))
+			continue;
 
-				const bool allowTarget = eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
+		for (const int qi: *qfQuery.quads) {
+			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
 
-				// Lua call may have changed tempNum, so needs to be set again
-				targetUnit->tempNum = tempNum;
+			for (CUnit* targetUnit: allyTeamUnits) {
+				if (visitMarks.marks[targetUnit->id] == markNum)
+					continue;
 
-				if (!allowTarget)
+				visitMarks.marks[targetUnit->id] = markNum;
+
+				float targetPriority = 1.0f;
+
+				if (!scorer.Score(targetUnit, targetPriority))
 					continue;
 
 				targets.emplace_back(targetPriority, targetUnit);
@@ -781,6 +898,28 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 		}
 	}
 
+	return (targets.size());
+}
+
+size_t CGameHelper::FilterWeaponTargetCandidates(const CWeapon* weapon, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	const CUnit* weaponOwner = weapon->owner;
+
+	size_t numTargets = 0;
+
+	// same call-in order as GenerateWeaponTargets, i.e. by quad and then by unit
+	for (size_t i = 0, n = targets.size(); i < n; i++) {
+		float targetPriority = targets[i].first;
+		CUnit* targetUnit = targets[i].second;
+
+		if (!eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weapon->weaponDef->id, &targetPriority))
+			continue;
+
+		targets[numTargets++] = {targetPriority, targetUnit};
+	}
+
+	targets.resize(numTargets);
+
 	std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
 	return (targets.size());
 }
@@ -11,6 +11,7 @@
 #include "System/float3.h"
 #include "System/float4.h"
 #include "System/type2.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <array>
 #include <bit>
@@ -210,6 +211,14 @@ public:
 	);
 
 	static size_t GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
+	/**
+	 * Thread-safe half of GenerateWeaponTargets: collects and scores <targets> without
+	 * running the AllowWeaponTarget call-in (or sorting), see FilterWeaponTargetCandidates.
+	 * Must not be used for weapons with a scripted TargetWeight.
+	 */
+	static size_t GenerateWeaponTargetCandidates(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
+	/// main-thread half, runs AllowWeaponTarget over the candidates and sorts them like GenerateWeaponTargets
+	static size_t FilterWeaponTargetCandidates(const CWeapon* weapon, std::vector<std::pair<float, CUnit*>>& targets);
 
 	void Init();
 	void Kill();
@@ -263,7 +272,13 @@ private:
 		float3 impulse;
 	};
 	
+	struct TargetVisitMarks {
+		std::vector<int> marks;
+		int markNum = 0;
+	};
+
 	std::array<std::vector<WaitingDamage>, 128> waitingDamages;
+	std::array<TargetVisitMarks, ThreadPool::MAX_THREADS> targetVisitMarks; // GenerateWeaponTargetCandidates
 	static_assert (std::has_single_bit(std::tuple_size_v <decltype(waitingDamages)>), "Size is used in bit hax and must be 2^N");
 
 public:
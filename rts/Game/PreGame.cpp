@@ -3,6 +3,7 @@
 #include <cinttypes>
 #include <cfloat>
 #include <functional>
+#include <limits>
 
 #include <SDL_keycode.h>
 
@@ -17,6 +18,7 @@
 #include "GameVersion.h"
 #include "GlobalUnsynced.h"
 #include "LoadScreen.h"
+#include "SimBenchmark.h"
 #include "Game/Players/Player.h"
 #include "Game/Players/PlayerHandler.h"
 #include "UI/InfoConsole.h"
@@ -42,6 +44,7 @@
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/VFSHandler.h"
+#include "System/LoadSave/DemoKeyframes.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/LoadSave/LoadSaveHandler.h"
@@ -119,6 +122,15 @@ void CPreGame::LoadDemoFile(const std::string& demo)
 	wantDemo &= configHandler->GetBool("DemoFromDemo");
 
 	ReadDataFromDemo(demo);
+
+	if (clientSetup->demoSeekFrame > 0)
+		SeekDemo(demo, clientSetup->demoSeekFrame);
+
+	if (!clientSetup->benchmarkFile.empty()) {
+		// fast-read the entire stream; the skip-end marker tells the client when it is done
+		simBenchmark.Init(clientSetup->benchmarkFile);
+		gameServer->SetDemoSkipTarget(std::numeric_limits<int>::max());
+	}
 }
 
 void CPreGame::LoadSaveFile(const std::string& save)
@@ -559,6 +571,36 @@ void CPreGame::ReadDataFromDemo(const std::string& demoName)
 	assert(gameServer != nullptr);
 }
 
+void CPreGame::SeekDemo(const std::string& demoName, int targetFrame)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(gameServer != nullptr);
+	assert(saveFileHandler == nullptr);
+
+	CDemoKeyframeIndex keyframeIndex(demoName, gameServer->GetDemoReader()->GetFileHeader());
+
+	// without a usable keyframe the server resimulates from the start as usual
+	const DemoKeyframe* keyframe = keyframeIndex.Load()? keyframeIndex.FindNearest(-1, targetFrame): nullptr;
+
+	if (keyframe != nullptr) {
+		LOG("[PreGame::%s] seeking to frame %d from keyframe at frame %d (\"%s\")", __func__, targetFrame, keyframe->pos.frameNum, keyframe->saveFile.c_str());
+
+		saveFileHandler = ILoadSaveHandler::CreateHandler(keyframe->saveFile);
+
+		// the demo's (modified) setup-script stays in effect, only the game-state is loaded
+		if (!saveFileHandler->LoadGameStartInfo(keyframe->saveFile) && !configHandler->GetBool("LoadBadSaves")) {
+			LOG_L(L_WARNING, "[PreGame::%s] keyframe \"%s\" was saved by a different engine version", __func__, keyframe->saveFile.c_str());
+			spring::SafeDelete(saveFileHandler);
+		} else if (!gameServer->SeekDemoKeyframe(*keyframe)) {
+			spring::SafeDelete(saveFileHandler);
+		}
+	} else {
+		LOG("[PreGame::%s] no keyframe available, seeking to frame %d from the start", __func__, targetFrame);
+	}
+
+	gameServer->SetDemoSkipTarget(targetFrame);
+}
+
 void CPreGame::GameDataReceived(std::shared_ptr<const netcode::RawPacket> packet)
 {
 	SCOPED_ONCE_TIMER("PreGame::GameDataReceived");
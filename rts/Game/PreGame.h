@@ -62,6 +62,8 @@ private:
 
 	/// reads out map, mod and script from demos (with or without a gameSetupScript)
 	void ReadDataFromDemo(const std::string& demoName);
+	/// fast-forwards demo playback, from the nearest keyframe if there is one
+	void SeekDemo(const std::string& demoName, int targetFrame);
 
 	/// receive network traffic
 	void UpdateClientNet();
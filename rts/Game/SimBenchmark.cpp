@@ -0,0 +1,241 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SimBenchmark.h"
+#include "GameVersion.h"
+
+#include "System/TimeProfiler.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <json/json.h>
+#include <json/writer.h>
+#include <nowide/fstream.hpp>
+
+#include "System/Misc/TracyDefs.h"
+
+CSimBenchmark simBenchmark;
+
+
+namespace {
+	struct TimerStats {
+		float total = 0.0f;
+		float mean = 0.0f;
+		float p50 = 0.0f;
+		float p90 = 0.0f;
+		float p99 = 0.0f;
+		float max = 0.0f;
+	};
+
+	TimerStats CalcTimerStats(std::vector<float> samples)
+	{
+		TimerStats stats;
+
+		if (samples.empty())
+			return stats;
+
+		std::sort(samples.begin(), samples.end());
+
+		// nearest-rank percentiles
+		const auto percentile = [&](float p) {
+			const size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+			return samples[std::clamp(rank, size_t(1), samples.size()) - 1];
+		};
+
+		for (const float s: samples) {
+			stats.total += s;
+		}
+
+		stats.mean = stats.total / samples.size();
+		stats.p50 = percentile(0.50f);
+		stats.p90 = percentile(0.90f);
+		stats.p99 = percentile(0.99f);
+		stats.max = samples.back();
+		return stats;
+	}
+
+	Json::Value TimerToJSON(const std::vector<float>& frameTimes)
+	{
+		const TimerStats stats = CalcTimerStats(frameTimes);
+
+		Json::Value node;
+		Json::Value frames = Json::arrayValue;
+
+		node["total"] = stats.total;
+		node["mean"] = stats.mean;
+		node["p50"] = stats.p50;
+		node["p90"] = stats.p90;
+		node["p99"] = stats.p99;
+		node["max"] = stats.max;
+
+		for (const float t: frameTimes) {
+			frames.append(t);
+		}
+
+		node["frames"] = std::move(frames);
+		return node;
+	}
+}
+
+
+void CSimBenchmark::Init(const std::string& outputFile)
+{
+	Kill();
+
+	outputFileName = outputFile;
+
+	LOG("[SimBenchmark::%s] writing sim-frame timings to \"%s\"", __func__, outputFileName.c_str());
+}
+
+void CSimBenchmark::Kill()
+{
+	outputFileName.clear();
+
+	frameNums.clear();
+	frameTimes.clear();
+	timerSeries.clear();
+
+	preFrameTotals.clear();
+	postFrameTotals.clear();
+}
+
+
+void CSimBenchmark::PreSimFrame()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	CTimeProfiler& profiler = CTimeProfiler::GetInstance();
+
+	// regular timers only record anything while the profiler is enabled
+	if (!profiler.IsEnabled())
+		profiler.SetEnabled(true);
+
+	if (frameNums.empty())
+		startTime = spring_gettime();
+
+	preFrameTotals.clear();
+	profiler.GetTimerTotals(preFrameTotals);
+}
+
+void CSimBenchmark::PostSimFrame(int frameNum, spring_time frameTime)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const auto hashCmp = [](const std::pair<unsigned, spring_time>& a, const std::pair<unsigned, spring_time>& b) { return (a.first < b.first); };
+
+	postFrameTotals.clear();
+	CTimeProfiler::GetInstance().GetTimerTotals(postFrameTotals);
+
+	std::sort(preFrameTotals.begin(), preFrameTotals.end(), hashCmp);
+	std::sort(postFrameTotals.begin(), postFrameTotals.end(), hashCmp);
+
+	const size_t frameIdx = frameNums.size();
+
+	frameNums.push_back(frameNum);
+	frameTimes.push_back(frameTime.toMilliSecsf());
+
+	auto preIt = preFrameTotals.cbegin();
+
+	for (const auto& [nameHash, postTotal]: postFrameTotals) {
+		while (preIt != preFrameTotals.cend() && preIt->first < nameHash)
+			++preIt;
+
+		// timers created during this frame have no previous total
+		const spring_time preTotal = (preIt != preFrameTotals.cend() && preIt->first == nameHash)? preIt->second: spring_notime;
+		const spring_time frameDelta = postTotal - preTotal;
+
+		if (frameDelta <= spring_notime)
+			continue;
+
+		auto seriesIt = timerSeries.find(nameHash);
+
+		if (seriesIt == timerSeries.end()) {
+			std::string name = CTimeProfiler::GetTimerName(nameHash);
+
+			if (!IsTrackedTimer(name))
+				name.clear();
+
+			seriesIt = timerSeries.emplace(nameHash, TimerSeries{std::move(name), {}}).first;
+		}
+
+		TimerSeries& series = seriesIt->second;
+
+		if (series.name.empty())
+			continue;
+
+		series.frameTimes.resize(frameIdx, 0.0f);
+		series.frameTimes.push_back(frameDelta.toMilliSecsf());
+	}
+}
+
+
+bool CSimBenchmark::WriteResults(const std::string& demoName) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<const TimerSeries*> sortedSeries;
+	sortedSeries.reserve(timerSeries.size());
+
+	for (const auto& [nameHash, series]: timerSeries) {
+		if (series.name.empty())
+			continue;
+
+		sortedSeries.push_back(&series);
+	}
+
+	std::sort(sortedSeries.begin(), sortedSeries.end(), [](const TimerSeries* a, const TimerSeries* b) { return (a->name < b->name); });
+
+	const float wallTime = frameNums.empty()? 0.0f: (spring_gettime() - startTime).toSecsf();
+
+	Json::Value root;
+	Json::Value timers;
+
+	root["engine"] = SpringVersion::GetFull();
+	root["demo"] = demoName;
+	root["threads"] = ThreadPool::GetNumThreads();
+	root["wallTimeSecs"] = wallTime;
+	root["numFrames"] = static_cast<Json::UInt>(frameNums.size());
+	root["firstFrame"] = frameNums.empty()? -1: frameNums.front();
+	root["lastFrame"] = frameNums.empty()? -1: frameNums.back();
+
+	// total wall-time of each CGame::SimFrame call, including untimed parts
+	timers["SimFrame"] = TimerToJSON(frameTimes);
+
+	std::vector<float> paddedTimes;
+
+	for (const TimerSeries* series: sortedSeries) {
+		paddedTimes.assign(series->frameTimes.begin(), series->frameTimes.end());
+		paddedTimes.resize(frameNums.size(), 0.0f);
+
+		timers[series->name] = TimerToJSON(paddedTimes);
+	}
+
+	root["timers"] = std::move(timers);
+
+	nowide::ofstream ofs(outputFileName, std::ios::out | std::ios::trunc);
+
+	if (!ofs.good()) {
+		LOG_L(L_ERROR, "[SimBenchmark::%s] could not open \"%s\" for writing", __func__, outputFileName.c_str());
+		return false;
+	}
+
+	Json::StyledWriter writer;
+	ofs << writer.write(root);
+
+	if (!ofs.good()) {
+		LOG_L(L_ERROR, "[SimBenchmark::%s] error writing \"%s\"", __func__, outputFileName.c_str());
+		return false;
+	}
+
+	const TimerStats stats = CalcTimerStats(frameTimes);
+
+	LOG("[SimBenchmark::%s] %u frames in %.2fs (sim-frame mean=%.3fms p50=%.3fms p99=%.3fms max=%.3fms), results written to \"%s\"",
+		__func__, static_cast<unsigned>(frameNums.size()), wallTime, stats.mean, stats.p50, stats.p99, stats.max, outputFileName.c_str());
+
+	return true;
+}
+
+
+bool CSimBenchmark::IsTrackedTimer(const std::string& name)
+{
+	return (name.starts_with("Sim") || name.starts_with("Lua"));
+}
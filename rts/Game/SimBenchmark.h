@@ -0,0 +1,61 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SIM_BENCHMARK_H
+#define SIM_BENCHMARK_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+#include "System/UnorderedMap.hpp"
+
+/**
+ * @brief Records per-frame CTimeProfiler timings while a demo is replayed
+ *
+ * Enabled with --benchmark <file.json> when playing a demo: the server then
+ * fast-reads the whole demo stream (as for /skip), the client simulates it as
+ * fast as possible and, once the stream has been consumed, the time every
+ * "Sim*" and "Lua*" timer spent inside each sim-frame is written to <file>
+ * together with per-timer percentiles, after which the engine quits.
+ */
+class CSimBenchmark
+{
+public:
+	void Init(const std::string& outputFile);
+	void Kill();
+
+	bool IsEnabled() const { return (!outputFileName.empty()); }
+
+	void PreSimFrame();
+	void PostSimFrame(int frameNum, spring_time frameTime);
+
+	/// writes the collected data, returns false if the output could not be written
+	bool WriteResults(const std::string& demoName) const;
+
+private:
+	struct TimerSeries {
+		std::string name;
+		std::vector<float> frameTimes; ///< milliseconds, one entry per recorded frame
+	};
+
+	static bool IsTrackedTimer(const std::string& name);
+
+private:
+	std::string outputFileName;
+
+	std::vector<int> frameNums;
+	std::vector<float> frameTimes;
+
+	// timers which are not tracked map to an empty name
+	spring::unordered_map<unsigned, TimerSeries> timerSeries;
+
+	std::vector< std::pair<unsigned, spring_time> > preFrameTotals;
+	std::vector< std::pair<unsigned, spring_time> > postFrameTotals;
+
+	spring_time startTime;
+};
+
+extern CSimBenchmark simBenchmark;
+
+#endif // SIM_BENCHMARK_H
@@ -182,6 +182,38 @@ inline static bool TestTrajectoryConeHelper(
 	return ret;
 }
 
+/**
+ * helper for TraceRay
+ * @return the object in <objs> whose intersection point is closest to <pos>
+ *   and nearer than <traceLength> (which is shortened to it), nullptr if none
+ *
+ * hit-tests all objects in one pass, same result as one-by-one testing
+ */
+template<typename T>
+static T* DetectClosestHit(
+	const std::vector<T*>& objs,
+	const float3& pos,
+	const float3& dir,
+	float& traceLength,
+	CollisionQuery* hitColQuery
+) {
+	static thread_local std::vector<const CSolidObject*> solidObjs;
+	static thread_local std::vector<CollisionQuery> cqs;
+	static thread_local std::vector<std::uint8_t> hits;
+
+	solidObjs.assign(objs.begin(), objs.end());
+	cqs.resize(solidObjs.size());
+	hits.resize(solidObjs.size());
+
+	const size_t i = CCollisionHandler::DetectClosestHit(solidObjs.data(), solidObjs.size(), pos, dir, traceLength, cqs.data(), hits.data(), true);
+
+	if (i == objs.size())
+		return nullptr;
+
+	*hitColQuery = cqs[i];
+	return objs[i];
+}
+
 
 
 //////////////////////////////////////////////////////////////////////
@@ -236,12 +268,16 @@ float TraceRay(
 		quadField.GetQuadsOnRay(qfQuery, pos, dir, traceLength);
 
 		// locally point somewhere non-NULL; we cannot pass hitColQuery
-		// to DetectHit directly because each call resets it internally
+		// to DetectClosestHit directly because it resets the queries
 		if (hitColQuery == nullptr)
 			hitColQuery = &cq;
 
 		// feature intersection
 		if (scanForFeatures) {
+			static thread_local std::vector<CFeature*> features;
+
+			features.clear();
+
 			for (const int quadIdx: *qfQuery.quads) {
 				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
@@ -252,24 +288,20 @@ float TraceRay(
 					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 						continue;
 
-					if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
-
-						// we want the closest feature (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
-
-						traceLength = len;
-
-						hitFeature = f;
-						*hitColQuery = cq;
-					}
+					features.push_back(f);
 				}
 			}
+
+			// we want the closest feature (intersection point) on the ray
+			hitFeature = DetectClosestHit(features, pos, dir, traceLength, hitColQuery);
 		}
 
 		// unit intersection
 		if (scanForAnyUnits) {
+			static thread_local std::vector<CUnit*> units;
+
+			units.clear();
+
 			for (const int quadIdx: *qfQuery.quads) {
 				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
@@ -290,21 +322,13 @@ float TraceRay(
 					if (!doHitTest)
 						continue;
 
-					if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
-
-						// we want the closest unit (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
-
-						traceLength = len;
-
-						hitUnit = u;
-						*hitColQuery = cq;
-					}
+					units.push_back(u);
 				}
 			}
 
+			// we want the closest unit (intersection point) on the ray
+			hitUnit = DetectClosestHit(units, pos, dir, traceLength, hitColQuery);
+
 			// units override features, so feature != null implies no unit was hit
 			if (hitUnit != nullptr)
 				hitFeature = nullptr;
@@ -39,6 +39,7 @@
 #include "Sim/Units/Scripts/CobInstance.h" // for UNPACK{X,Z}
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Weapons/WeaponDef.h"
 #include "System/creg/SerializeLuaState.h"
@@ -1405,6 +1406,103 @@ void CLuaHandle::UnitDamaged(
 	RunCallInTraceback(L, cmdStr, argCount, 0, traceBack.GetErrFuncIdx(), false);
 }
 
+/*** Batched form of UnitDamaged, called at the end of each frame (after GameFramePost).
+ *
+ * Receives every UnitDamaged event since the previous call as parallel arrays,
+ * grouped by damaged unit (ascending unitID) and in the order they happened
+ * for each unit. Attacker values are false where UnitDamaged would pass nil.
+ *
+ * @function Callins:UnitDamagedBatch
+ * @param count integer
+ * @param unitIDs integer[]
+ * @param unitDefIDs integer[]
+ * @param unitTeams integer[]
+ * @param damages number[]
+ * @param paralyzers boolean[]
+ * @param weaponDefIDs integer[]
+ * @param projectileIDs integer[]
+ * @param attackerIDs (integer|false)[]
+ * @param attackerDefIDs (integer|false)[]
+ * @param attackerTeams (integer|false)[]
+ */
+void CLuaHandle::UnitDamagedBatch(const std::vector<UnitDamagedEvent>& events)
+{
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 14, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!cmdStr.GetGlobalFunc(L))
+		return;
+
+	static constexpr int numArrays = 10;
+	static constexpr int argCount = 1 + numArrays;
+
+	const bool fullRead = GetFullRead();
+	const int readAllyTeam = GetHandleReadAllyTeam(L);
+	int count = 0;
+
+	for (const UnitDamagedEvent& event: events) {
+		count += CanReadAllyTeam(event.unitAllyTeam);
+	}
+
+	lua_pushnumber(L, count);
+
+	const int arraysIdx = lua_gettop(L) + 1;
+
+	for (int i = 0; i < numArrays; i++) {
+		lua_createtable(L, count, 0);
+	}
+
+	const auto setArrayValue = [&](int arrayNum, int index) { lua_rawseti(L, arraysIdx + arrayNum, index); };
+
+	for (int i = 0, index = 1; i < static_cast<int>(events.size()); i++) {
+		const UnitDamagedEvent& event = events[i];
+
+		if (!CanReadAllyTeam(event.unitAllyTeam))
+			continue;
+
+		lua_pushnumber(L, event.unitID      ); setArrayValue(0, index);
+		lua_pushnumber(L, event.unitDefID   ); setArrayValue(1, index);
+		lua_pushnumber(L, event.unitTeam    ); setArrayValue(2, index);
+		lua_pushnumber(L, event.damage      ); setArrayValue(3, index);
+		lua_pushboolean(L, event.paralyzer  ); setArrayValue(4, index);
+		lua_pushnumber(L, event.weaponDefID ); setArrayValue(5, index);
+		lua_pushnumber(L, event.projectileID); setArrayValue(6, index);
+
+		// same visibility rules as PushAttackerInfo, evaluated against the LOS
+		// state recorded when the damage happened (see QueueUnitDamaged)
+		const bool attackerAllied = (readAllyTeam < 0)? fullRead: (event.attackerAllyTeam == readAllyTeam);
+		const bool attackerVisible = attackerAllied || (readAllyTeam >= 0 && event.attackerVisible[readAllyTeam]);
+		const bool attackerTyped = attackerAllied || (readAllyTeam >= 0 && event.attackerTyped[readAllyTeam]);
+
+		if (event.attackerID >= 0 && (fullRead || attackerVisible)) {
+			lua_pushnumber(L, event.attackerID); setArrayValue(7, index);
+
+			if (fullRead || attackerAllied) {
+				lua_pushnumber(L, event.attackerDefID);
+			} else if (attackerTyped) {
+				lua_pushnumber(L, event.attackerEffectiveDefID);
+			} else {
+				lua_pushboolean(L, false);
+			}
+
+			setArrayValue(8, index);
+			lua_pushnumber(L, event.attackerTeam); setArrayValue(9, index);
+		} else {
+			lua_pushboolean(L, false); setArrayValue(7, index);
+			lua_pushboolean(L, false); setArrayValue(8, index);
+			lua_pushboolean(L, false); setArrayValue(9, index);
+		}
+
+		index++;
+	}
+
+	// call the routine
+	RunCallInTraceback(L, cmdStr, argCount, 0, traceBack.GetErrFuncIdx(), false);
+}
+
 /*** Called when a unit changes its stun status.
  *
  * @function Callins:UnitStunned
@@ -26,6 +26,7 @@
 #include "LuaUnitDefs.h"
 #include "LuaWeaponDefs.h"
 #include "LuaScream.h"
+#include "LuaSharedBuffers.h"
 #include "LuaMaterial.h"
 #include "LuaOpenGL.h"
 #include "LuaVFS.h"
@@ -134,6 +135,7 @@ bool CUnsyncedLuaHandle::Init(std::string code, const std::string& file)
 		if (!AddEntriesToTable(L, "FeatureDefs",   LuaFeatureDefs::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Script",          LuaInterCall::PushEntriesUnsynced)) KILL
 		if (!AddEntriesToTable(L, "Script",             LuaScream::PushEntries        )) KILL
+		if (!AddEntriesToTable(L, "Script",      LuaSharedBuffers::PushUnsynced       )) KILL
 		if (!AddEntriesToTable(L, "Spring",         LuaSyncedRead::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Spring",       LuaUnsyncedCtrl::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Spring",       LuaUnsyncedRead::PushEntries        )) KILL
@@ -524,6 +526,7 @@ bool CSyncedLuaHandle::Init(std::string code, const std::string& file)
 		if (!AddEntriesToTable(L, "WeaponDefs",     LuaWeaponDefs::PushEntries      )) KILL
 		if (!AddEntriesToTable(L, "FeatureDefs",   LuaFeatureDefs::PushEntries      )) KILL
 		if (!AddEntriesToTable(L, "Script",          LuaInterCall::PushEntriesSynced)) KILL
+		if (!AddEntriesToTable(L, "Script",      LuaSharedBuffers::PushSynced       )) KILL
 		if (!AddEntriesToTable(L, "Spring",       LuaUnsyncedCtrl::PushEntries      )) KILL
 		if (!AddEntriesToTable(L, "Spring",         LuaSyncedCtrl::PushEntries      )) KILL
 		if (!AddEntriesToTable(L, "Spring",         LuaSyncedRead::PushEntries      )) KILL
@@ -2006,8 +2009,10 @@ int CSyncedLuaHandle::SyncedPairs(lua_State* L)
  * @param ... nil|boolean|number|string|table Arguments. Typically the first argument is the name of a function to call.
  *
  * Argument tables will be recursively copied and stripped of unsupported types and metatables.
+ * Bulk numeric data that is sent every frame is cheaper to share through `Script.CreateSharedBuffer`.
  *
  * @see UnsyncedCallins:RecvFromSynced
+ * @see Script.CreateSharedBuffer
  */
 int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
 {
@@ -7,6 +7,7 @@
 
 #include "LuaHandle.h"
 #include "LuaRulesParams.h"
+#include "LuaSharedBuffers.h"
 #include "System/UnorderedMap.hpp"
 
 struct lua_State;
@@ -216,6 +217,10 @@ class CSplitLuaHandle
 			return &ulh->base.syncedLuaHandle;
 		}
 
+		static LuaSharedBuffers& GetSharedBuffers(lua_State* L) {
+			return GetSyncedHandle(L)->base.sharedBuffers;
+		}
+
 		bool ReloadUnsynced() { return (FreeUnsynced(), LoadUnsynced()); }
 		bool SwapSyncedHandle(lua_State* L, lua_State* L_GC);
 		bool InitUnsynced();
@@ -273,6 +278,10 @@ class CSplitLuaHandle
 		CSyncedLuaHandle syncedLuaHandle;
 		CUnsyncedLuaHandle unsyncedLuaHandle;
 
+	private:
+		// outlive reloads of the unsynced handle
+		LuaSharedBuffers sharedBuffers;
+
 	public:
 		static void ClearGameParams() { spring::clear_unordered_map(gameParams); }
 		static const LuaRulesParams::Params& GetGameParams() { return gameParams; }
@@ -63,6 +63,7 @@ bool LuaPathFinder::PushEntries(lua_State* L)
 	CreatePathMetatable(L);
 
 	REGISTER_LUA_CFUNC(RequestPath);
+	REGISTER_LUA_CFUNC(RequestPaths);
 	REGISTER_LUA_CFUNC(InitPathNodeCostsArray);
 	REGISTER_LUA_CFUNC(FreePathNodeCostsArray);
 	REGISTER_LUA_CFUNC(SetPathNodeCosts);
@@ -211,20 +212,32 @@ static void CreatePathMetatable(lua_State* L)
 /******************************************************************************/
 /******************************************************************************/
 
-int LuaPathFinder::RequestPath(lua_State* L)
+static const MoveDef* ParseMoveDef(lua_State* L, const char* caller)
 {
-	const MoveDef* moveDef = nullptr;
+	if (lua_israwstring(L, 1))
+		return (moveDefHandler.GetMoveDefByName(lua_tostring(L, 1)));
 
-	if (lua_israwstring(L, 1)) {
-		moveDef = moveDefHandler.GetMoveDefByName(lua_tostring(L, 1));
-	} else {
-		const unsigned int pathType = luaL_checkint(L, 1);
+	const unsigned int pathType = luaL_checkint(L, 1);
 
-		if (pathType >= moveDefHandler.GetNumMoveDefs())
-			luaL_error(L, "Invalid moveID passed to RequestPath");
+	if (pathType >= moveDefHandler.GetNumMoveDefs())
+		luaL_error(L, "Invalid moveID passed to %s", caller);
+
+	return (moveDefHandler.GetMoveDefByPathType(pathType));
+}
+
+static void PushPathObject(lua_State* L, const int pathID)
+{
+	int* idPtr = (int*)lua_newuserdata(L, sizeof(int));
+	luaL_getmetatable(L, "Path");
+	lua_setmetatable(L, -2);
+
+	*idPtr = pathID;
+}
 
-		moveDef = moveDefHandler.GetMoveDefByPathType(pathType);
-	}
+
+int LuaPathFinder::RequestPath(lua_State* L)
+{
+	const MoveDef* moveDef = ParseMoveDef(L, __func__);
 
 	if (moveDef == nullptr)
 		return 0;
@@ -240,14 +253,72 @@ int LuaPathFinder::RequestPath(lua_State* L)
 	if (pathID == 0)
 		return 0;
 
-	int* idPtr = (int*)lua_newuserdata(L, sizeof(int));
-	luaL_getmetatable(L, "Path");
-	lua_setmetatable(L, -2);
-
-	*idPtr = pathID;
+	PushPathObject(L, pathID);
 	return 1;
 }
 
+// RequestPaths(moveID | moveName, {{sx, sy, sz, ex, ey, ez [, radius]}, ...})
+// returns an array with a path object (or false) per request; the searches
+// are solved as one batch so duplicates share a result
+int LuaPathFinder::RequestPaths(lua_State* L)
+{
+	const MoveDef* moveDef = ParseMoveDef(L, __func__);
+
+	if (moveDef == nullptr)
+		return 0;
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	std::vector<IPathManager::PathRequest> requests;
+	std::vector<unsigned int> pathIDs;
+
+	requests.reserve(lua_objlen(L, 2));
+
+	for (int i = 1; /*NA*/; i++) {
+		lua_rawgeti(L, 2, i);
+
+		if (lua_isnil(L, -1)) {
+			lua_pop(L, 1);
+			break;
+		}
+
+		if (!lua_istable(L, -1))
+			luaL_error(L, "Invalid request #%d passed to %s", i, __func__);
+
+		float args[7] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 8.0f};
+
+		for (int j = 0; j < 7; j++) {
+			lua_rawgeti(L, -1, j + 1);
+
+			if (lua_isnumber(L, -1)) {
+				args[j] = lua_tofloat(L, -1);
+			} else if (j < 6) {
+				luaL_error(L, "Invalid request #%d passed to %s", i, __func__);
+			}
+
+			lua_pop(L, 1);
+		}
+
+		requests.push_back({moveDef, {args[0], args[1], args[2]}, {args[3], args[4], args[5]}, args[6]});
+		lua_pop(L, 1);
+	}
+
+	pathManager->RequestPaths(requests, pathIDs, CLuaHandle::GetHandleSynced(L));
+
+	lua_createtable(L, pathIDs.size(), 0);
+
+	for (size_t i = 0; i < pathIDs.size(); i++) {
+		if (pathIDs[i] != 0) {
+			PushPathObject(L, pathIDs[i]);
+		} else {
+			lua_pushboolean(L, false);
+		}
+
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 1;
+}
 
 
 int LuaPathFinder::InitPathNodeCostsArray(lua_State* L)
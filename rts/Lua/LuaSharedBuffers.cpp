@@ -0,0 +1,442 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+
+#include "LuaSharedBuffers.h"
+
+#include "LuaInclude.h"
+#include "LuaHandleSynced.h"
+#include "LuaHashString.h"
+#include "LuaUtils.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "System/StringHash.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "System/Misc/TracyDefs.h"
+
+
+/******************************************************************************
+ * Shared buffers
+ * @see rts/Lua/LuaSharedBuffers.cpp
+******************************************************************************/
+
+bool LuaSharedBuffers::PushSynced(lua_State* L)
+{
+	CreateMetatable(L, true);
+
+	REGISTER_LUA_CFUNC(CreateSharedBuffer);
+	return true;
+}
+
+
+bool LuaSharedBuffers::PushUnsynced(lua_State* L)
+{
+	CreateMetatable(L, false);
+
+	REGISTER_LUA_CFUNC(GetSharedBuffer);
+	return true;
+}
+
+
+bool LuaSharedBuffers::CreateMetatable(lua_State* L, bool synced)
+{
+	luaL_newmetatable(L, "SharedBuffer");
+
+	// methods are looked up in the metatable itself
+	lua_pushvalue(L, -1);
+	lua_setfield(L, -2, "__index");
+	LuaPushNamedString(L, "__metatable", "protected metatable");
+
+		REGISTER_LUA_CFUNC(Size);
+		REGISTER_LUA_CFUNC(GetFrame);
+		REGISTER_LUA_CFUNC(Get);
+		REGISTER_LUA_CFUNC(GetArray);
+
+	// unsynced code can only read
+	if (synced) {
+		REGISTER_LUA_CFUNC(Clear);
+		REGISTER_LUA_CFUNC(Resize);
+		REGISTER_LUA_CFUNC(Set);
+		REGISTER_LUA_CFUNC(Push);
+		REGISTER_LUA_CFUNC(PushArray);
+	}
+
+	lua_pop(L, 1);
+	return true;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+void LuaSharedBuffers::Buffer::Resize(size_t newSize)
+{
+	// never shrinks the storage, buffers are usually refilled every frame
+	if ((newSize * elementSize) > data.size())
+		data.resize(newSize * elementSize, 0);
+
+	if (newSize > size)
+		std::memset(&data[size * elementSize], 0, (newSize - size) * elementSize);
+
+	size = newSize;
+}
+
+
+float LuaSharedBuffers::Buffer::GetElement(size_t index) const
+{
+	assert(index < size);
+
+	switch (elementType) {
+		case ELEMENT_FLOAT32: {
+			float value;
+			std::memcpy(&value, &data[index * sizeof(value)], sizeof(value));
+			return value;
+		} break;
+		case ELEMENT_INT32: {
+			std::int32_t value;
+			std::memcpy(&value, &data[index * sizeof(value)], sizeof(value));
+			return value;
+		} break;
+		case ELEMENT_UINT8: {
+			return data[index];
+		} break;
+		default: {
+			assert(false);
+		} break;
+	}
+
+	return 0.0f;
+}
+
+
+void LuaSharedBuffers::Buffer::SetElement(size_t index, float value)
+{
+	assert(index < size);
+
+	switch (elementType) {
+		case ELEMENT_FLOAT32: {
+			std::memcpy(&data[index * sizeof(value)], &value, sizeof(value));
+		} break;
+		case ELEMENT_INT32: {
+			// largest float below 2^31
+			const std::int32_t intValue = std::clamp(value, -2147483648.0f, 2147483520.0f);
+			std::memcpy(&data[index * sizeof(intValue)], &intValue, sizeof(intValue));
+		} break;
+		case ELEMENT_UINT8: {
+			data[index] = std::clamp(value, 0.0f, 255.0f);
+		} break;
+		default: {
+			assert(false);
+		} break;
+	}
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+LuaSharedBuffers::Buffer* LuaSharedBuffers::GetBuffer(lua_State* L, int index)
+{
+	const int* bufferIndex = static_cast<int*>(luaL_checkudata(L, index, "SharedBuffer"));
+	std::vector<Buffer>& buffers = CSplitLuaHandle::GetSharedBuffers(L).buffers;
+
+	// buffers are not part of savegames and have to be recreated after loading
+	if (*bufferIndex < 0 || *bufferIndex >= static_cast<int>(buffers.size()))
+		luaL_error(L, "[SharedBuffer] invalid buffer");
+
+	return &buffers[*bufferIndex];
+}
+
+
+void LuaSharedBuffers::PushBuffer(lua_State* L, int bufferIndex)
+{
+	int* bufferIndexPtr = static_cast<int*>(lua_newuserdata(L, sizeof(int)));
+	*bufferIndexPtr = bufferIndex;
+
+	luaL_getmetatable(L, "SharedBuffer");
+	lua_setmetatable(L, -2);
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+/***
+ * User Data SharedBuffer
+ *
+ * A typed number buffer written by synced code and read by unsynced code
+ * without copying the values through `SendToUnsynced`. Indices are 1-based.
+ * Unsynced code only gets the read methods.
+ *
+ * @class SharedBuffer
+ */
+
+/***
+ * @function SharedBuffer:Size
+ * @return integer size number of elements
+ */
+int LuaSharedBuffers::Size(lua_State* L)
+{
+	lua_pushnumber(L, GetBuffer(L, 1)->size);
+	return 1;
+}
+
+
+/***
+ * @function SharedBuffer:GetFrame
+ * @return integer frame the simulation frame of the last write, -1 if never written
+ */
+int LuaSharedBuffers::GetFrame(lua_State* L)
+{
+	lua_pushnumber(L, GetBuffer(L, 1)->writeFrame);
+	return 1;
+}
+
+
+/***
+ * @function SharedBuffer:Get
+ * @param index integer
+ * @param count integer? (Default: `1`)
+ * @return number ... values of the elements within the buffer
+ */
+int LuaSharedBuffers::Get(lua_State* L)
+{
+	const Buffer* buffer = GetBuffer(L, 1);
+
+	const size_t first = std::max(luaL_checkint(L, 2), 1) - 1;
+	const size_t last = std::min(first + std::max(luaL_optint(L, 3, 1), 0), buffer->size);
+
+	if (first >= last)
+		return 0;
+
+	luaL_checkstack(L, last - first, __func__);
+
+	for (size_t i = first; i < last; i++) {
+		lua_pushnumber(L, buffer->GetElement(i));
+	}
+
+	return (last - first);
+}
+
+
+/***
+ * @function SharedBuffer:GetArray
+ * @param values number[]? table to fill, a new one is created if not given
+ * @return number[] values
+ * @return integer size
+ */
+int LuaSharedBuffers::GetArray(lua_State* L)
+{
+	const Buffer* buffer = GetBuffer(L, 1);
+
+	if (lua_istable(L, 2)) {
+		lua_pushvalue(L, 2);
+	} else {
+		lua_createtable(L, buffer->size, 0);
+	}
+
+	for (size_t i = 0; i < buffer->size; i++) {
+		lua_pushnumber(L, buffer->GetElement(i));
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	lua_pushnumber(L, buffer->size);
+	return 2;
+}
+
+
+/***
+ * Empties the buffer, keeping its storage for the next fill.
+ *
+ * @function SharedBuffer:Clear
+ */
+int LuaSharedBuffers::Clear(lua_State* L)
+{
+	Buffer* buffer = GetBuffer(L, 1);
+
+	buffer->Resize(0);
+	buffer->writeFrame = gs->frameNum;
+	return 0;
+}
+
+
+/***
+ * @function SharedBuffer:Resize
+ * @param size integer new elements are zero
+ */
+int LuaSharedBuffers::Resize(lua_State* L)
+{
+	Buffer* buffer = GetBuffer(L, 1);
+
+	buffer->Resize(std::max(luaL_checkint(L, 2), 0));
+	buffer->writeFrame = gs->frameNum;
+	return 0;
+}
+
+
+/***
+ * Writes the values starting at index, growing the buffer if required.
+ *
+ * @function SharedBuffer:Set
+ * @param index integer
+ * @param ... number
+ */
+int LuaSharedBuffers::Set(lua_State* L)
+{
+	Buffer* buffer = GetBuffer(L, 1);
+
+	const int index = luaL_checkint(L, 2);
+	const int numValues = lua_gettop(L) - 2;
+
+	if (index < 1)
+		luaL_error(L, "[SharedBuffer::%s] index %d out of range", __func__, index);
+
+	const size_t first = index - 1;
+
+	if ((first + numValues) > buffer->size)
+		buffer->Resize(first + numValues);
+
+	for (int n = 0; n < numValues; n++) {
+		buffer->SetElement(first + n, luaL_checkfloat(L, 3 + n));
+	}
+
+	buffer->writeFrame = gs->frameNum;
+	return 0;
+}
+
+
+/***
+ * Appends the values to the end of the buffer.
+ *
+ * @function SharedBuffer:Push
+ * @param ... number
+ * @return integer size
+ */
+int LuaSharedBuffers::Push(lua_State* L)
+{
+	Buffer* buffer = GetBuffer(L, 1);
+
+	const int numValues = lua_gettop(L) - 1;
+	const size_t first = buffer->size;
+
+	buffer->Resize(first + numValues);
+
+	for (int n = 0; n < numValues; n++) {
+		buffer->SetElement(first + n, luaL_checkfloat(L, 2 + n));
+	}
+
+	buffer->writeFrame = gs->frameNum;
+
+	lua_pushnumber(L, buffer->size);
+	return 1;
+}
+
+
+/***
+ * Appends the values of an array to the end of the buffer.
+ *
+ * @function SharedBuffer:PushArray
+ * @param values number[]
+ * @param count integer? (Default: `#values`)
+ * @return integer size
+ */
+int LuaSharedBuffers::PushArray(lua_State* L)
+{
+	Buffer* buffer = GetBuffer(L, 1);
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	const int numValues = std::max(luaL_optint(L, 3, lua_objlen(L, 2)), 0);
+	const size_t first = buffer->size;
+
+	buffer->Resize(first + numValues);
+
+	for (int n = 0; n < numValues; n++) {
+		lua_rawgeti(L, 2, n + 1);
+		buffer->SetElement(first + n, lua_tofloat(L, -1));
+		lua_pop(L, 1);
+	}
+
+	buffer->writeFrame = gs->frameNum;
+
+	lua_pushnumber(L, buffer->size);
+	return 1;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+/***
+ * Creates a buffer that unsynced code can read with `Script.GetSharedBuffer`,
+ * or returns the existing one of the same name.
+ *
+ * @function Script.CreateSharedBuffer
+ * @param name string
+ * @param type ("float32"|"int32"|"uint8")? (Default: `"float32"`)
+ * @return SharedBuffer
+ */
+int LuaSharedBuffers::CreateSharedBuffer(lua_State* L)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const std::string name = luaL_checksstring(L, 1);
+
+	int elementType = ELEMENT_FLOAT32;
+	size_t elementSize = sizeof(float);
+
+	switch (hashString(luaL_optstring(L, 2, "float32"))) {
+		case hashString("float32"): { elementType = ELEMENT_FLOAT32; elementSize = sizeof(float       ); } break;
+		case hashString(  "int32"): { elementType = ELEMENT_INT32  ; elementSize = sizeof(std::int32_t); } break;
+		case hashString(  "uint8"): { elementType = ELEMENT_UINT8  ; elementSize = sizeof(std::uint8_t); } break;
+		default: {
+			luaL_error(L, "[%s] unknown element type \"%s\"", __func__, lua_tostring(L, 2));
+		} break;
+	}
+
+	std::vector<Buffer>& buffers = CSplitLuaHandle::GetSharedBuffers(L).buffers;
+
+	const auto pred = [&name](const Buffer& b) { return (b.name == name); };
+	const auto iter = std::find_if(buffers.begin(), buffers.end(), pred);
+
+	if (iter != buffers.end()) {
+		if (iter->elementType != elementType)
+			luaL_error(L, "[%s] buffer \"%s\" exists with another element type", __func__, name.c_str());
+
+		PushBuffer(L, iter - buffers.begin());
+		return 1;
+	}
+
+	Buffer& buffer = buffers.emplace_back();
+	buffer.name = name;
+	buffer.elementType = elementType;
+	buffer.elementSize = elementSize;
+
+	PushBuffer(L, buffers.size() - 1);
+	return 1;
+}
+
+
+/***
+ * @function Script.GetSharedBuffer
+ * @param name string
+ * @return SharedBuffer? buffer nil if synced code has not created it
+ */
+int LuaSharedBuffers::GetSharedBuffer(lua_State* L)
+{
+	const std::string name = luaL_checksstring(L, 1);
+	const std::vector<Buffer>& buffers = CSplitLuaHandle::GetSharedBuffers(L).buffers;
+
+	const auto pred = [&name](const Buffer& b) { return (b.name == name); };
+	const auto iter = std::find_if(buffers.begin(), buffers.end(), pred);
+
+	if (iter == buffers.end())
+		return 0;
+
+	PushBuffer(L, iter - buffers.begin());
+	return 1;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
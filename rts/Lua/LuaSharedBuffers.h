@@ -0,0 +1,90 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_SHARED_BUFFERS_H
+#define LUA_SHARED_BUFFERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct lua_State;
+
+
+/**
+ * Typed number buffers that synced code writes into and unsynced code of
+ * the same split handle reads from. Unlike SendToUnsynced, the values are
+ * never marshalled through the other Lua state; both states access the same
+ * engine-side storage, which keeps its capacity across frames.
+ * You use it like this (Lua):
+ * <code>
+ *   -- synced
+ *   local buffer = Script.CreateSharedBuffer("unitSpeeds", "float32")
+ *   buffer:Clear()
+ *   buffer:Push(unitID, speed)
+ *
+ *   -- unsynced
+ *   local buffer = Script.GetSharedBuffer("unitSpeeds")
+ *   local unitID, speed = buffer:Get(1, 2)
+ *   vbo:Upload(buffer) -- or straight into a VBO
+ * </code>
+ */
+class LuaSharedBuffers {
+	public:
+		enum ElementType {
+			ELEMENT_FLOAT32 = 0,
+			ELEMENT_INT32   = 1,
+			ELEMENT_UINT8   = 2,
+		};
+
+		struct Buffer {
+			template<typename T> T* GetData() { return reinterpret_cast<T*>(data.data()); }
+			template<typename T> const T* GetData() const { return reinterpret_cast<const T*>(data.data()); }
+
+			void Resize(size_t newSize);
+
+			float GetElement(size_t index) const;
+			void SetElement(size_t index, float value);
+
+			std::string name;
+			std::vector<std::uint8_t> data;
+
+			size_t size = 0; // in elements
+			size_t elementSize = 0;
+
+			int elementType = ELEMENT_FLOAT32;
+			int writeFrame = -1;
+		};
+
+	public:
+		static bool PushSynced(lua_State* L);
+		static bool PushUnsynced(lua_State* L);
+
+		/// also used by VBO:Upload, raises a Lua error if <index> is not a SharedBuffer
+		static Buffer* GetBuffer(lua_State* L, int index);
+
+	private:
+		std::vector<Buffer> buffers;
+
+	private: // helpers
+		static bool CreateMetatable(lua_State* L, bool synced);
+		static void PushBuffer(lua_State* L, int bufferIndex);
+
+	private: // metatable methods
+		static int Size(lua_State* L);
+		static int GetFrame(lua_State* L);
+		static int Get(lua_State* L);
+		static int GetArray(lua_State* L);
+
+		static int Clear(lua_State* L);
+		static int Resize(lua_State* L);
+		static int Set(lua_State* L);
+		static int Push(lua_State* L);
+		static int PushArray(lua_State* L);
+
+	private: // call-outs
+		static int CreateSharedBuffer(lua_State* L);
+		static int GetSharedBuffer(lua_State* L);
+};
+
+
+#endif /* LUA_SHARED_BUFFERS_H */
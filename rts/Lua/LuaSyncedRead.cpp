@@ -190,6 +190,10 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitArrayCentroid);
 	REGISTER_LUA_CFUNC(GetUnitMapCentroid);
 
+	REGISTER_LUA_CFUNC(GetUnitArrayPositions);
+	REGISTER_LUA_CFUNC(GetUnitArrayHealths);
+	REGISTER_LUA_CFUNC(GetUnitArrayVelocities);
+
 	REGISTER_LUA_CFUNC(GetFeaturesInRectangle);
 	REGISTER_LUA_CFUNC(GetFeaturesInSphere);
 	REGISTER_LUA_CFUNC(GetFeaturesInCylinder);
@@ -564,6 +568,33 @@ static int GetSolidObjectRotation(lua_State* L, const CSolidObject* o)
 	return 3;
 }
 
+static int GetUnitHealthValues(lua_State* L, const CUnit* unit)
+{
+	if (unit == nullptr)
+		return 0;
+
+	const UnitDef* ud = unit->unitDef;
+	const bool enemyUnit = LuaUtils::IsEnemyUnit(L, unit);
+
+	if (ud->hideDamage && enemyUnit) {
+		lua_pushnil(L);
+		lua_pushnil(L);
+		lua_pushnil(L);
+	} else if (!enemyUnit || (ud->decoyDef == nullptr)) {
+		lua_pushnumber(L, unit->health);
+		lua_pushnumber(L, unit->maxHealth);
+		lua_pushnumber(L, unit->paralyzeDamage);
+	} else {
+		const float scale = (ud->decoyDef->health / ud->health);
+		lua_pushnumber(L, scale * unit->health);
+		lua_pushnumber(L, scale * unit->maxHealth);
+		lua_pushnumber(L, scale * unit->paralyzeDamage);
+	}
+	lua_pushnumber(L, unit->captureProgress);
+	lua_pushnumber(L, unit->buildProgress);
+	return 5;
+}
+
 static int GetSolidObjectBlocking(lua_State* L, const CSolidObject* o)
 {
 	if (o == nullptr)
@@ -3434,6 +3465,117 @@ int LuaSyncedRead::GetUnitMapCentroid(lua_State* L)
 }
 
 
+/*
+ * Fills a flat array with <stride> values per unit of the unitID array at
+ * stack index 1, as pushed by <pushValues> for units that pass <parseUnit>.
+ * The values of the i-th unit go to [(i - 1) * stride + 1, i * stride], and
+ * are nil for units that can not be read (the per-unit call returns nothing
+ * for those). Fills the table at stack index 2 if one is given, so that it
+ * can be reused across calls without creating garbage; entries past the end
+ * of the filled range are left as they are.
+ */
+template<int stride, typename ParseUnitFunc, typename PushValuesFunc>
+static int FillUnitArrayValues(lua_State* L, const char* caller, ParseUnitFunc parseUnit, PushValuesFunc pushValues)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	const int numUnits = lua_objlen(L, 1);
+
+	if (lua_istable(L, 2)) {
+		lua_pushvalue(L, 2);
+	} else {
+		lua_createtable(L, numUnits * stride, 0);
+	}
+
+	const int valuesIndex = lua_gettop(L);
+	const int unitIndex = valuesIndex + 1;
+
+	for (int i = 0; i < numUnits; i++) {
+		lua_rawgeti(L, 1, i + 1);
+
+		if (!lua_isnumber(L, unitIndex))
+			luaL_error(L, "[%s] unitIDs[%d] not a number", caller, i + 1);
+
+		const CUnit* unit = parseUnit(L, caller, unitIndex);
+		const int numValues = (unit != nullptr)? pushValues(L, unit): 0;
+
+		assert(numValues == 0 || numValues == stride);
+
+		// pushed values sit above the unitID, fill the slots from the last one down
+		for (int n = stride - 1; n >= numValues; n--) {
+			lua_pushnil(L);
+			lua_rawseti(L, valuesIndex, i * stride + n + 1);
+		}
+		for (int n = numValues - 1; n >= 0; n--) {
+			lua_rawseti(L, valuesIndex, i * stride + n + 1);
+		}
+
+		lua_pop(L, 1);
+	}
+
+	return 1;
+}
+
+
+/*** Bulk version of `Spring.GetUnitPosition`
+ *
+ * Entries of units that are invalid or not visible are nil.
+ *
+ * @function Spring.GetUnitArrayPositions
+ * @param unitIDs integer[]
+ * @param positions number[]? table to fill, a new one is created if not given
+ * @param midPos boolean? (Default: `false`) return midpoints instead of base points
+ * @return number[] positions { x1, y1, z1, x2, y2, z2, ... }
+ */
+int LuaSyncedRead::GetUnitArrayPositions(lua_State* L)
+{
+	const bool midPos = luaL_optboolean(L, 3, false);
+
+	return FillUnitArrayValues<3>(L, __func__, ParseUnit, [midPos](lua_State* L, const CUnit* unit) {
+		const float3 pos = midPos? float3(unit->midPos): float3(unit->pos);
+
+		float3 errorVec;
+
+		if (!LuaUtils::IsAllyUnit(L, unit))
+			errorVec = unit->GetLuaErrorVector(CLuaHandle::GetHandleReadAllyTeam(L), CLuaHandle::GetHandleFullRead(L));
+
+		lua_pushnumber(L, pos.x + errorVec.x);
+		lua_pushnumber(L, pos.y + errorVec.y);
+		lua_pushnumber(L, pos.z + errorVec.z);
+		return 3;
+	});
+}
+
+/*** Bulk version of `Spring.GetUnitHealth`
+ *
+ * Entries of units that are invalid or not in LOS are nil, as are
+ * the first three of enemy units that hide their damage.
+ *
+ * @function Spring.GetUnitArrayHealths
+ * @param unitIDs integer[]
+ * @param healths number[]? table to fill, a new one is created if not given
+ * @return number[] healths { health1, maxHealth1, paralyzeDamage1, captureProgress1, buildProgress1, health2, ... }
+ */
+int LuaSyncedRead::GetUnitArrayHealths(lua_State* L)
+{
+	return FillUnitArrayValues<5>(L, __func__, ParseInLosUnit, GetUnitHealthValues);
+}
+
+/*** Bulk version of `Spring.GetUnitVelocity`
+ *
+ * Entries of units that are invalid or not in LOS are nil.
+ *
+ * @function Spring.GetUnitArrayVelocities
+ * @param unitIDs integer[]
+ * @param velocities number[]? table to fill, a new one is created if not given
+ * @return number[] velocities { x1, y1, z1, speed1, x2, ... }
+ */
+int LuaSyncedRead::GetUnitArrayVelocities(lua_State* L)
+{
+	return FillUnitArrayValues<4>(L, __func__, ParseInLosUnit, GetWorldObjectVelocity);
+}
+
+
 /***
  *
  * @function Spring.GetUnitNearestAlly
@@ -4188,30 +4330,7 @@ int LuaSyncedRead::GetUnitNeutral(lua_State* L)
  */
 int LuaSyncedRead::GetUnitHealth(lua_State* L)
 {
-	const CUnit* unit = ParseInLosUnit(L, __func__, 1);
-	if (unit == nullptr)
-		return 0;
-
-	const UnitDef* ud = unit->unitDef;
-	const bool enemyUnit = LuaUtils::IsEnemyUnit(L, unit);
-
-	if (ud->hideDamage && enemyUnit) {
-		lua_pushnil(L);
-		lua_pushnil(L);
-		lua_pushnil(L);
-	} else if (!enemyUnit || (ud->decoyDef == nullptr)) {
-		lua_pushnumber(L, unit->health);
-		lua_pushnumber(L, unit->maxHealth);
-		lua_pushnumber(L, unit->paralyzeDamage);
-	} else {
-		const float scale = (ud->decoyDef->health / ud->health);
-		lua_pushnumber(L, scale * unit->health);
-		lua_pushnumber(L, scale * unit->maxHealth);
-		lua_pushnumber(L, scale * unit->paralyzeDamage);
-	}
-	lua_pushnumber(L, unit->captureProgress);
-	lua_pushnumber(L, unit->buildProgress);
-	return 5;
+	return (GetUnitHealthValues(L, ParseInLosUnit(L, __func__, 1)));
 }
 
 
@@ -32,7 +32,10 @@ bool LuaVBOs::PushEntries(lua_State* L)
 		"Delete", &LuaVBOImpl::Delete,
 
 		"Define", &LuaVBOImpl::Define,
-		"Upload", &LuaVBOImpl::Upload,
+		"Upload", sol::overload(
+			sol::resolve<size_t(const sol::stack_table&, sol::optional<int>, sol::optional<int>, sol::optional<int>, sol::optional<int>)>(&LuaVBOImpl::Upload),
+			sol::resolve<size_t(const sol::stack_userdata&, sol::optional<int>, sol::optional<int>, sol::optional<int>, sol::optional<int>)>(&LuaVBOImpl::Upload)
+		),
 		"Download", &LuaVBOImpl::Download,
 		"Clear", &LuaVBOImpl::Clear,
 
@@ -31,6 +31,7 @@
 #include "Sim/Misc/LosHandler.h"
 #include "Game/GlobalUnsynced.h"
 
+#include "LuaSharedBuffers.h"
 #include "LuaUtils.h"
 
 
@@ -603,7 +604,11 @@ std::tuple<uint32_t, uint32_t, uint32_t> LuaVBOImpl::GetBufferSize()
  * Uploads data into the VBO.
  *
  * @function VBO:Upload
- * @param vboData number[] Array of values to upload into the VBO.
+ * @param vboData number[]|SharedBuffer Array of values to upload into the VBO.
+ *
+ * A `SharedBuffer` (see `Script.GetSharedBuffer`) is read directly, without
+ * going through a Lua table.
+ *
  * @param attributeIndex integer? (Default: `-1`)
  * 
  * If supplied with non-default value then the data from `vboData` will only be
@@ -625,41 +630,97 @@ size_t LuaVBOImpl::Upload(const sol::stack_table& luaTblData, sol::optional<int>
 {
 	VBOExistenceCheck(vbo, __func__);
 
-	const uint32_t elemOffset = static_cast<uint32_t>(std::max(elemOffsetOpt.value_or(0), 0));
-	if (elemOffset >= elementsCount) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid elemOffset [%u] >= elementsCount [%u]", __func__, elemOffset, elementsCount);
-	}
+	int attribIdx;
+	uint32_t elemOffset;
+	uint32_t luaStartIndex;
+	uint32_t luaFinishIndex;
 
-	const int attribIdx = std::max(attribIdxOpt.value_or(-1), -1);
-	if (attribIdx != -1 && bufferAttribDefs.find(attribIdx) == bufferAttribDefs.cend()) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] attribIdx is not found in bufferAttribDefs", __func__);
+	UploadArgsCheck(luaTblData.size(), attribIdxOpt, elemOffsetOpt, luaStartIndexOpt, luaFinishIndexOpt, attribIdx, elemOffset, luaStartIndex, luaFinishIndex, __func__);
+
+	std::vector<lua_Number> dataVec;
+	dataVec.resize(luaFinishIndex - luaStartIndex + 1);
+
+	constexpr auto defaultValue = static_cast<lua_Number>(0);
+	for (auto k = 0; k < dataVec.size(); ++k) {
+		dataVec[k] = luaTblData.raw_get_or<lua_Number>(luaStartIndex + k, defaultValue);
 	}
 
-	const uint32_t luaTblDataSize = luaTblData.size();
+	return UploadImpl<lua_Number>(dataVec, elemOffset, attribIdx);
+}
 
-	const uint32_t luaStartIndex = static_cast<uint32_t>(std::max(luaStartIndexOpt.value_or(1), 1));
-	if (luaStartIndex > luaTblDataSize) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaStartIndex [%u] exceeds table size [%u]", __func__, luaStartIndex, luaTblDataSize);
+size_t LuaVBOImpl::Upload(const sol::stack_userdata& sharedBufferData, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt)
+{
+	VBOExistenceCheck(vbo, __func__);
+
+	const LuaSharedBuffers::Buffer* buffer = LuaSharedBuffers::GetBuffer(sharedBufferData.lua_state(), sharedBufferData.stack_index());
+
+	// synced code commonly clears its buffers when there is nothing to send
+	if (buffer->size == 0)
+		return 0u;
+
+	int attribIdx;
+	uint32_t elemOffset;
+	uint32_t luaStartIndex;
+	uint32_t luaFinishIndex;
+
+	UploadArgsCheck(buffer->size, attribIdxOpt, elemOffsetOpt, luaStartIndexOpt, luaFinishIndexOpt, attribIdx, elemOffset, luaStartIndex, luaFinishIndex, __func__);
+
+	switch (buffer->elementType) {
+		case LuaSharedBuffers::ELEMENT_FLOAT32: {
+			const float* data = buffer->GetData<float>();
+			return UploadImpl<float>(std::vector<float>(data + luaStartIndex - 1, data + luaFinishIndex), elemOffset, attribIdx);
+		} break;
+		case LuaSharedBuffers::ELEMENT_INT32: {
+			const int32_t* data = buffer->GetData<int32_t>();
+			return UploadImpl<int32_t>(std::vector<int32_t>(data + luaStartIndex - 1, data + luaFinishIndex), elemOffset, attribIdx);
+		} break;
+		case LuaSharedBuffers::ELEMENT_UINT8: {
+			const uint8_t* data = buffer->GetData<uint8_t>();
+			return UploadImpl<uint8_t>(std::vector<uint8_t>(data + luaStartIndex - 1, data + luaFinishIndex), elemOffset, attribIdx);
+		} break;
+		default: {
+			assert(false);
+		} break;
 	}
 
-	const uint32_t luaFinishIndex = static_cast<uint32_t>(std::max(luaFinishIndexOpt.value_or(luaTblDataSize), 1));
-	if (luaFinishIndex > luaTblDataSize) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaFinishIndex [%u] exceeds table size [%u]", __func__, luaFinishIndex, luaTblDataSize);
+	return 0u;
+}
+
+void LuaVBOImpl::UploadArgsCheck(
+	uint32_t dataSize,
+	sol::optional<int> attribIdxOpt,
+	sol::optional<int> elemOffsetOpt,
+	sol::optional<int> luaStartIndexOpt,
+	sol::optional<int> luaFinishIndexOpt,
+	int& attribIdx,
+	uint32_t& elemOffset,
+	uint32_t& luaStartIndex,
+	uint32_t& luaFinishIndex,
+	const char* func
+) {
+	elemOffset = static_cast<uint32_t>(std::max(elemOffsetOpt.value_or(0), 0));
+	if (elemOffset >= elementsCount) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid elemOffset [%u] >= elementsCount [%u]", func, elemOffset, elementsCount);
 	}
 
-	if (luaStartIndex > luaFinishIndex) {
-		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaStartIndex [%u] is greater than luaFinishIndex [%u]", __func__, luaStartIndex, luaFinishIndex);
+	attribIdx = std::max(attribIdxOpt.value_or(-1), -1);
+	if (attribIdx != -1 && bufferAttribDefs.find(attribIdx) == bufferAttribDefs.cend()) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] attribIdx is not found in bufferAttribDefs", func);
 	}
 
-	std::vector<lua_Number> dataVec;
-	dataVec.resize(luaFinishIndex - luaStartIndex + 1);
+	luaStartIndex = static_cast<uint32_t>(std::max(luaStartIndexOpt.value_or(1), 1));
+	if (luaStartIndex > dataSize) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaStartIndex [%u] exceeds table size [%u]", func, luaStartIndex, dataSize);
+	}
 
-	constexpr auto defaultValue = static_cast<lua_Number>(0);
-	for (auto k = 0; k < dataVec.size(); ++k) {
-		dataVec[k] = luaTblData.raw_get_or<lua_Number>(luaStartIndex + k, defaultValue);
+	luaFinishIndex = static_cast<uint32_t>(std::max(luaFinishIndexOpt.value_or(dataSize), 1));
+	if (luaFinishIndex > dataSize) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaFinishIndex [%u] exceeds table size [%u]", func, luaFinishIndex, dataSize);
 	}
 
-	return UploadImpl<lua_Number>(dataVec, elemOffset, attribIdx);
+	if (luaStartIndex > luaFinishIndex) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid luaStartIndex [%u] is greater than luaFinishIndex [%u]", func, luaStartIndex, luaFinishIndex);
+	}
 }
 
 
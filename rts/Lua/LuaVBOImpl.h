@@ -31,6 +31,7 @@ public:
 	std::tuple<uint32_t, uint32_t, uint32_t> GetBufferSize();
 
 	size_t Upload(const sol::stack_table& luaTblData, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt);
+	size_t Upload(const sol::stack_userdata& sharedBufferData, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt);
 	sol::as_table_t<std::vector<lua_Number>> Download(sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> elemCountOpt, sol::optional<bool> forceGPUReadOpt);
 	void Clear();
 
@@ -62,6 +63,8 @@ private:
 	void AllocGLBuffer(size_t byteSize);
 	void CopyAttrMapToVec();
 
+	void UploadArgsCheck(uint32_t dataSize, sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> luaStartIndexOpt, sol::optional<int> luaFinishIndexOpt, int& attribIdx, uint32_t& elemOffset, uint32_t& luaStartIndex, uint32_t& luaFinishIndex, const char* func);
+
 	int BindBufferRangeImpl(GLuint index, const sol::optional<int> elemOffsetOpt, const sol::optional<int> elemCountOpt, const sol::optional<GLenum> targetOpt, bool bind);
 
 	bool IsTypeValid(GLenum type);
@@ -6,6 +6,7 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "System/SpringMath.h"
+#include "System/Log/ILog.h"
 
 #include <cassert>
 #include <limits>
@@ -190,6 +191,46 @@ void CGround::CheckColSquare(CProjectile* p, int x, int y)
 }
 */
 
+// margin for float imprecision when comparing ray heights against pyramid bounds
+static constexpr float PYRAMID_HEIGHT_EPS = 0.1f;
+
+// lowest height of the (infinite) line through <from> along <dir> over the squares in <rect>
+static inline float LineMinHeightOverRect(const float3& from, const float3& dir, const SRectangle& rect)
+{
+	const float tx1 = (rect.x1 * SQUARE_SIZE - from.x) / dir.x;
+	const float tx2 = (rect.x2 * SQUARE_SIZE - from.x) / dir.x;
+	const float tz1 = (rect.z1 * SQUARE_SIZE - from.z) / dir.z;
+	const float tz2 = (rect.z2 * SQUARE_SIZE - from.z) / dir.z;
+
+	const float tmin = std::max(std::min(tx1, tx2), std::min(tz1, tz2));
+	const float tmax = std::min(std::max(tx1, tx2), std::max(tz1, tz2));
+
+	// line misses the rectangle
+	if (tmin > tmax)
+		return std::numeric_limits<float>::max();
+
+	return (std::min(from.y + dir.y * tmin, from.y + dir.y * tmax));
+}
+
+// highest pyramid level whose cell containing square <x>,<z> the line passes above, -1 if none
+static inline int LineClearLevel(const CHeightMapPyramid* pyramid, const float3& from, const float3& dir, int x, int z)
+{
+	int level = -1;
+
+	while ((level + 1) < pyramid->GetNumLevels()) {
+		const float cellMaxHeight = pyramid->GetBounds(level + 1, x, z).y;
+		const float lineMinHeight = LineMinHeightOverRect(from, dir, pyramid->GetCellRect(level + 1, x, z));
+
+		if (lineMinHeight <= (cellMaxHeight + PYRAMID_HEIGHT_EPS))
+			break;
+
+		level++;
+	}
+
+	return level;
+}
+
+
 inline static bool ClampInMapHeight(float3& from, float3& to)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -212,7 +253,11 @@ inline static bool ClampInMapHeight(float3& from, float3& to)
 }
 
 
-float CGround::LineGroundCol(float3 from, float3 to, bool synced)
+// if <pyramid> is non-null, squares and blocks of squares which the line
+// provably passes above (or beside) are skipped without testing them; the
+// remaining squares are visited in the same order and by the same tests as
+// without it, so either way produces identical results
+static float LineGroundColImpl(float3 from, float3 to, bool synced, const CHeightMapPyramid* pyramid)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const float* hm  = readMap->GetSharedCornerHeightMap(synced);
@@ -333,9 +378,75 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 		int curx = fsx;
 		int curz = fsz;
 
+		// normalized positions along the ray at which the traversal leaves column <x> or row <z>
+		const auto nextEdgeX = [&](int x) { return (((x + dirx) - tsx) * dirx > 0)? 1337.0f: ((x + dirx) + testposx - ffsx) * rdsx; };
+		const auto nextEdgeZ = [&](int z) { return (((z + dirz) - tsz) * dirz > 0)? 1337.0f: ((z + dirz) + testposz - ffsz) * rdsz; };
+
+		const float3 dir = to - from;
+
 		for (unsigned int i = 0, n = Square(mapDims.mapxp1) + Square(mapDims.mapyp1); !stopTrace; i++) {
+			const bool inMap = (curx >= 0) && (curz >= 0) && (curx <= mapDims.mapxm1) && (curz <= mapDims.mapym1);
+			const int clearLevel = (pyramid != nullptr && inMap)? LineClearLevel(pyramid, from, dir, curx, curz): -1;
+
+			const int prevx = curx;
+			const int prevz = curz;
+
+			bool jumped = false;
+
+			// the ray passes above the whole cell, jump to the square through which the
+			// per-square traversal below would leave it; cells containing the column
+			// or row in which the ray ends are left square by square, try a smaller one
+			for (int level = clearLevel; level > 0; level--) {
+				const SRectangle cell = pyramid->GetCellRect(level, curx, curz);
+
+				const int exitx = (dirx > 0)? (cell.x2 - 1): cell.x1;
+				const int exitz = (dirz > 0)? (cell.z2 - 1): cell.z1;
+				const float exitxn = nextEdgeX(exitx);
+				const float exitzn = nextEdgeZ(exitz);
+
+				if (exitxn >= 1.0f || exitzn >= 1.0f)
+					continue;
+
+				if (exitxn < exitzn) {
+					// leaves through the x-edge, in the first row whose z-edge lies beyond it
+					int z = std::clamp(int(ffsz + exitxn * dz / SQUARE_SIZE), std::min(curz, exitz), std::max(curz, exitz));
+
+					while (nextEdgeZ(z) <= exitxn)
+						z += dirz;
+					while (z != curz && nextEdgeZ(z - dirz) > exitxn)
+						z -= dirz;
+
+					curx = exitx + dirx;
+					curz = z;
+				} else {
+					// leaves through the z-edge, in the first column whose x-edge is not before it
+					int x = std::clamp(int(ffsx + exitzn * dx / SQUARE_SIZE), std::min(curx, exitx), std::max(curx, exitx));
+
+					while (nextEdgeX(x) < exitzn)
+						x += dirx;
+					while (x != curx && nextEdgeX(x - dirx) >= exitzn)
+						x -= dirx;
+
+					curx = x;
+					curz = exitz + dirz;
+				}
+
+				jumped = true;
+				break;
+			}
+
+			if (jumped) {
+				// count the skipped squares towards the iteration limit as if each had been visited
+				i += (std::abs(curx - prevx) + std::abs(curz - prevz) - 1);
+
+				if (Square(i) > n)
+					break;
+
+				continue;
+			}
+
 			// test for collision with the ground-square triangles
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  curx, curz);
+			const float ret = (clearLevel < 0)? LineGroundSquareCol(hm, nm,  from, to,  curx, curz): -2.0f;
 
 			if (ret >= 0.0f)
 				return (ret + skippedDist);
@@ -382,6 +493,27 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 	return -1.0f;
 }
 
+float CGround::LineGroundCol(float3 from, float3 to, bool synced)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the pyramid only covers the synced heightmap
+	const CHeightMapPyramid* pyramid = synced? readMap->GetHeightMapPyramidSynced(): nullptr;
+
+	if (pyramid == nullptr)
+		return (LineGroundColImpl(from, to, synced, nullptr));
+
+	const float ret = LineGroundColImpl(from, to, synced, pyramid);
+
+	if (readMap->ValidateHeightMapPyramid()) {
+		const float ref = LineGroundColImpl(from, to, synced, nullptr);
+
+		if (ret != ref)
+			LOG_L(L_WARNING, "[Ground::%s] from=<%f,%f,%f> to=<%f,%f,%f> dist=%f (expected %f)", __func__, from.x, from.y, from.z, to.x, to.y, to.z, ret, ref);
+	}
+
+	return ret;
+}
+
 float CGround::LineGroundCol(const float3 pos, const float3 dir, float len, bool synced)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -553,7 +685,40 @@ float3 CGround::GetSmoothNormal(float x, float z, bool synced)
 
 
 
-float CGround::SimTrajectoryGroundColDist(const float3& trajStartPos, const float3& trajStartDir, const float3& acc, const float2& args)
+namespace {
+	// remembers the largest pyramid cell a sampled trajectory is known to be above
+	struct PyramidCellCache {
+		PyramidCellCache(const CHeightMapPyramid* p): pyramid(p) {}
+
+		// true if the ground everywhere in square <x>,<z> is lower than <y>
+		bool IsAbove(int x, int z, float y) {
+			if (cell.Inside({x, z}) && y > (cellMaxHeight + PYRAMID_HEIGHT_EPS))
+				return true;
+
+			const int level = pyramid->FindLevelBelow(x, z, y - PYRAMID_HEIGHT_EPS);
+
+			if (level < 0)
+				return false;
+
+			cell = pyramid->GetCellRect(level, x, z);
+			cellMaxHeight = pyramid->GetBounds(level, x, z).y;
+			return true;
+		}
+
+		// true if the ground everywhere in square <x>,<z> is higher than <y>
+		bool IsBelow(int x, int z, float y) const {
+			return (y < (pyramid->GetBounds(0, x, z).x - PYRAMID_HEIGHT_EPS));
+		}
+
+		const CHeightMapPyramid* pyramid;
+
+		SRectangle cell;
+		float cellMaxHeight = 0.0f;
+	};
+}
+
+
+static float SimTrajectoryGroundColDistImpl(const float3& trajStartPos, const float3& trajStartDir, const float3& acc, const float2& args, const CHeightMapPyramid* pyramid)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// args.x := speed, args.y := length
@@ -576,9 +741,30 @@ float CGround::SimTrajectoryGroundColDist(const float3& trajStartPos, const floa
 		vel += acc;
 		pos += vel;
 	}
-	while (pos.y >= GetHeightReal(pos)) {
-		vel += acc;
-		pos += vel;
+
+	if (pyramid == nullptr) {
+		while (pos.y >= CGround::GetHeightReal(pos)) {
+			vel += acc;
+			pos += vel;
+		}
+	} else {
+		PyramidCellCache cache(pyramid);
+
+		while (true) {
+			// same square as sampled by GetHeightReal
+			const int sx = std::clamp(pos.x, 0.0f, float3::maxxpos) / SQUARE_SIZE;
+			const int sz = std::clamp(pos.z, 0.0f, float3::maxzpos) / SQUARE_SIZE;
+
+			if (!cache.IsAbove(sx, sz, pos.y)) {
+				if (cache.IsBelow(sx, sz, pos.y))
+					break;
+				if (pos.y < CGround::GetHeightReal(pos))
+					break;
+			}
+
+			vel += acc;
+			pos += vel;
+		}
 	}
 
 	if (pos.SqDistance2D(trajStartPos) >= Square(maxDist))
@@ -587,7 +773,7 @@ float CGround::SimTrajectoryGroundColDist(const float3& trajStartPos, const floa
 	return (math::sqrt(pos.SqDistance2D(trajStartPos)));
 }
 
-float CGround::TrajectoryGroundCol(const float3& trajStartPos, const float3& trajTargetDir, float length, float linCoeff, float qdrCoeff)
+static float TrajectoryGroundColImpl(const float3& trajStartPos, const float3& trajTargetDir, float length, float linCoeff, float qdrCoeff, const CHeightMapPyramid* pyramid)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// trajTargetDir should be the normalized xz-vector from <trajStartPos> to the target
@@ -604,14 +790,27 @@ float CGround::TrajectoryGroundCol(const float3& trajStartPos, const float3& tra
 	const float minDist = length * std::max(0.0f, ips.x);
 	const float maxDist = length * std::min(1.0f, ips.y);
 
+	PyramidCellCache cache(pyramid);
+
 	for (float dist = minDist; dist < maxDist; dist += SQUARE_SIZE) {
 		const float3 pos = (trajStartPos + dir * dist) + (alt * dist * dist);
 
+		if (pyramid != nullptr) {
+			// same square as sampled by GetApproximateHeight
+			const int sx = std::clamp(int(pos.x) / SQUARE_SIZE, 0, mapDims.mapxm1);
+			const int sz = std::clamp(int(pos.z) / SQUARE_SIZE, 0, mapDims.mapym1);
+
+			if (cache.IsAbove(sx, sz, pos.y))
+				continue;
+			if (cache.IsBelow(sx, sz, pos.y))
+				return dist;
+		}
+
 		#if 1
-		if (GetApproximateHeight(pos) > pos.y)
+		if (CGround::GetApproximateHeight(pos) > pos.y)
 			return dist;
 		#else
-		if (GetHeightReal(pos) > pos.y)
+		if (CGround::GetHeightReal(pos) > pos.y)
 			return dist;
 		#endif
 	}
@@ -619,6 +818,46 @@ float CGround::TrajectoryGroundCol(const float3& trajStartPos, const float3& tra
 	return -1.0f;
 }
 
+float CGround::SimTrajectoryGroundColDist(const float3& trajStartPos, const float3& trajStartDir, const float3& acc, const float2& args)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const CHeightMapPyramid* pyramid = readMap->GetHeightMapPyramidSynced();
+
+	if (pyramid == nullptr)
+		return (SimTrajectoryGroundColDistImpl(trajStartPos, trajStartDir, acc, args, nullptr));
+
+	const float ret = SimTrajectoryGroundColDistImpl(trajStartPos, trajStartDir, acc, args, pyramid);
+
+	if (readMap->ValidateHeightMapPyramid()) {
+		const float ref = SimTrajectoryGroundColDistImpl(trajStartPos, trajStartDir, acc, args, nullptr);
+
+		if (ret != ref)
+			LOG_L(L_WARNING, "[Ground::%s] pos=<%f,%f,%f> dir=<%f,%f,%f> dist=%f (expected %f)", __func__, trajStartPos.x, trajStartPos.y, trajStartPos.z, trajStartDir.x, trajStartDir.y, trajStartDir.z, ret, ref);
+	}
+
+	return ret;
+}
+
+float CGround::TrajectoryGroundCol(const float3& trajStartPos, const float3& trajTargetDir, float length, float linCoeff, float qdrCoeff)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const CHeightMapPyramid* pyramid = readMap->GetHeightMapPyramidSynced();
+
+	if (pyramid == nullptr)
+		return (TrajectoryGroundColImpl(trajStartPos, trajTargetDir, length, linCoeff, qdrCoeff, nullptr));
+
+	const float ret = TrajectoryGroundColImpl(trajStartPos, trajTargetDir, length, linCoeff, qdrCoeff, pyramid);
+
+	if (readMap->ValidateHeightMapPyramid()) {
+		const float ref = TrajectoryGroundColImpl(trajStartPos, trajTargetDir, length, linCoeff, qdrCoeff, nullptr);
+
+		if (ret != ref)
+			LOG_L(L_WARNING, "[Ground::%s] pos=<%f,%f,%f> dir=<%f,%f,%f> dist=%f (expected %f)", __func__, trajStartPos.x, trajStartPos.y, trajStartPos.z, trajTargetDir.x, trajTargetDir.y, trajTargetDir.z, ret, ref);
+	}
+
+	return ret;
+}
+
 
 
 int CGround::GetSquare(const float3& pos) {
@@ -0,0 +1,96 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "HeightMapPyramid.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "System/Misc/TracyDefs.h"
+
+
+void CHeightMapPyramid::Init(int sizeX, int sizeZ)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(sizeX > 0 && sizeZ > 0);
+
+	levels.clear();
+
+	while (true) {
+		Level& level = levels.emplace_back();
+
+		level.sizeX = sizeX;
+		level.sizeZ = sizeZ;
+		level.bounds.clear();
+		level.bounds.resize(sizeX * sizeZ, {0.0f, 0.0f});
+
+		if (sizeX == 1 && sizeZ == 1)
+			break;
+
+		sizeX = (sizeX + 1) >> 1;
+		sizeZ = (sizeZ + 1) >> 1;
+	}
+}
+
+
+void CHeightMapPyramid::Update(const float* cornerHeightMap, const SRectangle& rect)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (levels.empty())
+		return;
+
+	{
+		Level& base = levels[0];
+
+		const int x1 = std::max(rect.x1, 0);
+		const int z1 = std::max(rect.z1, 0);
+		const int x2 = std::min(rect.x2, base.sizeX - 1);
+		const int z2 = std::min(rect.z2, base.sizeZ - 1);
+
+		// corner heightmap has one more vertex per row than there are squares
+		const int cornerSizeX = base.sizeX + 1;
+
+		for (int z = z1; z <= z2; z++) {
+			for (int x = x1; x <= x2; x++) {
+				const float hTL = cornerHeightMap[(z    ) * cornerSizeX + x    ];
+				const float hTR = cornerHeightMap[(z    ) * cornerSizeX + x + 1];
+				const float hBL = cornerHeightMap[(z + 1) * cornerSizeX + x    ];
+				const float hBR = cornerHeightMap[(z + 1) * cornerSizeX + x + 1];
+
+				base.bounds[z * base.sizeX + x] = {
+					std::min(std::min(hTL, hTR), std::min(hBL, hBR)),
+					std::max(std::max(hTL, hTR), std::max(hBL, hBR)),
+				};
+			}
+		}
+	}
+
+	for (size_t i = 1; i < levels.size(); i++) {
+		const Level& src = levels[i - 1];
+		      Level& dst = levels[i    ];
+
+		const int x1 = std::max(rect.x1, 0) >> i;
+		const int z1 = std::max(rect.z1, 0) >> i;
+		const int x2 = std::min(rect.x2 >> i, dst.sizeX - 1);
+		const int z2 = std::min(rect.z2 >> i, dst.sizeZ - 1);
+
+		for (int z = z1; z <= z2; z++) {
+			for (int x = x1; x <= x2; x++) {
+				// odd-sized levels have cells with only one child along an edge
+				const int sx1 = x * 2;
+				const int sz1 = z * 2;
+				const int sx2 = std::min(sx1 + 1, src.sizeX - 1);
+				const int sz2 = std::min(sz1 + 1, src.sizeZ - 1);
+
+				const float2& bTL = src.bounds[sz1 * src.sizeX + sx1];
+				const float2& bTR = src.bounds[sz1 * src.sizeX + sx2];
+				const float2& bBL = src.bounds[sz2 * src.sizeX + sx1];
+				const float2& bBR = src.bounds[sz2 * src.sizeX + sx2];
+
+				dst.bounds[z * dst.sizeX + x] = {
+					std::min(std::min(bTL.x, bTR.x), std::min(bBL.x, bBR.x)),
+					std::max(std::max(bTL.y, bTR.y), std::max(bBL.y, bBR.y)),
+				};
+			}
+		}
+	}
+}
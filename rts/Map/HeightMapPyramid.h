@@ -0,0 +1,72 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef HEIGHTMAP_PYRAMID_H
+#define HEIGHTMAP_PYRAMID_H
+
+#include <algorithm>
+#include <vector>
+
+#include "System/type2.h"
+#include "System/Rectangle.h"
+
+/**
+ * @brief min/max mip pyramid over a corner heightmap
+ *
+ * Level 0 holds the lowest and highest corner height of every heightmap
+ * square, each cell of level n+1 the bounds of (up to) 2x2 cells of level n
+ * until a single cell covers the whole map. Ground ray-casts use it to skip
+ * blocks of squares which a ray or trajectory passes above without looking
+ * at the individual triangles.
+ */
+class CHeightMapPyramid
+{
+public:
+	/// allocates the levels for a map of <sizeX> x <sizeZ> squares
+	void Init(int sizeX, int sizeZ);
+	void Kill() { levels.clear(); }
+
+	/**
+	 * recalculates the bounds of the squares in <rect> (x2 and z2 inclusive)
+	 * from <cornerHeightMap> and those of all coarser cells containing them
+	 */
+	void Update(const float* cornerHeightMap, const SRectangle& rect);
+
+	int GetNumLevels() const { return (static_cast<int>(levels.size())); }
+
+	/// {min, max} of the cell on <level> which contains square <x>,<z>
+	const float2& GetBounds(int level, int x, int z) const {
+		const Level& l = levels[level];
+		return l.bounds[(z >> level) * l.sizeX + (x >> level)];
+	}
+
+	/// squares covered by the cell on <level> which contains square <x>,<z> (x2 and z2 exclusive)
+	SRectangle GetCellRect(int level, int x, int z) const {
+		const int x1 = (x >> level) << level;
+		const int z1 = (z >> level) << level;
+
+		return {x1, z1, std::min(x1 + (1 << level), levels[0].sizeX), std::min(z1 + (1 << level), levels[0].sizeZ)};
+	}
+
+	/// highest level whose cell containing square <x>,<z> lies entirely below <height>, -1 if none
+	int FindLevelBelow(int x, int z, float height) const {
+		int level = -1;
+
+		// cells only grow taller towards the top
+		while ((level + 1) < GetNumLevels() && GetBounds(level + 1, x, z).y < height)
+			level++;
+
+		return level;
+	}
+
+private:
+	struct Level {
+		int sizeX = 0;
+		int sizeZ = 0;
+
+		std::vector<float2> bounds;
+	};
+
+	std::vector<Level> levels;
+};
+
+#endif // HEIGHTMAP_PYRAMID_H
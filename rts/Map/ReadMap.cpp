@@ -14,6 +14,7 @@
 #include "Game/LoadScreen.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/SpringMath.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/FileSystem/ArchiveScanner.h"
@@ -31,6 +32,9 @@
 
 static constexpr size_t MAX_UHM_RECTS_PER_FRAME = 128;
 
+CONFIG(bool, GroundRayPyramid).defaultValue(true).description("Use a min/max pyramid over the heightmap to skip terrain which ground ray-casts pass above.");
+CONFIG(bool, GroundRayPyramidValidation).defaultValue(false).description("Repeat every ground ray-cast that used the heightmap pyramid without it and log differing results. Slow, for debugging only.");
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -65,6 +69,8 @@ CR_REG_METADATA(CReadMap, (
 	CR_IGNORED(unsyncedHeightInfo),
 	CR_IGNORED(boundingRadius),
 	CR_IGNORED(mapChecksum),
+	CR_IGNORED(useHeightMapPyramid),
+	CR_IGNORED(validateHeightMapPyramid),
 
 	CR_IGNORED(heightMapSyncedPtr),
 	CR_IGNORED(heightMapUnsyncedPtr),
@@ -115,6 +121,7 @@ std::vector<float> CReadMap::mapFileHeightMap;
 std::vector<float> CReadMap::originalHeightMap;
 std::vector<float> CReadMap::centerHeightMap;
 std::vector<float> CReadMap::maxHeightMap;
+CHeightMapPyramid CReadMap::heightMapPyramid;
 std::array<std::vector<float>, CReadMap::numHeightMipMaps - 1> CReadMap::mipCenterHeightMaps;
 
 std::vector<float3> CReadMap::faceNormalsSynced;
@@ -334,6 +341,9 @@ void CReadMap::Initialize()
 			reqMemFootPrintKB += ((((mapDims.mapx >> i) * (mapDims.mapy >> i)) * sizeof(float)) / 1024);
 		}
 
+		// heightMapPyramid, all levels together take at most 4/3 of the first
+		reqMemFootPrintKB += (((mapDims.mapx * mapDims.mapy * sizeof(float2)) / 1024) * 4) / 3;
+
 		sprintf(loadMsg, fmtString, reqMemFootPrintKB / 1024);
 		loadscreen->SetLoadMessage(loadMsg);
 	}
@@ -356,6 +366,10 @@ void CReadMap::Initialize()
 	centerHeightMap.resize(mapDims.mapx * mapDims.mapy);
 	maxHeightMap.clear();
 	maxHeightMap.resize(mapDims.mapx * mapDims.mapy);
+	heightMapPyramid.Init(mapDims.mapx, mapDims.mapy);
+
+	useHeightMapPyramid = configHandler->GetBool("GroundRayPyramid");
+	validateHeightMapPyramid = configHandler->GetBool("GroundRayPyramidValidation");
 
 	mipPointerHeightMaps.fill(nullptr);
 	mipPointerHeightMaps[0] = &centerHeightMap[0];
@@ -534,6 +548,7 @@ void CReadMap::UpdateHeightMapSynced(const SRectangle& hgtMapRect)
 
 	UpdateCenterHeightmap(centerRect, initialize);
 	UpdateMipHeightmaps(centerRect, initialize);
+	heightMapPyramid.Update(GetCornerHeightMapSynced(), centerRect);
 	UpdateFaceNormals(centerRect, initialize);
 	UpdateSlopemap(centerRect, initialize); // must happen after UpdateFaceNormals()!
 
@@ -8,6 +8,7 @@
 
 #include "MapTexture.h"
 #include "MapDimensions.h"
+#include "HeightMapPyramid.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "System/float3.h"
@@ -192,6 +193,11 @@ public:
 	const float3* GetSharedCenterNormals(bool synced) const { return sharedCenterNormals[synced]; }
 	const float* GetSharedSlopeMap(bool synced) const { return sharedSlopeMaps[synced]; }
 
+	/// min/max pyramid over the synced heightmap, nullptr if ground ray-casts should not use it
+	const CHeightMapPyramid* GetHeightMapPyramidSynced() const { return (useHeightMapPyramid? &heightMapPyramid: nullptr); }
+	/// if ray-casts using the pyramid should be checked against the plain per-square traversal
+	bool ValidateHeightMapPyramid() const { return validateHeightMapPyramid; }
+
 	// Misc
 	void CopySyncedToUnsynced();
 
@@ -262,6 +268,7 @@ protected:
 	static std::vector<float> centerHeightMap;          //< size: (mapx  )*(mapy  ) (per face) [SYNCED, updates on terrain deformation]
 	static std::array<std::vector<float>, numHeightMipMaps - 1> mipCenterHeightMaps;
 	static std::vector<float> maxHeightMap;			// map for sea/hover to catch coast lines with sharp vertical changes so they don't try to climb the cliff.
+	static CHeightMapPyramid heightMapPyramid;          //< min/max corner heights per square and per 2^n x 2^n squares [SYNCED, updates on terrain deformation]
 
 	/**
 	 * array of pointers to heightmaps in different resolutions
@@ -304,6 +311,9 @@ private:
 	bool processingHeightBounds = false;
 	bool hmUpdated = false;
 
+	bool useHeightMapPyramid = true;
+	bool validateHeightMapPyramid = false;
+
 	float2 initHeightBounds; //< initial minimum- and maximum-height (before any deformations)
 	float2 tempHeightBounds; //< temporary minimum- and maximum-height
 	float2 currHeightBounds; //< current minimum- and maximum-height
@@ -73,6 +73,7 @@ CONFIG(int, SpeedControl).defaultValue(1).minimumValue(1).maximumValue(2)
 CONFIG(bool, AllowSpectatorJoin).defaultValue(true).dedicatedValue(false).description("allow any unauthenticated clients to join as spectator with any name, name will be prefixed with ~");
 CONFIG(bool, WhiteListAdditionalPlayers).defaultValue(true);
 CONFIG(bool, ServerRecordDemos).defaultValue(false).dedicatedValue(true);
+CONFIG(int, DemoKeyframeInterval).defaultValue(0).minimumValue(0).description("Frames between savegame keyframes written while watching a demo (0 to disable), used by --demo-seek to avoid resimulating from the start.");
 CONFIG(bool, ServerLogInfoMessages).defaultValue(false);
 CONFIG(bool, ServerLogDebugMessages).defaultValue(false);
 CONFIG(std::string, AutohostIP).defaultValue("127.0.0.1");
@@ -110,6 +111,9 @@ static constexpr unsigned gameProgressFrameInterval = GAME_SPEED * 5;
 
 static constexpr unsigned syncResponseEchoInterval = GAME_SPEED * 2;
 
+/// unconsumed demo stream positions kept for keyframe creation by the client
+static constexpr size_t maxDemoStreamPositions = 64;
+
 
 //FIXME remodularize server commands, so they get registered in word completion etc.
 decltype(CGameServer::commandBlacklist) CGameServer::commandBlacklist{
@@ -185,6 +189,7 @@ void CGameServer::Initialize()
 	if (myGameSetup->hostDemo) {
 		Message(spring::format(PlayingDemo, myGameSetup->demoName.c_str()));
 		demoReader.reset(new CDemoReader(myGameSetup->demoName, modGameTime + 0.1f));
+		demoKeyframeInterval = configHandler->GetInt("DemoKeyframeInterval");
 	}
 
 	// initialize players, teams & ais
@@ -436,6 +441,44 @@ void CGameServer::SkipTo(int targetFrameNum)
 	isPaused = wasPaused;
 }
 
+bool CGameServer::SeekDemoKeyframe(const DemoKeyframe& keyframe)
+{
+	std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+
+	if (gameHasStarted || demoReader == nullptr)
+		return false;
+
+	if (!demoReader->SeekStreamPos(keyframe.pos, modGameTime)) {
+		Message(spring::format("Warning: invalid demo keyframe for frame %d", keyframe.pos.frameNum));
+		return false;
+	}
+
+	Message(spring::format("Resuming demo from keyframe at frame %d", keyframe.pos.frameNum), false);
+	return true;
+}
+
+void CGameServer::SetDemoSkipTarget(int targetFrameNum)
+{
+	std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+	demoSkipTargetFrame = targetFrameNum;
+}
+
+DemoStreamPos CGameServer::PopDemoStreamPos(int frameNum)
+{
+	std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+
+	// positions are recorded in frame order; drop all older than <frameNum>
+	while (!demoStreamPositions.empty() && demoStreamPositions.front().frameNum < frameNum)
+		demoStreamPositions.pop_front();
+
+	if (demoStreamPositions.empty() || demoStreamPositions.front().frameNum != frameNum)
+		return {};
+
+	const DemoStreamPos pos = demoStreamPositions.front();
+	demoStreamPositions.pop_front();
+	return pos;
+}
+
 std::string CGameServer::GetPlayerNames(const std::vector<int>& indices) const
 {
 	std::string playerstring;
@@ -483,6 +526,17 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 				CheckSync();
 #endif
 
+				// remember where this frame ends so the client can tie a keyframe to it
+				if (demoKeyframeInterval > 0 && (serverFrameNum % demoKeyframeInterval) == 0) {
+					demoStreamPositions.push_back(demoReader->GetStreamPos(serverFrameNum));
+
+					// bounded in case the client does not consume them
+					if (demoStreamPositions.size() > maxDemoStreamPositions) {
+						LOG_L(L_WARNING, "[%s] dropping unconsumed demo keyframe position for frame %d", __func__, demoStreamPositions.front().frameNum);
+						demoStreamPositions.pop_front();
+					}
+				}
+
 				Broadcast(rpkt);
 				break;
 			}
@@ -844,6 +898,11 @@ void CGameServer::Update()
 	else if (!PreSimFrame() || demoReader != nullptr)
 		CreateNewFrame(true, false);
 
+	if (gameHasStarted && demoSkipTargetFrame >= 0) {
+		SkipTo(demoSkipTargetFrame);
+		demoSkipTargetFrame = -1;
+	}
+
 	if (hostif != nullptr) {
 		const std::string msg = hostif->GetChatMessage();
 
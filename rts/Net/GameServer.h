@@ -19,6 +19,7 @@
 #include "Sim/Misc/TeamBase.h"
 #include "System/float3.h"
 #include "System/GlobalRNG.h"
+#include "System/LoadSave/DemoKeyframes.h"
 #include "System/Misc/SpringTime.h"
 #include "System/Threading/SpringThreading.h"
 
@@ -114,6 +115,18 @@ public:
 	const std::shared_ptr<const    GameData> GetGameData() const { return myGameData; }
 	const std::shared_ptr<const  CGameSetup> GetGameSetup() const { return myGameSetup; }
 
+	/**
+	 * @brief resume demo playback from a keyframe
+	 * Must be called before the game starts; the local client is expected
+	 * to load the keyframe's savegame, after which PostLoad sets the frame
+	 * to the keyframe's and reading continues from its stream position.
+	 */
+	bool SeekDemoKeyframe(const DemoKeyframe& keyframe);
+	/// skip demo playback to <targetFrameNum> as soon as the game has started
+	void SetDemoSkipTarget(int targetFrameNum);
+	/// demo stream position recorded when <frameNum> was read, frameNum of the result is -1 if none
+	DemoStreamPos PopDemoStreamPos(int frameNum);
+
 	const std::unique_ptr<CDemoReader>& GetDemoReader() const { return demoReader; }
 	const std::unique_ptr<CDemoRecorder>& GetDemoRecorder() const { return demoRecorder; }
 
@@ -222,6 +235,7 @@ private:
 	std::pair<std::string, std::string> refClientVersion;
 
 	std::deque< std::shared_ptr<const netcode::RawPacket> > packetCache;
+	std::deque<DemoStreamPos> demoStreamPositions;
 
 	/////////////////// sync stuff ///////////////////
 #ifdef SYNCCHECK
@@ -253,6 +267,10 @@ private:
 
 	int serverFrameNum = -1;
 
+	/// record a DemoStreamPos every this many demo frames, for keyframe creation by the client
+	int demoKeyframeInterval = 0;
+	int demoSkipTargetFrame = -1;
+
 	int syncErrorFrame = 0;
 	int syncWarningFrame = 0;
 	bool desyncHasOccurred = false;
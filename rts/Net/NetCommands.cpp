@@ -631,7 +631,12 @@ void CGame::ClientReadNet()
 				if ((gs->frameNum & 4095) == 0)
 					CSyncChecker::NewFrame();
 #endif
+				const bool keyframeQueued = WriteDemoKeyframe();
 				AddTraffic(-1, packetCode, dataLength);
+
+				// the queued keyframe save has to capture the state of this frame
+				if (keyframeQueued)
+					return;
 			} break;
 
 			case NETMSG_SYNCRESPONSE: {
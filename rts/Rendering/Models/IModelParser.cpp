@@ -385,11 +385,15 @@ void CModelLoader::DrainPreloadFutures(uint32_t numAllowed)
 	if (preloadFutures.size() <= numAllowed)
 		return;
 
-	while (preloadFutures.size() > numAllowed) {
-		//drain queue until there are <= numAllowed items there
-		std::erase_if(preloadFutures, erasePredicate);
-		spring_sleep(spring_msecs(100));
+	// block on the oldest outstanding loads rather than polling, s.t. the
+	// caller resumes as soon as the pool threads have parsed enough models
+	const size_t numWait = preloadFutures.size() - numAllowed;
+
+	for (size_t i = 0; i < numWait; i++) {
+		preloadFutures[i].wait();
 	}
+
+	preloadFutures.erase(preloadFutures.begin(), preloadFutures.begin() + numWait);
 }
 
 IModelParser* CModelLoader::GetFormatParser(const std::string& pathExt)
@@ -5,9 +5,15 @@
 #include "3DModelDefs.hpp"
 #include "System/Misc/TracyDefs.h"
 
+#include <algorithm>
+#include <bit>
+#include <utility>
+
 CR_BIND(LocalModel, )
 CR_REG_METADATA(LocalModel, (
 	CR_MEMBER(pieces),
+	CR_MEMBER(dirtyPieceBits),
+	CR_IGNORED(pieceTreeEnds),
 
 	CR_MEMBER(boundingVolume),
 	CR_IGNORED(luaMaterialData),
@@ -64,7 +70,8 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 			pieces[n].original = omp;
 		}
 
-		pieces[0].UpdateChildTransformRec(true);
+		InitPieceTree();
+		UpdatePieceTransforms(true);
 		UpdateBoundingVolume();
 		return;
 	}
@@ -75,11 +82,17 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 	pieces.reserve(model->numPieces);
 
 	CreateLocalModelPieces(model->GetRootPiece());
+	InitPieceTree();
+
+	// all pieces start out dirty
+	dirtyPieceBits.clear();
+	dirtyPieceBits.resize((pieces.size() + 63) / 64, 0);
+	SetPieceTreeDirty(0);
 
-	// must recursively update matrices here too: for features
+	// must update matrices here too: for features
 	// LocalModel::Update is never called, but they might have
 	// baked piece rotations (in the case of .dae)
-	pieces[0].UpdateChildTransformRec(false);
+	UpdatePieceTransforms(false);
 
 	for (auto& piece : pieces) {
 		piece.SavePrevModelSpaceTransform();
@@ -116,6 +129,58 @@ LocalModelPiece* LocalModel::CreateLocalModelPieces(const S3DModelPiece* mpParen
 	return lmpParent;
 }
 
+void LocalModel::InitPieceTree()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	pieceTreeEnds.clear();
+	pieceTreeEnds.resize(pieces.size());
+
+	// children come after their parents, so walking backwards
+	// visits every piece before the one it is attached to
+	for (size_t i = pieces.size(); i-- > 0; ) {
+		pieceTreeEnds[i] = std::max(pieceTreeEnds[i], static_cast<uint32_t>(i + 1));
+
+		if (const LocalModelPiece* parent = pieces[i].parent; parent != nullptr) {
+			assert(parent->GetLModelPieceIndex() < i);
+			pieceTreeEnds[parent->GetLModelPieceIndex()] = std::max(pieceTreeEnds[parent->GetLModelPieceIndex()], pieceTreeEnds[i]);
+		}
+	}
+}
+
+void LocalModel::SetPieceTreeDirty(unsigned int i) const
+{
+	// the pieces below <i> are the range following it
+	for (uint32_t n = i, end = pieceTreeEnds[i]; n < end; ) {
+		const uint32_t bit = n % 64;
+		const uint32_t numBits = std::min(end - n, 64 - bit);
+		const uint64_t mask = (numBits == 64)? ~uint64_t(0): (((uint64_t(1) << numBits) - 1) << bit);
+
+		dirtyPieceBits[n / 64] |= mask;
+		n += numBits;
+	}
+}
+
+void LocalModel::UpdatePieceTransforms(bool updateAllModelSpace)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (updateAllModelSpace) {
+		for (const LocalModelPiece& lmp: pieces) {
+			lmp.UpdateTransforms(IsPieceDirty(lmp.GetLModelPieceIndex()));
+		}
+
+		std::fill(dirtyPieceBits.begin(), dirtyPieceBits.end(), 0);
+		return;
+	}
+
+	// a dirty piece has only dirty pieces below it, and its parent is
+	// either clean or dirty with a lower index, hence updated before it
+	for (size_t w = 0; w < dirtyPieceBits.size(); w++) {
+		for (uint64_t bits = std::exchange(dirtyPieceBits[w], 0); bits != 0; bits &= (bits - 1)) {
+			pieces[w * 64 + std::countr_zero(bits)].UpdateTransforms(true);
+		}
+	}
+}
+
 
 void LocalModel::UpdateBoundingVolume()
 {
@@ -53,6 +53,20 @@ struct LocalModel
 	void SetLODCount(unsigned int lodCount);
 	void UpdateBoundingVolume();
 
+	// recalculates the transforms of all dirty pieces (and the model-space
+	// transforms of all pieces if <updateAllModelSpace>) in one linear pass
+	void UpdatePieceTransforms(bool updateAllModelSpace = false);
+
+	bool IsPieceDirty(unsigned int i) const { return ((dirtyPieceBits[i / 64] >> (i % 64)) & 1); }
+	void SetPieceDirty(unsigned int i, bool dirty) const {
+		if (dirty)
+			dirtyPieceBits[i / 64] |=  (uint64_t(1) << (i % 64));
+		else
+			dirtyPieceBits[i / 64] &= ~(uint64_t(1) << (i % 64));
+	}
+	// marks the piece and every piece below it
+	void SetPieceTreeDirty(unsigned int i) const;
+
 	void GetBoundingBoxVerts(std::vector<float3>& verts) const {
 		verts.resize(8 + 2); GetBoundingBoxVerts(&verts[0]);
 	}
@@ -80,14 +94,22 @@ struct LocalModel
 	bool GetBoundariesNeedsRecalc() const { return needsBoundariesRecalc; }
 private:
 	LocalModelPiece* CreateLocalModelPieces(const S3DModelPiece* mpParent);
+	void InitPieceTree();
 
 	void DrawPieces() const;
 	void DrawPiecesLOD(unsigned int lod) const;
 
 public:
+	// in depth-first order; every piece comes after its parent and is
+	// followed by the pieces below it as one contiguous range
 	std::vector<LocalModelPiece> pieces;
 
 private:
+	// one bit per piece, set if its transforms have to be recalculated
+	mutable std::vector<uint64_t> dirtyPieceBits;
+	// one past the index of the last piece below each piece
+	std::vector<uint32_t> pieceTreeEnds;
+
 	// object-oriented box; accounts for piece movement
 	CollisionVolume boundingVolume;
 
@@ -21,7 +21,6 @@ CR_REG_METADATA(LocalModelPiece, (
 
 	CR_IGNORED(wasUpdated),
 	CR_MEMBER(noInterpolation),
-	CR_MEMBER(dirty),
 
 	CR_MEMBER(scriptSetVisible),
 	CR_MEMBER(blockScriptAnims),
@@ -44,8 +43,7 @@ CR_REG_METADATA(LocalModelPiece, (
  */
 
 LocalModelPiece::LocalModelPiece(const S3DModelPiece* piece)
-	: dirty(true)
-	, wasUpdated{ true }
+	: wasUpdated{ true }
 	, noInterpolation{ false }
 
 	, scriptSetVisible(true)
@@ -78,13 +76,12 @@ LocalModelPiece::~LocalModelPiece()
 
 void LocalModelPiece::SetDirty() {
 	RECOIL_DETAILED_TRACY_ZONE;
-	dirty = true;
+	localModel->SetPieceTreeDirty(lmodelPieceIndex);
+}
 
-	for (LocalModelPiece* child: children) {
-		if (child->dirty)
-			continue;
-		child->SetDirty();
-	}
+bool LocalModelPiece::GetDirty() const
+{
+	return localModel->IsPieceDirty(lmodelPieceIndex);
 }
 
 void LocalModelPiece::SetFloat3(const float3& src, float3& dst) {
@@ -92,7 +89,7 @@ void LocalModelPiece::SetFloat3(const float3& src, float3& dst) {
 	if (blockScriptAnims)
 		return;
 
-	if (!dirty && !dst.same(src)) {
+	if (!GetDirty() && !dst.same(src)) {
 		SetDirty();
 		assert(localModel);
 		localModel->SetBoundariesNeedsRecalc();
@@ -107,7 +104,7 @@ void LocalModelPiece::SetFloat(const float& src, float& dst)
 	if (blockScriptAnims)
 		return;
 
-	if (!dirty && !(dst == src)) {
+	if (!GetDirty() && !(dst == src)) {
 		SetDirty();
 		assert(localModel);
 		localModel->SetBoundariesNeedsRecalc();
@@ -139,7 +136,7 @@ bool LocalModelPiece::SetPieceSpaceMatrix(const CMatrix44f& mat)
 
 const Transform& LocalModelPiece::GetModelSpaceTransform() const
 {
-	if (dirty)
+	if (GetDirty())
 		UpdateParentMatricesRec();
 
 	return modelSpaceTra;
@@ -147,7 +144,7 @@ const Transform& LocalModelPiece::GetModelSpaceTransform() const
 
 const CMatrix44f& LocalModelPiece::GetModelSpaceMatrix() const
 {
-	if (dirty)
+	if (GetDirty())
 		UpdateParentMatricesRec();
 
 	return modelSpaceMat;
@@ -177,20 +174,16 @@ Transform LocalModelPiece::GetEffectivePrevModelSpaceTransform() const
 	};
 }
 
-void LocalModelPiece::UpdatePieceSpaceTransform()
+void LocalModelPiece::UpdateTransforms(bool updatePieceSpace) const
 {
-	pieceSpaceTra = CalcPieceSpaceTransform(pos, rot, scale);
-}
+	if (updatePieceSpace) {
+		wasUpdated[0] = true;  //update for current frame
 
-void LocalModelPiece::UpdateModelSpaceTransform(const Transform& pTra)
-{
-	modelSpaceTra = pTra * pieceSpaceTra;
-	modelSpaceMat = modelSpaceTra.ToMatrix();
-}
+		pieceSpaceTra = CalcPieceSpaceTransform(pos, rot, scale);
+	}
 
-void LocalModelPiece::UpdateModelSpaceTransform(const LocalModelPiece* parent)
-{
-	if (parent)
+	// the parent is expected to be up to date
+	if (parent != nullptr)
 		modelSpaceTra = parent->modelSpaceTra * pieceSpaceTra;
 	else
 		modelSpaceTra = pieceSpaceTra;
@@ -198,49 +191,14 @@ void LocalModelPiece::UpdateModelSpaceTransform(const LocalModelPiece* parent)
 	modelSpaceMat = modelSpaceTra.ToMatrix();
 }
 
-void LocalModelPiece::UpdateChildTransformRec(bool updateChildTransform) const
-{
-	RECOIL_DETAILED_TRACY_ZONE;
-
-	if (dirty) {
-		dirty = false;
-		wasUpdated[0] = true;  //update for current frame
-		updateChildTransform = true;
-
-		pieceSpaceTra = CalcPieceSpaceTransform(pos, rot, scale);
-	}
-
-	if (updateChildTransform) {
-		if (parent != nullptr)
-			modelSpaceTra = parent->modelSpaceTra * pieceSpaceTra;
-		else
-			modelSpaceTra = pieceSpaceTra;
-
-		modelSpaceMat = modelSpaceTra.ToMatrix();
-	}
-
-	for (auto& child : children) {
-		child->UpdateChildTransformRec(updateChildTransform);
-	}
-}
-
 void LocalModelPiece::UpdateParentMatricesRec() const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (parent != nullptr && parent->dirty)
+	if (parent != nullptr && parent->GetDirty())
 		parent->UpdateParentMatricesRec();
 
-	dirty = false;
-	wasUpdated[0] = true;  //update for current frame
-
-	pieceSpaceTra = CalcPieceSpaceTransform(pos, rot, scale);
-
-	if (parent != nullptr)
-		modelSpaceTra = parent->modelSpaceTra * pieceSpaceTra;
-	else
-		modelSpaceTra = pieceSpaceTra;
-
-	modelSpaceMat = modelSpaceTra.ToMatrix();
+	localModel->SetPieceDirty(lmodelPieceIndex, false);
+	UpdateTransforms(true);
 }
 
 Transform LocalModelPiece::CalcPieceSpaceTransformOrig(const float3& p, const float3& r, float s) const
@@ -22,8 +22,7 @@ struct LocalModelPiece
 	CR_DECLARE_STRUCT(LocalModelPiece)
 
 	LocalModelPiece()
-		: dirty(true)
-		, wasUpdated{ true }
+		: wasUpdated{ true }
 		, noInterpolation { false }
 	{}
 	LocalModelPiece(const S3DModelPiece* piece);
@@ -45,10 +44,7 @@ struct LocalModelPiece
 
 
 	// on-demand functions
-	void UpdatePieceSpaceTransform();
-	void UpdateModelSpaceTransform(const Transform& pTra);
-	void UpdateModelSpaceTransform(const LocalModelPiece* parent);
-	void UpdateChildTransformRec(bool updateChildMatrices) const;
+	void UpdateTransforms(bool updatePieceSpace) const;
 	void UpdateParentMatricesRec() const;
 
 	Transform CalcPieceSpaceTransformOrig(const float3& p, const float3& r, float s) const;
@@ -59,9 +55,8 @@ struct LocalModelPiece
 
 	bool GetEmitDirPos(float3& emitPos, float3& emitDir) const;
 
-	void SetDirtyRaw(bool state) { dirty = state; }
 	void SetDirty();
-	bool GetDirty() const { return dirty; }
+	bool GetDirty() const;
 	void SetFloat3(const float3& src, float3& dst); // anim-script only
 	void SetFloat(const float& src, float& dst); // anim-script only
 	void SetPosition(const float3& p) { SetFloat3(p, pos); } // anim-script only
@@ -108,7 +103,6 @@ private:
 	float scale;     // uniform scaling
 
 	mutable std::array<bool, 3> noInterpolation; // rotate, move, scale
-	mutable bool dirty;
 
 	Transform prevModelSpaceTra;
 
@@ -1,28 +1,195 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <stdexcept>
+#include <type_traits>
 
 #include "S3OParser.h"
 #include "3DModel.hpp"
 #include "ModelUtils.h"
 #include "s3o.h"
+#include "Game/GameVersion.h"
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/Textures/S3OTextureHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "System/CRC.h"
 #include "System/Exceptions.h"
 #include "System/SpringMath.h"
 #include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
+#include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/MemoryMappedFile.h"
 #include "System/Platform/byteorder.h"
 
 #include "System/Misc/TracyDefs.h"
 
+#include <ostream>
 
+CONFIG(bool, ModelCache).defaultValue(true).description("Store S3O models after triangulation and tangent generation in the cache directory, s.t. later loads of the same archive version skip parsing and processing them.");
+
+static constexpr char S3OCACHE_MAGIC[8] = {'R', 'C', 'L', 'S', '3', 'O', 'C', '\0'};
+// bump whenever the piece processing in LoadPiece or the layout below changes
+static constexpr uint32_t S3OCACHE_VERSION = 2;
+
+struct S3OCacheHeader {
+	char magic[sizeof(S3OCACHE_MAGIC)];
+	uint32_t version;
+	uint32_t vertexSize; // sizeof(SVertexData), guards against layout changes between builds
+	uint32_t numPieces;
+	uint32_t archiveKey; // CRC of the archive checksum and the engine sync version
+	uint64_t fileSize;
+
+	float radius;
+	float height;
+	float3 mins;
+	float3 maxs;
+	float3 relMidPos;
+};
+
+// followed by the piece name, vertices and indices
+struct S3OCachePiece {
+	int32_t parentIndex; // into pieceObjects, -1 for the root
+	int32_t primType;
+	uint32_t numVertices;
+	uint32_t numIndices;
+
+	float3 offset;
+	float3 goffset;
+	float3 mins;
+	float3 maxs;
+};
+
+static_assert(std::is_trivially_copyable_v<SVertexData>);
+
+
+// pieces are only cached (and accepted from the cache) if all their indices are usable
+static bool IsCacheablePiece(int primType, size_t numVertices, const std::vector<uint32_t>& indices)
+{
+	if (primType < S3O_PRIMTYPE_TRIANGLES || primType > S3O_PRIMTYPE_QUADS)
+		return false;
+
+	return std::all_of(indices.begin(), indices.end(), [&](uint32_t idx) { return (idx < numVertices); });
+}
+
+
+namespace {
+	class CacheReader {
+	public:
+		CacheReader(const uint8_t* data, size_t size): pos(data), end(data + size) {}
+
+		void Read(void* dst, size_t size) {
+			if (size > static_cast<size_t>(end - pos))
+				throw content_error("[S3OParser] truncated model cache-file");
+
+			if (size == 0)
+				return;
+
+			std::memcpy(dst, pos, size);
+			pos += size;
+		}
+
+		template<typename T> T Read() { T t; Read(&t, sizeof(T)); return t; }
+
+		size_t GetRemaining() const { return (end - pos); }
+
+		std::string ReadString() {
+			const uint32_t size = Read<uint32_t>();
+
+			// check before allocating, a corrupt size could be up to 4GB
+			if (size > GetRemaining())
+				throw content_error("[S3OParser] truncated model cache-file");
+
+			std::string str(size, '\0');
+			Read(str.data(), str.size());
+			return str;
+		}
+
+	private:
+		const uint8_t* pos;
+		const uint8_t* end;
+	};
+
+	class CacheWriter {
+	public:
+		void Write(const void* src, size_t size) {
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+			data.insert(data.end(), bytes, bytes + size);
+		}
+
+		template<typename T> void Write(const T& t) { Write(&t, sizeof(T)); }
+
+		void WriteString(const std::string& str) {
+			Write(static_cast<uint32_t>(str.size()));
+			Write(str.data(), str.size());
+		}
+
+		std::vector<uint8_t> data;
+	};
+}
+
+
+
+void CS3OParser::Init()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	freePieces.clear();
+	numPoolPieces = 0;
+	useModelCache = configHandler->GetBool("ModelCache");
+
+	archiveCaches.clear();
+
+	if (!useModelCache)
+		return;
+
+	cacheDir = dataDirsAccess.LocateDir(FileSystem::GetCacheDir() + FileSystem::GetNativePathSeparator() + "models" + FileSystem::GetNativePathSeparator(), FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+	useModelCache = !cacheDir.empty();
+
+	if (useModelCache)
+		PurgeOrphanedCaches();
+}
+
+void CS3OParser::PurgeOrphanedCaches() const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<std::string> archiveDirs;
+	std::vector<std::string> cacheFiles;
+
+	// cache-files are overwritten when their archive changes, but one subdirectory
+	// is left behind for every archive that is deleted or renamed (e.g. by updates)
+	FileSystem::FindFiles(archiveDirs, cacheDir, "", ".*", FileQueryFlags::INCLUDE_DIRS | FileQueryFlags::ONLY_DIRS);
+	// files of the former flat layout
+	FileSystem::FindFiles(cacheFiles, cacheDir, "", ".*\\.s3ocache", 0);
+
+	for (const std::string& cacheFile: cacheFiles) {
+		FileSystem::DeleteFile(cacheFile);
+	}
+
+	for (const std::string& archiveDir: archiveDirs) {
+		const std::string archiveFile = FileSystem::GetFilename(archiveDir.substr(0, archiveDir.size() - 1));
+
+		if (!archiveScanner->GetArchivePath(archiveFile).empty())
+			continue;
+
+		cacheFiles.clear();
+		FileSystem::FindFiles(cacheFiles, archiveDir, "", ".*", 0);
+
+		for (const std::string& cacheFile: cacheFiles) {
+			FileSystem::DeleteFile(cacheFile);
+		}
+
+		if (!FileSystem::DeleteFile(archiveDir))
+			LOG_L(L_WARNING, "[S3OParser::%s] could not remove orphaned model cache-directory \"%s\"", __func__, archiveDir.c_str());
+	}
+}
 
-void CS3OParser::Init() { numPoolPieces = 0; }
 void CS3OParser::Kill() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	LOG_L(L_INFO, "[S3OParser::%s] allocated %u pieces", __func__, numPoolPieces);
@@ -33,12 +200,20 @@ void CS3OParser::Kill() {
 		piecePool[i].Clear();
 	}
 
+	freePieces.clear();
 	numPoolPieces = 0;
 }
 
 void CS3OParser::Load(S3DModel& model, const std::string& name)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	uint32_t archiveKey = 0;
+
+	const std::string cacheFileName = GetCacheFileName(name, archiveKey);
+
+	if (!cacheFileName.empty() && LoadCachedModel(model, name, cacheFileName, archiveKey))
+		return;
+
 	CFileHandler file(name);
 	std::vector<uint8_t> fileBuf;
 
@@ -79,6 +254,218 @@ void CS3OParser::Load(S3DModel& model, const std::string& name)
 	model.radius = (header.radius <= 0.01f)? model.CalcDrawRadius(): header.radius;
 	model.height = (header.height <= 0.01f)? model.CalcDrawHeight(): header.height;
 	model.relMidPos = float3(header.midx, header.midy, header.midz);
+
+	if (!cacheFileName.empty())
+		SaveCachedModel(model, name, cacheFileName, archiveKey);
+}
+
+
+std::string CS3OParser::GetCacheFileName(const std::string& name, uint32_t& archiveKey)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!useModelCache)
+		return "";
+
+	// loose files can change without any archive checksum noticing
+	if (CFileHandler::FileExists(name, SPRING_VFS_RAW))
+		return "";
+
+	const std::string archiveName = CFileHandler::GetArchiveContainingFile(name, SPRING_VFS_ZIP);
+
+	if (archiveName.empty())
+		return "";
+
+	std::string archiveDir;
+
+	{
+		// checksums are looked up once per archive, not once per model
+		std::lock_guard<spring::mutex> lock(cacheMutex);
+
+		const auto it = archiveCaches.find(archiveName);
+
+		if (it != archiveCaches.end()) {
+			archiveDir = it->second.first;
+			archiveKey = it->second.second;
+		} else {
+			const std::string archiveFile = archiveScanner->ArchiveFromName(archiveName);
+			const sha512::raw_digest checksum = archiveScanner->GetArchiveSingleChecksumBytes(archiveScanner->GetArchivePath(archiveFile) + archiveFile);
+			const std::string& engineVersion = SpringVersion::GetSync();
+
+			CRC crc;
+			crc.Update(checksum.data(), checksum.size());
+			crc.Update(engineVersion.data(), engineVersion.size());
+
+			// one subdirectory per archive file s.t. PurgeOrphanedCaches can drop it as a whole
+			archiveDir = cacheDir + StringToLower(FileSystem::GetFilename(archiveFile));
+			archiveDir = FileSystem::MkDir(archiveDir)? (archiveDir + FileSystem::GetNativePathSeparator()): "";
+			archiveKey = crc.GetDigest();
+
+			archiveCaches[archiveName] = {archiveDir, archiveKey};
+		}
+	}
+
+	if (archiveDir.empty())
+		return "";
+
+	// a different archive version or engine fails the key check and is overwritten
+	return (archiveDir + IntToString(CRC::CalcDigest(name.data(), name.size()), "%08x") + ".s3ocache");
+}
+
+bool CS3OParser::LoadCachedModel(S3DModel& model, const std::string& name, const std::string& cacheFileName, uint32_t archiveKey)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	CMemoryMappedFile mmf;
+
+	if (!FileSystem::FileExists(cacheFileName) || !mmf.Open(cacheFileName))
+		return false;
+
+	std::vector<SS3OPiece*> pieces;
+
+	try {
+		CacheReader reader(mmf.GetData(), mmf.GetSize());
+
+		const auto header = reader.Read<S3OCacheHeader>();
+
+		bool valid = true;
+		valid &= (std::memcmp(header.magic, S3OCACHE_MAGIC, sizeof(S3OCACHE_MAGIC)) == 0);
+		valid &= (header.version == S3OCACHE_VERSION);
+		valid &= (header.archiveKey == archiveKey);
+		valid &= (header.vertexSize == sizeof(SVertexData));
+		valid &= (header.fileSize == mmf.GetSize());
+		valid &= (header.numPieces > 0 && header.numPieces <= MAX_PIECES_PER_MODEL);
+
+		// the file name is only a CRC, so collisions are possible
+		if (!valid || reader.ReadString() != name)
+			throw content_error("[S3OParser] stale model cache-file");
+
+		std::array<std::string, S3DModel::NUM_MODEL_TEXTURES> texs;
+
+		for (auto& tex: texs) {
+			tex = reader.ReadString();
+		}
+
+		// pieces are stored in pieceObjects order, so every parent precedes its children
+		pieces.reserve(header.numPieces);
+
+		for (uint32_t i = 0; i < header.numPieces; i++) {
+			const auto cp = reader.Read<S3OCachePiece>();
+
+			if (cp.parentIndex >= static_cast<int32_t>(i) || (cp.parentIndex < 0) != (i == 0))
+				throw content_error("[S3OParser] corrupted model cache-file");
+			if ((uint64_t(cp.numVertices) * sizeof(SVertexData) + uint64_t(cp.numIndices) * sizeof(uint32_t)) > reader.GetRemaining())
+				throw content_error("[S3OParser] truncated model cache-file");
+
+			SS3OPiece* piece = pieces.emplace_back(AllocPiece());
+			SS3OPiece* parent = (i == 0)? nullptr: pieces[cp.parentIndex];
+
+			piece->name = reader.ReadString();
+			piece->parent = parent;
+			piece->primType = cp.primType;
+			piece->offset = cp.offset;
+			piece->goffset = cp.goffset;
+			piece->mins = cp.mins;
+			piece->maxs = cp.maxs;
+			piece->SetParentModel(&model);
+			piece->SetCollisionVolume(CollisionVolume('b', 'z', piece->maxs - piece->mins, (piece->maxs + piece->mins) * 0.5f));
+
+			piece->SetVertexCount(cp.numVertices);
+			piece->SetIndexCount(cp.numIndices);
+			reader.Read(piece->GetVerticesVec().data(), piece->GetVerticesVec().size() * sizeof(SVertexData));
+			reader.Read(piece->GetIndicesVec().data(), piece->GetIndicesVec().size() * sizeof(uint32_t));
+
+			if (!IsCacheablePiece(piece->primType, piece->GetVerticesVec().size(), piece->GetIndicesVec()))
+				throw content_error("[S3OParser] corrupted model cache-file");
+
+			if (parent != nullptr)
+				parent->children.push_back(piece);
+		}
+
+		model.name = name;
+		model.type = MODELTYPE_S3O;
+		model.numPieces = header.numPieces;
+		model.texs = std::move(texs);
+		model.mins = header.mins;
+		model.maxs = header.maxs;
+		model.radius = header.radius;
+		model.height = header.height;
+		model.relMidPos = header.relMidPos;
+		model.FlattenPieceTree(pieces[0]);
+	} catch (const content_error& ex) {
+		LOG_L(L_WARNING, "[S3OParser::%s] discarding cache-file \"%s\" of model \"%s\" (%s)", __func__, cacheFileName.c_str(), name.c_str(), ex.what());
+		FreePieces(pieces);
+		mmf.Close();
+		FileSystem::DeleteFile(cacheFileName);
+		return false;
+	}
+
+	textureHandlerS3O.PreloadTexture(
+		&model,
+		false,
+		false
+	);
+
+	return true;
+}
+
+void CS3OParser::SaveCachedModel(const S3DModel& model, const std::string& name, const std::string& cacheFileName, uint32_t archiveKey) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	CacheWriter writer;
+
+	S3OCacheHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, S3OCACHE_MAGIC, sizeof(S3OCACHE_MAGIC));
+
+	header.version = S3OCACHE_VERSION;
+	header.archiveKey = archiveKey;
+	header.vertexSize = sizeof(SVertexData);
+	header.numPieces = model.pieceObjects.size();
+	header.radius = model.radius;
+	header.height = model.height;
+	header.mins = model.mins;
+	header.maxs = model.maxs;
+	header.relMidPos = model.relMidPos;
+
+	writer.Write(header);
+	writer.WriteString(name);
+
+	for (const auto& tex: model.texs) {
+		writer.WriteString(tex);
+	}
+
+	for (const S3DModelPiece* modelPiece: model.pieceObjects) {
+		const SS3OPiece* piece = static_cast<const SS3OPiece*>(modelPiece);
+		const auto pit = std::find(model.pieceObjects.begin(), model.pieceObjects.end(), piece->parent);
+
+		// LoadCachedModel would only discard it again
+		if (!IsCacheablePiece(piece->primType, piece->GetVerticesVec().size(), piece->GetIndicesVec()))
+			return;
+
+		S3OCachePiece cp;
+		std::memset(&cp, 0, sizeof(cp));
+
+		cp.parentIndex = (piece->parent == nullptr)? -1: static_cast<int32_t>(pit - model.pieceObjects.begin());
+		cp.primType = piece->primType;
+		cp.numVertices = piece->GetVerticesVec().size();
+		cp.numIndices = piece->GetIndicesVec().size();
+		cp.offset = piece->offset;
+		cp.goffset = piece->goffset;
+		cp.mins = piece->mins;
+		cp.maxs = piece->maxs;
+
+		writer.Write(cp);
+		writer.WriteString(piece->name);
+		writer.Write(piece->GetVerticesVec().data(), piece->GetVerticesVec().size() * sizeof(SVertexData));
+		writer.Write(piece->GetIndicesVec().data(), piece->GetIndicesVec().size() * sizeof(uint32_t));
+	}
+
+	header.fileSize = writer.data.size();
+	std::memcpy(writer.data.data(), &header, sizeof(header));
+
+	// concurrent processes see either the previous or the complete new cache
+	FileSystem::WriteFileViaTemp(cacheFileName, [&](std::ostream& os) {
+		os.write(reinterpret_cast<const char*>(writer.data.data()), writer.data.size());
+	});
 }
 
 
@@ -93,6 +480,12 @@ SS3OPiece* CS3OParser::AllocPiece()
 	if (piecePool.empty())
 		piecePool.resize(MAX_MODEL_OBJECTS * AVG_MODEL_PIECES);
 
+	if (!freePieces.empty()) {
+		SS3OPiece* piece = freePieces.back();
+		freePieces.pop_back();
+		return piece;
+	}
+
 	if (numPoolPieces >= piecePool.size()) {
 		throw std::bad_alloc();
 		return nullptr;
@@ -101,6 +494,17 @@ SS3OPiece* CS3OParser::AllocPiece()
 	return &piecePool[numPoolPieces++];
 }
 
+void CS3OParser::FreePieces(const std::vector<SS3OPiece*>& pieces)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (SS3OPiece* piece: pieces) {
+		piece->Clear();
+	}
+
+	std::lock_guard<spring::mutex> lock(poolMutex);
+	freePieces.insert(freePieces.end(), pieces.begin(), pieces.end());
+}
+
 SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, std::vector<uint8_t>& buf, int offset)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -7,6 +7,7 @@
 #include "IModelParser.h"
 
 #include "System/type2.h"
+#include "System/UnorderedMap.hpp"
 #include "System/Threading/SpringThreading.h"
 
 enum {
@@ -64,13 +65,29 @@ public:
 
 private:
 	SS3OPiece* AllocPiece();
+	/// returns the pieces of a model that failed to load, AllocPiece hands them out again
+	void FreePieces(const std::vector<SS3OPiece*>& pieces);
 	SS3OPiece* LoadPiece(S3DModel*, SS3OPiece*, std::vector<uint8_t>& buf, int offset);
 
+	std::string GetCacheFileName(const std::string& name, uint32_t& archiveKey);
+	bool LoadCachedModel(S3DModel& model, const std::string& name, const std::string& cacheFileName, uint32_t archiveKey);
+	void SaveCachedModel(const S3DModel& model, const std::string& name, const std::string& cacheFileName, uint32_t archiveKey) const;
+	/// removes the cache-directories of archives that no longer exist
+	void PurgeOrphanedCaches() const;
+
 private:
 	std::vector<SS3OPiece> piecePool;
+	std::vector<SS3OPiece*> freePieces;
 	spring::mutex poolMutex;
 
+	// archive name --> {cache-directory, CRC of its checksum and the engine version}
+	spring::unordered_map<std::string, std::pair<std::string, uint32_t>> archiveCaches;
+	spring::mutex cacheMutex;
+
+	std::string cacheDir;
+
 	unsigned int numPoolPieces = 0;
+	bool useModelCache = false;
 };
 
 #endif /* S3O_PARSER_H */
@@ -23,6 +23,7 @@
 #include "System/SpringMem.h"
 #include "System/SpringMath.h"
 #include "System/StringUtil.h"
+#include "System/UnorderedSet.hpp"
 #include "System/Threading/ThreadPool.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
@@ -74,11 +75,36 @@ public:
 	virtual       uint8_t* GetRawMem(size_t memIdx)       = 0;
 	virtual std::span<const uint8_t> GetSpan(size_t memIdx) const = 0;
 
+	size_t GetAllocSize() {
+		std::scoped_lock lck(bmpMutex);
+		return allocSize;
+	}
+
+	virtual void GetStatsRaw(CBitmap::PoolStats& stats) const {
+		stats.poolSize = Size();
+		stats.allocSize = allocSize;
+		stats.numBitmaps = numAllocs - numFrees;
+	}
+
 	spring::mutex& GetMutex() { return bmpMutex; }
 public:
 	static void Init(size_t size);
 	static void Kill();
 	static std::unique_ptr<ITexMemPool> texMemPool;
+public:
+	// eviction state, only used when the pool has a budget;
+	// lock order is evictMutex before bmpMutex (decoding)
+	spring::unordered_set<CBitmap*> evictables;
+	spring::mutex evictMutex;
+
+	size_t budget = 0;
+	size_t numEvictions = 0;
+
+	std::atomic<size_t> numHits = {0};
+	std::atomic<size_t> numMisses = {0};
+
+	// advanced by each CBitmap::TrimPool
+	std::atomic<uint32_t> trimGen = {1};
 protected:
 	size_t numAllocs = 0;
 	size_t allocSize = 0;
@@ -251,6 +277,18 @@ public:
 		return (DefragRaw());
 	}
 
+	void GetStatsRaw(CBitmap::PoolStats& stats) const override {
+		ITexMemPool::GetStatsRaw(stats);
+
+		for (const FreePair& p: freeList) {
+			stats.freeSize += p.second;
+			stats.maxFreeChunk = std::max(stats.maxFreeChunk, p.second);
+		}
+
+		stats.numFreeChunks = freeList.size();
+		stats.fragmentation = (stats.freeSize > 0)? (1.0f - stats.maxFreeChunk / float(stats.freeSize)): 0.0f;
+	}
+
 	const uint8_t* GetRawMem(size_t memIdx) const override { return ((memIdx == size_t(-1))? nullptr: (Base() + memIdx)); }
 	      uint8_t* GetRawMem(size_t memIdx)       override { return ((memIdx == size_t(-1))? nullptr: (Base() + memIdx)); }
 	std::span<const uint8_t> GetSpan(size_t memIdx) const override {
@@ -981,9 +1019,22 @@ CBitmap TBitmapAction<T, ch>::CreateRescaled(int newx, int newy)
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
 
+struct CBitmap::Source {
+	std::vector<uint8_t> fileData;
+	std::string fileName;
+
+	float defaultAlpha = 1.0f;
+	uint32_t reqChannel = 4;
+	uint32_t reqDataType = 0;
+
+	bool forceReplaceAlpha = false;
+	bool flipOrigin = false;
+};
+
+
 CBitmap::~CBitmap()
 {
-	ITexMemPool::texMemPool->Free(GetRawMem(), GetMemSize());
+	FreeMem();
 }
 
 CBitmap::CBitmap()
@@ -1021,8 +1072,8 @@ CBitmap& CBitmap::operator=(const CBitmap& bmp)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (this != &bmp) {
-		// NB: Free preserves size for asserts
-		ITexMemPool::texMemPool->Free(GetRawMem(), GetMemSize());
+		// NB: FreeMem preserves size for asserts
+		FreeMem();
 
 		if (bmp.GetRawMem() != nullptr) {
 			assert(!bmp.compressed);
@@ -1054,6 +1105,11 @@ CBitmap& CBitmap::operator=(const CBitmap& bmp)
 
 	assert(GetMemSize() == bmp.GetMemSize());
 	assert((GetRawMem() != nullptr) == (bmp.GetRawMem() != nullptr));
+
+	// unmodified copies can be evicted and decoded again just like the original
+	if (source != bmp.source)
+		SetSource(std::shared_ptr<const Source>(bmp.source));
+
 	return *this;
 }
 
@@ -1061,6 +1117,26 @@ CBitmap& CBitmap::operator=(CBitmap&& bmp) noexcept
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (this != &bmp) {
+		// TrimPool must not see a half-swapped pair
+		std::unique_lock lck(ITexMemPool::texMemPool->evictMutex, std::defer_lock);
+
+		if (source != nullptr || bmp.source != nullptr) {
+			auto& pool = *ITexMemPool::texMemPool;
+
+			// the registry is keyed by address, so it follows the sources
+			lck.lock();
+
+			if ((source == nullptr) != (bmp.source == nullptr)) {
+				pool.evictables.erase((source != nullptr)? this: &bmp);
+				pool.evictables.insert((source != nullptr)? &bmp: this);
+			}
+
+			std::swap(source, bmp.source);
+
+			evicted.store(bmp.evicted.exchange(evicted.load()));
+			accessGen.store(bmp.accessGen.exchange(accessGen.load()));
+		}
+
 		std::swap(memIdx, bmp.memIdx);
 		std::swap(xsize, bmp.xsize);
 		std::swap(ysize, bmp.ysize);
@@ -1085,7 +1161,7 @@ bool CBitmap::CanBeKilled()
 	return !ITexMemPool::texMemPool || ITexMemPool::texMemPool->NoCurrentAllocations();
 }
 
-void CBitmap::InitPool(size_t size)
+void CBitmap::InitPool(size_t size, size_t budget)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// only allow expansion; config-size is in MB
@@ -1093,25 +1169,228 @@ void CBitmap::InitPool(size_t size)
 	ITexMemPool::Init(size);
 	ITexMemPool::texMemPool->Resize(size);
 	ITexMemPool::texMemPool->Defrag();
+	ITexMemPool::texMemPool->budget = budget * (1024 * 1024);
 }
 
 void CBitmap::KillPool()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(CanBeKilled());
+
+	if (ITexMemPool::texMemPool != nullptr && ITexMemPool::texMemPool->budget > 0)
+		PrintPoolStats();
+
 	ITexMemPool::Kill();
 }
 
+void CBitmap::TrimPool()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (ITexMemPool::texMemPool == nullptr || ITexMemPool::texMemPool->budget == 0)
+		return;
+
+	auto& pool = *ITexMemPool::texMemPool;
+
+	std::scoped_lock lck(pool.evictMutex);
+
+	if (pool.GetAllocSize() > pool.budget) {
+		const uint32_t gen = pool.trimGen.load();
+
+		std::vector<CBitmap*> candidates;
+		candidates.reserve(pool.evictables.size());
+
+		// only consider bitmaps nobody touched since the previous trim, any
+		// pointers into those are assumed to be no longer in use
+		for (CBitmap* bmp: pool.evictables) {
+			if (!bmp->evicted.load() && bmp->accessGen.load() < gen)
+				candidates.push_back(bmp);
+		}
+
+		// least recently used first, larger ones first among those
+		std::sort(candidates.begin(), candidates.end(), [](const CBitmap* a, const CBitmap* b) {
+			if (a->accessGen.load() != b->accessGen.load())
+				return (a->accessGen.load() < b->accessGen.load());
+
+			return (a->GetMemSize() > b->GetMemSize());
+		});
+
+		for (CBitmap* bmp: candidates) {
+			if (pool.GetAllocSize() <= pool.budget)
+				break;
+
+			pool.numEvictions += bmp->Evict();
+		}
+	}
+
+	pool.trimGen.fetch_add(1);
+}
+
+CBitmap::PoolStats CBitmap::GetPoolStats()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	PoolStats stats;
+
+	if (ITexMemPool::texMemPool == nullptr)
+		return stats;
+
+	auto& pool = *ITexMemPool::texMemPool;
+
+	{
+		std::scoped_lock lck(pool.evictMutex);
+
+		stats.numEvictable = pool.evictables.size();
+		stats.numEvicted = std::count_if(pool.evictables.begin(), pool.evictables.end(), [](const CBitmap* bmp) { return bmp->evicted.load(); });
+		stats.numEvictions = pool.numEvictions;
+	}
+	{
+		std::scoped_lock lck(pool.GetMutex());
+		pool.GetStatsRaw(stats);
+	}
+
+	stats.numHits = pool.numHits.load();
+	stats.numMisses = pool.numMisses.load();
+	return stats;
+}
+
+void CBitmap::PrintPoolStats()
+{
+	const PoolStats stats = GetPoolStats();
+	const size_t numAccesses = std::max(stats.numHits + stats.numMisses, size_t(1));
+
+	LOG("[BMP::%s] poolSize=" _STPF_ "u allocSize=" _STPF_ "u numBitmaps=" _STPF_ "u", __func__, stats.poolSize, stats.allocSize, stats.numBitmaps);
+	LOG("[BMP::%s] freeSize=" _STPF_ "u numFreeChunks=" _STPF_ "u maxFreeChunk=" _STPF_ "u fragmentation=%.3f", __func__, stats.freeSize, stats.numFreeChunks, stats.maxFreeChunk, stats.fragmentation);
+	LOG("[BMP::%s] evictable=" _STPF_ "u evicted=" _STPF_ "u evictions=" _STPF_ "u hits=" _STPF_ "u misses=" _STPF_ "u hitRate=%.3f", __func__, stats.numEvictable, stats.numEvicted, stats.numEvictions, stats.numHits, stats.numMisses, stats.numHits / float(numAccesses));
+}
+
+
+const uint8_t* CBitmap::GetRawMem() const {
+	if (source != nullptr)
+		Restore();
+
+	return ITexMemPool::texMemPool->GetRawMem(memIdx);
+}
+
+uint8_t* CBitmap::GetRawMem() {
+	// the caller might write, pixels can no longer be restored from the file
+	if (source != nullptr)
+		ReleaseSource();
+
+	return ITexMemPool::texMemPool->GetRawMem(memIdx);
+}
+
+std::span<const uint8_t> CBitmap::GetSpan() const {
+	if (source != nullptr)
+		Restore();
+
+	return ITexMemPool::texMemPool->GetSpan(memIdx);
+}
+
+
+void CBitmap::SetSource(std::shared_ptr<const Source>&& src)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto& pool = *ITexMemPool::texMemPool;
+
+	std::scoped_lock lck(pool.evictMutex);
+
+	if ((source = std::move(src)) == nullptr) {
+		pool.evictables.erase(this);
+		return;
+	}
+
+	accessGen.store(pool.trimGen.load());
+	pool.evictables.insert(this);
+}
+
+void CBitmap::ReleaseSource()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	Restore();
+	SetSource(nullptr);
+}
+
+void CBitmap::FreeMem()
+{
+	// unregister first, s.t. TrimPool can not evict concurrently
+	if (source != nullptr)
+		SetSource(nullptr);
+
+	if (!evicted.load())
+		ITexMemPool::texMemPool->Free(ITexMemPool::texMemPool->GetRawMem(memIdx), GetMemSize());
+
+	memIdx = size_t(-1);
+	evicted.store(false);
+}
+
+void CBitmap::Restore() const
+{
+	auto& pool = *ITexMemPool::texMemPool;
+
+	// mark as used before checking residency, TrimPool does the reverse
+	if (const uint32_t gen = pool.trimGen.load(); accessGen.load(std::memory_order_relaxed) != gen) {
+		accessGen.store(gen);
+		pool.numHits += !evicted.load();
+	}
+
+	if (!evicted.load())
+		return;
+
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	// decoding can take a while, do not hold up TrimPool or other restores;
+	// a concurrent Restore of the same bitmap just wastes its decoded copy
+	CBitmap bmp;
+
+	const bool isValid = (bmp.Decode(*source) && bmp.GetMemSize() == GetMemSize());
+
+	if (!isValid)
+		bmp.Alloc(xsize, ysize, channels, dataType);
+
+	{
+		std::scoped_lock lck(pool.evictMutex);
+
+		// restored by another thread meanwhile, bmp frees its copy
+		if (!evicted.load())
+			return;
+
+		memIdx = std::exchange(bmp.memIdx, size_t(-1));
+		evicted.store(false);
+
+		pool.numMisses += 1;
+	}
+
+	// outside the lock, LOG can indirectly cause other bitmaps to be loaded
+	if (!isValid)
+		LOG_L(L_ERROR, "[BMP::%s] could not decode evicted bitmap \"%s\" again", __func__, source->fileName.c_str());
+}
+
+bool CBitmap::Evict()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// caller has evictMutex
+	auto& pool = *ITexMemPool::texMemPool;
+
+	if (evicted.load() || memIdx == size_t(-1))
+		return false;
+
+	evicted.store(true);
+
+	// back off if Restore marked the bitmap as used before it could see the flag
+	if (accessGen.load() >= pool.trimGen.load()) {
+		evicted.store(false);
+		return false;
+	}
+
+	pool.Free(pool.GetRawMem(memIdx), GetMemSize());
+	memIdx = size_t(-1);
+	return true;
+}
 
-const uint8_t* CBitmap::GetRawMem() const { return ITexMemPool::texMemPool->GetRawMem(memIdx); }
-      uint8_t* CBitmap::GetRawMem()       { return ITexMemPool::texMemPool->GetRawMem(memIdx); }
-std::span<const uint8_t> CBitmap::GetSpan() const { return ITexMemPool::texMemPool->GetSpan(memIdx); }
 
 void CBitmap::Alloc(int w, int h, int c, uint32_t glType)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (!Empty())
-		ITexMemPool::texMemPool->Free(GetRawMem(), GetMemSize());
+	FreeMem();
 
 	dataType = glType;
 	const uint32_t dts = GetDataTypeSize();
@@ -1220,10 +1499,6 @@ bool CBitmap::CondReinterpret(int w, int h, int c, uint32_t dt)
 bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t reqChannel, uint32_t reqDataType, bool forceReplaceAlpha)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	bool isLoaded = false;
-	bool isValid  = false;
-	bool hasAlpha = false;
-
 	// LHS is only true for "image.dds", "IMAGE.DDS" would be loaded by IL
 	// which does not vertically flip DDS images by default, unlike nv_dds
 	// most Spring games do not seem to store DDS buildpics pre-flipped so
@@ -1233,7 +1508,8 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 	const bool loadDDS = (FileSystem::GetExtension(filename) == "dds"); // always lower-case
 	const bool flipDDS = (filename.find("unitpics") == std::string::npos); // keep buildpics as-is
 
-	const size_t curMemSize = GetMemSize();
+	// also drops the previous source if any
+	FreeMem();
 
 	channels = 4;
 	textype = GL_TEXTURE_2D;
@@ -1283,7 +1559,8 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 
 
 	CFileHandler file(filename);
-	std::vector<uint8_t> buffer;
+	Source src;
+	std::vector<uint8_t>& buffer = src.fileData;
 
 	if (!file.FileExists()) {
 		AllocDummy();
@@ -1299,12 +1576,46 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 	}
 
 
+	src.defaultAlpha = defaultAlpha;
+	src.reqChannel = reqChannel;
+	src.reqDataType = reqDataType;
+	src.forceReplaceAlpha = forceReplaceAlpha;
+	src.flipOrigin = (loadDDS && flipDDS);
+
+	// has to be outside the mutex scope; AllocDummy will acquire it again and
+	// LOG can indirectly cause other bitmaps to be loaded through FontTexture
+	if (!Decode(src)) {
+		LOG_L(L_ERROR, "[BMP::%s] invalid bitmap \"%s\"", __func__, filename.c_str());
+		AllocDummy();
+		return false;
+	}
+
+	// keep the encoded file around s.t. the pixels can be evicted under a budget
+	if (ITexMemPool::texMemPool->budget > 0) {
+		src.fileName = filename;
+		SetSource(std::make_shared<const Source>(std::move(src)));
+	}
+
+	return true;
+}
+
+bool CBitmap::Decode(const Source& src)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	bool isLoaded = false;
+	bool isValid  = false;
+	bool hasAlpha = false;
+
+	const size_t curMemSize = GetMemSize();
+
+	const auto& buffer = src.fileData;
+
 	{
 		std::scoped_lock lck(ITexMemPool::texMemPool->GetMutex());
 
 		// do not preserve the image origin since IL does not
 		// vertically flip DDS images by default, unlike nv_dds
-		ilOriginFunc((loadDDS && flipDDS)? IL_ORIGIN_LOWER_LEFT: IL_ORIGIN_UPPER_LEFT);
+		ilOriginFunc(src.flipOrigin? IL_ORIGIN_LOWER_LEFT: IL_ORIGIN_UPPER_LEFT);
 		ilEnable(IL_ORIGIN_SET);
 
 		ILuint imageID = 0;
@@ -1316,7 +1627,7 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 			// do not signal floating point exceptions in devil library
 			ScopedDisableFpuExceptions fe;
 
-			isLoaded = !!ilLoadL(IL_TYPE_UNKNOWN, buffer.data(), static_cast<ILuint>(buffer.size()));
+			isLoaded = !!ilLoadL(IL_TYPE_UNKNOWN, const_cast<uint8_t*>(buffer.data()), static_cast<ILuint>(buffer.size()));
 			currFormat = ilGetInteger(IL_IMAGE_FORMAT);
 			isValid = (isLoaded && IsValidImageFormat(currFormat));
 			dataType = ilGetInteger(IL_IMAGE_TYPE);
@@ -1377,17 +1688,17 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 			{
 				// conditional transformation
 				ILenum dstFormat;
-				if (reqChannel == 0) {
+				if (src.reqChannel == 0) {
 					dstFormat = currFormat;
 					channels = ExtFmtToChannels(dstFormat);
 				}
 				else {
-					dstFormat = GetExtFmt(reqChannel);
-					channels = reqChannel;
+					dstFormat = GetExtFmt(src.reqChannel);
+					channels = src.reqChannel;
 				}
 
-				if (reqDataType != 0)
-					dataType = reqDataType;
+				if (src.reqDataType != 0)
+					dataType = src.reqDataType;
 
 				ilConvertImage(dstFormat, dataType);
 			}
@@ -1408,16 +1719,11 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 		ilDeleteImages(1, &imageID);
 	}
 
-	// has to be outside the mutex scope; AllocDummy will acquire it again and
-	// LOG can indirectly cause other bitmaps to be loaded through FontTexture
-	if (!isValid) {
-		LOG_L(L_ERROR, "[BMP::%s] invalid bitmap \"%s\" (loaded=%d)", __func__, filename.c_str(), isLoaded);
-		AllocDummy();
+	if (!isValid)
 		return false;
-	}
 
-	if (!hasAlpha || forceReplaceAlpha)
-		ReplaceAlpha(defaultAlpha);
+	if (!hasAlpha || src.forceReplaceAlpha)
+		ReplaceAlpha(src.defaultAlpha);
 
 	return true;
 }
@@ -1426,6 +1732,9 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 bool CBitmap::LoadGrayscale(const std::string& filename)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (source != nullptr)
+		FreeMem();
+
 	const size_t curMemSize = GetMemSize();
 
 	compressed = false;
@@ -1554,6 +1863,9 @@ bool CBitmap::Save(const std::string& filename, bool dontSaveAlpha, bool logged,
 	CBitmap flippedCopy = *this;
 	flippedCopy.ReverseYAxis();
 
+	// fetched before locking, might have to be decoded again
+	uint8_t* flippedMem = flippedCopy.GetRawMem();
+
 	std::unique_lock lck(ITexMemPool::texMemPool->GetMutex());
 
 	// clear any previous errors
@@ -1577,7 +1889,7 @@ bool CBitmap::Save(const std::string& filename, bool dontSaveAlpha, bool logged,
 		IL_RGBA
 	};
 
-	ilTexImage(xsize, ysize, 1, channels, Channels2Formats[channels], dataType, flippedCopy.GetRawMem());
+	ilTexImage(xsize, ysize, 1, channels, Channels2Formats[channels], dataType, flippedMem);
 	assert(ilGetError() == IL_NO_ERROR);
 
 	if (dontSaveAlpha && channels == 4) {
@@ -1663,6 +1975,9 @@ bool CBitmap::SaveFloat(std::string const& filename) const
 	if (GetMemSize() == 0 || channels != 1 || dataType != IL_FLOAT)
 		return false;
 
+	// may have to decode again, which acquires ITexMemPool's mutex internally
+	const auto* f32b = reinterpret_cast<const float*>(GetRawMem());
+
 	std::scoped_lock lck(ITexMemPool::texMemPool->GetMutex());
 
 	using ConvertType = uint16_t;
@@ -1671,7 +1986,6 @@ bool CBitmap::SaveFloat(std::string const& filename) const
 
 	// seems IL_ORIGIN_SET only works in ilLoad and not in ilTexImage nor in ilSaveImage
 	// so we need to flip the image ourselves
-	const auto* f32b = reinterpret_cast<const float*>(GetRawMem());
 	      auto* ctb  = reinterpret_cast<ConvertType*>(ITexMemPool::texMemPool->AllocRaw(channels * xsize * ysize * sizeof(ConvertType)));
 
 	const auto* f32e = f32b + channels * xsize * ysize;
@@ -4,6 +4,8 @@
 #define _BITMAP_H
 
 #include <stdint.h>
+#include <atomic>
+#include <memory>
 #include <string>
 #include <span>
 #include <vector>
@@ -29,6 +31,27 @@ struct TextureCreationParams {
 };
 
 class CBitmap {
+public:
+	struct PoolStats {
+		size_t poolSize = 0;
+		size_t allocSize = 0;
+		size_t numBitmaps = 0; // live allocations
+
+		size_t freeSize = 0;
+		size_t numFreeChunks = 0;
+		size_t maxFreeChunk = 0;
+		float fragmentation = 0.0f; // 1 - maxFreeChunk / freeSize
+
+		// bitmaps that can be evicted, and those that currently are
+		size_t numEvictable = 0;
+		size_t numEvicted = 0;
+
+		// hits are counted once per bitmap and trim-period
+		size_t numHits = 0;
+		size_t numMisses = 0;
+		size_t numEvictions = 0;
+	};
+
 public:
 	CBitmap();
 	CBitmap(const uint8_t* data, int xsize, int ysize, int channels = 4, uint32_t reqDataType = 0);
@@ -43,8 +66,13 @@ public:
 	CBitmap CreateRescaled(int newx, int newy) const;
 
 	static bool CanBeKilled();
-	static void InitPool(size_t size);
+	/// both sizes in MB; budget=0 keeps all decoded bitmaps resident
+	static void InitPool(size_t size, size_t budget = 0);
 	static void KillPool();
+	/// evicts bitmaps not accessed since the previous call while the pool exceeds its budget
+	static void TrimPool();
+	static PoolStats GetPoolStats();
+	static void PrintPoolStats();
 
 	void Alloc(int w, int h, int c, uint32_t glType);
 	void Alloc(int w, int h, int c) { Alloc(w, h, c, 0x1401/*GL_UNSIGNED_BYTE*/); }
@@ -71,7 +99,8 @@ public:
 	bool SaveGrayScale(const std::string& filename) const;
 	bool SaveFloat(const std::string& filename) const;
 
-	bool Empty() const { return (memIdx == size_t(-1)); } // implies size=0
+	bool Empty() const { return (memIdx == size_t(-1) && !evicted); } // implies size=0
+	bool Evicted() const { return evicted; }
 
 	uint32_t CreateTexture(const GL::TextureCreationParams& tcp = GL::TextureCreationParams{}) const;
 	uint32_t CreateMipMapTexture(float aniso = 0.0f, float lodBias = 0.0f, int32_t reqNumLevels = 0, uint32_t texID = 0) const;
@@ -101,15 +130,45 @@ public:
 	 */
 	SDL_Surface* CreateSDLSurface();
 
+	/**
+	 * Evicted bitmaps are decoded again by any of these. The const versions
+	 * keep a bitmap evictable, while the mutable one turns it into a regular
+	 * bitmap as the caller might modify its pixels.
+	 *
+	 * NOTE: memory returned by the const versions for an evictable bitmap is
+	 * only valid until the next TrimPool call that finds the bitmap unused
+	 * since the call before it. Eviction releases the memory to the pool, so
+	 * a pointer kept past that reads whatever was allocated there next, or
+	 * freed heap memory if the pool is disabled (TextureMemPoolSize=0). Call
+	 * again after each trim-period instead of caching the result, or use the
+	 * mutable version to make the bitmap non-evictable.
+	 */
 	const uint8_t* GetRawMem() const;
 	      uint8_t* GetRawMem()      ;
 	std::span<const uint8_t> GetSpan() const;
 
 	size_t GetMemSize() const { return (xsize * ysize * channels * GetDataTypeSize()); }
 
+private:
+	struct Source;
+
+	bool Decode(const Source& src);
+	void SetSource(std::shared_ptr<const Source>&& src);
+	void ReleaseSource();
+	void FreeMem();
+
+	void Restore() const;
+	bool Evict();
+
 private:
 	// managed by pool
-	size_t memIdx = size_t(-1);
+	mutable size_t memIdx = size_t(-1);
+
+	// encoded file data, set by Load if the pool has a budget
+	std::shared_ptr<const Source> source;
+
+	mutable std::atomic<uint32_t> accessGen = {0};
+	mutable std::atomic<bool> evicted = {false};
 
 public:
 	int32_t xsize = 0;
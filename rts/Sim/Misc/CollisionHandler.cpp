@@ -2,6 +2,7 @@
 
 #include "CollisionHandler.h"
 #include "CollisionVolume.h"
+#include "CollisionVolumeBatch.h"
 #include "Map/ReadMap.h" // mapDims
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/GlobalConstants.h"
@@ -9,6 +10,10 @@
 #include "System/Matrix44f.h"
 #include "System/Log/ILog.h"
 
+#include <array>
+#include <cassert>
+#include <vector>
+
 #include "System/Misc/TracyDefs.h"
 
 unsigned int CCollisionHandler::numDiscTests = 0;
@@ -73,6 +78,196 @@ bool CCollisionHandler::DetectHit(
 	return hit;
 }
 
+void CCollisionHandler::DetectHits(
+	const CSolidObject* const* objs,
+	size_t numObjs,
+	const float3 p0,
+	const float3 p1,
+	CollisionQuery* cqs,
+	std::uint8_t* hits,
+	bool forceTrace
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	DetectVolumeHits(objs, numObjs, p0, p1, cqs, hits, forceTrace);
+
+	for (size_t i = 0; i < numObjs; i++) {
+		if (hits[i] != HIT_DEFERRED)
+			continue;
+
+		hits[i] = DetectHit(objs[i], objs[i]->GetTransformMatrix(true), p0, p1, &cqs[i], forceTrace);
+	}
+}
+
+size_t CCollisionHandler::DetectFirstHit(
+	const CSolidObject* const* objs,
+	size_t numObjs,
+	const float3 p0,
+	const float3 p1,
+	CollisionQuery* cqs,
+	std::uint8_t* hits,
+	bool forceTrace
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	DetectVolumeHits(objs, numObjs, p0, p1, cqs, hits, forceTrace);
+
+	for (size_t i = 0; i < numObjs; i++) {
+		if (hits[i] == HIT_DEFERRED)
+			hits[i] = DetectHit(objs[i], objs[i]->GetTransformMatrix(true), p0, p1, &cqs[i], forceTrace);
+
+		if (hits[i])
+			return i;
+	}
+
+	return numObjs;
+}
+
+size_t CCollisionHandler::DetectClosestHit(
+	const CSolidObject* const* objs,
+	size_t numObjs,
+	const float3 pos,
+	const float3 dir,
+	float& length,
+	CollisionQuery* cqs,
+	std::uint8_t* hits,
+	bool forceTrace
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	DetectVolumeHits(objs, numObjs, pos, pos + dir * length, cqs, hits, forceTrace);
+
+	size_t closest = numObjs;
+
+	for (size_t i = 0; i < numObjs; i++) {
+		if (hits[i] == HIT_DEFERRED) {
+			hits[i] = DetectHit(objs[i], objs[i]->GetTransformMatrix(true), pos, pos + dir * length, &cqs[i], forceTrace);
+		} else if (hits[i] && closest != numObjs) {
+			// batched against the full ray, but the ray has been shortened since;
+			// misses and far ingress hits stay so, anything else is tested again
+			// (a ray starting inside the volume can turn into an inside-hit)
+			if (cqs[i].IngressHit() && cqs[i].GetHitPosDist(pos, dir) >= length)
+				continue;
+
+			hits[i] = DetectHit(objs[i], objs[i]->GetTransformMatrix(true), pos, pos + dir * length, &cqs[i], forceTrace);
+		}
+
+		if (!hits[i])
+			continue;
+
+		const float len = cqs[i].GetHitPosDist(pos, dir);
+
+		if (len >= length)
+			continue;
+
+		length = len;
+		closest = i;
+	}
+
+	return closest;
+}
+
+void CCollisionHandler::DetectVolumeHits(
+	const CSolidObject* const* objs,
+	size_t numObjs,
+	const float3 p0,
+	const float3 p1,
+	CollisionQuery* cqs,
+	std::uint8_t* hits,
+	bool forceTrace
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	struct VolumeBatch {
+		void Clear() {
+			batch.Clear();
+			objIndices.clear();
+			matrices.clear();
+		}
+
+		CollisionVolumeBatch batch;
+
+		std::vector<size_t> objIndices;
+		std::vector<CMatrix44f> matrices;
+		std::vector<CollisionQuery> queries;
+		std::vector<std::uint8_t> results;
+	};
+
+	// ellipsoids (and spheres), cylinders, boxes
+	static thread_local std::array<VolumeBatch, 3> volumeBatches;
+
+	for (VolumeBatch& vb: volumeBatches) {
+		vb.Clear();
+	}
+
+	for (size_t i = 0; i < numObjs; i++) {
+		const CSolidObject* o = objs[i];
+		const CollisionVolume* v = &o->collisionVolume;
+
+		cqs[i].Reset();
+		hits[i] = false;
+
+		if (o->IsInVoid())
+			continue;
+
+		// piece-trees, discrete tests and ignored volumes take the regular path
+		if (v->DefaultToPieceTree() || v->IgnoreHits() || !(forceTrace || v->UseContHitTest())) {
+			hits[i] = HIT_DEFERRED;
+			continue;
+		}
+
+		// same transform as Intersect
+		CMatrix44f mr = o->GetTransformMatrix(true);
+
+		mr.Translate(o->relMidPos);
+		mr.Translate(v->GetOffsets());
+
+		const CMatrix44f mInv = mr.InvertAffine();
+
+		VolumeBatch* vb = nullptr;
+
+		switch (v->GetVolumeType()) {
+			case CollisionVolume::COLVOL_TYPE_ELLIPSOID:
+			case CollisionVolume::COLVOL_TYPE_SPHERE  : { vb = &volumeBatches[0]; } break;
+			case CollisionVolume::COLVOL_TYPE_CYLINDER: { vb = &volumeBatches[1]; } break;
+			case CollisionVolume::COLVOL_TYPE_BOX     : { vb = &volumeBatches[2]; } break;
+			default: {
+				assert(false);
+				continue;
+			} break;
+		}
+
+		vb->batch.Add(v, mInv.Mul(p0), mInv.Mul(p1));
+		vb->objIndices.push_back(i);
+		vb->matrices.push_back(mr);
+	}
+
+	for (size_t n = 0; n < volumeBatches.size(); n++) {
+		VolumeBatch& vb = volumeBatches[n];
+
+		if (vb.batch.Empty())
+			continue;
+
+		numContTests += vb.batch.Size();
+
+		vb.queries.clear();
+		vb.queries.resize(vb.batch.Size());
+		vb.results.resize(vb.batch.Size());
+
+		switch (n) {
+			case 0: { IntersectEllipsoids(vb.batch, vb.queries.data(), vb.results.data()); } break;
+			case 1: { IntersectCylinders (vb.batch, vb.queries.data(), vb.results.data()); } break;
+			case 2: { IntersectBoxes     (vb.batch, vb.queries.data(), vb.results.data()); } break;
+		}
+
+		for (size_t j = 0; j < vb.objIndices.size(); j++) {
+			CollisionQuery& cq = cqs[vb.objIndices[j]];
+
+			cq = vb.queries[j];
+			cq.SwapParams();
+			cq.Transform(vb.matrices[j]);
+
+			hits[vb.objIndices[j]] = vb.results[j];
+		}
+	}
+}
+
 
 
 bool CCollisionHandler::Collision(
@@ -8,10 +8,12 @@
 #include "System/Matrix44f.h"
 
 #include <algorithm>
+#include <cstdint>
 
 class CSolidObject;
 struct LocalModelPiece;
 struct CollisionVolume;
+struct CollisionVolumeBatch;
 
 enum {
 	CQ_POINT_NO_INT = 0,
@@ -112,6 +114,53 @@ class CCollisionHandler {
 			CollisionQuery* cq = nullptr,
 			bool forceTrace = false
 		);
+		/**
+		 * Same as calling DetectHit(objs[i], objs[i]->GetTransformMatrix(true), p0, p1, &cqs[i], forceTrace)
+		 * for each of the <numObjs> objects and storing its result in hits[i], but continuous hit-tests
+		 * against regular volumes are done in batches per volume-type.
+		 */
+		static void DetectHits(
+			const CSolidObject* const* objs,
+			size_t numObjs,
+			const float3 p0,
+			const float3 p1,
+			CollisionQuery* cqs,
+			std::uint8_t* hits,
+			bool forceTrace = false
+		);
+		/**
+		 * Like DetectHits, but stops at the first object (in order) that is hit and
+		 * returns its index, or <numObjs> if there is none. Only the batched volume
+		 * tests are run for all objects; piece-tree and discrete tests are run for
+		 * objects up to the first hit. cqs and hits are undefined past that index.
+		 */
+		static size_t DetectFirstHit(
+			const CSolidObject* const* objs,
+			size_t numObjs,
+			const float3 p0,
+			const float3 p1,
+			CollisionQuery* cqs,
+			std::uint8_t* hits,
+			bool forceTrace = false
+		);
+		/**
+		 * Returns the index of the object whose hit-position is closest to <pos> along
+		 * the ray <pos> + <dir> * <length>, or <numObjs> if none is hit, and shortens
+		 * <length> to that distance. Gives the same result as testing the objects one
+		 * by one and shortening the ray after each closer hit, but the volume tests are
+		 * batched once for the full ray and every object is resolved in a single pass.
+		 * Only cqs[index] is defined on return.
+		 */
+		static size_t DetectClosestHit(
+			const CSolidObject* const* objs,
+			size_t numObjs,
+			const float3 pos,
+			const float3 dir,
+			float& length,
+			CollisionQuery* cqs,
+			std::uint8_t* hits,
+			bool forceTrace = false
+		);
 		static bool MouseHit(
 			const CSolidObject* o,
 			const CMatrix44f& m,
@@ -121,6 +170,20 @@ class CCollisionHandler {
 			CollisionQuery* cq = nullptr
 		);
 
+	private:
+		/// batched part of DetectHits, marks objects that need DetectHit as HIT_DEFERRED
+		static void DetectVolumeHits(
+			const CSolidObject* const* objs,
+			size_t numObjs,
+			const float3 p0,
+			const float3 p1,
+			CollisionQuery* cqs,
+			std::uint8_t* hits,
+			bool forceTrace
+		);
+
+		static constexpr std::uint8_t HIT_DEFERRED = 2;
+
 	private:
 		// HITTEST_DISC helpers for DetectHit
 		static bool Collision(
@@ -167,6 +230,20 @@ class CCollisionHandler {
 		static bool IntersectCylinder(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
 		static bool IntersectBox(const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq);
 
+		/**
+		 * Batch versions of Intersect{Ellipsoid,Cylinder,Box}, including the bounding-box
+		 * early-out of Intersect: tests the segment against every volume of <batch> and
+		 * stores into cqs[i] and hits[i] bit-identical results to those of the scalar test
+		 * for volume i (several volumes per SIMD instruction, unless <vectorize> is false).
+		 */
+		static void IntersectEllipsoids(const CollisionVolumeBatch& batch, CollisionQuery* cqs, std::uint8_t* hits, bool vectorize = true);
+		static void IntersectCylinders(const CollisionVolumeBatch& batch, CollisionQuery* cqs, std::uint8_t* hits, bool vectorize = true);
+		static void IntersectBoxes(const CollisionVolumeBatch& batch, CollisionQuery* cqs, std::uint8_t* hits, bool vectorize = true);
+
+	private:
+		template<typename LaneResults>
+		static void WriteBatchResults(const LaneResults& results, size_t offset, size_t numLanes, CollisionQuery* cqs, std::uint8_t* hits);
+
 	private:
 		static unsigned int numDiscTests; // number of discrete hit-tests executed
 		static unsigned int numContTests; // number of continuous hit-tests executed (inc. unsynced)
@@ -0,0 +1,504 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "CollisionVolumeBatch.h"
+#include "CollisionHandler.h"
+#include "CollisionVolume.h"
+#include "System/FastMath.h"
+#include "System/XSimdOps.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "System/Misc/TracyDefs.h"
+
+
+void CollisionVolumeBatch::Clear()
+{
+	for (std::vector<float>* v: {&pi0x, &pi0y, &pi0z, &pi1x, &pi1y, &pi1z, &hsx, &hsy, &hsz, &hisx, &hisy, &hisz, &hsqx, &hsqy, &hsqz, &axes}) {
+		v->clear();
+	}
+}
+
+void CollisionVolumeBatch::Add(const CollisionVolume* v, const float3& pi0, const float3& pi1)
+{
+	Add(pi0, pi1, v->GetHScales(), v->GetHIScales(), v->GetHSqScales(), v->GetPrimaryAxis());
+}
+
+void CollisionVolumeBatch::Add(
+	const float3& pi0,
+	const float3& pi1,
+	const float3& hScales,
+	const float3& hiScales,
+	const float3& hsqScales,
+	int primaryAxis
+) {
+	pi0x.push_back(pi0.x); pi0y.push_back(pi0.y); pi0z.push_back(pi0.z);
+	pi1x.push_back(pi1.x); pi1y.push_back(pi1.y); pi1z.push_back(pi1.z);
+
+	hsx.push_back(hScales.x); hsy.push_back(hScales.y); hsz.push_back(hScales.z);
+	hisx.push_back(hiScales.x); hisy.push_back(hiScales.y); hisz.push_back(hiScales.z);
+	hsqx.push_back(hsqScales.x); hsqy.push_back(hsqScales.y); hsqz.push_back(hsqScales.z);
+
+	axes.push_back(primaryAxis * 1.0f);
+}
+
+
+
+// every lane of the batch kernels below must compute exactly what the scalar
+// CCollisionHandler::Intersect{Ellipsoid,Cylinder,Box} compute for a volume:
+// the same operations in the same order, with their branches turned into
+// selects, so that results are bit-identical to the scalar path
+namespace {
+	using FloatBatch = xsimd::simd_type<float>;
+	using IntBatch = xsimd::simd_type<std::int32_t>;
+
+	constexpr size_t BATCH_SIZE = xsimd::simd_traits<float>::size;
+
+	// what a lane's hit-test wrote into its query
+	constexpr float LANE_QUERY_NONE = 0.0f; // nothing (early-out)
+	constexpr float LANE_QUERY_IVOL = 1.0f; // b{0,1} and p{0,1} (segment starts inside the volume)
+	constexpr float LANE_QUERY_FULL = 2.0f; // b{0,1}, t{0,1} and p{0,1}
+
+
+	inline float Load(const float* p, float) { return *p; }
+	inline FloatBatch Load(const float* p, const FloatBatch&) { return xsimd::load_unaligned(p); }
+
+	inline void Store(float* p, float v) { *p = v; }
+	inline void Store(float* p, const FloatBatch& v) { v.store_unaligned(p); }
+
+	inline float Select(bool m, float a, float b) { return (m? a: b); }
+	template<typename M, typename T> T Select(const M& m, const T& a, const T& b) { return xsimd::select(m, a, b); }
+
+	inline bool And(bool a, bool b) { return (a && b); }
+	inline bool Or(bool a, bool b) { return (a || b); }
+	inline bool Not(bool a) { return !a; }
+	template<typename M> M And(const M& a, const M& b) { return (a & b); }
+	template<typename M> M Or(const M& a, const M& b) { return (a | b); }
+	template<typename M> M Not(const M& a) { return !a; }
+
+	inline float Abs(float x) { return math::fabs(x); }
+	inline float Sqrt(float x) { return math::sqrt(x); }
+	inline float ISqrt(float x) { return math::isqrt(x); }
+	inline FloatBatch Abs(const FloatBatch& x) { return xsimd::abs(x); }
+	inline FloatBatch Sqrt(const FloatBatch& x) { return xsimd::sqrt(x); }
+	inline FloatBatch ISqrt(const FloatBatch& x) {
+		// fastmath::isqrt2_nosse
+		const FloatBatch xh = FloatBatch(0.5f) * x;
+
+		IntBatch i = xsimd::bitwise_cast<IntBatch>(x);
+		i = IntBatch(0x5f375a86) - (i >> 1);
+
+		FloatBatch y = xsimd::bitwise_cast<FloatBatch>(i);
+		y = y * (FloatBatch(1.5f) - xh * (y * y));
+		y = y * (FloatBatch(1.5f) - xh * (y * y));
+		return y;
+	}
+
+
+	template<typename T> struct Vec3 {
+		Vec3 operator + (const Vec3& v) const { return {x + v.x, y + v.y, z + v.z}; }
+		Vec3 operator - (const Vec3& v) const { return {x - v.x, y - v.y, z - v.z}; }
+		Vec3 operator * (const Vec3& v) const { return {x * v.x, y * v.y, z * v.z}; }
+		Vec3 operator * (const T& s) const { return {x * s, y * s, z * s}; }
+
+		T dot(const Vec3& v) const { return ((x * v.x) + (y * v.y) + (z * v.z)); }
+		T SqLength() const { return (x*x + y*y + z*z); }
+
+		Vec3 SafeNormalize() const {
+			const T sql = SqLength();
+			const auto nrm = (sql > T(float3::nrm_eps()));
+
+			return {Select(nrm, x * ISqrt(sql), x), Select(nrm, y * ISqrt(sql), y), Select(nrm, z * ISqrt(sql), z)};
+		}
+
+		template<typename M> static Vec3 Select(const M& m, const Vec3& a, const Vec3& b) {
+			return {::Select(m, a.x, b.x), ::Select(m, a.y, b.y), ::Select(m, a.z, b.z)};
+		}
+		template<typename M> static T Select(const M& m, const T& a, const T& b) { return ::Select(m, a, b); }
+
+		T x;
+		T y;
+		T z;
+	};
+
+	template<typename T> Vec3<T> LoadVec3(const std::vector<float>& x, const std::vector<float>& y, const std::vector<float>& z, size_t i) {
+		return {Load(&x[i], T{}), Load(&y[i], T{}), Load(&z[i], T{})};
+	}
+
+
+	// results of one vector of lanes, written into the queries by WriteBatchResults
+	struct LaneResults {
+		template<typename T> void Store(const T& m, const T& h, const T& ib0, const T& ib1, const T& ft0, const T& ft1, const Vec3<T>& fp0, const Vec3<T>& fp1) {
+			::Store(mode, m);
+			::Store(hit, h);
+			::Store(b0, ib0);
+			::Store(b1, ib1);
+			::Store(t0, ft0);
+			::Store(t1, ft1);
+			::Store(p0x, fp0.x); ::Store(p0y, fp0.y); ::Store(p0z, fp0.z);
+			::Store(p1x, fp1.x); ::Store(p1y, fp1.y); ::Store(p1z, fp1.z);
+		}
+
+		float mode[BATCH_SIZE];
+		float hit[BATCH_SIZE];
+		float b0[BATCH_SIZE], b1[BATCH_SIZE];
+		float t0[BATCH_SIZE], t1[BATCH_SIZE];
+		float p0x[BATCH_SIZE], p0y[BATCH_SIZE], p0z[BATCH_SIZE];
+		float p1x[BATCH_SIZE], p1y[BATCH_SIZE], p1z[BATCH_SIZE];
+	};
+
+
+	// the bounding-box early-out of CCollisionHandler::Intersect
+	template<typename T> auto MissesBounds(const CollisionVolumeBatch& batch, size_t i) {
+		const Vec3<T> pi0 = LoadVec3<T>(batch.pi0x, batch.pi0y, batch.pi0z, i);
+		const Vec3<T> pi1 = LoadVec3<T>(batch.pi1x, batch.pi1y, batch.pi1z, i);
+		const Vec3<T> hs  = LoadVec3<T>(batch.hsx , batch.hsy , batch.hsz , i);
+
+		// float3::{min,max} (std::{min,max} semantics)
+		const Vec3<T> rmin = {Select(pi1.x < pi0.x, pi1.x, pi0.x), Select(pi1.y < pi0.y, pi1.y, pi0.y), Select(pi1.z < pi0.z, pi1.z, pi0.z)};
+		const Vec3<T> rmax = {Select(pi0.x < pi1.x, pi1.x, pi0.x), Select(pi0.y < pi1.y, pi1.y, pi0.y), Select(pi0.z < pi1.z, pi1.z, pi0.z)};
+		const Vec3<T> vmin = {-hs.x, -hs.y, -hs.z};
+		const Vec3<T> vmax =  hs;
+
+		auto miss = Or(rmax.x < vmin.x, rmin.x > vmax.x);
+		miss = Or(miss, Or(rmax.y < vmin.y, rmin.y > vmax.y));
+		miss = Or(miss, Or(rmax.z < vmin.z, rmin.z > vmax.z));
+		return miss;
+	}
+
+
+	template<typename T> void IntersectEllipsoidLanes(const CollisionVolumeBatch& batch, size_t i, LaneResults& results)
+	{
+		const T zero = T(0.0f);
+		const T one = T(1.0f);
+
+		const Vec3<T> pi0 = LoadVec3<T>(batch.pi0x, batch.pi0y, batch.pi0z, i);
+		const Vec3<T> pi1 = LoadVec3<T>(batch.pi1x, batch.pi1y, batch.pi1z, i);
+		const Vec3<T> hs  = LoadVec3<T>(batch.hsx , batch.hsy , batch.hsz , i);
+		const Vec3<T> his = LoadVec3<T>(batch.hisx, batch.hisy, batch.hisz, i);
+
+
+		const Vec3<T> upi0 = pi0 * his;
+		const Vec3<T> upi1 = pi1 * his;
+
+		const auto inside = (upi0.dot(upi0) <= one);
+
+		const Vec3<T> dir = (upi1 - upi0).SafeNormalize();
+
+		// A is 1
+		const T B = T(2.0f) * upi0.dot(dir);
+		const T C = upi0.dot(upi0) - one;
+		const T D = (B * B) - (T(4.0f) * C);
+
+		const auto noRoot = (D < T(-COLLISION_VOLUME_EPS));
+		const auto oneRoot = (D < T(COLLISION_VOLUME_EPS));
+
+		const T segLenSq = (pi1 - pi0).SqLength();
+
+		const T rD = Sqrt(Select(oneRoot, zero, D));
+		const T t0 = Select(oneRoot, -B * T(0.5f), (-B - rD) * T(0.5f));
+		const T t1 = Select(oneRoot, zero, (-B + rD) * T(0.5f));
+
+		const Vec3<T> p0 = (upi0 + (dir * t0)) * hs;
+		const Vec3<T> p1 = Vec3<T>::Select(oneRoot, {zero, zero, zero}, (upi0 + (dir * t1)) * hs);
+
+		const T dSq0 = (p0 - pi0).SqLength();
+		const T dSq1 = (p1 - pi0).SqLength();
+
+		const auto hit0 = And(t0 > zero, dSq0 <= segLenSq);
+		const auto hit1 = And(Not(oneRoot), And(t1 > zero, dSq1 <= segLenSq));
+
+		const T ray = T(CQ_POINT_ON_RAY);
+		const T vol = T(CQ_POINT_IN_VOL);
+
+		const T mode = Select(inside, T(LANE_QUERY_IVOL), Select(noRoot, zero, T(LANE_QUERY_FULL)));
+		const T hit = Select(Or(inside, And(Not(noRoot), Or(hit0, hit1))), one, zero);
+
+		const T b0 = Select(inside, vol, Select(hit0, ray, zero));
+		const T b1 = Select(inside, vol, Select(hit1, ray, zero));
+
+		results.Store(mode, hit, b0, b1, t0, t1, Vec3<T>::Select(inside, {zero, zero, zero}, p0), Vec3<T>::Select(inside, {zero, zero, zero}, p1));
+	}
+
+	template<typename T> void IntersectCylinderLanes(const CollisionVolumeBatch& batch, size_t i, LaneResults& results)
+	{
+		const T zero = T(0.0f);
+		const T one = T(1.0f);
+
+		const Vec3<T> pi0  = LoadVec3<T>(batch.pi0x, batch.pi0y, batch.pi0z, i);
+		const Vec3<T> pi1  = LoadVec3<T>(batch.pi1x, batch.pi1y, batch.pi1z, i);
+		const Vec3<T> ahs  = LoadVec3<T>(batch.hsx , batch.hsy , batch.hsz , i);
+		const Vec3<T> ahis = LoadVec3<T>(batch.hisx, batch.hisy, batch.hisz, i);
+		const Vec3<T> ahsq = LoadVec3<T>(batch.hsqx, batch.hsqy, batch.hsqz, i);
+
+
+		const T axis = Load(&batch.axes[i], T{});
+
+		const auto xAxis = (axis == T(CollisionVolume::COLVOL_AXIS_X));
+		const auto yAxis = (axis == T(CollisionVolume::COLVOL_AXIS_Y));
+
+		// v[pAx], v[sAx0] and v[sAx1]; secondary axes are (y, z), (x, z) and (x, y)
+		const auto prim = [&](const Vec3<T>& v) { return Select(xAxis, v.x, Select(yAxis, v.y, v.z)); };
+		const auto sec0 = [&](const Vec3<T>& v) { return Select(xAxis, v.y, v.x); };
+		const auto sec1 = [&](const Vec3<T>& v) { return Select(xAxis, v.z, Select(yAxis, v.z, v.y)); };
+
+		const T hsP = prim(ahs);
+		const T hsqS0 = sec0(ahsq);
+		const T hsqS1 = sec1(ahsq);
+
+		const T ratio =
+			((sec0(pi0) * sec0(pi0)) / hsqS0) +
+			((sec1(pi0) * sec1(pi0)) / hsqS1);
+
+		const auto inside = And(Abs(prim(pi0)) < hsP, ratio <= one);
+
+		// ray terminals in (unit) cylinder-space, secondary axes are scaled
+		const Vec3<T> upi0 = {Select(xAxis, pi0.x, pi0.x * ahis.x), Select(yAxis, pi0.y, pi0.y * ahis.y), Select(Or(xAxis, yAxis), pi0.z * ahis.z, pi0.z)};
+		const Vec3<T> upi1 = {Select(xAxis, pi1.x, pi1.x * ahis.x), Select(yAxis, pi1.y, pi1.y * ahis.y), Select(Or(xAxis, yAxis), pi1.z * ahis.z, pi1.z)};
+		// (unit) cylinder-space to volume-space transformation
+		const Vec3<T> inv = {Select(xAxis, one, ahs.x), Select(yAxis, one, ahs.y), Select(Or(xAxis, yAxis), ahs.z, one)};
+
+		const Vec3<T> udir = (upi1 - upi0).SafeNormalize();
+
+		// end-cap plane normals
+		const Vec3<T> n0 = {Select(xAxis, T(-1.0f), zero), Select(yAxis, one, zero), Select(Or(xAxis, yAxis), zero, one)};
+		const Vec3<T> n1 = {Select(xAxis, one, zero), Select(yAxis, T(-1.0f), zero), Select(Or(xAxis, yAxis), zero, T(-1.0f))};
+
+		// unit-cylinder surface equation params
+		const T a =  (sec0(udir) * sec0(udir)) + (sec1(udir) * sec1(udir));
+		const T b = ((sec0(upi0) * sec0(udir)) + (sec1(upi0) * sec1(udir))) * T(2.0f);
+		const T c =  (sec0(upi0) * sec0(upi0)) + (sec1(upi0) * sec1(upi0))  - one;
+		const T d = (b * b) - (T(4.0f) * a * c);
+
+		const T segLenSq = (pi1 - pi0).SqLength();
+
+		// quadratic eq. with one (oneRoot) or two (twoRoot) surface intersections, or linear eq. (oneLin)
+		const auto anyRoot = (d >= T(-COLLISION_VOLUME_EPS));
+		const auto quad = And(anyRoot, a != zero);
+		const auto oneRoot = And(quad, d < T(COLLISION_VOLUME_EPS));
+		const auto twoRoot = And(quad, Not(d < T(COLLISION_VOLUME_EPS)));
+		const auto oneLin = And(anyRoot, And(Not(a != zero), b != zero));
+
+		const T a2 = Select(quad, T(2.0f) * a, one);
+		const T rd = Sqrt(Select(twoRoot, d, zero));
+
+		const T qt0 = Select(twoRoot, (-b - rd) / a2, Select(oneRoot, -b / a2, -c / Select(oneLin, b, one)));
+		const T qt1 = (-b + rd) / a2;
+
+		const Vec3<T> qp0 = (upi0 + (udir * qt0)) * inv;
+		const Vec3<T> qp1 = (upi0 + (udir * qt1)) * inv;
+
+		const T qs0 = (qp0 - pi0).SqLength();
+		const T qs1 = (qp1 - pi0).SqLength();
+
+		const auto qHit0 = And(Or(quad, oneLin), And(qs0 < segLenSq, Abs(prim(qp0)) < hsP));
+		const auto qHit1 = And(twoRoot, And(qs1 < segLenSq, Abs(prim(qp1)) < hsP));
+
+		// segment through the front and rear caps, for points the surface test did not find
+		const T dp0 = n0.dot(udir);
+		const T dp1 = n1.dot(udir);
+		const T rd0 = Select(dp0 != zero, one / Select(dp0 != zero, dp0, one), T(0.01f));
+		const T rd1 = Select(dp1 != zero, one / Select(dp1 != zero, dp1, one), T(0.01f));
+
+		const T ct0 = -(n0.dot(upi0) - hsP) * rd0;
+		const T ct1 = -(n1.dot(upi0) - hsP) * rd1;
+
+		const Vec3<T> cp0 = (upi0 + (udir * ct0)) * inv;
+		const Vec3<T> cp1 = (upi0 + (udir * ct1)) * inv;
+
+		const T cs0 = (cp0 - pi0).SqLength();
+		const T cs1 = (cp1 - pi0).SqLength();
+
+		const T ra0 =
+			(((sec0(cp0) * sec0(cp0)) / hsqS0) +
+			 ((sec1(cp0) * sec1(cp0)) / hsqS1));
+		const T ra1 =
+			(((sec0(cp1) * sec0(cp1)) / hsqS0) +
+			 ((sec1(cp1) * sec1(cp1)) / hsqS1));
+
+		const auto cHit0 = And(ct0 >= zero, And(ra0 <= one, cs0 <= segLenSq));
+		const auto cHit1 = And(ct1 >= zero, And(ra1 <= one, cs1 <= segLenSq));
+
+		const T ray = T(CQ_POINT_ON_RAY);
+		const T vol = T(CQ_POINT_IN_VOL);
+
+		const T mode = Select(inside, T(LANE_QUERY_IVOL), T(LANE_QUERY_FULL));
+		const T hit = Select(Or(inside, Or(Or(qHit0, cHit0), Or(qHit1, cHit1))), one, zero);
+
+		const T b0 = Select(inside, vol, Select(Or(qHit0, cHit0), ray, zero));
+		const T b1 = Select(inside, vol, Select(Or(qHit1, cHit1), ray, zero));
+
+		const T t0 = Select(qHit0, qt0, ct0);
+		const T t1 = Select(qHit1, qt1, ct1);
+
+		const Vec3<T> p0 = Vec3<T>::Select(inside, {zero, zero, zero}, Vec3<T>::Select(qHit0, qp0, cp0));
+		const Vec3<T> p1 = Vec3<T>::Select(inside, {zero, zero, zero}, Vec3<T>::Select(qHit1, qp1, cp1));
+
+		results.Store(mode, hit, b0, b1, t0, t1, p0, p1);
+	}
+
+	template<typename T> void IntersectBoxLanes(const CollisionVolumeBatch& batch, size_t i, LaneResults& results)
+	{
+		const T zero = T(0.0f);
+		const T one = T(1.0f);
+
+		const Vec3<T> pi0 = LoadVec3<T>(batch.pi0x, batch.pi0y, batch.pi0z, i);
+		const Vec3<T> pi1 = LoadVec3<T>(batch.pi1x, batch.pi1y, batch.pi1z, i);
+		const Vec3<T> ahs = LoadVec3<T>(batch.hsx , batch.hsy , batch.hsz , i);
+
+
+		const auto inside = And(And(Abs(pi0.x) < ahs.x, Abs(pi0.y) < ahs.y), Abs(pi0.z) < ahs.z);
+
+		T tn = T(-9999999.9f);
+		T tf = T( 9999999.9f);
+
+		const Vec3<T> dir = (pi1 - pi0).SafeNormalize();
+
+		// lanes whose scalar test has not returned false yet
+		auto slab = Not(inside);
+
+		const auto clipSlab = [&](const T& d, const T& p, const T& h) {
+			const auto parallel = (Abs(d) < T(COLLISION_VOLUME_EPS));
+			const auto crossing = And(slab, Not(parallel));
+
+			slab = And(slab, Not(And(parallel, Abs(p) > h)));
+
+			const T rd = Select(parallel, one, d);
+			const T ta = (-h - p) / rd;
+			const T tb = ( h - p) / rd;
+			const auto fwd = (d > zero);
+
+			T t0 = Select(fwd, ta, tb);
+			T t1 = Select(fwd, tb, ta);
+
+			const auto swap = (t0 > t1);
+			const T t2 = t1;
+
+			t1 = Select(swap, t0, t1);
+			t0 = Select(swap, t2, t0);
+
+			tn = Select(And(crossing, t0 > tn), t0, tn);
+			tf = Select(And(crossing, t1 < tf), t1, tf);
+
+			slab = And(slab, Not(And(crossing, tn > tf)));
+			slab = And(slab, Not(And(crossing, tf < zero)));
+		};
+
+		clipSlab(dir.x, pi0.x, ahs.x);
+		clipSlab(dir.y, pi0.y, ahs.y);
+		clipSlab(dir.z, pi0.z, ahs.z);
+
+		const Vec3<T> p0 = pi0 + (dir * tn);
+		const Vec3<T> p1 = pi0 + (dir * tf);
+
+		const T segLenSq = (pi1 - pi0).SqLength();
+		const T dSq0 = (p0 - pi0).SqLength();
+		const T dSq1 = (p1 - pi0).SqLength();
+
+		const auto hit0 = (dSq0 <= segLenSq);
+		const auto hit1 = (dSq1 <= segLenSq);
+
+		const T ray = T(CQ_POINT_ON_RAY);
+		const T vol = T(CQ_POINT_IN_VOL);
+
+		const T mode = Select(inside, T(LANE_QUERY_IVOL), Select(slab, T(LANE_QUERY_FULL), zero));
+		const T hit = Select(Or(inside, And(slab, Or(hit0, hit1))), one, zero);
+
+		const T b0 = Select(inside, vol, Select(hit0, ray, zero));
+		const T b1 = Select(inside, vol, Select(hit1, ray, zero));
+
+		results.Store(mode, hit, b0, b1, tn, tf, Vec3<T>::Select(inside, {zero, zero, zero}, p0), Vec3<T>::Select(inside, {zero, zero, zero}, p1));
+	}
+
+
+	using LanesFunc = void(*)(const CollisionVolumeBatch&, size_t, LaneResults&);
+
+	// runs <Lanes> over all volumes of <batch> which pass the bounding-box test,
+	// passing each vector of results on to <writeLanes> with missing lanes set
+	// to LANE_QUERY_NONE
+	template<LanesFunc SimdLanes, LanesFunc ScalarLanes, typename WriteFunc>
+	void IntersectLanes(const CollisionVolumeBatch& batch, bool vectorize, const WriteFunc& writeLanes)
+	{
+		const size_t numLanes = batch.Size();
+		const size_t numSimdLanes = vectorize? (numLanes - (numLanes % BATCH_SIZE)): 0;
+
+		LaneResults results;
+
+		for (size_t i = 0; i < numSimdLanes; i += BATCH_SIZE) {
+			const auto miss = MissesBounds<FloatBatch>(batch, i);
+
+			if (xsimd::all(miss))
+				continue;
+
+			SimdLanes(batch, i, results);
+
+			Store(results.mode, Select(miss, FloatBatch(LANE_QUERY_NONE), Load(results.mode, FloatBatch{})));
+			Store(results.hit, Select(miss, FloatBatch(0.0f), Load(results.hit, FloatBatch{})));
+
+			writeLanes(results, i, BATCH_SIZE);
+		}
+		for (size_t i = numSimdLanes; i < numLanes; i += 1) {
+			if (MissesBounds<float>(batch, i))
+				continue;
+
+			ScalarLanes(batch, i, results);
+			writeLanes(results, i, 1);
+		}
+	}
+}
+
+
+
+template<typename LaneResults>
+void CCollisionHandler::WriteBatchResults(const LaneResults& results, size_t offset, size_t numLanes, CollisionQuery* cqs, std::uint8_t* hits)
+{
+	for (size_t i = 0; i < numLanes; i++) {
+		hits[offset + i] = (results.hit[i] != 0.0f);
+
+		if (results.mode[i] == LANE_QUERY_NONE)
+			continue;
+
+		CollisionQuery* q = &cqs[offset + i];
+
+		q->b0 = static_cast<int>(results.b0[i]);
+		q->b1 = static_cast<int>(results.b1[i]);
+		q->p0 = {results.p0x[i], results.p0y[i], results.p0z[i]};
+		q->p1 = {results.p1x[i], results.p1y[i], results.p1z[i]};
+
+		if (results.mode[i] == LANE_QUERY_IVOL)
+			continue;
+
+		q->t0 = results.t0[i];
+		q->t1 = results.t1[i];
+	}
+}
+
+void CCollisionHandler::IntersectEllipsoids(const CollisionVolumeBatch& batch, CollisionQuery* cqs, std::uint8_t* hits, bool vectorize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::fill(hits, hits + batch.Size(), 0);
+
+	IntersectLanes<IntersectEllipsoidLanes<FloatBatch>, IntersectEllipsoidLanes<float>>(batch, vectorize, [&](const LaneResults& results, size_t offset, size_t n) {
+		WriteBatchResults(results, offset, n, cqs, hits);
+	});
+}
+
+void CCollisionHandler::IntersectCylinders(const CollisionVolumeBatch& batch, CollisionQuery* cqs, std::uint8_t* hits, bool vectorize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::fill(hits, hits + batch.Size(), 0);
+
+	IntersectLanes<IntersectCylinderLanes<FloatBatch>, IntersectCylinderLanes<float>>(batch, vectorize, [&](const LaneResults& results, size_t offset, size_t n) {
+		WriteBatchResults(results, offset, n, cqs, hits);
+	});
+}
+
+void CCollisionHandler::IntersectBoxes(const CollisionVolumeBatch& batch, CollisionQuery* cqs, std::uint8_t* hits, bool vectorize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::fill(hits, hits + batch.Size(), 0);
+
+	IntersectLanes<IntersectBoxLanes<FloatBatch>, IntersectBoxLanes<float>>(batch, vectorize, [&](const LaneResults& results, size_t offset, size_t n) {
+		WriteBatchResults(results, offset, n, cqs, hits);
+	});
+}
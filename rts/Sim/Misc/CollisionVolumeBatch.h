@@ -0,0 +1,53 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COLLISION_VOLUME_BATCH_H
+#define COLLISION_VOLUME_BATCH_H
+
+#include <vector>
+
+#include "System/float3.h"
+
+struct CollisionVolume;
+
+/**
+ * @brief one ray segment in the spaces of many collision volumes
+ *
+ * Input of the CCollisionHandler::Intersect{Ellipsoids,Cylinders,Boxes}
+ * batch hit-tests: for every volume the segment end-points (already
+ * transformed into that volume's space) and the volume's scales, kept
+ * in structure-of-arrays layout so that the tests can process several
+ * volumes per SIMD instruction. All volumes in a batch must be of the
+ * shape type passed to the test.
+ */
+struct CollisionVolumeBatch {
+public:
+	void Clear();
+
+	void Add(const CollisionVolume* v, const float3& pi0, const float3& pi1);
+	void Add(
+		const float3& pi0,
+		const float3& pi1,
+		const float3& hScales,
+		const float3& hiScales,
+		const float3& hsqScales,
+		int primaryAxis = 0
+	);
+
+	size_t Size() const { return pi0x.size(); }
+	bool Empty() const { return pi0x.empty(); }
+
+public:
+	///< segment start- and end-points in volume-space
+	std::vector<float> pi0x, pi0y, pi0z;
+	std::vector<float> pi1x, pi1y, pi1z;
+
+	///< half-length axis scales (regular, inverted and squared)
+	std::vector<float> hsx, hsy, hsz;
+	std::vector<float> hisx, hisy, hisz;
+	std::vector<float> hsqx, hsqy, hsqz;
+
+	///< COLVOL_AXIS_* of cylinders, stored as float for lane-masks
+	std::vector<float> axes;
+};
+
+#endif // COLLISION_VOLUME_BATCH_H
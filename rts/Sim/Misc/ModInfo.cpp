@@ -122,6 +122,7 @@ void CModInfo::ResetState()
 		alwaysVisibleOverridesCloaked = false;
 		decloakRequiresLineOfSight = false;
 		separateJammers = true;
+		mtLosStatusUpdate = false;
 	}
 	{
 		featureVisibility = FEATURELOS_ALL;
@@ -150,6 +151,9 @@ void CModInfo::ResetState()
 		allowEnginePlayerlist = true;
 
 		useStartPositionSelecter = true;
+
+		mtWeaponTargeting = false;
+		mtCobThreads = false;
 	}
 	{
 		// make windChangeReportPeriod equal to EnvResourceHandler::WIND_UPDATE_RATE = 15 * GAME_SPEED;
@@ -212,6 +216,9 @@ void CModInfo::Init(const std::string& modFileName)
 		allowEnginePlayerlist = system.GetBool("allowEnginePlayerlist", allowEnginePlayerlist);
 
 		useStartPositionSelecter = system.GetBool("useStartPositionSelecter", useStartPositionSelecter);
+
+		mtWeaponTargeting = system.GetBool("mtWeaponTargeting", mtWeaponTargeting);
+		mtCobThreads = system.GetBool("mtCobThreads", mtCobThreads);
 	}
 
 	{
@@ -356,6 +363,7 @@ void CModInfo::Init(const std::string& modFileName)
 		alwaysVisibleOverridesCloaked = sensors.GetBool("alwaysVisibleOverridesCloaked", alwaysVisibleOverridesCloaked);
 		decloakRequiresLineOfSight = sensors.GetBool("decloakRequiresLineOfSight", decloakRequiresLineOfSight);
 		separateJammers = sensors.GetBool("separateJammers", separateJammers);
+		mtLosStatusUpdate = sensors.GetBool("mtLosStatusUpdate", mtLosStatusUpdate);
 
 		losMipLevel = los.GetInt("losMipLevel", losMipLevel);
 		airMipLevel = los.GetInt("airMipLevel", airMipLevel);
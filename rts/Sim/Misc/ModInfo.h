@@ -185,6 +185,8 @@ public:
 	bool decloakRequiresLineOfSight;
 	/// should _all_ allyteams share the same jammermap
 	bool separateJammers;
+	/// evaluate unit LOS states on all threads, callins still run in unit order
+	bool mtLosStatusUpdate;
 
 
 	enum {
@@ -253,6 +255,14 @@ public:
 
 	// If true, players can select their start position by clicking the map
 	bool useStartPositionSelecter;
+
+	/// score weapon auto-target candidates for all slow-updated units on all threads,
+	/// call-ins and target selection still run in unit order
+	bool mtWeaponTargeting;
+
+	/// run COB threads of different units concurrently up to their first instruction with
+	/// global side-effects; animation and effect calls are replayed in thread order
+	bool mtCobThreads;
 };
 
 extern CModInfo modInfo;
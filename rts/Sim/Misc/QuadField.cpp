@@ -33,7 +33,9 @@ CR_REG_METADATA(CQuadField, (
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+	CR_IGNORED(quadChangeStamps),
+	CR_IGNORED(changeCount)
 ))
 
 CR_BIND(CQuadField::Quad, )
@@ -79,6 +81,8 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 	invQuadSize = {1.0f / quadSizeX, 1.0f / quadSizeZ};
 
 	baseQuads.resize(numQuadsX * numQuadsZ);
+	quadChangeStamps.clear();
+	quadChangeStamps.resize(numQuadsX * numQuadsZ, 0);
 
 	size_t threadCount = ThreadPool::GetNumThreads();
 
@@ -391,6 +395,7 @@ bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 	if (!spring::VectorInsertUnique(unit->quads, wposQuadIdx, true))
 		return false;
 
+	TouchQuad(wposQuadIdx);
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].units, unit, false);
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit, false);
 	return true;
@@ -422,6 +427,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 	if (!spring::VectorErase(unit->quads, wposQuadIdx))
 		return false;
 
+	TouchQuad(wposQuadIdx);
 	spring::VectorErase(baseQuads[wposQuadIdx].units, unit);
 	spring::VectorErase(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit);
 	return true;
@@ -444,11 +450,13 @@ void CQuadField::MovedUnit(CUnit* unit)
 	}
 
 	for (const int qi: unit->quads) {
+		TouchQuad(qi);
 		spring::VectorErase(baseQuads[qi].units, unit);
 		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
 	}
 
 	for (const int qi: *qfQuery.quads) {
+		TouchQuad(qi);
 		spring::VectorInsertUnique(baseQuads[qi].units, unit, false);
 		spring::VectorInsertUnique(baseQuads[qi].teamUnits[unit->allyteam], unit, false);
 	}
@@ -460,6 +468,7 @@ void CQuadField::RemoveUnit(CUnit* unit)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	for (const int qi: unit->quads) {
+		TouchQuad(qi);
 		spring::VectorErase(baseQuads[qi].units, unit);
 		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
 	}
@@ -493,10 +502,12 @@ void CQuadField::MovedRepulser(CPlasmaRepulser* repulser)
 	}
 
 	for (const int qi: repulserQuads) {
+		TouchQuad(qi);
 		spring::VectorErase(baseQuads[qi].repulsers, repulser);
 	}
 
 	for (const int qi: *qfQuery.quads) {
+		TouchQuad(qi);
 		spring::VectorInsertUnique(baseQuads[qi].repulsers, repulser, false);
 	}
 
@@ -507,6 +518,7 @@ void CQuadField::RemoveRepulser(CPlasmaRepulser* repulser)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	for (const int qi: repulser->GetQuads()) {
+		TouchQuad(qi);
 		spring::VectorErase(baseQuads[qi].repulsers, repulser);
 	}
 
@@ -529,6 +541,7 @@ void CQuadField::AddFeature(CFeature* feature)
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
 	for (const int qi: *qfQuery.quads) {
+		TouchQuad(qi);
 		spring::VectorInsertUnique(baseQuads[qi].features, feature, false);
 	}
 }
@@ -540,6 +553,7 @@ void CQuadField::RemoveFeature(CFeature* feature)
 	GetQuads(qfQuery, feature->pos, feature->radius);
 
 	for (const int qi: *qfQuery.quads) {
+		TouchQuad(qi);
 		spring::VectorErase(baseQuads[qi].features, feature);
 	}
 
@@ -987,4 +1001,88 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		}
 	}
 }
+
+void CQuadField::GetUnitsAndFeaturesColVolCandidates(
+	const float3& pos,
+	const float radius,
+	std::vector<CUnit*>& units,
+	std::vector<CFeature*>& features,
+	std::vector<CPlasmaRepulser*>& repulsers,
+	std::vector<int>& quads,
+	int thread
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int tempNum = gs->GetMtTempNum(thread);
+
+	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = thread;
+	GetQuads(qfQuery, pos, radius);
+
+	quads.insert(quads.end(), qfQuery.quads->begin(), qfQuery.quads->end());
+
+	// same visiting order as GetUnitsAndFeaturesColVol, so filtering
+	// the result afterwards yields exactly what that would return
+	for (const int qi: *qfQuery.quads) {
+		const Quad& quad = baseQuads[qi];
+
+		for (CUnit* u: quad.units) {
+			if (u->mtTempNum[thread] == tempNum)
+				continue;
+
+			u->mtTempNum[thread] = tempNum;
+			units.push_back(u);
+		}
+
+		for (CFeature* f: quad.features) {
+			if (f->mtTempNum[thread] == tempNum)
+				continue;
+
+			f->mtTempNum[thread] = tempNum;
+			features.push_back(f);
+		}
+
+		for (CPlasmaRepulser* r: quad.repulsers) {
+			if (r->mtTempNum[thread] == tempNum)
+				continue;
+
+			r->mtTempNum[thread] = tempNum;
+			repulsers.push_back(r);
+		}
+	}
+}
+
+bool CQuadField::QuadsUnchangedSince(const int* quads, size_t numQuads, unsigned int changeStamp) const
+{
+	for (size_t i = 0; i < numQuads; ++i) {
+		if (quadChangeStamps[quads[i]] > changeStamp)
+			return false;
+	}
+
+	return true;
+}
+
+void CQuadField::FilterUnitsAndFeaturesColVol(
+	const float3& pos,
+	const float radius,
+	std::vector<CUnit*>& units,
+	std::vector<CFeature*>& features,
+	std::vector<CPlasmaRepulser*>& repulsers
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const auto outOfRange = [&](const CSolidObject* o) {
+		const auto* colvol = &o->collisionVolume;
+		const float totRad = radius + colvol->GetBoundingRadius();
+
+		return (pos.SqDistance(colvol->GetWorldSpacePos(o)) >= (totRad * totRad));
+	};
+
+	// order-preserving, collision checks take the first hit
+	std::erase_if(units, outOfRange);
+	std::erase_if(features, outOfRange);
+	std::erase_if(repulsers, [&](const CPlasmaRepulser* r) {
+		const float totRad = radius + r->collisionVolume.GetBoundingRadius();
+
+		return (pos.SqDistance(r->weaponMuzzlePos) >= (totRad * totRad));
+	});
+}
 #endif // UNIT_TEST
@@ -97,6 +97,29 @@ public:
 		std::vector<CFeature*>& features,
 		std::vector<CPlasmaRepulser*>* repulsers = nullptr
 	);
+	/**
+	 * Thread-safe broad-phase of GetUnitsAndFeaturesColVol: appends every object
+	 * in the quads overlapping @c pos and @c radius in the same order, but skips
+	 * the distance test which FilterUnitsAndFeaturesColVol has to apply later.
+	 * The visited quads are appended to @c quads; the result stays valid while
+	 * QuadsUnchangedSince(quads, GetChangeCount() at gather time) holds.
+	 */
+	void GetUnitsAndFeaturesColVolCandidates(
+		const float3& pos,
+		const float radius,
+		std::vector<CUnit*>& units,
+		std::vector<CFeature*>& features,
+		std::vector<CPlasmaRepulser*>& repulsers,
+		std::vector<int>& quads,
+		int thread
+	);
+	static void FilterUnitsAndFeaturesColVol(
+		const float3& pos,
+		const float radius,
+		std::vector<CUnit*>& units,
+		std::vector<CFeature*>& features,
+		std::vector<CPlasmaRepulser*>& repulsers
+	);
 
 	/**
 	 * Returns all units within @c radius of @c pos,
@@ -219,6 +242,11 @@ public:
 	}
 
 
+	/// incremented whenever the unit, feature or repulser lists of any quad change
+	unsigned int GetChangeCount() const { return changeCount; }
+	/// true if none of the given quads had its unit, feature or repulser lists changed after @c changeStamp
+	bool QuadsUnchangedSince(const int* quads, size_t numQuads, unsigned int changeStamp) const;
+
 	int GetNumQuadsX() const { return numQuadsX; }
 	int GetNumQuadsZ() const { return numQuadsZ; }
 
@@ -231,6 +259,8 @@ private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+	void TouchQuad(int qi) { quadChangeStamps[qi] = ++changeCount; }
+
 private:
 	std::vector<Quad> baseQuads;
 
@@ -248,6 +278,11 @@ private:
 
 	int quadSizeX;
 	int quadSizeZ;
+
+	// value of changeCount at the last modification of each quad
+	std::vector<unsigned int> quadChangeStamps;
+
+	unsigned int changeCount = 0;
 };
 
 extern CQuadField quadField;
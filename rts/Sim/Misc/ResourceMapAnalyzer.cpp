@@ -6,6 +6,7 @@
 #include "ResourceMapAnalyzer.h"
 
 #include "Sim/Misc/ResourceHandler.h"
+#include "Sim/Misc/ResourceSpotFinder.h"
 #include "Sim/Misc/Resource.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
@@ -13,6 +14,8 @@
 #include "Game/GameSetup.h"
 #include "Map/MapInfo.h"
 #include "Map/MetalMap.h"
+#include "Map/ReadMap.h"
+#include "System/CRC.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
@@ -23,31 +26,15 @@
 #include "System/Misc/TracyDefs.h"
 
 static constexpr float3 ERRORVECTOR(-1, 0, 0);
+// bump whenever the spot search or the cache layout changes
+static constexpr int CACHE_VERSION = 2;
 static std::string CACHE_BASE("");
 
 CResourceMapAnalyzer::CResourceMapAnalyzer(int resourceId)
 	: resourceId(resourceId)
 	, numSpotsFound(-1)
-
-	, extractorRadius(-1.0f)
 	, averageIncome(0.0f)
-
-	, stopMe(false)
-
-	, maxSpots(10000)
-	, mapHeight(0)
-	, mapWidth(0)
-	, totalCells(0)
-	, squareRadius(0)
-	, doubleSquareRadius(0)
-	, totalResources(0)
-	, maxResource(0)
-	, tempResources(0)
-	, coordX(0)
-	, coordZ(0)
-	, minIncomeForSpot(50)
-	, xtractorRadius(0)
-	, doubleRadius(0)
+	, cacheKey(0)
 {
 	if (CACHE_BASE.empty())
 		CACHE_BASE = dataDirsAccess.LocateDir(FileSystem::GetCacheDir() + FileSystem::GetNativePathSeparator() + "analyzedResourceMaps" + FileSystem::GetNativePathSeparator(), FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
@@ -113,22 +100,19 @@ void CResourceMapAnalyzer::Init() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
 
-	mapWidth = resourceHandler->GetResourceMapWidth(resourceId);
-	mapHeight = resourceHandler->GetResourceMapHeight(resourceId);
-
-	totalCells = mapHeight * mapWidth;
-	extractorRadius = resource->extractorRadius;
-	xtractorRadius = static_cast<int>(extractorRadius / (SQUARE_SIZE * 2));
-	doubleRadius = xtractorRadius * 2;
-	squareRadius = xtractorRadius * xtractorRadius;
-	doubleSquareRadius = doubleRadius * doubleRadius;
+	const int mapWidth = resourceHandler->GetResourceMapWidth(resourceId);
+	const int mapHeight = resourceHandler->GetResourceMapHeight(resourceId);
 
-	rexArrayA.resize(totalCells);
-	rexArrayB.resize(totalCells);
-	// used for drawing the TGA, not really needed with a couple of changes
-	rexArrayC.resize(totalCells);
+	// the map checksum only covers the heightmap, the resource map itself is
+	// included since games can generate or modify it before this runs
+	CRC crc;
+	crc << readMap->GetMapChecksum();
+	crc << CRC::CalcDigest(resourceHandler->GetResourceMap(resourceId), mapWidth * mapHeight);
+	crc << mapWidth << mapHeight;
+	crc << resource->extractorRadius << resource->maxWorth;
+	crc.Update(resource->name.data(), resource->name.size());
 
-	tempAverage.resize(totalCells);
+	cacheKey = crc.GetDigest();
 
 	// if there's no available load file, create one and save it
 	if (!LoadResourceMap()) {
@@ -145,358 +129,20 @@ float CResourceMapAnalyzer::GetAverageIncome() const {
 
 void CResourceMapAnalyzer::GetResourcePoints() {
 	RECOIL_DETAILED_TRACY_ZONE;
-	std::vector<int> xend(doubleRadius + 1);
-
-	for (int a = 0; a < doubleRadius + 1; a++) {
-		float z = a - xtractorRadius;
-		float floatsqrradius = squareRadius;
-		xend[a] = int(math::sqrt(floatsqrradius - z * z));
-	}
-
-	// load up the resource values in each pixel
-	const unsigned char* resourceMapArray = resourceHandler->GetResourceMap(resourceId);
-	double totalResourcesDouble  = 0;
-
-	for (int i = 0; i < totalCells; i++) {
-		// count the total resources so you can work out
-		// an average of the whole map
-		totalResourcesDouble +=  rexArrayA[i] = resourceMapArray[i];
-	}
-
-	// do the average
-	averageIncome = totalResourcesDouble / totalCells;
-	numSpotsFound = 0;
-
-	// if the map does not have any resource (quick test), just stop
-	if (totalResourcesDouble < 0.9)
-		return;
-
-	// Now work out how much resources each spot can make
-	// by adding up the resources from nearby spots
-	for (int y = 0; y < mapHeight; y++) {
-		for (int x = 0; x < mapWidth; x++) {
-			totalResources = 0;
-
-			// first spot needs full calculation
-			if (x == 0 && y == 0)
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight){
-						for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
-							if (sx >= 0 && sx < mapWidth) {
-								// get the resources from all pixels around the extractor radius
-								totalResources += rexArrayA[sy * mapWidth + sx];
-							}
-						}
-					}
-				}
-
-			// quick calc test
-			if (x > 0) {
-				totalResources = tempAverage[y * mapWidth + x - 1];
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight) {
-						const int addX = x + xend[a];
-						const int remX = x - xend[a] - 1;
-
-						if (addX < mapWidth) {
-							totalResources += rexArrayA[sy * mapWidth + addX];
-						}
-						if (remX >= 0) {
-							totalResources -= rexArrayA[sy * mapWidth + remX];
-						}
-					}
-				}
-			} else if (y > 0) {
-				// x == 0 here
-				totalResources = tempAverage[(y - 1) * mapWidth];
-				// remove the top half
-				int a = xtractorRadius;
-
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int remY = y - xend[a] - 1;
-
-						if (remY >= 0) {
-							totalResources -= rexArrayA[remY * mapWidth + sx];
-						}
-					}
-				}
-
-				// add the bottom half
-				a = xtractorRadius;
-
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int addY = y + xend[a];
-
-						if (addY < mapHeight) {
-							totalResources += rexArrayA[addY * mapWidth + sx];
-						}
-					}
-				}
-			}
-
-			// set that spot's resource making ability
-			// (divide by cells to values are small)
-			tempAverage[y * mapWidth + x] = totalResources;
-
-			if (maxResource < totalResources) {
-				// find the spot with the highest resource value to set as the map's max
-				maxResource = totalResources;
-			}
-		}
-	}
-
-	// make a list for the distribution of values
-	std::vector<int> valueDist(256, 0);
-
-	// this will get the total resources a rex placed at each spot would make
-	for (int i = 0; i < totalCells; i++) {
-		// scale the resources so any map will have values 0-255,
-		// no matter how much resources it has
-		rexArrayB[i] = tempAverage[i] * 255 / maxResource;
-		// clear out the array since it has never been used
-		rexArrayC[i] = 0;
-
-		int value = rexArrayB[i];
-		valueDist[value]++;
-	}
-
-	// find the current best value
-	int bestValue = 0;
-	int numberOfValues = 0;
-	int usedSpots = 0;
-
-	for (int i = 255; i >= 0; i--) {
-		if (valueDist[i] != 0) {
-			bestValue = i;
-			numberOfValues = valueDist[i];
-			break;
-		}
-	}
-
-	// make a list of the indexes of the best spots
-	// (make sure that the list wont be too big)
-	if (numberOfValues > 256) {
-		numberOfValues = 256;
-	}
-
-	std::vector<int> bestSpotList(numberOfValues);
-
-	for (int i = 0; i < totalCells; i++) {
-		if (rexArrayB[i] == bestValue) {
-			// add the index of this spot to the list
-			bestSpotList[usedSpots] = i;
-			usedSpots++;
-
-			if (usedSpots == numberOfValues) {
-				// the list is filled, stop the loop
-				usedSpots = 0;
-				break;
-			}
-		}
-	}
-
-	for (int a = 0; a < maxSpots; a++) {
-		if (!stopMe) {
-			// reset temporary resources so it can find new spots
-			tempResources = 0;
-			// take the first spot
-			int speedTempResources_x = 0;
-			int speedTempResources_y = 0;
-			int speedTempResources = 0;
-			bool found = false;
-
-			while (!found) {
-				if (usedSpots == numberOfValues) {
-					// the list is empty now, refill it
-
-					// make a list of all the best spots
-					for (int i = 0; i < 256; i++) {
-						// clear the array
-						valueDist[i] = 0;
-					}
-
-					// find the resource distribution
-					for (int i = 0; i < totalCells; i++) {
-						int value = rexArrayB[i];
-						valueDist[value]++;
-					}
-
-					// find the current best value
-					bestValue = 0;
-					numberOfValues = 0;
-					usedSpots = 0;
-
-					for (int i = 255; i >= 0; i--) {
-						if (valueDist[i] != 0) {
-							bestValue = i;
-							numberOfValues = valueDist[i];
-							break;
-						}
-					}
-
-					// make a list of the indexes of the best spots
-					// (make sure that the list wont be too big)
-					if (numberOfValues > 256) {
-						numberOfValues = 256;
-					}
-
-					bestSpotList.clear();
-					bestSpotList.resize(numberOfValues);
-
-					for (int i = 0; i < totalCells; i++) {
-						if (rexArrayB[i] == bestValue) {
-							// add the index of this spot to the list
-							bestSpotList[usedSpots] = i;
-							usedSpots++;
-
-							if (usedSpots == numberOfValues) {
-								// the list is filled, stop the loop
-								usedSpots = 0;
-								break;
-							}
-						}
-					}
-				}
-
-				// The list is not empty now.
-				int spotIndex = bestSpotList[usedSpots];
-
-				if (rexArrayB[spotIndex] == bestValue) {
-					// the spot is still valid, so use it
-					speedTempResources_x = spotIndex % mapWidth;
-					speedTempResources_y = spotIndex / mapWidth;
-					speedTempResources = bestValue;
-					found = true;
-				}
-
-				// update the bestSpotList index
-				usedSpots++;
-			}
-
-			coordX = speedTempResources_x;
-			coordZ = speedTempResources_y;
-			tempResources = speedTempResources;
-		}
-
-		if (tempResources < minIncomeForSpot) {
-			// if the spots get too crappy it will stop running the loops to speed it all up
-			stopMe = true;
-		}
-
-		if (!stopMe) {
-			// format resource coords to game-coords
-			bufferSpot.x = coordX * (SQUARE_SIZE * 2) + SQUARE_SIZE;
-			bufferSpot.z = coordZ * (SQUARE_SIZE * 2) + SQUARE_SIZE;
-			// gets the actual amount of resource an extractor can make
-			const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
-			bufferSpot.y = tempResources * (resource->maxWorth) * maxResource / 255;
-			vectoredSpots.push_back(bufferSpot);
-
-			// plot TGA array (not necessary) for debug
-			rexArrayC[coordZ * mapWidth + coordX] = tempResources;
-			numSpotsFound += 1;
-
-			// small speedup of "wipes the resources around the spot so it is not counted twice"
-			for (int sy = coordZ - xtractorRadius, a = 0;  sy <= coordZ + xtractorRadius;  sy++, a++) {
-				if (sy >= 0 && sy < mapHeight) {
-					int clearXStart = coordX - xend[a];
-					int clearXEnd = coordX + xend[a];
-
-					if (clearXStart < 0) {
-						clearXStart = 0;
-					}
-					if (clearXEnd >= mapWidth) {
-						clearXEnd = mapWidth - 1;
-					}
-
-					for (int xClear = clearXStart; xClear <= clearXEnd; xClear++) {
-						// wipes the resources around the spot so it is not counted twice
-						rexArrayA[sy * mapWidth + xClear] = 0;
-						rexArrayB[sy * mapWidth + xClear] = 0;
-						tempAverage[sy * mapWidth + xClear] = 0;
-					}
-				}
-			}
+	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
 
-			// redo the whole averaging process around the picked spot so other spots can be found around it
-			for (int y = coordZ - doubleRadius; y <= coordZ + doubleRadius; y++) {
-				if (y >=0 && y < mapHeight) {
-					for (int x = coordX - doubleRadius; x <= coordX + doubleRadius; x++) {
-						if (x >=0 && x < mapWidth) {
-							totalResources = 0;
-
-							// comment out for debug
-							if (x == 0 && y == 0) {
-								for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-									if (sy >= 0 && sy < mapHeight) {
-										for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
-											if (sx >= 0 && sx < mapWidth) {
-												// get the resources from all pixels around the extractor radius
-												totalResources += rexArrayA[sy * mapWidth + sx];
-											}
-										}
-									}
-								}
-							}
-
-							// quick calc test
-							if (x > 0) {
-								totalResources = tempAverage[y * mapWidth + x - 1];
-
-								for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-									if (sy >= 0 && sy < mapHeight) {
-										int addX = x + xend[a];
-										int remX = x - xend[a] - 1;
-
-										if (addX < mapWidth) {
-											totalResources += rexArrayA[sy * mapWidth + addX];
-										}
-										if (remX >= 0) {
-											totalResources -= rexArrayA[sy * mapWidth + remX];
-										}
-									}
-								}
-							} else if (y > 0) {
-								// x == 0 here
-								totalResources = tempAverage[(y - 1) * mapWidth];
-								// remove the top half
-								int a = xtractorRadius;
-
-								for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-									if (sx < mapWidth) {
-										int remY = y - xend[a] - 1;
-
-										if (remY >= 0) {
-											totalResources -= rexArrayA[remY * mapWidth + sx];
-										}
-									}
-								}
-
-								// add the bottom half
-								a = xtractorRadius;
-
-								for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-									if (sx < mapWidth) {
-										int addY = y + xend[a];
-
-										if (addY < mapHeight) {
-											totalResources += rexArrayA[addY * mapWidth + sx];
-										}
-									}
-								}
-							}
-
-							tempAverage[y * mapWidth + x] = totalResources;
-							// set that spot's resource amount
-							rexArrayB[y * mapWidth + x] = totalResources * 255 / maxResource;
-						}
-					}
-				}
-			}
-		}
-	}
+	CResourceSpotFinder spotFinder;
+	spotFinder.FindSpots(
+		resourceHandler->GetResourceMap(resourceId),
+		resourceHandler->GetResourceMapWidth(resourceId),
+		resourceHandler->GetResourceMapHeight(resourceId),
+		resource->extractorRadius,
+		resource->maxWorth
+	);
+
+	vectoredSpots = spotFinder.GetSpots();
+	averageIncome = spotFinder.GetAverageIncome();
+	numSpotsFound = vectoredSpots.size();
 }
 
 
@@ -520,6 +166,8 @@ void CResourceMapAnalyzer::SaveResourceMap() {
 			throw std::runtime_error("failed to open file for writing");
 
 		assert(numSpotsFound != -1);
+		writeToFile(CACHE_VERSION, saveFile);
+		writeToFile(cacheKey, saveFile);
 		writeToFile(numSpotsFound, saveFile);
 		writeToFile(averageIncome, saveFile);
 		for (int i = 0; i < numSpotsFound; i++) {
@@ -529,7 +177,8 @@ void CResourceMapAnalyzer::SaveResourceMap() {
 		LOG_L(L_WARNING, "Failed to save the analyzed resource-map to file %s, reason: %s", cacheFileName.c_str(), err.what());
 	}
 
-	std::fclose(saveFile);
+	if (saveFile != nullptr)
+		std::fclose(saveFile);
 }
 
 static void fileReadChecked(void* buf, size_t size, size_t count, FILE* fstream) {
@@ -551,6 +200,15 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 
 	if (cacheFile != nullptr) {
 		try {
+			int version = 0;
+			std::uint32_t key = 0;
+
+			fileReadChecked(&version, sizeof(int), 1, cacheFile);
+			fileReadChecked(&key, sizeof(std::uint32_t), 1, cacheFile);
+
+			if (version != CACHE_VERSION || key != cacheKey)
+				throw std::runtime_error("stale cache");
+
 			fileReadChecked(&numSpotsFound, sizeof(int), 1, cacheFile);
 			vectoredSpots.resize(numSpotsFound);
 			fileReadChecked(&averageIncome, sizeof(float), 1, cacheFile);
@@ -560,6 +218,9 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 			loaded = true;
 		} catch (const std::runtime_error& err) {
 			LOG_L(L_WARNING, "Failed to load the resource map cache from file %s: %s", cacheFileName.c_str(), err.what());
+
+			numSpotsFound = -1;
+			vectoredSpots.clear();
 		}
 		fclose(cacheFile);
 	}
@@ -568,6 +229,8 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 }
 
 
+// one file per map and resource; a cache of other map content or resource
+// parameters fails the key check in LoadResourceMap and gets overwritten
 std::string CResourceMapAnalyzer::GetCacheFileName() const {
 	RECOIL_DETAILED_TRACY_ZONE;
 
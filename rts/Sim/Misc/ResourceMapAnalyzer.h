@@ -4,6 +4,9 @@
 #define _RESOURCE_MAP_ANALYZER_H
 
 #include "System/float3.h"
+
+#include <cstdint>
+#include <string>
 #include <vector>
 
 class CResource;
@@ -42,36 +45,10 @@ private:
 	int resourceId;
 	int numSpotsFound;
 
-	float extractorRadius;
 	float averageIncome;
 
-	bool stopMe;
-
-	// if more spots than this are found the map is considered a resource-map (eg. speed-metal), tweak as needed
-	int maxSpots;
-	int mapHeight;
-	int mapWidth;
-	int totalCells;
-	int squareRadius;
-	int doubleSquareRadius;
-	int totalResources;
-	int maxResource;
-	int tempResources;
-	int coordX;
-	int coordZ;
-	// from 0-255, the minimum percentage of resources a spot needs to have from
-	// the maximum to be saved, prevents crappier spots in between taken spaces
-	// (they are still perfectly valid and will generate resources mind you!)
-	int minIncomeForSpot;
-	int xtractorRadius;
-	int doubleRadius;
-
-	float3 bufferSpot;
-
-	std::vector<unsigned char> rexArrayA;
-	std::vector<unsigned char> rexArrayB;
-	std::vector<unsigned char> rexArrayC;
-	std::vector<int> tempAverage;
+	// identifies the map and resource definition the cached spots were found for
+	std::uint32_t cacheKey;
 
 	std::vector<float3> vectoredSpots;
 };
@@ -0,0 +1,331 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ResourceSpotFinder.h"
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/SpringMath.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+
+#include "System/Misc/TracyDefs.h"
+
+// number of cells per tile of the value distribution
+static constexpr int TILE_CELLS = 64 * 64;
+
+
+void CResourceSpotFinder::FindSpots(const unsigned char* resourceMap, int width, int height, float extractorRadius, float maxWorth)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	mapWidth = width;
+	mapHeight = height;
+
+	totalCells = mapHeight * mapWidth;
+	xtractorRadius = static_cast<int>(extractorRadius / (SQUARE_SIZE * 2));
+	doubleRadius = xtractorRadius * 2;
+	squareRadius = xtractorRadius * xtractorRadius;
+	maxResource = 0;
+
+	rexArrayA.resize(totalCells);
+	rexArrayB.resize(totalCells);
+	tempAverage.resize(totalCells);
+	vectoredSpots.clear();
+
+	std::vector<int> xend(doubleRadius + 1);
+
+	for (int a = 0; a < doubleRadius + 1; a++) {
+		float z = a - xtractorRadius;
+		float floatsqrradius = squareRadius;
+		xend[a] = int(math::sqrt(floatsqrradius - z * z));
+	}
+
+	// load up the resource values in each pixel
+	double totalResourcesDouble  = 0;
+
+	for (int i = 0; i < totalCells; i++) {
+		// count the total resources so you can work out
+		// an average of the whole map
+		totalResourcesDouble +=  rexArrayA[i] = resourceMap[i];
+	}
+
+	// do the average
+	averageIncome = totalResourcesDouble / totalCells;
+
+	// if the map does not have any resource (quick test), just stop
+	if (totalResourcesDouble < 0.9)
+		return;
+
+	// Now work out how much resources each spot can make
+	// by adding up the resources from nearby spots
+	CalcSpotResources(xend);
+
+	// this will get the total resources a rex placed at each spot would make
+	for_mt(0, totalCells, TILE_CELLS, [&](const int t) {
+		for (int i = t, n = std::min(t + TILE_CELLS, totalCells); i < n; i++) {
+			// scale the resources so any map will have values 0-255,
+			// no matter how much resources it has
+			rexArrayB[i] = tempAverage[i] * 255 / maxResource;
+		}
+	});
+
+	// make a list of the indexes of the best spots
+	std::vector<int> bestSpotList;
+
+	int bestValue = FindBestSpots(bestSpotList);
+	int usedSpots = 0;
+
+	for (int n = 0; n < maxSpots; n++) {
+		// take the first spot
+		int coordX = 0;
+		int coordZ = 0;
+		int tempResources = 0;
+		bool found = false;
+
+		while (!found) {
+			if (usedSpots == static_cast<int>(bestSpotList.size())) {
+				// the list is empty now, refill it
+				bestValue = FindBestSpots(bestSpotList);
+				usedSpots = 0;
+			}
+
+			// The list is not empty now.
+			int spotIndex = bestSpotList[usedSpots];
+
+			if (rexArrayB[spotIndex] == bestValue) {
+				// the spot is still valid, so use it
+				coordX = spotIndex % mapWidth;
+				coordZ = spotIndex / mapWidth;
+				tempResources = bestValue;
+				found = true;
+			}
+
+			// update the bestSpotList index
+			usedSpots++;
+		}
+
+		if (tempResources < minIncomeForSpot) {
+			// if the spots get too crappy it will stop running the loops to speed it all up
+			break;
+		}
+
+		// format resource coords to game-coords
+		float3 bufferSpot;
+		bufferSpot.x = coordX * (SQUARE_SIZE * 2) + SQUARE_SIZE;
+		bufferSpot.z = coordZ * (SQUARE_SIZE * 2) + SQUARE_SIZE;
+		// gets the actual amount of resource an extractor can make
+		bufferSpot.y = tempResources * maxWorth * maxResource / 255;
+		vectoredSpots.push_back(bufferSpot);
+
+		// small speedup of "wipes the resources around the spot so it is not counted twice"
+		for (int sy = coordZ - xtractorRadius, a = 0;  sy <= coordZ + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				int clearXStart = coordX - xend[a];
+				int clearXEnd = coordX + xend[a];
+
+				if (clearXStart < 0) {
+					clearXStart = 0;
+				}
+				if (clearXEnd >= mapWidth) {
+					clearXEnd = mapWidth - 1;
+				}
+
+				for (int xClear = clearXStart; xClear <= clearXEnd; xClear++) {
+					// wipes the resources around the spot so it is not counted twice
+					rexArrayA[sy * mapWidth + xClear] = 0;
+					rexArrayB[sy * mapWidth + xClear] = 0;
+					tempAverage[sy * mapWidth + xClear] = 0;
+				}
+			}
+		}
+
+		// redo the whole averaging process around the picked spot so other spots can be found around it
+		for (int y = coordZ - doubleRadius; y <= coordZ + doubleRadius; y++) {
+			if (y >=0 && y < mapHeight) {
+				for (int x = coordX - doubleRadius; x <= coordX + doubleRadius; x++) {
+					if (x >=0 && x < mapWidth) {
+						int totalResources = 0;
+
+						// comment out for debug
+						if (x == 0 && y == 0) {
+							for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+								if (sy >= 0 && sy < mapHeight) {
+									for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
+										if (sx >= 0 && sx < mapWidth) {
+											// get the resources from all pixels around the extractor radius
+											totalResources += rexArrayA[sy * mapWidth + sx];
+										}
+									}
+								}
+							}
+						}
+
+						// quick calc test
+						if (x > 0) {
+							totalResources = tempAverage[y * mapWidth + x - 1];
+
+							for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+								if (sy >= 0 && sy < mapHeight) {
+									int addX = x + xend[a];
+									int remX = x - xend[a] - 1;
+
+									if (addX < mapWidth) {
+										totalResources += rexArrayA[sy * mapWidth + addX];
+									}
+									if (remX >= 0) {
+										totalResources -= rexArrayA[sy * mapWidth + remX];
+									}
+								}
+							}
+						} else if (y > 0) {
+							// x == 0 here
+							totalResources = tempAverage[(y - 1) * mapWidth];
+							// remove the top half
+							int a = xtractorRadius;
+
+							for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
+								if (sx < mapWidth) {
+									int remY = y - xend[a] - 1;
+
+									if (remY >= 0) {
+										totalResources -= rexArrayA[remY * mapWidth + sx];
+									}
+								}
+							}
+
+							// add the bottom half
+							a = xtractorRadius;
+
+							for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
+								if (sx < mapWidth) {
+									int addY = y + xend[a];
+
+									if (addY < mapHeight) {
+										totalResources += rexArrayA[addY * mapWidth + sx];
+									}
+								}
+							}
+						}
+
+						tempAverage[y * mapWidth + x] = totalResources;
+						// set that spot's resource amount
+						rexArrayB[y * mapWidth + x] = totalResources * 255 / maxResource;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void CResourceSpotFinder::CalcSpotResources(const std::vector<int>& xend)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	rowMaxResources.resize(mapHeight);
+
+	// the sums are exact, so every row can start with a full calculation of
+	// its first spot instead of deriving it from the row above; rows are then
+	// independent of each other
+	for_mt(0, mapHeight, [&](const int y) {
+		int totalResources = 0;
+		int rowMaxResource = 0;
+
+		// first spot needs full calculation
+		for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				for (int sx = -xend[a]; sx <= xend[a]; sx++) {
+					if (sx >= 0 && sx < mapWidth) {
+						// get the resources from all pixels around the extractor radius
+						totalResources += rexArrayA[sy * mapWidth + sx];
+					}
+				}
+			}
+		}
+
+		tempAverage[y * mapWidth] = totalResources;
+		rowMaxResource = std::max(rowMaxResource, totalResources);
+
+		for (int x = 1; x < mapWidth; x++) {
+			// quick calc test
+			for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+				if (sy >= 0 && sy < mapHeight) {
+					const int addX = x + xend[a];
+					const int remX = x - xend[a] - 1;
+
+					if (addX < mapWidth) {
+						totalResources += rexArrayA[sy * mapWidth + addX];
+					}
+					if (remX >= 0) {
+						totalResources -= rexArrayA[sy * mapWidth + remX];
+					}
+				}
+			}
+
+			// set that spot's resource making ability
+			// (divide by cells to values are small)
+			tempAverage[y * mapWidth + x] = totalResources;
+			rowMaxResource = std::max(rowMaxResource, totalResources);
+		}
+
+		rowMaxResources[y] = rowMaxResource;
+	});
+
+	// find the spot with the highest resource value to set as the map's max
+	maxResource = *std::max_element(rowMaxResources.begin(), rowMaxResources.end());
+}
+
+
+int CResourceSpotFinder::FindBestSpots(std::vector<int>& bestSpotList)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int numTiles = (totalCells + TILE_CELLS - 1) / TILE_CELLS;
+
+	tileValueDists.resize(numTiles);
+
+	// find the resource distribution
+	for_mt(0, numTiles, [&](const int t) {
+		std::array<int, 256>& valueDist = tileValueDists[t];
+
+		valueDist.fill(0);
+
+		for (int i = t * TILE_CELLS, n = std::min(i + TILE_CELLS, totalCells); i < n; i++) {
+			valueDist[rexArrayB[i]]++;
+		}
+	});
+
+	// find the current best value
+	int bestValue = 0;
+	int numberOfValues = 0;
+
+	for (int i = 255; i >= 0 && numberOfValues == 0; i--) {
+		for (const std::array<int, 256>& valueDist: tileValueDists) {
+			numberOfValues += valueDist[i];
+		}
+
+		bestValue = i;
+	}
+
+	// make a list of the indexes of the best spots
+	// (make sure that the list wont be too big)
+	numberOfValues = std::min(numberOfValues, 256);
+
+	bestSpotList.clear();
+
+	// only the tiles holding the first <numberOfValues> best spots need to be searched
+	for (int t = 0; t < numTiles && static_cast<int>(bestSpotList.size()) < numberOfValues; t++) {
+		if (tileValueDists[t][bestValue] == 0)
+			continue;
+
+		for (int i = t * TILE_CELLS, n = std::min(i + TILE_CELLS, totalCells); i < n; i++) {
+			if (rexArrayB[i] != bestValue)
+				continue;
+
+			// add the index of this spot to the list
+			bestSpotList.push_back(i);
+
+			if (static_cast<int>(bestSpotList.size()) == numberOfValues)
+				break;
+		}
+	}
+
+	return bestValue;
+}
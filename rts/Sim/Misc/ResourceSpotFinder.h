@@ -0,0 +1,62 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _RESOURCE_SPOT_FINDER_H
+#define _RESOURCE_SPOT_FINDER_H
+
+#include "System/float3.h"
+
+#include <array>
+#include <vector>
+
+/**
+ * Finds the best places for resource extractors on a resource map, used by
+ * CResourceMapAnalyzer. Kept free of any game state so that it can be run
+ * (and benchmarked) on its own.
+ */
+class CResourceSpotFinder {
+public:
+	/**
+	 * @param resourceMap <mapWidth> x <mapHeight> resource values (0-255)
+	 * @param extractorRadius extraction radius in elmos
+	 * @param maxWorth what value 255 in the resource map is worth
+	 */
+	void FindSpots(const unsigned char* resourceMap, int mapWidth, int mapHeight, float extractorRadius, float maxWorth);
+
+	/// same layout as CResourceMapAnalyzer::GetSpots
+	const std::vector<float3>& GetSpots() const { return vectoredSpots; }
+	float GetAverageIncome() const { return averageIncome; }
+
+private:
+	void CalcSpotResources(const std::vector<int>& xend);
+	int FindBestSpots(std::vector<int>& bestSpotList);
+
+private:
+	// if more spots than this are found the map is considered a resource-map (eg. speed-metal), tweak as needed
+	static constexpr int maxSpots = 10000;
+	// from 0-255, the minimum percentage of resources a spot needs to have from
+	// the maximum to be saved, prevents crappier spots in between taken spaces
+	// (they are still perfectly valid and will generate resources mind you!)
+	static constexpr int minIncomeForSpot = 50;
+
+	int mapHeight = 0;
+	int mapWidth = 0;
+	int totalCells = 0;
+	int squareRadius = 0;
+	int maxResource = 0;
+	int xtractorRadius = 0;
+	int doubleRadius = 0;
+
+	float averageIncome = 0.0f;
+
+	std::vector<unsigned char> rexArrayA;
+	std::vector<unsigned char> rexArrayB;
+	std::vector<int> tempAverage;
+
+	// per-row maxima of tempAverage and per-tile distributions of rexArrayB
+	std::vector<int> rowMaxResources;
+	std::vector< std::array<int, 256> > tileValueDists;
+
+	std::vector<float3> vectoredSpots;
+};
+
+#endif // _RESOURCE_SPOT_FINDER_H
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <limits>
 
@@ -102,10 +103,10 @@ void SmoothHeightMesh::InitDataStructures() {
 	mesh.resize(maxx * maxy, 0.0f);
 	tempMesh.resize(maxx * maxy, 0.0f);
 	origMesh.resize(maxx * maxy, 0.0f);
-	colsMaxima.clear();
-	colsMaxima.resize(maxx, -std::numeric_limits<float>::max());
-	maximaRows.clear();
-	maximaRows.resize(maxx, -1);
+	threadColsMaxima.clear();
+	threadColsMaxima.resize(ThreadPool::MAX_THREADS, std::vector<float>(maxx, -std::numeric_limits<float>::max()));
+	threadMaximaRows.clear();
+	threadMaximaRows.resize(ThreadPool::MAX_THREADS, std::vector<int>(maxx, -1));
 }
 
 void SmoothHeightMesh::Kill() {
@@ -116,6 +117,8 @@ void SmoothHeightMesh::Kill() {
 	while (!mapChangeTrack.verticalBlurQueue.empty()) { mapChangeTrack.verticalBlurQueue.pop(); }
 
 	mapChangeTrack.damageMap.clear();
+	updateQuads.clear();
+	updateQuadColumns.clear();
 	maximaMesh.clear();
 	mesh.clear();
 	origMesh.clear();
@@ -218,33 +221,41 @@ inline static void FindRadialMaximum(
 		const int startx = std::max(x - winSize, 0);
 		const int endx = std::min(x + winSize, map.x - 1);
 
-		// This may mean the last SSE max function compares some values have already been compared
-		// This is harmless and avoids needlessly messy SSE code here
-		const int endIdx = endx - 3;
+		// colsMaxima is only valid within [startx, endx] (the caller resets and
+		// fills the columns of the current quad only); windows narrower than a
+		// vector, i.e. near the map edges or for tiny radii, are done one by one
+		if (endx - startx < 3) {
+			for (int i = startx; i <= endx; ++i)
+				maxRowHeight = std::max(maxRowHeight, colsMaxima[i]);
+		} else {
+			// This may mean the last SSE max function compares some values have already been compared
+			// This is harmless and avoids needlessly messy SSE code here
+			const int endIdx = endx - 3;
+
+			// Main loop for finding maximum height values
+			__m128 best = _mm_loadu_ps(&colsMaxima[startx]);
+			for (int i = startx + 4; i < endIdx; i += 4) {
+				__m128 next = _mm_loadu_ps(&colsMaxima[i]);
+				best = _mm_max_ps(best, next);
+			}
 
-		// Main loop for finding maximum height values
-		__m128 best = _mm_loadu_ps(&colsMaxima[startx]);
-		for (int i = startx + 4; i < endIdx; i += 4) {
-			__m128 next = _mm_loadu_ps(&colsMaxima[i]);
-			best = _mm_max_ps(best, next);
-		}
+			// Check the last few height values
+			{
+				__m128 next = _mm_loadu_ps(&colsMaxima[endIdx]);
+				best = _mm_max_ps(best, next);
+			}
 
-		// Check the last few height values
-		{
-			__m128 next = _mm_loadu_ps(&colsMaxima[endIdx]);
-			best = _mm_max_ps(best, next);
-		}
+			// This is an SSE horizontal compare
+			{
+				// split the four values into sets of two and compare
+				__m128 bestAlt = _mm_movehl_ps(best, best);
+				best = _mm_max_ps(best, bestAlt);
 
-		// This is an SSE horizontal compare
-		{
-			// split the four values into sets of two and compare
-			__m128 bestAlt = _mm_movehl_ps(best, best);
-			best = _mm_max_ps(best, bestAlt);
-
-			// split the two values and compare
-			bestAlt = _mm_shuffle_ps(best, best, _MM_SHUFFLE(0, 0, 0, 1));
-			best = _mm_max_ss(best, bestAlt);
-			_mm_store_ss(&maxRowHeight, best);
+				// split the two values and compare
+				bestAlt = _mm_shuffle_ps(best, best, _MM_SHUFFLE(0, 0, 0, 1));
+				best = _mm_max_ss(best, bestAlt);
+				_mm_store_ss(&maxRowHeight, best);
+			}
 		}
 
 		mesh[x + y * map.x] = maxRowHeight;
@@ -512,10 +523,24 @@ inline static bool UpdateSmoothMeshRequired(SmoothHeightMesh::MapChangeTrack& ma
 }
 
 
-void SmoothHeightMesh::UpdateSmoothMeshMaximas(int2 damageMin, int2 damageMax) {
+void SmoothHeightMesh::GetDamagedQuadBounds(int damagedAreaIndex, int2& damageMin, int2& damageMax) const {
+	// area of the map which to recalculate the height values
+	const int damageX = damagedAreaIndex % mapChangeTrack.width;
+	const int damageY = damagedAreaIndex / mapChangeTrack.width;
+
+	damageMin = {damageX*SAMPLES_PER_QUAD, damageY*SAMPLES_PER_QUAD};
+	damageMax = damageMin + int2{SAMPLES_PER_QUAD - 1, SAMPLES_PER_QUAD - 1};
+
+	damageMin.x = std::clamp(damageMin.x, 0, maxx - 1);
+	damageMin.y = std::clamp(damageMin.y, 0, maxy - 1);
+	damageMax.x = std::clamp(damageMax.x, 0, maxx - 1);
+	damageMax.y = std::clamp(damageMax.y, 0, maxy - 1);
+}
+
+
+void SmoothHeightMesh::UpdateSmoothMeshMaximas(int2 damageMin, int2 damageMax, std::vector<float>& colsMaxima, std::vector<int>& maximaRows) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const int winSize = smoothRadius / resolution;
-	const int blurSize = std::max(1, winSize / 2);
 	int2 map{maxx, maxy};
 
 	int2 impactRadius{winSize, winSize};
@@ -528,8 +553,8 @@ void SmoothHeightMesh::UpdateSmoothMeshMaximas(int2 damageMin, int2 damageMax) {
 	max.y = std::clamp(max.y, 0, map.y - 1);
 
 #ifdef SMOOTH_MESH_DEBUG_GENERAL
-LOG("%s: quad index %d (%d,%d)-(%d,%d) (%d,%d)-(%d,%d) updating maxima"
-	, __func__, damagedAreaIndex, damageMin.x, damageMin.y, damageMax.x, damageMax.y, min.x, min.y, max.x, max.y
+LOG("%s: quad (%d,%d)-(%d,%d) (%d,%d)-(%d,%d) updating maxima"
+	, __func__, damageMin.x, damageMin.y, damageMax.x, damageMax.y, min.x, min.y, max.x, max.y
 	);
 
 LOG("%s: quad area in world space (%f,%f) (%f,%f)", __func__
@@ -572,49 +597,89 @@ void SmoothHeightMesh::UpdateSmoothMesh() {
 	else
 		activeQueue = &mapChangeTrack.verticalBlurQueue;
 
-	const int damagedAreaIndex = activeQueue->front();
-	activeQueue->pop();
+	// every stage (maxima, horizontal blur, vertical blur) is completed for
+	// all damaged quads before the next one starts, quads within a stage are
+	// processed in parallel
+	updateQuads.clear();
 
-	// area of the map which to recalculate the height values
-	const int damageX = damagedAreaIndex % mapChangeTrack.width;
-	const int damageY = damagedAreaIndex / mapChangeTrack.width;
-	int2 damageMin{damageX*SAMPLES_PER_QUAD, damageY*SAMPLES_PER_QUAD};
-	int2 damageMax = damageMin + int2{SAMPLES_PER_QUAD - 1, SAMPLES_PER_QUAD - 1};
+	while (!activeQueue->empty() && updateQuads.size() < SMOOTH_MESH_UPDATE_QUADS) {
+		updateQuads.push_back(activeQueue->front());
+		activeQueue->pop();
+	}
 
-	damageMin.x = std::clamp(damageMin.x, 0, maxx - 1);
-	damageMin.y = std::clamp(damageMin.y, 0, maxy - 1);
-	damageMax.x = std::clamp(damageMax.x, 0, maxx - 1);
-	damageMax.y = std::clamp(damageMax.y, 0, maxy - 1);
+	const int winSize = smoothRadius / resolution;
+	const int blurSize = std::max(1, winSize / 2);
+	const int2 map{maxx, maxy};
 
 	if (updateMaxima) {
-		UpdateSmoothMeshMaximas(damageMin, damageMax);
+		// writes only the quad's own maxima, reads only the heightmap
+		for_mt(0, updateQuads.size(), [&](const int i) {
+			const int thread = ThreadPool::GetThreadNum();
 
-		mapChangeTrack.horizontalBlurQueue.push(damagedAreaIndex);
-		mapChangeTrack.damageMap[damagedAreaIndex] = false;
-	} else {
-		const int winSize = smoothRadius / resolution;
-		const int blurSize = std::max(1, winSize / 2);
-		const int2 map{maxx, maxy};
+			int2 damageMin;
+			int2 damageMax;
+			GetDamagedQuadBounds(updateQuads[i], damageMin, damageMax);
 
-#ifdef SMOOTH_MESH_DEBUG_GENERAL
-	LOG("%s: quad index %d (%d,%d)-(%d,%d) applying blur", __func__
-		, damagedAreaIndex, damageMin.x, damageMin.y, damageMax.x, damageMax.y
-		);
+			UpdateSmoothMeshMaximas(damageMin, damageMax, threadColsMaxima[thread], threadMaximaRows[thread]);
+		});
 
-	LOG("%s: quad area in world space (%f,%f) (%f,%f)", __func__
-		, (float)damageMin.x * fresolution, (float)damageMin.y * fresolution
-		, (float)damageMax.x * fresolution, (float)damageMax.y * fresolution
-		);
+		for (const int damagedAreaIndex: updateQuads) {
+			mapChangeTrack.horizontalBlurQueue.push(damagedAreaIndex);
+			mapChangeTrack.damageMap[damagedAreaIndex] = false;
+		}
+	} else if (doHorizontalBlur) {
+		// writes only the quad's own temporary heights, reads only maxima
+		for_mt(0, updateQuads.size(), [&](const int i) {
+			int2 damageMin;
+			int2 damageMax;
+			GetDamagedQuadBounds(updateQuads[i], damageMin, damageMax);
+
+#ifdef SMOOTH_MESH_DEBUG_GENERAL
+			LOG("%s: quad index %d (%d,%d)-(%d,%d) applying horizontal blur", __func__
+				, updateQuads[i], damageMin.x, damageMin.y, damageMax.x, damageMax.y
+				);
 #endif
 
-		if (doHorizontalBlur) {
 			BlurHorizontal(map, damageMin, damageMax, blurSize, resolution, maximaMesh, tempMesh);
+		});
+
+		for (const int damagedAreaIndex: updateQuads) {
 			mapChangeTrack.verticalBlurQueue.push(damagedAreaIndex);
 		}
-		else {
-			BlurVertical(map, damageMin, damageMax, blurSize, resolution, tempMesh, mesh);
-			CopyMeshPart(map.x, damageMin, damageMax, mesh, tempMesh);
+	} else {
+		// a quad's vertical blur reads the temporary heights of the quads above
+		// and below it, which their own blur overwrites with the final heights;
+		// quads of one column therefore keep their queue order while separate
+		// columns run in parallel
+		std::stable_sort(updateQuads.begin(), updateQuads.end(), [w = mapChangeTrack.width](int a, int b) {
+			return ((a % w) < (b % w));
+		});
+
+		updateQuadColumns.clear();
+
+		for (size_t i = 0; i < updateQuads.size(); i++) {
+			if (i == 0 || (updateQuads[i] % mapChangeTrack.width) != (updateQuads[i - 1] % mapChangeTrack.width))
+				updateQuadColumns.push_back(i);
 		}
+
+		updateQuadColumns.push_back(updateQuads.size());
+
+		for_mt(0, updateQuadColumns.size() - 1, [&](const int c) {
+			for (int i = updateQuadColumns[c]; i < updateQuadColumns[c + 1]; i++) {
+				int2 damageMin;
+				int2 damageMax;
+				GetDamagedQuadBounds(updateQuads[i], damageMin, damageMax);
+
+#ifdef SMOOTH_MESH_DEBUG_GENERAL
+				LOG("%s: quad index %d (%d,%d)-(%d,%d) applying vertical blur", __func__
+					, updateQuads[i], damageMin.x, damageMin.y, damageMax.x, damageMax.y
+					);
+#endif
+
+				BlurVertical(map, damageMin, damageMax, blurSize, resolution, tempMesh, mesh);
+				CopyMeshPart(map.x, damageMin, damageMax, mesh, tempMesh);
+			}
+		});
 	}
 }
 
@@ -631,6 +696,9 @@ void SmoothHeightMesh::MakeSmoothMesh() {
 	int2 max{maxx-1, maxy-1};
 	int2 map{maxx, maxy};
 
+	std::vector<float>& colsMaxima = threadColsMaxima[0];
+	std::vector<int>& maximaRows = threadMaximaRows[0];
+
  	FindMaximumColumnHeights(map, 0, 0, max.x, winSize, resolution, colsMaxima, maximaRows);
 
 	for (int y = 0; y <= max.y; ++y) {
@@ -15,6 +15,9 @@ class CGround;
 namespace SmoothHeightMeshNamespace {
 	constexpr int SMOOTH_MESH_UPDATE_DELAY = GAME_SPEED;
 	constexpr int SAMPLES_PER_QUAD = 32;
+	// at most this many damaged quads go through one update stage per frame,
+	// spread across worker threads (fixed since the mesh is synced)
+	constexpr int SMOOTH_MESH_UPDATE_QUADS = 16;
 }
 
 /**
@@ -64,7 +67,8 @@ public:
 private:
 	void InitMapChangeTracking();
 	void InitDataStructures();
-	void UpdateSmoothMeshMaximas(int2 damageMin, int2 damageMax);
+	void GetDamagedQuadBounds(int damagedAreaIndex, int2& damageMin, int2& damageMax) const;
+	void UpdateSmoothMeshMaximas(int2 damageMin, int2 damageMax, std::vector<float>& colsMaxima, std::vector<int>& maximaRows);
 
 	bool enabled = true;
 
@@ -81,8 +85,13 @@ private:
 	std::vector<float> tempMesh;
 	std::vector<float> origMesh;
 
-	std::vector<float> colsMaxima;
-	std::vector<int> maximaRows;
+	// sliding-window state, one per worker thread
+	std::vector< std::vector<float> > threadColsMaxima;
+	std::vector< std::vector<int> > threadMaximaRows;
+
+	// damaged quads taken off a queue by the current update
+	std::vector<int> updateQuads;
+	std::vector<int> updateQuadColumns;
 
 	MapChangeTrack mapChangeTrack;
 };
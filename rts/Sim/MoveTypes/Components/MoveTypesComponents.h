@@ -47,13 +47,24 @@ struct YardmapTrapCheckSystemComponent {
 	std::array<std::vector<CUnit*>, ThreadPool::MAX_THREADS> trappedUnitLists;
 };
 
-constexpr size_t UNIT_EVENT_VECTOR_RESERVE = 4;
+// Events raised by the multi-threaded collision detection of ground units. They are gathered
+// per thread and issued afterwards, single threaded, in collider unit-ID order.
+struct CollisionEventLists {
+    std::vector<UnitCrushEvent> unitCrushEvents;
+    std::vector<FeatureCrushEvent> featureCrushEvents;
+    std::vector<UnitCollisionEvent> unitCollisionEvents;
+    std::vector<FeatureCollisionEvent> featureCollisionEvents;
+    std::vector<FeatureMoveEvent> featureMoveEvents;
+};
+
+struct CollisionEventsSystemComponent {
+	static constexpr std::size_t page_size = 1;
 
-ALIAS_COMPONENT_LIST_RESERVE(FeatureCollisionEvents, std::vector<FeatureCollisionEvent>, UNIT_EVENT_VECTOR_RESERVE);
-ALIAS_COMPONENT_LIST_RESERVE(UnitCollisionEvents, std::vector<UnitCollisionEvent>, UNIT_EVENT_VECTOR_RESERVE);
-ALIAS_COMPONENT_LIST_RESERVE(FeatureCrushEvents, std::vector<FeatureCrushEvent>, UNIT_EVENT_VECTOR_RESERVE);
-ALIAS_COMPONENT_LIST_RESERVE(UnitCrushEvents, std::vector<UnitCrushEvent>, UNIT_EVENT_VECTOR_RESERVE);
-ALIAS_COMPONENT_LIST_RESERVE(FeatureMoveEvents, std::vector<FeatureMoveEvent>, UNIT_EVENT_VECTOR_RESERVE);
+	std::array<CollisionEventLists, ThreadPool::MAX_THREADS> threadEventLists;
+
+	// the per-thread lists merged and sorted, see GroundMoveSystem::Update
+	CollisionEventLists mergedEventLists;
+};
 
 }
 
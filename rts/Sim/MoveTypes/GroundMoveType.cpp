@@ -279,6 +279,12 @@ static bool CheckCollisionInclSAT(
 
 
 
+static MoveTypes::CollisionEventLists& GetThreadCollisionEvents(int curThread)
+{
+	auto& comp = Sim::systemGlobals.GetSystemComponent<MoveTypes::CollisionEventsSystemComponent>();
+	return comp.threadEventLists[curThread];
+}
+
 static void HandleUnitCollisionsAux(
 	const CUnit* collider,
 	const CUnit* collidee,
@@ -2812,6 +2818,8 @@ void CGroundMoveType::HandleUnitCollisions(
 	if ( !colliderMD->overrideUnitWaterline )
 		colliderInfo.DisableHeightChecks();
 
+	MoveTypes::CollisionEventLists& collisionEvents = GetThreadCollisionEvents(curThread);
+
 	// copy on purpose, since the below can call Lua
 	QuadFieldQuery qfQuery;
 	qfQuery.threadOwner = curThread;
@@ -2896,16 +2904,12 @@ void CGroundMoveType::HandleUnitCollisions(
 			crushCollidee |= (!alliedCollision || allowCAU);
 			crushCollidee &= ((colliderParams.x * collider->mass) > (collideeParams.x * collidee->mass));
 
-			if (crushCollidee && !CMoveMath::CrushResistant(*colliderMD, collidee)) {
-				auto& events = Sim::registry.get<UnitCrushEvents>(owner->entityReference);
-				events.value.emplace_back(collider, collidee, crushImpulse);
-			}
+			if (crushCollidee && !CMoveMath::CrushResistant(*colliderMD, collidee))
+				collisionEvents.unitCrushEvents.emplace_back(collider, collidee, crushImpulse);
 
 			// Only trigger this event once for each colliding pair of units.
-			if (collider->id < collidee->id){
-				auto& events = Sim::registry.get<UnitCollisionEvents>(owner->entityReference);
-				events.value.emplace_back(collider, collidee);
-			}
+			if (collider->id < collidee->id)
+				collisionEvents.unitCollisionEvents.emplace_back(collider, collidee);
 		}
 
 		if (collideeMobile)
@@ -3018,6 +3022,8 @@ void CGroundMoveType::HandleFeatureCollisions(
 	const float3 crushImpulse = owner->speed * owner->mass * Sign(int(!reversing));
 	MoveTypes::CheckCollisionQuery colliderInfo(collider);
 
+	MoveTypes::CollisionEventLists& collisionEvents = GetThreadCollisionEvents(curThread);
+
 	// copy on purpose, since DoDamage below can call Lua
 	QuadFieldQuery qfQuery;
 	qfQuery.threadOwner = curThread;
@@ -3037,19 +3043,15 @@ void CGroundMoveType::HandleFeatureCollisions(
 		if (CMoveMath::IsNonBlocking(collidee, &colliderInfo))
 			continue;
 
-		if (!CMoveMath::CrushResistant(*colliderMD, collidee)){
-			auto& events = Sim::registry.get<FeatureCrushEvents>(owner->entityReference);
-			events.value.emplace_back(collider, collidee, crushImpulse);
-		}
+		if (!CMoveMath::CrushResistant(*colliderMD, collidee))
+			collisionEvents.featureCrushEvents.emplace_back(collider, collidee, crushImpulse);
+
 		#if 0
 		if (pathController.IgnoreCollision(collider, collidee))
 			continue;
 		#endif
 
-		{
-			auto& events = Sim::registry.get<FeatureCollisionEvents>(owner->entityReference);
-			events.value.emplace_back(collider, collidee);
-		}
+		collisionEvents.featureCollisionEvents.emplace_back(collider, collidee);
 
 		if (!collidee->IsMoving()) {
 			if (HandleStaticObjectCollision(collider, collidee, colliderMD,  colliderParams.y, collideeParams.y,  separationVect, (!atEndOfPath && !atGoal), true, false, curThread)) {
@@ -3086,10 +3088,7 @@ void CGroundMoveType::HandleFeatureCollisions(
 
 		forceFromMovingCollidees += colResponseVec * colliderMassScale;
 
-		{
-			auto& events = Sim::registry.get<FeatureMoveEvents>(owner->entityReference);
-			events.value.emplace_back(collider, collidee, -colResponseVec * collideeMassScale);
-		}
+		collisionEvents.featureMoveEvents.emplace_back(collider, collidee, -colResponseVec * collideeMassScale);
 	}
 }
 
@@ -3104,11 +3103,6 @@ void CGroundMoveType::LeaveTransport()
 void CGroundMoveType::Connect() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	Sim::registry.emplace_or_replace<GroundMoveType>(owner->entityReference, owner->id);
-	Sim::registry.emplace_or_replace<FeatureCollisionEvents>(owner->entityReference);
-	Sim::registry.emplace_or_replace<UnitCollisionEvents>(owner->entityReference);
-	Sim::registry.emplace_or_replace<FeatureCrushEvents>(owner->entityReference);
-	Sim::registry.emplace_or_replace<UnitCrushEvents>(owner->entityReference);
-	Sim::registry.emplace_or_replace<FeatureMoveEvents>(owner->entityReference);
 	Sim::registry.emplace_or_replace<UnitMovedEvent>(owner->entityReference);
 	Sim::registry.emplace_or_replace<ChangeHeadingEvent>(owner->entityReference, owner->id);
 	Sim::registry.emplace_or_replace<ChangeMainHeadingEvent>(owner->entityReference, owner->id);
@@ -3118,11 +3112,6 @@ void CGroundMoveType::Connect() {
 void CGroundMoveType::Disconnect() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	Sim::registry.remove<GroundMoveType>(owner->entityReference);
-	Sim::registry.remove<FeatureCollisionEvents>(owner->entityReference);
-	Sim::registry.remove<UnitCollisionEvents>(owner->entityReference);
-	Sim::registry.remove<FeatureCrushEvents>(owner->entityReference);
-	Sim::registry.remove<UnitCrushEvents>(owner->entityReference);
-	Sim::registry.remove<FeatureMoveEvents>(owner->entityReference);
 	Sim::registry.remove<UnitMovedEvent>(owner->entityReference);
 	Sim::registry.remove<ChangeHeadingEvent>(owner->entityReference);
 	Sim::registry.remove<ChangeMainHeadingEvent>(owner->entityReference);
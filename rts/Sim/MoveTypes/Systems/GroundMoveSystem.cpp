@@ -11,22 +11,39 @@
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 
+#include "System/Ecs/Utils/SystemGlobalUtils.h"
 #include "System/EventHandler.h"
 #include "System/TimeProfiler.h"
 #include "System/Threading/ThreadPool.h"
 
 using namespace MoveTypes;
 
-void GroundMoveSystem::Init() {}
+static void InitSystemComponents() {
+    Sim::systemGlobals.CreateSystemComponent<CollisionEventsSystemComponent>();
+}
+
+void GroundMoveSystem::Init() {
+    InitSystemComponents();
+
+    Sim::systemUtils.OnPostLoad().connect<&InitSystemComponents>();
+}
 
 template<typename T, typename F>
-void issue_events(F func)
+void issue_events(CollisionEventsSystemComponent& comp, std::vector<T> CollisionEventLists::* eventList, F func)
 {
-    auto view = Sim::registry.view<T>();
-    view.each([&](T& comp){
-        std::for_each(comp.value.begin(), comp.value.end(), func);
-        comp.value.clear();
-    });
+    auto& events = comp.mergedEventLists.*eventList;
+    events.clear();
+
+    for (auto& threadEventLists: comp.threadEventLists) {
+        auto& threadEvents = threadEventLists.*eventList;
+        events.insert(events.end(), threadEvents.begin(), threadEvents.end());
+        threadEvents.clear();
+    }
+
+    // each collider's events come from a single thread and are already in order, so
+    // sorting by collider makes the order independent of how the work was scheduled
+    std::stable_sort(events.begin(), events.end(), [](const T& a, const T& b) { return (a.collider->id < b.collider->id); });
+    std::for_each(events.begin(), events.end(), func);
 }
 
 void GroundMoveSystem::Update() {
@@ -126,19 +143,21 @@ void GroundMoveSystem::Update() {
 	{
         SCOPED_TIMER("Sim::Unit::MoveType::4::ProcessCollisionEvents");
 
-        issue_events<UnitCrushEvents>([](const UnitCrushEvent& event) {
+        auto& comp = Sim::systemGlobals.GetSystemComponent<CollisionEventsSystemComponent>();
+
+        issue_events(comp, &CollisionEventLists::unitCrushEvents, [](const UnitCrushEvent& event) {
             event.collidee->Kill(event.collider, event.crushImpulse, true);
         });
-        issue_events<FeatureCrushEvents>([](const FeatureCrushEvent& event) {
+        issue_events(comp, &CollisionEventLists::featureCrushEvents, [](const FeatureCrushEvent& event) {
             event.collidee->Kill(event.collider, event.crushImpulse, true);
         });
-        issue_events<UnitCollisionEvents>([&](const UnitCollisionEvent& event) {
+        issue_events(comp, &CollisionEventLists::unitCollisionEvents, [](const UnitCollisionEvent& event) {
             eventHandler.UnitUnitCollision(event.collider, event.collidee);
         });
-        issue_events<FeatureCollisionEvents>([](const FeatureCollisionEvent& event) {
+        issue_events(comp, &CollisionEventLists::featureCollisionEvents, [](const FeatureCollisionEvent& event) {
             eventHandler.UnitFeatureCollision(event.collider, event.collidee);
         });
-        issue_events<FeatureMoveEvents>([](const FeatureMoveEvent& event) {
+        issue_events(comp, &CollisionEventLists::featureMoveEvents, [](const FeatureMoveEvent& event) {
             quadField.RemoveFeature(event.collidee);
             event.collidee->Move(event.moveImpulse, true);
             quadField.AddFeature(event.collidee);
@@ -164,4 +183,6 @@ void GroundMoveSystem::Update() {
     }
 }
 
-void GroundMoveSystem::Shutdown() {}
+void GroundMoveSystem::Shutdown() {
+    Sim::systemUtils.OnPostLoad().disconnect<&InitSystemComponents>();
+}
@@ -32,8 +32,12 @@
 
 #include "System/Misc/TracyDefs.h"
 
+#include <ostream>
+
 #define ENABLE_NETLOG_CHECKSUM 1
 
+CONFIG(bool, PathCacheMemoryMapped).defaultValue(true).description("Write HAPFS path-estimator caches uncompressed so they can be memory-mapped (and shared between processes) on load. Disable to keep the smaller zip caches.");
+
 static constexpr int BLOCK_UPDATE_DELAY_FRAMES = GAME_SPEED / 2;
 
 namespace HAPFS {
@@ -51,11 +55,33 @@ static const std::string GetPathCacheDir() {
 	return (FileSystem::GetCacheDir() + FileSystem::GetNativePathSeparator() + "paths" + FileSystem::GetNativePathSeparator());
 }
 
-static const std::string GetCacheFileName(const std::string& fileHashCode, const std::string& peFileName, const std::string& mapFileName) {
+static const std::string GetCacheFileName(const std::string& fileHashCode, const std::string& peFileName, const std::string& mapFileName, const char* fileExt = ".zip") {
 	RECOIL_DETAILED_TRACY_ZONE;
-	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".zip");
+	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + fileExt);
 }
 
+
+static constexpr char PATHCACHE_MAGIC[8] = {'R', 'C', 'L', 'P', 'E', 'C', 'H', '\0'};
+static constexpr std::uint32_t PATHCACHE_VERSION = 1;
+
+/**
+ * Header of the uncompressed (memory-mappable) cache-file; followed by the
+ * per-pathtype block center-offsets at offsetsPos and by the vertex-costs at
+ * costsPos, which is page-aligned so the costs can be used in-place.
+ */
+struct PathCacheHeader {
+	char magic[sizeof(PATHCACHE_MAGIC)];
+	std::uint32_t version;
+	std::uint32_t hashCode; // same as the zip-file header, PathingState::fileHashCode
+	std::uint32_t blockSize;
+	std::uint32_t numPathTypes;
+	std::uint32_t numBlocks;
+	std::uint32_t padding;
+	std::uint64_t offsetsPos;
+	std::uint64_t costsPos;
+	std::uint64_t numCosts;
+};
+
 void PathingState::KillStatic() { pathingStates = 0; }
 
 PathingState::PathingState()
@@ -106,11 +132,15 @@ void PathingState::Init(std::vector<IPathFinder*> pathFinderlist, PathingState*
 	 	pathChecksum = 0;
 	 	fileHashCode = CalcHash(__func__);
 
+		mappedCacheFiles = configHandler->GetBool("PathCacheMemoryMapped");
+
 		offsetBlockNum = {mapDimensionsInBlocks.x * mapDimensionsInBlocks.y};
 		costBlockNum = {mapDimensionsInBlocks.x * mapDimensionsInBlocks.y};
 
-		vertexCosts.clear();
-		vertexCosts.resize(moveDefHandler.GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
+		// allocated by InitEstimator, unless the costs can be mapped
+		vertexCostsMapping.Close();
+		vertexCostsBuffer.clear();
+		vertexCosts = {};
 		maxSpeedMods.clear();
 		maxSpeedMods.resize(moveDefHandler.GetNumMoveDefs(), 0.001f);
 
@@ -190,6 +220,25 @@ void PathingState::Terminate()
 	// allow our PNSB to be reused across reloads
 	if (instanceIndex < nodeStateBuffers.size())
 		nodeStateBuffers[instanceIndex] = std::move(blockStates);
+
+	vertexCosts = {};
+	vertexCostsMapping.Close();
+	vertexCostsBuffer.clear();
+	vertexCostsBuffer.shrink_to_fit();
+}
+
+std::size_t PathingState::GetNumVertexCosts() const
+{
+	return (moveDefHandler.GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES);
+}
+
+void PathingState::AllocVertexCosts()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	vertexCostsMapping.Close();
+	vertexCostsBuffer.clear();
+	vertexCostsBuffer.resize(GetNumVertexCosts(), PATHCOST_INFINITY);
+	vertexCosts = vertexCostsBuffer;
 }
 
 void PathingState::AllocStateBuffer()
@@ -208,7 +257,13 @@ void PathingState::AllocStateBuffer()
 bool PathingState::RemoveCacheFile(const std::string& peFileName, const std::string& mapFileName)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	return (FileSystem::Remove(GetCacheFileName(IntToString(fileHashCode, "%x"), peFileName, mapFileName)));
+	const std::string hashHexString = IntToString(fileHashCode, "%x");
+
+	// mapped file stays valid after unlinking, no need to close it here
+	const bool removedZip = FileSystem::Remove(GetCacheFileName(hashHexString, peFileName, mapFileName));
+	const bool removedRaw = FileSystem::Remove(GetCacheFileName(hashHexString, peFileName, mapFileName, ".pecache"));
+
+	return (removedZip || removedRaw);
 }
 
 
@@ -235,6 +290,8 @@ void PathingState::InitEstimator(const std::string& peFileName, const std::strin
 			loadscreen->SetLoadMessage(calcMsg);
 		}
 
+		AllocVertexCosts();
+
 		// Mark block directions as dirty to ensure they get updated.
 		auto& nodeFlags = blockStates.nodeLinksObsoleteFlags;
 		std::for_each(nodeFlags.begin(), nodeFlags.end(), [](std::uint8_t& f){ f = PATH_DIRECTIONS_HALF_MASK; });
@@ -493,6 +550,88 @@ void PathingState::CalcVertexPathCost(
  * Try to read offset and vertices data from file, return false on failure
  */
 bool PathingState::ReadFile(const std::string& peFileName, const std::string& mapFileName)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (ReadMappedFile(peFileName, mapFileName))
+		return true;
+
+	if (!ReadZipFile(peFileName, mapFileName))
+		return false;
+
+	// convert legacy caches so the next load can map them
+	if (mappedCacheFiles)
+		WriteMappedFile(peFileName, mapFileName);
+
+	return true;
+}
+
+bool PathingState::ReadMappedFile(const std::string& peFileName, const std::string& mapFileName)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const std::string hashHexString = IntToString(fileHashCode, "%x");
+	const std::string cacheFileName = GetCacheFileName(hashHexString, peFileName, mapFileName, ".pecache");
+
+	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
+
+	if (!FileSystem::FileExists(cacheFileName))
+		return false;
+
+	CMemoryMappedFile mmf;
+
+	// private mapping, MapChanged only duplicates the pages it rewrites
+	if (!mmf.Open(dataDirsAccess.LocateFile(cacheFileName), CMemoryMappedFile::MAP_COPY_ON_WRITE))
+		return false;
+
+	char calcMsg[512];
+	sprintf(calcMsg, "Mapping Estimate PathCosts [%d]", BLOCK_SIZE);
+	loadscreen->SetLoadMessage(calcMsg);
+
+	PathCacheHeader header;
+
+	if (mmf.GetSize() < sizeof(header)) {
+		FileSystem::Remove(cacheFileName);
+		return false;
+	}
+
+	std::memcpy(&header, mmf.GetData(), sizeof(header));
+
+	const std::size_t numPathTypes = moveDefHandler.GetNumMoveDefs();
+	const std::size_t numCosts = GetNumVertexCosts();
+	const std::size_t offsetsSize = blockStates.GetSize() * sizeof(short2);
+
+	bool valid = true;
+	valid &= (std::memcmp(header.magic, PATHCACHE_MAGIC, sizeof(PATHCACHE_MAGIC)) == 0);
+	valid &= (header.version == PATHCACHE_VERSION);
+	valid &= (header.hashCode == fileHashCode);
+	valid &= (header.blockSize == BLOCK_SIZE);
+	valid &= (header.numPathTypes == numPathTypes);
+	valid &= (header.numBlocks == blockStates.GetSize());
+	valid &= (header.numCosts == numCosts);
+	valid &= (header.costsPos % alignof(float)) == 0;
+	valid &= (header.offsetsPos + offsetsSize * numPathTypes) <= header.costsPos;
+	valid &= (header.costsPos + numCosts * sizeof(float)) <= mmf.GetSize();
+
+	if (!valid) {
+		LOG_L(L_WARNING, "[PathEstimator::%s] discarding invalid cache-file \"%s\"", __func__, cacheFileName.c_str());
+		mmf.Close();
+		FileSystem::Remove(cacheFileName);
+		return false;
+	}
+
+	// center-offsets are small, copy them
+	for (std::size_t pathType = 0; pathType < numPathTypes; ++pathType) {
+		std::memcpy(&blockStates.peNodeOffsets[pathType][0], mmf.GetData() + header.offsetsPos + offsetsSize * pathType, offsetsSize);
+	}
+
+	// vertex-costs are used straight from the mapping
+	vertexCostsBuffer.clear();
+	vertexCostsBuffer.shrink_to_fit();
+	vertexCostsMapping = std::move(mmf);
+	vertexCosts = {reinterpret_cast<float*>(vertexCostsMapping.GetWritableData() + header.costsPos), numCosts};
+	return true;
+}
+
+bool PathingState::ReadZipFile(const std::string& peFileName, const std::string& mapFileName)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
@@ -547,13 +686,15 @@ bool PathingState::ReadFile(const std::string& peFileName, const std::string& ma
 		pos += blockSize;
 	}
 
+	AllocVertexCosts();
+
 	// read vertex-cost data
 	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
+	std::memcpy(vertexCosts.data(), &buffer[pos], vertexCosts.size() * sizeof(float));
 	return true;
 }
 
@@ -562,6 +703,61 @@ bool PathingState::ReadFile(const std::string& peFileName, const std::string& ma
  * Try to write offset and vertex data to file.
  */
 bool PathingState::WriteFile(const std::string& peFileName, const std::string& mapFileName)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (mappedCacheFiles)
+		return (WriteMappedFile(peFileName, mapFileName));
+
+	return (WriteZipFile(peFileName, mapFileName));
+}
+
+bool PathingState::WriteMappedFile(const std::string& peFileName, const std::string& mapFileName)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!FileSystem::CreateDirectory(GetPathCacheDir()))
+		return false;
+
+	const std::string hashHexString = IntToString(fileHashCode, "%x");
+	const std::string cacheFileName = GetCacheFileName(hashHexString, peFileName, mapFileName, ".pecache");
+	const std::string cacheFilePath = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+
+	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
+
+	const std::size_t numPathTypes = moveDefHandler.GetNumMoveDefs();
+	const std::size_t pageSize = CMemoryMappedFile::GetPageSize();
+	const std::size_t offsetsSize = blockStates.GetSize() * sizeof(short2);
+
+	PathCacheHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, PATHCACHE_MAGIC, sizeof(PATHCACHE_MAGIC));
+
+	header.version = PATHCACHE_VERSION;
+	header.hashCode = fileHashCode;
+	header.blockSize = BLOCK_SIZE;
+	header.numPathTypes = numPathTypes;
+	header.numBlocks = blockStates.GetSize();
+	header.offsetsPos = sizeof(header);
+	header.costsPos = ((header.offsetsPos + offsetsSize * numPathTypes + pageSize - 1) / pageSize) * pageSize;
+	header.numCosts = vertexCosts.size();
+
+	// a process that already mapped the old file keeps reading that; others
+	// open either the old or the complete new one (on Windows the rename can
+	// fail while the old file is mapped, the cache is just not updated then)
+	return FileSystem::WriteFileViaTemp(cacheFilePath, [&](std::ostream& os) {
+		const std::vector<char> padding(header.costsPos - (header.offsetsPos + offsetsSize * numPathTypes), 0);
+
+		os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (std::size_t pathType = 0; pathType < numPathTypes; ++pathType) {
+			os.write(reinterpret_cast<const char*>(blockStates.peNodeOffsets[pathType].data()), offsetsSize);
+		}
+
+		os.write(padding.data(), padding.size());
+		os.write(reinterpret_cast<const char*>(vertexCosts.data()), vertexCosts.size() * sizeof(float));
+	});
+}
+
+bool PathingState::WriteZipFile(const std::string& peFileName, const std::string& mapFileName)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// we need this directory to exist
@@ -4,11 +4,13 @@
 #define HAPFS_PATHINGSTATESYSTEM_H
 
 #include <atomic>
+#include <span>
 #include <string>
 #include <vector>
 
 #include "IPathFinder.h"
 #include "PathDataTypes.h"
+#include "System/FileSystem/MemoryMappedFile.h"
 #include "System/Threading/SpringThreading.h"
 
 #include "Sim/Path/HAPFS/PathEstimator.h"
@@ -40,7 +42,7 @@ public:
 
     float GetVertexCost(size_t index) const { return vertexCosts[index]; };
 
-	const std::vector<float>& GetVertexCosts() const { return vertexCosts; }
+	std::span<const float> GetVertexCosts() const { return vertexCosts; }
 	const std::deque<int2>& GetUpdatedBlocks() const { return updatedBlocks; }
 
 	struct SOffsetBlock {
@@ -141,8 +143,19 @@ private:
 	bool ReadFile(const std::string& peFileName, const std::string& mapFileName);
 	bool WriteFile(const std::string& peFileName, const std::string& mapFileName);
 
+	/// uncompressed cache-file, mapped copy-on-write into vertexCosts
+	bool ReadMappedFile(const std::string& peFileName, const std::string& mapFileName);
+	bool WriteMappedFile(const std::string& peFileName, const std::string& mapFileName);
+	/// legacy zip cache-file, inflated into vertexCostsBuffer
+	bool ReadZipFile(const std::string& peFileName, const std::string& mapFileName);
+	bool WriteZipFile(const std::string& peFileName, const std::string& mapFileName);
+
 	std::size_t getCountOfUpdates() const { return updatedBlocks.size(); }
 
+private:
+	std::size_t GetNumVertexCosts() const;
+	void AllocVertexCosts();
+
 private:
 	friend class HAPFS::CPathEstimator;
 
@@ -176,11 +189,16 @@ private:
     std::vector<IPathFinder*> pathFinders; // InitEstimator helpers
 
     std::vector<float> maxSpeedMods;
-    std::vector<float> vertexCosts;
+    // views either vertexCostsBuffer or the memory-mapped cache-file
+    std::span<float> vertexCosts;
+    std::vector<float> vertexCostsBuffer;
+    CMemoryMappedFile vertexCostsMapping;
     std::deque<int2> updatedBlocks;
 
     PathNodeStateBuffer blockStates;
 
+    bool mappedCacheFiles = true;
+
 	struct SingleBlock {
 		int2 blockPos;
 		const MoveDef* moveDef;
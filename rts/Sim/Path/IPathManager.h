@@ -153,6 +153,31 @@ public:
 		return 0;
 	}
 
+	struct PathRequest {
+		const MoveDef* moveDef = nullptr;
+		float3 startPos;
+		float3 goalPos;
+		float goalRadius = 8.0f;
+	};
+
+	/**
+	 * Batched variant of RequestPath for owner-less requests with immediate
+	 * results (e.g. from Lua). Equivalent to calling RequestPath(nullptr, ...,
+	 * synced, true) for each request, but allows the path manager to coalesce
+	 * duplicate requests and to run the searches concurrently.
+	 *
+	 * @param pathIDs
+	 *     receives one path-id per request, 0 for requests that failed
+	 */
+	virtual void RequestPaths(const std::vector<PathRequest>& requests, std::vector<unsigned int>& pathIDs, bool synced) {
+		pathIDs.clear();
+		pathIDs.reserve(requests.size());
+
+		for (const PathRequest& req: requests) {
+			pathIDs.push_back(RequestPath(nullptr, req.moveDef, req.startPos, req.goalPos, req.goalRadius, synced, true));
+		}
+	}
+
 	/**
 	 * Whenever there are any changes in the terrain
 	 * (examples: explosions, new buildings, etc.)
@@ -668,49 +668,6 @@ unsigned int QTPFS::QTNode::GetMaxNumNeighbors() const {
 }
 
 
-// THIS FUNCTION IS NOT USED
-// Loading the cache seems to be slower than regenerating the data live at the moment.
-void QTPFS::QTNode::Serialize(nowide::fstream& fStream, NodeLayer& nodeLayer, unsigned int* streamSize, unsigned int depth, bool readMode) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// overwritten when de-serializing
-	unsigned int numChildren = QTNODE_CHILD_COUNT * (1 - int(IsLeaf()));
-
-	(*streamSize) += (3 * sizeof(unsigned int));
-	(*streamSize) += (3 * sizeof(float));
-
-	if (readMode) {
-		fStream.read(reinterpret_cast<char*>(&nodeNumber), sizeof(unsigned int));
-		fStream.read(reinterpret_cast<char*>(&numChildren), sizeof(unsigned int));
-		fStream.read(reinterpret_cast<char*>(&childBaseIndex), sizeof(unsigned int));
-
-		// fStream.read(reinterpret_cast<char*>(&speedModAvg), sizeof(float));
-		// fStream.read(reinterpret_cast<char*>(&speedModSum), sizeof(float));
-		fStream.read(reinterpret_cast<char*>(&moveCostAvg), sizeof(float));
-
-		if (numChildren > 0) {
-			// re-create child nodes
-			assert(IsLeaf());
-			Split(nodeLayer, depth, true);
-		} else {
-			// node was a leaf in an earlier life, register it
-			// nodeLayer.RegisterNode(this);
-		}
-	} else {
-		fStream.write(reinterpret_cast<const char*>(&nodeNumber), sizeof(unsigned int));
-		fStream.write(reinterpret_cast<const char*>(&numChildren), sizeof(unsigned int));
-		fStream.write(reinterpret_cast<const char*>(&childBaseIndex), sizeof(unsigned int));
-
-		// fStream.write(reinterpret_cast<const char*>(&speedModAvg), sizeof(float));
-		// fStream.write(reinterpret_cast<const char*>(&speedModSum), sizeof(float));
-		fStream.write(reinterpret_cast<const char*>(&moveCostAvg), sizeof(float));
-	}
-
-	for (unsigned int i = 0; i < numChildren; i++) {
-		nodeLayer.GetPoolNode(childBaseIndex + i)->Serialize(fStream, nodeLayer, streamSize, depth + 1, readMode);
-	}
-}
-
-
 // this is *either* called from ::GetNeighbors when the conservative
 // update-scheme is enabled, *or* from PM::ExecQueuedNodeLayerUpdates
 // (never both)
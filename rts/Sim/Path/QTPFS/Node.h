@@ -29,6 +29,7 @@ namespace QTPFS {
 
 	struct INode {
 			friend SearchNode;
+			friend NodeLayer; // node-layer cache (de)serialization
 	public:
 		struct NeighbourPoints {
 			int nodeId;
@@ -82,7 +83,6 @@ namespace QTPFS {
 
 		void PreTesselate(NodeLayer& nl, const SRectangle& r, SRectangle& ur, unsigned int depth, const UpdateThreadData* threadData);
 		void Tesselate(NodeLayer& nl, const SRectangle& r, unsigned int depth, const UpdateThreadData* threadData);
-		void Serialize(nowide::fstream& fStream, NodeLayer& nodeLayer, unsigned int* streamSize, unsigned int depth, bool readMode);
 
 		bool IsLeaf() const { return (childBaseIndex == -1u); }
 		bool CanSplit(unsigned int depth, bool forced) const;
@@ -33,6 +33,9 @@ inline int __bsfd (int mask)
 
 #include "System/Misc/TracyDefs.h"
 
+#include <cstring>
+#include <type_traits>
+
 unsigned int QTPFS::NodeLayer::NUM_SPEEDMOD_BINS;
 float        QTPFS::NodeLayer::MIN_SPEEDMOD_VALUE;
 float        QTPFS::NodeLayer::MAX_SPEEDMOD_VALUE;
@@ -60,6 +63,11 @@ void QTPFS::NodeLayer::Init(unsigned int layerNum) {
 	numLeafNodes = 1;
 	layerNumber = layerNum;
 
+	// layer might be re-initialized after a failed cache load
+	numOpenNodes = 0;
+	numClosedNodes = 0;
+	maxNodesAlloced = 0;
+
 	xsize = mapDims.mapx;
 	zsize = mapDims.mapy;
 
@@ -197,6 +205,162 @@ bool QTPFS::NodeLayer::Update(UpdateThreadData& threadData) {
 }
 
 
+namespace {
+	template<typename T> void WriteRaw(std::vector<std::uint8_t>& buffer, const T* src, std::size_t count = 1) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		const std::size_t pos = buffer.size();
+
+		buffer.resize(pos + sizeof(T) * count);
+		std::memcpy(buffer.data() + pos, src, sizeof(T) * count);
+	}
+
+	template<typename T> bool ReadRaw(const std::uint8_t*& data, const std::uint8_t* dataEnd, T* dst, std::size_t count = 1) {
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		if (static_cast<std::size_t>(dataEnd - data) < (sizeof(T) * count))
+			return false;
+
+		std::memcpy(dst, data, sizeof(T) * count);
+		data += (sizeof(T) * count);
+		return true;
+	}
+}
+
+
+bool QTPFS::NodeLayer::Serialize(std::vector<std::uint8_t>& buffer) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the free-list starts out as [POOL_TOTAL_SIZE - 1, ..., 0] and is popped from the
+	// back, so its front still holds the never-allocated indices in descending order;
+	// only the indices freed by merges (pushed after those) need to be stored
+	const std::uint32_t numFreshIndcs = POOL_TOTAL_SIZE - maxNodesAlloced;
+
+	if (nodeIndcs.size() < numFreshIndcs)
+		return false;
+
+	for (std::uint32_t i = 0; i < numFreshIndcs; i++) {
+		if (nodeIndcs[i] != (POOL_TOTAL_SIZE - 1 - i))
+			return false;
+	}
+
+	const std::uint32_t numFreedIndcs = nodeIndcs.size() - numFreshIndcs;
+	const std::uint32_t layerHeader[] = {
+		layerNumber,
+		numLeafNodes,
+		numOpenNodes,
+		numClosedNodes,
+		static_cast<std::uint32_t>(maxNodesAlloced),
+		static_cast<std::uint32_t>(numRootNodes),
+		static_cast<std::uint32_t>(xRootNodes),
+		static_cast<std::uint32_t>(zRootNodes),
+		static_cast<std::uint32_t>(rootNodeSize),
+		rootMask,
+		numFreedIndcs,
+	};
+
+	WriteRaw(buffer, &layerHeader[0], std::size(layerHeader));
+	WriteRaw(buffer, nodeIndcs.data() + numFreshIndcs, numFreedIndcs);
+
+	for (int32_t i = 0; i < maxNodesAlloced; i++) {
+		const INode* node = GetPoolNode(i);
+		const std::uint32_t numNeighbours = node->neighbours.size();
+
+		WriteRaw(buffer, &node->nodeNumber);
+		WriteRaw(buffer, &node->index);
+		WriteRaw(buffer, node->points.data(), node->points.size());
+		WriteRaw(buffer, &node->moveCostAvg);
+		WriteRaw(buffer, &node->childBaseIndex);
+		WriteRaw(buffer, &numNeighbours);
+		WriteRaw(buffer, node->neighbours.data(), numNeighbours);
+	}
+
+	return true;
+}
+
+bool QTPFS::NodeLayer::Deserialize(const std::uint8_t* data, std::size_t size) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const std::uint8_t* dataEnd = data + size;
+
+	std::uint32_t layerHeader[11];
+
+	if (!ReadRaw(data, dataEnd, &layerHeader[0], std::size(layerHeader)))
+		return false;
+
+	const std::uint32_t numNodes = layerHeader[4];
+	const std::uint32_t numFreedIndcs = layerHeader[10];
+
+	if (layerHeader[0] != layerNumber || numNodes > POOL_TOTAL_SIZE || numFreedIndcs > numNodes)
+		return false;
+	// must match what InitNodeLayer derived from the current map
+	if (static_cast<int32_t>(layerHeader[5]) != numRootNodes || layerHeader[9] != rootMask)
+		return false;
+	if (static_cast<int32_t>(layerHeader[6]) != xRootNodes || static_cast<int32_t>(layerHeader[7]) != zRootNodes || static_cast<int32_t>(layerHeader[8]) != rootNodeSize)
+		return false;
+	// root nodes are allocated first and never freed
+	if (numNodes < static_cast<std::uint32_t>(numRootNodes) || (numNodes - numFreedIndcs) < static_cast<std::uint32_t>(numRootNodes))
+		return false;
+	if (layerHeader[1] > numNodes)
+		return false;
+
+	numLeafNodes    = layerHeader[1];
+	numOpenNodes    = layerHeader[2];
+	numClosedNodes  = layerHeader[3];
+	maxNodesAlloced = numNodes;
+
+	nodeIndcs.resize(POOL_TOTAL_SIZE - numNodes + numFreedIndcs);
+
+	if (!ReadRaw(data, dataEnd, nodeIndcs.data() + (POOL_TOTAL_SIZE - numNodes), numFreedIndcs))
+		return false;
+
+	for (std::uint32_t i = POOL_TOTAL_SIZE - numNodes; i < nodeIndcs.size(); i++) {
+		if (nodeIndcs[i] < static_cast<std::uint32_t>(numRootNodes) || nodeIndcs[i] >= numNodes)
+			return false;
+	}
+
+	for (std::uint32_t i = 0; i < numNodes; i += POOL_CHUNK_SIZE) {
+		if (poolNodes[i / POOL_CHUNK_SIZE].empty())
+			poolNodes[i / POOL_CHUNK_SIZE].resize(POOL_CHUNK_SIZE);
+	}
+
+	for (std::uint32_t i = 0; i < numNodes; i++) {
+		INode* node = GetPoolNode(i);
+		std::uint32_t numNeighbours = 0;
+
+		bool valid = true;
+		valid = valid && ReadRaw(data, dataEnd, &node->nodeNumber);
+		valid = valid && ReadRaw(data, dataEnd, &node->index);
+		valid = valid && ReadRaw(data, dataEnd, node->points.data(), node->points.size());
+		valid = valid && ReadRaw(data, dataEnd, &node->moveCostAvg);
+		valid = valid && ReadRaw(data, dataEnd, &node->childBaseIndex);
+		valid = valid && ReadRaw(data, dataEnd, &numNeighbours);
+
+		if (!valid || numNeighbours > ((dataEnd - data) / sizeof(INode::NeighbourPoints)))
+			return false;
+
+		// everything below is used as an index into the pool or the map
+		if (node->GetIndex() != i)
+			return false;
+		if (node->xmin() >= node->xmax() || node->xmax() > static_cast<int>(xsize))
+			return false;
+		if (node->zmin() >= node->zmax() || node->zmax() > static_cast<int>(zsize))
+			return false;
+		if (!node->IsLeaf() && (node->GetChildBaseIndex() >= numNodes || (numNodes - node->GetChildBaseIndex()) < QTNODE_CHILD_COUNT))
+			return false;
+
+		node->neighbours.resize(numNeighbours);
+
+		if (!ReadRaw(data, dataEnd, node->neighbours.data(), numNeighbours))
+			return false;
+
+		for (const INode::NeighbourPoints& ngb: node->neighbours) {
+			if (ngb.nodeId < 0 || static_cast<std::uint32_t>(ngb.nodeId) >= numNodes)
+				return false;
+		}
+	}
+
+	return (data == dataEnd);
+}
+
+
 QTPFS::SpeedBinType QTPFS::NodeLayer::GetSpeedModBin(float absSpeedMod, float relSpeedMod) const {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// NOTE:
@@ -165,6 +165,12 @@ namespace QTPFS {
 
 		bool UseShortestPath() { return useShortestPath; }
 
+		// raw dump of the tesselated node pool for the node-layer cache, see
+		// PathManager::{Read,Write}NodeLayerCache; Deserialize expects a layer
+		// that was freshly set up by PathManager::InitNodeLayer
+		bool Serialize(std::vector<std::uint8_t>& buffer) const;
+		bool Deserialize(const std::uint8_t* data, std::size_t size);
+
 	private:
 		std::vector<QTNode> poolNodes[16];
 		std::vector<unsigned int> nodeIndcs;
@@ -7,8 +7,10 @@
 #include <algorithm>
 #include <chrono>
 #include <cinttypes>
+#include <cstring>
 #include <deque>
 #include <functional>
+#include <type_traits>
 
 #include "System/Threading/ThreadPool.h"
 #include "System/Threading/SpringThreading.h"
@@ -19,10 +21,13 @@
 #include "Utils/PathSpeedModInfoSystemUtils.h"
 
 #include "Game/GameSetup.h"
+#include "Game/GameVersion.h"
 #include "Game/LoadScreen.h"
 #include "Map/MapInfo.h"
+#include "Map/ReadMap.h"
 
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
@@ -30,11 +35,15 @@
 #include "Sim/Objects/SolidObject.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/MemoryMappedFile.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
 #include "System/Rectangle.h"
 #include "System/TimeProfiler.h"
+#include "System/SpringHash.h"
 #include "System/StringUtil.h"
 
 #include "Components/Path.h"
@@ -46,6 +55,7 @@
 #include "Registry.h"
 
 #include <assert.h>
+#include <ostream>
 #include "System/Misc/TracyDefs.h"
 
 #ifdef GetTempPath
@@ -57,6 +67,7 @@
 #define MAP_RECTANGLE SRectangle(0, 0,  mapDims.mapx, mapDims.mapy)
 
 CONFIG(int, PathingThreadCount).defaultValue(0).safemodeValue(1).minimumValue(0);
+CONFIG(int, QTPFSNodeLayerCache).defaultValue(1).safemodeValue(0).minimumValue(0).maximumValue(2).description("Cache the initial QTPFS node-layers on disk, keyed by map, game, movedefs and engine version.\n0:=off, 1:=load and store, 2:=validate (always recompute and compare against the cache)");
 
 namespace QTPFS {
 	struct PMLoadScreen {
@@ -130,6 +141,101 @@ namespace QTPFS {
 	unsigned int PathManager::LAYERS_PER_UPDATE;
 	unsigned int PathManager::MAX_TEAM_SEARCHES;
 
+	enum NodeLayerCacheMode {
+		NODELAYER_CACHE_OFF      = 0,
+		NODELAYER_CACHE_LOAD     = 1,
+		NODELAYER_CACHE_VALIDATE = 2,
+	};
+
+	static constexpr char NODELAYER_CACHE_MAGIC[8] = {'R', 'C', 'L', 'Q', 'T', 'N', 'L', '\0'};
+	static constexpr std::uint32_t NODELAYER_CACHE_VERSION = 2;
+
+	// followed by numLayers + 1 absolute layer offsets, then the layer data
+	struct NodeLayerCacheHeader {
+		char magic[sizeof(NODELAYER_CACHE_MAGIC)];
+		std::uint32_t version;
+		std::uint32_t numLayers;
+		sha512::raw_digest key;
+	};
+
+	// digest of everything the tesselation depends on; stored in full in the
+	// header, s.t. a file whose name prefix collides is never mistaken for ours
+	static sha512::raw_digest CalcNodeLayerCacheKey(const sha512::raw_digest& mapCheckSum, const sha512::raw_digest& modCheckSum, int rootSize) {
+		const std::string& syncVersion = SpringVersion::GetSync();
+
+		sha512::msg_state msg;
+		sha512::raw_digest key;
+
+		const auto Feed = [&msg]<typename T>(const T& value) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			sha512::update_digest(msg, reinterpret_cast<const std::uint8_t*>(&value), sizeof(T));
+		};
+
+		sha512::init_digest(msg);
+		sha512::update_digest(msg, reinterpret_cast<const std::uint8_t*>(syncVersion.data()), syncVersion.size());
+
+		Feed(NODELAYER_CACHE_VERSION);
+		Feed(mapCheckSum);
+		Feed(modCheckSum);
+		Feed(moveDefHandler.GetCheckSum());
+
+		// layers are tesselated after map features and Lua (e.g. terraforming
+		// gadgets) got their turn, so also key on the state they can change
+		Feed(readMap->CalcHeightmapChecksum());
+		Feed(readMap->CalcTypemapChecksum());
+		Feed(groundBlockingObjectMap.CalcChecksum());
+
+		// tesselation constants, can be overridden by mapoptions
+		Feed(NodeLayer::NUM_SPEEDMOD_BINS);
+		Feed(NodeLayer::MIN_SPEEDMOD_VALUE);
+		Feed(NodeLayer::MAX_SPEEDMOD_VALUE);
+		Feed(QTNode::MinSizeX());
+		Feed(QTNode::MinSizeZ());
+		Feed(rootSize);
+
+		sha512::final_digest(msg, key);
+		return key;
+	}
+
+	// first 64 bits of the key in hex
+	static std::string GetNodeLayerCacheKeyString(const sha512::raw_digest& key) {
+		sha512::hex_digest hexKey;
+		sha512::dump_digest(key, hexKey);
+		return std::string(hexKey.data(), 16);
+	}
+
+	static std::string GetNodeLayerCacheFileName(const sha512::raw_digest& key) {
+		const std::string pathCacheDir = FileSystem::GetCacheDir() + FileSystem::GetNativePathSeparator() + "paths" + FileSystem::GetNativePathSeparator();
+		return (pathCacheDir + mapInfo->map.name + ".qtpfs-" + GetNodeLayerCacheKeyString(key) + ".cache");
+	}
+
+	static bool ReadNodeLayerCacheOffsets(const CMemoryMappedFile& mmf, const sha512::raw_digest& key, std::size_t numLayers, std::vector<std::uint64_t>& layerOffsets) {
+		NodeLayerCacheHeader header;
+
+		if (mmf.GetSize() < sizeof(header))
+			return false;
+
+		std::memcpy(&header, mmf.GetData(), sizeof(header));
+
+		if (std::memcmp(header.magic, NODELAYER_CACHE_MAGIC, sizeof(NODELAYER_CACHE_MAGIC)) != 0)
+			return false;
+		if (header.version != NODELAYER_CACHE_VERSION || header.key != key || header.numLayers != numLayers)
+			return false;
+		if (mmf.GetSize() < (sizeof(header) + (numLayers + 1) * sizeof(std::uint64_t)))
+			return false;
+
+		layerOffsets.resize(numLayers + 1);
+		std::memcpy(layerOffsets.data(), mmf.GetData() + sizeof(header), layerOffsets.size() * sizeof(std::uint64_t));
+
+		// offsets must be ascending and inside the file
+		for (std::size_t i = 0; i < numLayers; i++) {
+			if (layerOffsets[i] > layerOffsets[i + 1])
+				return false;
+		}
+
+		return (layerOffsets.back() <= mmf.GetSize());
+	}
+
 	IPath* GetPath(QTPFS::entity entityId) {
 		if (!registry.valid(entityId)) return nullptr;
 
@@ -380,7 +486,30 @@ void QTPFS::PathManager::Load() {
 		sha512::dump_digest(mapCheckSum, mapCheckSumHex);
 		sha512::dump_digest(modCheckSum, modCheckSumHex);
 
-		InitNodeLayersThreaded(MAP_RECTANGLE);
+		const int nodeLayerCacheMode = configHandler->GetInt("QTPFSNodeLayerCache");
+
+		nodeLayerCacheKey = CalcNodeLayerCacheKey(mapCheckSum, modCheckSum, rootSize);
+		nodeLayerCacheFile = GetNodeLayerCacheFileName(nodeLayerCacheKey);
+
+		if (nodeLayerCacheMode != NODELAYER_CACHE_LOAD || !ReadNodeLayerCache()) {
+			InitNodeLayersThreaded(MAP_RECTANGLE);
+
+			std::vector< std::vector<std::uint8_t> > layerBuffers;
+
+			switch (nodeLayerCacheMode) {
+				case NODELAYER_CACHE_LOAD: {
+					if (SerializeNodeLayers(layerBuffers))
+						WriteNodeLayerCache(layerBuffers);
+				} break;
+				case NODELAYER_CACHE_VALIDATE: {
+					if (SerializeNodeLayers(layerBuffers))
+						ValidateNodeLayerCache(layerBuffers);
+				} break;
+				default: {
+				} break;
+			}
+		}
+
 		PathSpeedModInfoSystem::Init();
 		RemoveDeadPathsSystem::Init();
 		RequeuePathsSystem::Init();
@@ -525,6 +654,157 @@ void QTPFS::PathManager::InitNodeLayersThreaded(const SRectangle& rect) {
 	streflop::streflop_init<streflop::Simple>();
 }
 
+bool QTPFS::PathManager::ReadNodeLayerCache() {
+	RECOIL_DETAILED_TRACY_ZONE;
+	LOG("[QTPFS::%s] key=%s file=\"%s\" (exists=%d)", __func__, GetNodeLayerCacheKeyString(nodeLayerCacheKey).c_str(), nodeLayerCacheFile.c_str(), FileSystem::FileExists(nodeLayerCacheFile));
+
+	if (!FileSystem::FileExists(nodeLayerCacheFile))
+		return false;
+
+	CMemoryMappedFile mmf;
+	std::vector<std::uint64_t> layerOffsets;
+
+	if (!mmf.Open(dataDirsAccess.LocateFile(nodeLayerCacheFile)))
+		return false;
+
+	if (!ReadNodeLayerCacheOffsets(mmf, nodeLayerCacheKey, nodeLayers.size(), layerOffsets)) {
+		mmf.Close();
+		FileSystem::Remove(nodeLayerCacheFile);
+		return false;
+	}
+
+	{
+		char loadMsg[512] = {'\0'};
+		const char* fmtString = "[PathManager::%s] loading %u node-layers from cache";
+		snprintf(loadMsg, sizeof(loadMsg), fmtString, __func__, nodeLayers.size());
+		pmLoadScreen.AddMessage(loadMsg);
+	}
+
+	std::vector<std::uint8_t> layersLoaded(nodeLayers.size(), 0);
+
+	for_mt(0, nodeLayers.size(), [&](const int layerNum) {
+		InitNodeLayer(layerNum, MAP_RECTANGLE);
+
+		const std::uint8_t* layerData = mmf.GetData() + layerOffsets[layerNum];
+		const std::size_t layerSize = layerOffsets[layerNum + 1] - layerOffsets[layerNum];
+
+		layersLoaded[layerNum] = nodeLayers[layerNum].Deserialize(layerData, layerSize);
+	});
+
+	if (std::find(layersLoaded.begin(), layersLoaded.end(), 0) == layersLoaded.end())
+		return true;
+
+	// caller re-initializes all layers from scratch
+	LOG_L(L_WARNING, "[QTPFS::%s] discarding corrupt node-layer cache \"%s\"", __func__, nodeLayerCacheFile.c_str());
+
+	mmf.Close();
+	FileSystem::Remove(nodeLayerCacheFile);
+	return false;
+}
+
+bool QTPFS::PathManager::SerializeNodeLayers(std::vector< std::vector<std::uint8_t> >& layerBuffers) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<std::uint8_t> layersSerialized(nodeLayers.size(), 0);
+
+	layerBuffers.clear();
+	layerBuffers.resize(nodeLayers.size());
+
+	for_mt(0, nodeLayers.size(), [&](const int layerNum) {
+		layersSerialized[layerNum] = nodeLayers[layerNum].Serialize(layerBuffers[layerNum]);
+	});
+
+	if (std::find(layersSerialized.begin(), layersSerialized.end(), 0) == layersSerialized.end())
+		return true;
+
+	LOG_L(L_WARNING, "[QTPFS::%s] node-layers can not be cached", __func__);
+	return false;
+}
+
+bool QTPFS::PathManager::WriteNodeLayerCache(const std::vector< std::vector<std::uint8_t> >& layerBuffers) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!FileSystem::CreateDirectory(FileSystem::GetDirectory(nodeLayerCacheFile)))
+		return false;
+
+	const std::string cacheFilePath = dataDirsAccess.LocateFile(nodeLayerCacheFile, FileQueryFlags::WRITE);
+
+	LOG("[QTPFS::%s] key=%s file=\"%s\"", __func__, GetNodeLayerCacheKeyString(nodeLayerCacheKey).c_str(), nodeLayerCacheFile.c_str());
+
+	NodeLayerCacheHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, NODELAYER_CACHE_MAGIC, sizeof(NODELAYER_CACHE_MAGIC));
+
+	header.version = NODELAYER_CACHE_VERSION;
+	header.key = nodeLayerCacheKey;
+	header.numLayers = layerBuffers.size();
+
+	std::vector<std::uint64_t> layerOffsets(layerBuffers.size() + 1);
+	layerOffsets[0] = sizeof(header) + layerOffsets.size() * sizeof(std::uint64_t);
+
+	for (std::size_t i = 0; i < layerBuffers.size(); i++) {
+		layerOffsets[i + 1] = layerOffsets[i] + layerBuffers[i].size();
+	}
+
+	// other instances might be loading the same cache, never expose a partial file
+	return FileSystem::WriteFileViaTemp(cacheFilePath, [&](std::ostream& os) {
+		os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		os.write(reinterpret_cast<const char*>(layerOffsets.data()), layerOffsets.size() * sizeof(std::uint64_t));
+
+		for (const auto& layerBuffer: layerBuffers) {
+			os.write(reinterpret_cast<const char*>(layerBuffer.data()), layerBuffer.size());
+		}
+	});
+}
+
+bool QTPFS::PathManager::ValidateNodeLayerCache(const std::vector< std::vector<std::uint8_t> >& layerBuffers) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	CMemoryMappedFile mmf;
+	std::vector<std::uint64_t> layerOffsets;
+
+	const bool haveCache = FileSystem::FileExists(nodeLayerCacheFile) && mmf.Open(dataDirsAccess.LocateFile(nodeLayerCacheFile));
+
+	if (!haveCache || !ReadNodeLayerCacheOffsets(mmf, nodeLayerCacheKey, layerBuffers.size(), layerOffsets)) {
+		LOG("[QTPFS::%s] no valid node-layer cache \"%s\" to compare against", __func__, nodeLayerCacheFile.c_str());
+		mmf.Close();
+		return WriteNodeLayerCache(layerBuffers);
+	}
+
+	unsigned int numMismatches = 0;
+
+	for (std::size_t layerNum = 0; layerNum < layerBuffers.size(); layerNum++) {
+		const std::vector<std::uint8_t>& layerBuffer = layerBuffers[layerNum];
+
+		const std::uint8_t* cacheData = mmf.GetData() + layerOffsets[layerNum];
+		const std::size_t cacheSize = layerOffsets[layerNum + 1] - layerOffsets[layerNum];
+
+		if (cacheSize == layerBuffer.size() && std::memcmp(cacheData, layerBuffer.data(), cacheSize) == 0)
+			continue;
+
+		const auto mismatch = std::mismatch(layerBuffer.begin(), layerBuffer.end(), cacheData, cacheData + cacheSize);
+		const std::size_t mismatchPos = mismatch.first - layerBuffer.begin();
+
+		LOG_L(L_WARNING, "[QTPFS::%s] node-layer %u differs from cache (size %u vs %u, first difference at byte %u)", __func__, unsigned(layerNum), unsigned(layerBuffer.size()), unsigned(cacheSize), unsigned(mismatchPos));
+		numMismatches++;
+	}
+
+	LOG("[QTPFS::%s] %u of %u cached node-layers differ from the recomputed ones", __func__, numMismatches, unsigned(layerBuffers.size()));
+
+	if (numMismatches == 0)
+		return true;
+
+	// replace the stale cache
+	mmf.Close();
+	WriteNodeLayerCache(layerBuffers);
+	return false;
+}
+
+void QTPFS::PathManager::RemoveCacheFiles() {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (nodeLayerCacheFile.empty())
+		return;
+
+	FileSystem::Remove(nodeLayerCacheFile);
+}
+
 void QTPFS::PathManager::InitRootSize(const SRectangle& r) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// setup the root node system
@@ -1533,6 +1813,121 @@ unsigned int QTPFS::PathManager::RequestPath(
 	return returnPathId;
 }
 
+void QTPFS::PathManager::RequestPaths(const std::vector<PathRequest>& requests, std::vector<unsigned int>& pathIDs, bool synced) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	pathIDs.clear();
+	pathIDs.resize(requests.size(), 0);
+
+	if (!IsFinalized())
+		return;
+
+	struct BatchEntry {
+		std::uint64_t key;
+		unsigned int reqIdx;
+		QTPFS::entity searchEntity;
+	};
+
+	std::vector<BatchEntry> batch;
+	std::vector<std::size_t> headEntries;
+
+	batch.reserve(requests.size());
+	headEntries.reserve(requests.size());
+
+	for (unsigned int i = 0; i < requests.size(); i++) {
+		const PathRequest& req = requests[i];
+
+		if (req.moveDef == nullptr)
+			continue;
+
+		assert(req.startPos.x != 0.f || req.startPos.z != 0.f);
+
+		// same as RequestPath(nullptr, ...): owner-less requests never do raw searches
+		if ((pathIDs[i] = QueueSearch(nullptr, req.moveDef, req.startPos, req.goalPos, req.goalRadius, synced, false)) == 0)
+			continue;
+
+		const QTPFS::entity pathEntity = QTPFS::entity(pathIDs[i]);
+		const QTPFS::entity searchEntity = registry.get<PathSearchRef>(pathEntity).value;
+
+		InitializeSearch(searchEntity);
+
+		// searches on the same layer between the same squares with the same goal
+		// radius yield the same path, so only one of them has to be executed
+		const IPath* path = GetPath(pathEntity);
+		const float3& srcPoint = path->GetSourcePoint();
+		const float3& tgtPoint = path->GetGoalPosition();
+
+		const std::uint32_t srcSquare = int(srcPoint.z / SQUARE_SIZE) * mapDims.mapx + int(srcPoint.x / SQUARE_SIZE);
+		const std::uint32_t tgtSquare = int(tgtPoint.z / SQUARE_SIZE) * mapDims.mapx + int(tgtPoint.x / SQUARE_SIZE);
+
+		std::uint64_t key = (std::uint64_t(srcSquare) << 32) | tgtSquare;
+		key = spring::LiteHash(req.moveDef->pathType, spring::LiteHash(req.goalRadius, 0)) ^ (key * 0x9E3779B97F4A7C15ull);
+
+		batch.push_back({key, i, searchEntity});
+	}
+
+	// group duplicates together, keeping request order within each group (the
+	// first request of a group becomes its head); the keys are only a grouping
+	// aid, equality is verified against the actual request below
+	std::stable_sort(batch.begin(), batch.end(), [](const BatchEntry& a, const BatchEntry& b) { return (a.key < b.key); });
+
+	const auto isDuplicate = [&](const BatchEntry& a, const BatchEntry& b) {
+		if (a.key != b.key)
+			return false;
+
+		const PathRequest& ra = requests[a.reqIdx];
+		const PathRequest& rb = requests[b.reqIdx];
+		const IPath* pa = GetPath(QTPFS::entity(pathIDs[a.reqIdx]));
+		const IPath* pb = GetPath(QTPFS::entity(pathIDs[b.reqIdx]));
+
+		if (ra.moveDef->pathType != rb.moveDef->pathType || ra.goalRadius != rb.goalRadius)
+			return false;
+
+		const int2 sa = {int(pa->GetSourcePoint().x / SQUARE_SIZE), int(pa->GetSourcePoint().z / SQUARE_SIZE)};
+		const int2 sb = {int(pb->GetSourcePoint().x / SQUARE_SIZE), int(pb->GetSourcePoint().z / SQUARE_SIZE)};
+		const int2 ga = {int(pa->GetGoalPosition().x / SQUARE_SIZE), int(pa->GetGoalPosition().z / SQUARE_SIZE)};
+		const int2 gb = {int(pb->GetGoalPosition().x / SQUARE_SIZE), int(pb->GetGoalPosition().z / SQUARE_SIZE)};
+
+		return (sa == sb && ga == gb);
+	};
+
+	for (std::size_t i = 0; i < batch.size(); i++) {
+		if (i == 0 || !isDuplicate(batch[headEntries.back()], batch[i]))
+			headEntries.push_back(i);
+	}
+
+	// searches use per-thread state, so the group heads can run concurrently
+	for_mt(0, headEntries.size(), [&](const int i) {
+		PathSearch* search = GetSearch(batch[ headEntries[i] ].searchEntity);
+		const int pathType = search->GetPathType();
+
+		ExecuteSearch(search, nodeLayers[pathType], pathType);
+	});
+
+	for (std::size_t i = 0, h = 0; i < batch.size(); i++) {
+		h += ((h + 1) < headEntries.size() && headEntries[h + 1] == i);
+
+		const BatchEntry& headEntry = batch[ headEntries[h] ];
+		const BatchEntry& curEntry = batch[i];
+
+		if (&headEntry != &curEntry) {
+			const PathSearch* headSearch = GetSearch(headEntry.searchEntity);
+			const IPath* headPath = GetPath(QTPFS::entity(pathIDs[headEntry.reqIdx]));
+
+			PathSearch* curSearch = GetSearch(curEntry.searchEntity);
+			IPath* curPath = GetPath(QTPFS::entity(pathIDs[curEntry.reqIdx]));
+
+			if (headSearch->PathWasFound() && headPath != nullptr && curPath != nullptr)
+				curSearch->SharedFinalize(headPath, curPath);
+		}
+	}
+
+	// heads are finished last since that destroys their search state
+	for (std::size_t i = batch.size(); i-- > 0; ) {
+		const BatchEntry& entry = batch[i];
+		pathIDs[entry.reqIdx] = FinishImmediateSearch(QTPFS::entity(pathIDs[entry.reqIdx]), entry.searchEntity);
+	}
+}
+
 unsigned int QTPFS::PathManager::ExecuteImmediateSearch(unsigned int pathId){
 	RECOIL_DETAILED_TRACY_ZONE;
 	QTPFS::entity pathEntity = QTPFS::entity(pathId);
@@ -1546,10 +1941,18 @@ unsigned int QTPFS::PathManager::ExecuteImmediateSearch(unsigned int pathId){
 	NodeLayer& nodeLayer = nodeLayers[pathType];
 	ExecuteSearch(&pathSearch, nodeLayer, pathType);
 
+	return (FinishImmediateSearch(pathEntity, pathSearchEntity));
+}
+
+unsigned int QTPFS::PathManager::FinishImmediateSearch(QTPFS::entity pathEntity, QTPFS::entity pathSearchEntity) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	unsigned int pathId = (unsigned int)pathEntity;
+
 	if (registry.valid(pathEntity)) {
+		const PathSearch* pathSearch = GetSearch(pathSearchEntity);
 		IPath* path = GetPath(pathEntity);
 		if (path != nullptr) {
-			if (pathSearch.PathWasFound()) {
+			if (pathSearch != nullptr && pathSearch->PathWasFound()) {
 				registry.remove<PathIsTemp>(pathEntity);
 				registry.remove<PathIsDirty>(pathEntity);
 				registry.remove<PathSearchRef>(pathEntity);
@@ -3,6 +3,7 @@
 #ifndef QTPFS_PATHMANAGER_HDR
 #define QTPFS_PATHMANAGER_HDR
 
+#include <string>
 #include <vector>
 
 #include "Sim/Misc/ModInfo.h"
@@ -11,6 +12,7 @@
 #include "PathCache.h"
 #include "PathSearch.h"
 #include "System/UnorderedMap.hpp"
+#include "System/Sync/SHA512.hpp"
 
 struct MoveDef;
 struct SRectangle;
@@ -46,6 +48,8 @@ namespace QTPFS {
 		std::int64_t Finalize() override;
 		std::int64_t PostFinalizeRefresh() override;
 
+		void RemoveCacheFiles() override;
+
 		bool PathUpdated(unsigned int pathID) override;
 		void ClearPathUpdated(unsigned int pathID) override;
 
@@ -67,6 +71,8 @@ namespace QTPFS {
 			bool immediateResult = false
 		) override;
 
+		void RequestPaths(const std::vector<PathRequest>& requests, std::vector<unsigned int>& pathIDs, bool synced) override;
+
 		float3 NextWayPoint(
 			const CSolidObject*, // owner
 			unsigned int pathID,
@@ -119,6 +125,12 @@ namespace QTPFS {
 		typedef std::vector<PathSearch*>::iterator PathSearchVectIt;
 
 		void InitNodeLayersThreaded(const SRectangle& rect);
+
+		// on-disk cache of the node-layers as tesselated by InitNodeLayersThreaded
+		bool ReadNodeLayerCache();
+		bool WriteNodeLayerCache(const std::vector< std::vector<std::uint8_t> >& layerBuffers) const;
+		bool ValidateNodeLayerCache(const std::vector< std::vector<std::uint8_t> >& layerBuffers) const;
+		bool SerializeNodeLayers(std::vector< std::vector<std::uint8_t> >& layerBuffers) const;
 		void InitNodeLayer(unsigned int layerNum, const SRectangle& r);
 		void InitRootSize(const SRectangle& r);
 		void UpdateNodeLayer(unsigned int layerNum, const SRectangle& r, int currentThread);
@@ -158,6 +170,7 @@ namespace QTPFS {
 		);
 
 		unsigned int ExecuteImmediateSearch(unsigned int pathId);
+		unsigned int FinishImmediateSearch(QTPFS::entity pathEntity, QTPFS::entity pathSearchEntity);
 
 		bool IsFinalized() const { return isFinalized; }
 
@@ -197,6 +210,9 @@ namespace QTPFS {
 
 		std::uint32_t pfsCheckSum;
 
+		std::string nodeLayerCacheFile;
+		sha512::raw_digest nodeLayerCacheKey = sha512::NULL_RAW_DIGEST;
+
 		QTPFS::entity systemEntity = entt::null;
 
 		bool isFinalized = false;
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <cstring>
 
 #include "Projectile.h"
 #include "ProjectileHandler.h"
@@ -42,6 +43,10 @@
 
 CONFIG(int, MaxParticles).defaultValue(10000).headlessValue(0).minimumValue(0);
 CONFIG(int, MaxNanoParticles).defaultValue(2000).headlessValue(0).minimumValue(0);
+CONFIG(bool, ProjectilesMT).defaultValue(true).description("Gather the collision candidates of projectiles on all threads. Results are identical to the single-threaded path.");
+
+// below this the parallel passes cost more than they save
+static constexpr size_t MT_MIN_PROJECTILES = 256;
 
 
 CR_BIND(CProjectileHandler, )
@@ -55,7 +60,11 @@ CR_REG_METADATA(CProjectileHandler, (
 	CR_MEMBER(maxNanoParticles),
 	CR_MEMBER(currentNanoParticles),
 	CR_MEMBER_UN(frameCurrentParticles),
-	CR_MEMBER_UN(frameProjectileCounts)
+	CR_MEMBER_UN(frameProjectileCounts),
+
+	CR_IGNORED(collisionCandidates),
+	CR_IGNORED(threadCandidates),
+	CR_IGNORED(projectilesMT)
 ))
 
 
@@ -79,6 +88,7 @@ void CProjectileHandler::Init()
 
 	maxParticles     = configHandler->GetInt("MaxParticles");
 	maxNanoParticles = configHandler->GetInt("MaxNanoParticles");
+	projectilesMT    = configHandler->GetBool("ProjectilesMT");
 
 	projMemPool.clear();
 	projMemPool.reserve(1024);
@@ -94,7 +104,7 @@ void CProjectileHandler::Init()
 	CExpGenSpawnable::InitSpawnables();
 
 	// register ConfigNotify()
-	configHandler->NotifyOnChange(this, {"MaxParticles", "MaxNanoParticles"});
+	configHandler->NotifyOnChange(this, {"MaxParticles", "MaxNanoParticles", "ProjectilesMT"});
 }
 
 void CProjectileHandler::Kill()
@@ -130,6 +140,17 @@ void CProjectileHandler::Kill()
 		}
 	}
 
+	{
+		collisionCandidates.clear();
+
+		for (ThreadCandidates& tc: threadCandidates) {
+			tc.units.clear();
+			tc.features.clear();
+			tc.repulsers.clear();
+			tc.quads.clear();
+		}
+	}
+
 	CCollisionHandler::PrintStats();
 }
 
@@ -139,6 +160,7 @@ void CProjectileHandler::ConfigNotify(const std::string& key, const std::string&
 	RECOIL_DETAILED_TRACY_ZONE;
 	maxParticles     = configHandler->GetInt("MaxParticles");
 	maxNanoParticles = configHandler->GetInt("MaxNanoParticles");
+	projectilesMT    = configHandler->GetBool("ProjectilesMT");
 
 	projectiles[false].reserve(static_cast<size_t>(maxParticles) * 2);
 }
@@ -156,6 +178,12 @@ static void MAPPOS_SANITY_CHECK(const float3 v)
 	assert(v.y <=  MAX_PROJECTILE_HEIGHT);
 }
 
+static bool BitwiseEqual(const float3& a, const float3& b)
+{
+	return (std::memcmp(&a, &b, sizeof(float3)) == 0);
+}
+
+
 template<bool synced>
 void CProjectileHandler::UpdateProjectilesImpl()
 {
@@ -424,6 +452,27 @@ static bool CheckProjectileCollisionFlags(const CProjectile* p, const CUnit* u)
 	return true;
 }
 
+// returns the first of <objs> (in order) hit by the segment p0-p1, or nullptr
+template<typename T>
+static T* DetectFirstHit(const std::vector<T*>& objs, const float3 p0, const float3 p1, CollisionQuery& cq)
+{
+	static std::vector<const CSolidObject*> solidObjs;
+	static std::vector<CollisionQuery> cqs;
+	static std::vector<std::uint8_t> hits;
+
+	solidObjs.assign(objs.begin(), objs.end());
+	cqs.resize(objs.size());
+	hits.resize(objs.size());
+
+	const size_t i = CCollisionHandler::DetectFirstHit(solidObjs.data(), solidObjs.size(), p0, p1, cqs.data(), hits.data());
+
+	if (i == objs.size())
+		return nullptr;
+
+	cq = cqs[i];
+	return objs[i];
+}
+
 
 void CProjectileHandler::CheckUnitCollisions(
 	CProjectile* p,
@@ -435,8 +484,12 @@ void CProjectileHandler::CheckUnitCollisions(
 	if (!p->checkCol)
 		return;
 
+	static std::vector<CUnit*> candidates;
+
 	CollisionQuery cq;
 
+	candidates.clear();
+
 	for (CUnit* unit: tempUnits) {
 		assert(unit != nullptr);
 
@@ -449,20 +502,23 @@ void CProjectileHandler::CheckUnitCollisions(
 		if (!CheckProjectileCollisionFlags(p, unit))
 			continue;
 
-		if (CCollisionHandler::DetectHit(unit, unit->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+		candidates.push_back(unit);
+	}
 
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(unit);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(unit);
-			}
+	CUnit* unit = DetectFirstHit(candidates, ppos0, ppos1, cq);
 
-			break;
-		}
+	if (unit == nullptr)
+		return;
+
+	if (cq.GetHitPiece() != nullptr)
+		unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+
+	if (!cq.InsideHit()) {
+		p->SetPosition(cq.GetHitPos());
+		p->Collision(unit);
+		p->SetPosition(ppos0);
+	} else {
+		p->Collision(unit);
 	}
 }
 
@@ -480,28 +536,35 @@ void CProjectileHandler::CheckFeatureCollisions(
 	if ((p->GetCollisionFlags() & Collision::NOFEATURES) != 0)
 		return;
 
+	static std::vector<CFeature*> candidates;
+
 	CollisionQuery cq;
 
+	candidates.clear();
+
 	for (CFeature* feature: tempFeatures) {
 		assert(feature != nullptr);
 
 		if (!feature->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
 			continue;
 
-		if (CCollisionHandler::DetectHit(feature, feature->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				feature->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+		candidates.push_back(feature);
+	}
 
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(feature);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(feature);
-			}
+	CFeature* feature = DetectFirstHit(candidates, ppos0, ppos1, cq);
 
-			break;
-		}
+	if (feature == nullptr)
+		return;
+
+	if (cq.GetHitPiece() != nullptr)
+		feature->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum, p->synced);
+
+	if (!cq.InsideHit()) {
+		p->SetPosition(cq.GetHitPos());
+		p->Collision(feature);
+		p->SetPosition(ppos0);
+	} else {
+		p->Collision(feature);
 	}
 }
 
@@ -560,6 +623,56 @@ void CProjectileHandler::CheckShieldCollisions(
 	}
 }
 
+size_t CProjectileHandler::GatherCollisionCandidatesMT(bool synced)
+{
+	const auto& pc = projectiles[synced];
+
+	if (!projectilesMT || pc.size() < MT_MIN_PROJECTILES)
+		return 0;
+
+	SCOPED_TIMER("Sim::Projectiles::GatherCandidatesMT");
+	collisionCandidates.resize(pc.size());
+
+	for (ThreadCandidates& tc: threadCandidates) {
+		tc.units.clear();
+		tc.features.clear();
+		tc.repulsers.clear();
+		tc.quads.clear();
+	}
+
+	for_mt_chunk(0, pc.size(), [&](int i) {
+		const CProjectile* p = pc[i];
+		CollisionCandidates& cc = collisionCandidates[i];
+
+		cc.proj = nullptr;
+
+		if (!p->checkCol) return;
+		if ( p->deleteMe) return;
+
+		const int thread = ThreadPool::GetThreadNum();
+		ThreadCandidates& tc = threadCandidates[thread];
+
+		cc.proj = p;
+		cc.pos = p->pos;
+		cc.radius = p->speed.w + p->radius;
+		cc.thread = thread;
+
+		cc.units[0] = tc.units.size();
+		cc.features[0] = tc.features.size();
+		cc.repulsers[0] = tc.repulsers.size();
+		cc.quads[0] = tc.quads.size();
+
+		quadField.GetUnitsAndFeaturesColVolCandidates(cc.pos, cc.radius, tc.units, tc.features, tc.repulsers, tc.quads, thread);
+
+		cc.units[1] = tc.units.size();
+		cc.features[1] = tc.features.size();
+		cc.repulsers[1] = tc.repulsers.size();
+		cc.quads[1] = tc.quads.size();
+	});
+
+	return pc.size();
+}
+
 void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -567,6 +680,9 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 	static std::vector<CFeature*> tempFeatures;
 	static std::vector<CPlasmaRepulser*> tempRepulsers;
 
+	const unsigned int qfChangeCount = quadField.GetChangeCount();
+	const size_t numGathered = GatherCollisionCandidatesMT(synced);
+
 	//can't use iterators here, because instructions inside the loop modify projectiles[synced]
 	for (size_t i = 0; i < projectiles[synced].size(); ++i) {
 		CProjectile* p = projectiles[synced][i];
@@ -577,8 +693,32 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 		const float3 ppos0 = p->pos;
 		const float3 ppos1 = p->pos + p->speed;
 		// const float3 ppos1 = p->pos + p->dir * (p->speed.w + p->radius);
+		const float radius = p->speed.w + p->radius;
+
+		// gathered candidates are only valid while neither <p> nor the quads it
+		// overlaps have changed since, which collisions of earlier projectiles in
+		// this loop can do (e.g. by killing a unit or spawning a feature)
+		const CollisionCandidates* cc = (i < numGathered)? &collisionCandidates[i]: nullptr;
+		const ThreadCandidates* tc = (cc != nullptr)? &threadCandidates[cc->thread]: nullptr;
+
+		const auto CandidatesValid = [&]() {
+			if (cc->proj != p || !BitwiseEqual(cc->pos, p->pos) || cc->radius != radius)
+				return false;
+
+			return quadField.QuadsUnchangedSince(tc->quads.data() + cc->quads[0], cc->quads[1] - cc->quads[0], qfChangeCount);
+		};
 
-		quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, tempUnits, tempFeatures, &tempRepulsers);
+		if (cc != nullptr && CandidatesValid()) {
+
+			tempUnits.assign(tc->units.begin() + cc->units[0], tc->units.begin() + cc->units[1]);
+			tempFeatures.assign(tc->features.begin() + cc->features[0], tc->features.begin() + cc->features[1]);
+			tempRepulsers.assign(tc->repulsers.begin() + cc->repulsers[0], tc->repulsers.begin() + cc->repulsers[1]);
+
+			// the distance test reads positions which may have changed, always do it here
+			CQuadField::FilterUnitsAndFeaturesColVol(p->pos, radius, tempUnits, tempFeatures, tempRepulsers);
+		} else {
+			quadField.GetUnitsAndFeaturesColVol(p->pos, radius, tempUnits, tempFeatures, &tempRepulsers);
+		}
 
 		CheckShieldCollisions (p, tempRepulsers, ppos0, ppos1); tempRepulsers.clear();
 		CheckUnitCollisions   (p, tempUnits    , ppos0, ppos1); tempUnits.clear();
@@ -10,6 +10,7 @@
 #include "Rendering/Env/Particles/Classes/FlyingPiece.h"
 #include "System/float3.h"
 #include "System/FreeListMap.h"
+#include "System/Threading/ThreadPool.h"
 
 
 // bypass id and event handling for unsynced projectiles (faster)
@@ -110,6 +111,37 @@ private:
 		UpdateProjectilesImpl<false>();
 	}
 
+	// parallel pass whose results are only used while still valid, so that the
+	// serial collision loop behaves exactly as without it; returns the number
+	// of projectiles it processed
+	size_t GatherCollisionCandidatesMT(bool synced);
+
+private:
+	struct CollisionCandidates {
+		const CProjectile* proj;
+		float3 pos;
+		float radius;
+		int thread;
+
+		// [begin, end) ranges into threadCandidates[thread]
+		std::array<uint32_t, 2> units;
+		std::array<uint32_t, 2> features;
+		std::array<uint32_t, 2> repulsers;
+		std::array<uint32_t, 2> quads;
+	};
+
+	struct ThreadCandidates {
+		std::vector<CUnit*> units;
+		std::vector<CFeature*> features;
+		std::vector<CPlasmaRepulser*> repulsers;
+		std::vector<int> quads;
+	};
+
+	std::vector<CollisionCandidates> collisionCandidates;
+	std::array<ThreadCandidates, ThreadPool::MAX_THREADS> threadCandidates;
+
+	bool projectilesMT = true;
+
 private:
 	// [0] contains only projectiles that can not change simulation state
 	// [1] contains only projectiles that can     change simulation state
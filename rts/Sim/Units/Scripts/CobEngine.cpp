@@ -8,6 +8,8 @@
 #include "CobFile.h"
 
 #include <cstdint>
+#include "Sim/Misc/ModInfo.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/Misc/TracyDefs.h"
 #include "Lua/LuaUI.h"
 
@@ -22,6 +24,10 @@ CR_REG_METADATA(CCobEngine, (
 	// always null/empty when saving
 	CR_IGNORED(waitingThreadIDs),
 
+	CR_IGNORED(wokenThreadIDs),
+	CR_IGNORED(threadGroups),
+	CR_IGNORED(threadGroupIndices),
+
 	CR_IGNORED(curThread),
 	CR_IGNORED(deferredCallins),
 
@@ -133,9 +139,104 @@ void CCobEngine::TickThread(CCobThread* thread)
 	curThread = nullptr;
 }
 
+void CCobEngine::TickThreadsMT(const std::vector<int>& threadIDs)
+{
+	ZoneScoped;
+
+	for (auto& group: threadGroups) {
+		group.clear();
+	}
+
+	threadGroupIndices.clear();
+
+	size_t numGroups = 0;
+
+	// group by owner in order of first appearance; threadInstances
+	// is not modified until the serial pass below, pointers are safe
+	for (const int threadID: threadIDs) {
+		CCobThread* thread = GetThread(threadID);
+
+		if (thread == nullptr)
+			continue;
+
+		const auto pair = threadGroupIndices.emplace(thread->cobInst, static_cast<int>(numGroups));
+
+		if (pair.second) {
+			if (numGroups == threadGroups.size())
+				threadGroups.emplace_back();
+
+			numGroups++;
+		}
+
+		threadGroups[pair.first->second].push_back(thread);
+	}
+
+	// a thread that stops early may still change its instance's state,
+	// so the threads queued after it in the same group wait for the serial
+	// pass altogether
+	for_mt(0, numGroups, [&](const int groupIdx) {
+		for (CCobThread* thread: threadGroups[groupIdx]) {
+			if (!thread->TickLocal())
+				break;
+		}
+	});
+
+	for (const int threadID: threadIDs) {
+		CCobThread* thread = GetThread(threadID);
+
+		if (thread == nullptr)
+			continue;
+
+		curThread = thread;
+
+		if (!thread->FinishTick())
+			RemoveThread(threadID);
+
+		curThread = nullptr;
+	}
+}
+
 void CCobEngine::WakeSleepingThreads()
 {
 	ZoneScoped;
+
+	if (modInfo.mtCobThreads) {
+		wokenThreadIDs.clear();
+
+		// same selection as below, but all threads are ticked together afterwards
+		while (!sleepingThreadIDs.empty()) {
+			CCobThread* zzzThread = GetThread((sleepingThreadIDs.top()).id);
+
+			if (zzzThread == nullptr) {
+				sleepingThreadIDs.pop();
+				continue;
+			}
+
+			if (zzzThread->GetWakeTime() >= currentTime)
+				break;
+
+			sleepingThreadIDs.pop();
+
+			switch (zzzThread->GetState()) {
+				case CCobThread::Sleep: {
+					zzzThread->SetState(CCobThread::Run);
+					wokenThreadIDs.push_back(zzzThread->GetID());
+				} break;
+				case CCobThread::Dead: {
+					RemoveThread(zzzThread->GetID());
+				} break;
+				default: {
+					LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, zzzThread->GetState(), zzzThread->GetID());
+				} break;
+			}
+		}
+
+		TickThreadsMT(wokenThreadIDs);
+
+		// threads that went back to sleep for a negative time are
+		// already due again, these are handled by the serial loop
+	}
+
 	// check on the sleeping threads, remove any whose owner died
 	while (!sleepingThreadIDs.empty()) {
 		CCobThread* zzzThread = GetThread((sleepingThreadIDs.top()).id);
@@ -174,8 +275,12 @@ void CCobEngine::TickRunningThreads()
 {
 	ZoneScoped;
 	// advance all currently running threads
-	for (const int threadID: runningThreadIDs) {
-		TickThread(GetThread(threadID));
+	if (modInfo.mtCobThreads) {
+		TickThreadsMT(runningThreadIDs);
+	} else {
+		for (const int threadID: runningThreadIDs) {
+			TickThread(GetThread(threadID));
+		}
 	}
 
 	// a thread can never go from running->running, so clear the list
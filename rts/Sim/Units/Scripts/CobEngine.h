@@ -109,6 +109,12 @@ public:
 	void RunDeferredCallins();
 private:
 	void TickThread(CCobThread* thread);
+	/**
+	 * Ticks <threadIDs> (in this order) like TickThread, but first runs the
+	 * local part (CCobThread::TickLocal) of threads belonging to different
+	 * script instances concurrently; see modInfo.mtCobThreads.
+	 */
+	void TickThreadsMT(const std::vector<int>& threadIDs);
 
 	void WakeSleepingThreads();
 	void TickRunningThreads();
@@ -130,6 +136,11 @@ private:
 	// for validity; thread owner might get removed while a thread is sleeping
 	std::priority_queue<SleepingThread, std::vector<SleepingThread>, CCobThreadComp> sleepingThreadIDs;
 
+	// per-tick scratch space of TickThreadsMT, groups are per script instance
+	std::vector<int> wokenThreadIDs;
+	std::vector< std::vector<CCobThread*> > threadGroups;
+	spring::unordered_map<const CCobInstance*, int> threadGroupIndices;
+
 	CCobThread* curThread = nullptr;
 
 	int currentTime = 0;
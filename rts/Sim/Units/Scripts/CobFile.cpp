@@ -2,8 +2,10 @@
 
 
 #include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/ModInfo.h"
 #include "CobFile.h"
 #include "CobOpCodes.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Sound/ISound.h"
@@ -85,6 +87,8 @@ do {									\
 } while (0)
 
 
+CONFIG(bool, CobPreDecode).defaultValue(true).description("Translate COB scripts into a pre-decoded instruction stream when loading them instead of interpreting their raw bytecode. Always on for games that enable mtCobThreads.");
+
 static std::vector<uint8_t> cobFileData;
 
 
@@ -206,6 +210,11 @@ CCobFile::CCobFile(CFileHandler& in, const std::string& scriptName)
 
 		scriptIndex[pair.second] = fn;
 	}
+
+	// TickLocal only runs decoded code and MT mode is synced, the config must
+	// not decide which clients get MT semantics
+	if (modInfo.mtCobThreads || configHandler->GetBool("CobPreDecode"))
+		Decode();
 }
 
 
@@ -219,3 +228,178 @@ int CCobFile::GetFunctionId(const std::string& name)
 
 	return -1;
 }
+
+
+void CCobFile::Decode()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int numWords = static_cast<int>(code.size());
+
+	decodedCode.clear();
+	decodedCode.resize(numWords + 1, {OP_INVALID, 1, 0, 0, 0, 0});
+
+	for (int pos = 0; pos < numWords; pos++) {
+		decodedCode[pos] = DecodeInstr(pos);
+	}
+}
+
+CCobFile::Instr CCobFile::DecodeInstr(int pos) const
+{
+	const int numWords = static_cast<int>(code.size());
+	const int opcode = code[pos];
+
+	Instr instr = {OP_INVALID, 1, opcode, 0, 0, 0};
+
+	const auto IsCodePos = [&](int p) { return (p >= 0 && p <= numWords); };
+	const auto IsScript = [&](int s) { return (s >= 0 && s < static_cast<int>(scriptNames.size()) && IsCodePos(scriptOffsets[s])); };
+	const auto HasWords = [&](int p, int n) { return ((p + n) <= numWords); };
+
+	// fused sequences; the words they cover keep their own decoding
+	if (opcode == PUSH_CONSTANT && HasWords(pos, 3)) {
+		const int next = pos + 2;
+
+		switch (code[next]) {
+			case SLEEP: {
+				return {OP_SLEEP_CONST, 3, code[pos + 1], 0, 0, 0};
+			} break;
+			case MOVE_NOW: {
+				if (HasWords(next, 3))
+					return {OP_MOVE_NOW_CONST, 5, code[next + 1], code[next + 2], code[pos + 1], 0};
+			} break;
+			case TURN_NOW: {
+				if (HasWords(next, 3))
+					return {OP_TURN_NOW_CONST, 5, code[next + 1], code[next + 2], code[pos + 1], 0};
+			} break;
+			case PUSH_CONSTANT: {
+				if (!HasWords(next, 5))
+					break;
+
+				// target is pushed first, speed second
+				if (code[next + 2] == MOVE)
+					return {OP_MOVE_CONST, 7, code[next + 3], code[next + 4], code[pos + 1], code[next + 1]};
+				if (code[next + 2] == TURN)
+					return {OP_TURN_CONST, 7, code[next + 3], code[next + 4], code[pos + 1], code[next + 1]};
+			} break;
+			default: {
+			} break;
+		}
+	}
+
+	Op op = OP_INVALID;
+	int numOperands = 0;
+
+	switch (opcode) {
+		case MOVE            : { op = OP_MOVE            ; numOperands = 2; } break;
+		case TURN            : { op = OP_TURN            ; numOperands = 2; } break;
+		case SPIN            : { op = OP_SPIN            ; numOperands = 2; } break;
+		case STOP_SPIN       : { op = OP_STOP_SPIN       ; numOperands = 2; } break;
+		case SHOW            : { op = OP_SHOW            ; numOperands = 1; } break;
+		case HIDE            : { op = OP_HIDE            ; numOperands = 1; } break;
+		case CACHE           : { op = OP_NOP             ; numOperands = 1; } break;
+		case DONT_CACHE      : { op = OP_NOP             ; numOperands = 1; } break;
+		case MOVE_NOW        : { op = OP_MOVE_NOW        ; numOperands = 2; } break;
+		case TURN_NOW        : { op = OP_TURN_NOW        ; numOperands = 2; } break;
+		case SHADE           : { op = OP_NOP             ; numOperands = 1; } break;
+		case DONT_SHADE      : { op = OP_NOP             ; numOperands = 1; } break;
+		case EMIT_SFX        : { op = OP_EMIT_SFX        ; numOperands = 1; } break;
+		case SCALE           : { op = OP_SCALE           ; numOperands = 1; } break;
+		case SCALE_NOW       : { op = OP_SCALE_NOW       ; numOperands = 1; } break;
+
+		case WAIT_TURN       : { op = OP_WAIT_TURN       ; numOperands = 2; } break;
+		case WAIT_MOVE       : { op = OP_WAIT_MOVE       ; numOperands = 2; } break;
+		case WAIT_SCALE      : { op = OP_WAIT_SCALE      ; numOperands = 1; } break;
+		case SLEEP           : { op = OP_SLEEP           ; numOperands = 0; } break;
+
+		case PUSH_CONSTANT   : { op = OP_PUSH_CONSTANT   ; numOperands = 1; } break;
+		case PUSH_LOCAL_VAR  : { op = OP_PUSH_LOCAL_VAR  ; numOperands = 1; } break;
+		case PUSH_STATIC     : { op = OP_PUSH_STATIC     ; numOperands = 1; } break;
+		case CREATE_LOCAL_VAR: { op = OP_CREATE_LOCAL_VAR; numOperands = 0; } break;
+		case POP_LOCAL_VAR   : { op = OP_POP_LOCAL_VAR   ; numOperands = 1; } break;
+		case POP_STATIC      : { op = OP_POP_STATIC      ; numOperands = 1; } break;
+		case POP_STACK       : { op = OP_POP_STACK       ; numOperands = 0; } break;
+
+		case ADD             : { op = OP_ADD             ; numOperands = 0; } break;
+		case SUB             : { op = OP_SUB             ; numOperands = 0; } break;
+		case MUL             : { op = OP_MUL             ; numOperands = 0; } break;
+		case DIV             : { op = OP_DIV             ; numOperands = 0; } break;
+		case MOD             : { op = OP_MOD             ; numOperands = 0; } break;
+		case BITWISE_AND     : { op = OP_BITWISE_AND     ; numOperands = 0; } break;
+		case BITWISE_OR      : { op = OP_BITWISE_OR      ; numOperands = 0; } break;
+		case BITWISE_XOR     : { op = OP_BITWISE_XOR     ; numOperands = 0; } break;
+		case BITWISE_NOT     : { op = OP_BITWISE_NOT     ; numOperands = 0; } break;
+
+		case RAND            : { op = OP_RAND            ; numOperands = 0; } break;
+		case GET_UNIT_VALUE  : { op = OP_GET_UNIT_VALUE  ; numOperands = 0; } break;
+		case GET             : { op = OP_GET             ; numOperands = 0; } break;
+
+		case SET_LESS            : { op = OP_SET_LESS            ; numOperands = 0; } break;
+		case SET_LESS_OR_EQUAL   : { op = OP_SET_LESS_OR_EQUAL   ; numOperands = 0; } break;
+		case SET_GREATER         : { op = OP_SET_GREATER         ; numOperands = 0; } break;
+		case SET_GREATER_OR_EQUAL: { op = OP_SET_GREATER_OR_EQUAL; numOperands = 0; } break;
+		case SET_EQUAL           : { op = OP_SET_EQUAL           ; numOperands = 0; } break;
+		case SET_NOT_EQUAL       : { op = OP_SET_NOT_EQUAL       ; numOperands = 0; } break;
+		case LOGICAL_AND         : { op = OP_LOGICAL_AND         ; numOperands = 0; } break;
+		case LOGICAL_OR          : { op = OP_LOGICAL_OR          ; numOperands = 0; } break;
+		case LOGICAL_XOR         : { op = OP_LOGICAL_XOR         ; numOperands = 0; } break;
+		case LOGICAL_NOT         : { op = OP_LOGICAL_NOT         ; numOperands = 0; } break;
+
+		case START           : { op = OP_START           ; numOperands = 2; } break;
+		case CALL            : { op = OP_REAL_CALL       ; numOperands = 2; } break;
+		case REAL_CALL       : { op = OP_REAL_CALL       ; numOperands = 2; } break;
+		case LUA_CALL        : { op = OP_LUA_CALL        ; numOperands = 2; } break;
+		case BATCH_LUA       : { op = OP_BATCH_LUA       ; numOperands = 2; } break;
+		case JUMP            : { op = OP_JUMP            ; numOperands = 1; } break;
+		case RETURN          : { op = OP_RETURN          ; numOperands = 0; } break;
+		case JUMP_NOT_EQUAL  : { op = OP_JUMP_NOT_EQUAL  ; numOperands = 1; } break;
+		case SIGNAL          : { op = OP_SIGNAL          ; numOperands = 0; } break;
+		case SET_SIGNAL_MASK : { op = OP_SET_SIGNAL_MASK ; numOperands = 0; } break;
+
+		case EXPLODE         : { op = OP_EXPLODE         ; numOperands = 1; } break;
+		case PLAY_SOUND      : { op = OP_PLAY_SOUND      ; numOperands = 1; } break;
+
+		case SET             : { op = OP_SET             ; numOperands = 0; } break;
+		case ATTACH          : { op = OP_ATTACH          ; numOperands = 0; } break;
+		case DROP            : { op = OP_DROP            ; numOperands = 0; } break;
+
+		case SIGNATURE_LUA   : { op = OP_SIGNATURE_LUA   ; numOperands = 0; } break;
+
+		default: {
+			return instr;
+		} break;
+	}
+
+	// the raw interpreter would read past the end of the code here
+	if (!HasWords(pos + 1, numOperands))
+		return instr;
+
+	const int a = (numOperands > 0)? code[pos + 1]: 0;
+	const int b = (numOperands > 1)? code[pos + 2]: 0;
+
+	switch (op) {
+		case OP_REAL_CALL: {
+			if (!IsScript(a))
+				return instr;
+
+			// resolved once here instead of patching <code> when first executed
+			if (opcode == CALL && scriptNames[a].find("lua_") == 0)
+				op = OP_LUA_CALL;
+			else if (scriptLengths[a] == 0)
+				op = OP_NOP;
+		} break;
+		case OP_START: {
+			if (!IsScript(a))
+				return instr;
+			if (scriptLengths[a] == 0)
+				op = OP_NOP;
+		} break;
+		case OP_JUMP:
+		case OP_JUMP_NOT_EQUAL: {
+			if (!IsCodePos(a))
+				return instr;
+		} break;
+		default: {
+		} break;
+	}
+
+	return {op, static_cast<std::uint8_t>(1 + numOperands), a, b, 0, 0};
+}
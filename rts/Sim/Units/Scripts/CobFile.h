@@ -4,6 +4,7 @@
 #define COB_FILE_H
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -23,6 +24,7 @@ public:
 		numStaticVars = f.numStaticVars;
 
 		code = std::move(f.code);
+		decodedCode = std::move(f.decodedCode);
 		scriptNames = std::move(f.scriptNames);
 		scriptOffsets = std::move(f.scriptOffsets);
 
@@ -39,10 +41,71 @@ public:
 
 	int GetFunctionId(const std::string& name);
 
+public:
+	/**
+	 * Operations of the pre-decoded instruction stream; unlike the raw
+	 * opcodes these are dense so dispatching on them compiles to a single
+	 * jump-table. The *_CONST variants are fused PUSH_CONSTANT sequences.
+	 */
+	enum Op: std::uint8_t {
+		OP_INVALID,
+		OP_NOP,
+
+		OP_MOVE, OP_TURN, OP_SPIN, OP_STOP_SPIN, OP_SHOW, OP_HIDE,
+		OP_MOVE_NOW, OP_TURN_NOW, OP_EMIT_SFX, OP_SCALE, OP_SCALE_NOW,
+		OP_WAIT_TURN, OP_WAIT_MOVE, OP_WAIT_SCALE, OP_SLEEP,
+
+		OP_PUSH_CONSTANT, OP_PUSH_LOCAL_VAR, OP_PUSH_STATIC, OP_CREATE_LOCAL_VAR,
+		OP_POP_LOCAL_VAR, OP_POP_STATIC, OP_POP_STACK,
+
+		OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD,
+		OP_BITWISE_AND, OP_BITWISE_OR, OP_BITWISE_XOR, OP_BITWISE_NOT,
+
+		OP_RAND, OP_GET_UNIT_VALUE, OP_GET,
+
+		OP_SET_LESS, OP_SET_LESS_OR_EQUAL, OP_SET_GREATER, OP_SET_GREATER_OR_EQUAL,
+		OP_SET_EQUAL, OP_SET_NOT_EQUAL,
+		OP_LOGICAL_AND, OP_LOGICAL_OR, OP_LOGICAL_XOR, OP_LOGICAL_NOT,
+
+		OP_START, OP_REAL_CALL, OP_LUA_CALL, OP_BATCH_LUA, OP_JUMP, OP_RETURN,
+		OP_JUMP_NOT_EQUAL, OP_SIGNAL, OP_SET_SIGNAL_MASK,
+
+		OP_EXPLODE, OP_PLAY_SOUND,
+		OP_SET, OP_ATTACH, OP_DROP,
+		OP_SIGNATURE_LUA,
+
+		OP_MOVE_CONST, OP_TURN_CONST, OP_MOVE_NOW_CONST, OP_TURN_NOW_CONST, OP_SLEEP_CONST,
+	};
+
+	struct Instr {
+		Op op;
+		/// number of code words covered, the next instruction starts at pc + size
+		std::uint8_t size;
+
+		// operands in code order; fused instructions store the pushed
+		// constants in c and d, OP_INVALID keeps the raw opcode in a
+		int a;
+		int b;
+		int c;
+		int d;
+	};
+
+private:
+	void Decode();
+	Instr DecodeInstr(int pos) const;
+
 public:
 	int numStaticVars = 0;
 
 	std::vector<int> code;
+	/**
+	 * One decoded instruction per word of <code>, plus an invalid sentinel
+	 * at the end. Indexing it by the raw program counter keeps jump targets,
+	 * return addresses and the counters stored in savegames valid; operand
+	 * words are decoded as well in case a (broken) jump lands on them, just
+	 * like the raw interpreter would run them. Empty if CobPreDecode and mtCobThreads are both off.
+	 */
+	std::vector<Instr> decodedCode;
 	std::vector<std::string> scriptNames;
 	std::vector<int> scriptOffsets;
 	/// Assumes that the scripts are sorted by offset in the file
@@ -38,7 +38,12 @@ CR_REG_METADATA(CCobThread, (
 
 	CR_MEMBER(luaArgs),
 	CR_MEMBER(callStack),
-	CR_MEMBER(dataStack)
+	CR_MEMBER(dataStack),
+
+	// always empty when saving
+	CR_IGNORED(deferredOps),
+	CR_IGNORED(deferredCallins),
+	CR_IGNORED(localResult)
 ))
 
 CR_BIND(CCobThread::CallInfo,)
@@ -108,6 +113,10 @@ CCobThread& CCobThread::operator = (CCobThread&& t) {
 	dataStack = std::move(t.dataStack);
 	// execTrace = std::move(t.execTrace);
 
+	deferredOps = std::move(t.deferredOps);
+	deferredCallins = std::move(t.deferredCallins);
+	localResult = t.localResult;
+
 	state = t.state;
 	cbType = t.cbType;
 
@@ -135,6 +144,10 @@ CCobThread& CCobThread::operator = (const CCobThread& t) {
 	dataStack = t.dataStack;
 	// execTrace = t.execTrace;
 
+	deferredOps = t.deferredOps;
+	deferredCallins = t.deferredCallins;
+	localResult = t.localResult;
+
 	state = t.state;
 	cbType = t.cbType;
 
@@ -246,6 +259,14 @@ bool CCobThread::Tick()
 
 	state = Run;
 
+	if (cobFile->decodedCode.empty())
+		return TickRaw();
+
+	return (RunDecoded<false>());
+}
+
+bool CCobThread::TickRaw()
+{
 	int r1, r2, r3, r4, r5, r6;
 
 	while (state == Run) {
@@ -318,7 +339,9 @@ bool CCobThread::Tick()
 			} break;
 
 			case BATCH_LUA: {
-				DeferredCall(false);
+				r1 = GET_LONG_PC();
+				r2 = GET_LONG_PC();
+				DeferredCall(r1, r2, false);
 			} break;
 
 			case CALL: {
@@ -327,7 +350,9 @@ bool CCobThread::Tick()
 
 				if (cobFile->scriptNames[r1].find("lua_") == 0) {
 					cobFile->code[pc - 1] = LUA_CALL;
-					LuaCall();
+					r1 = GET_LONG_PC();
+					r2 = GET_LONG_PC();
+					LuaCall(r1, r2);
 					break;
 				}
 
@@ -354,7 +379,9 @@ bool CCobThread::Tick()
 				pc = cobFile->scriptOffsets[r1];
 			} break;
 			case LUA_CALL: {
-				LuaCall();
+				r1 = GET_LONG_PC();
+				r2 = GET_LONG_PC();
+				LuaCall(r1, r2);
 			} break;
 
 
@@ -753,6 +780,704 @@ bool CCobThread::Tick()
 	return (state != Dead);
 }
 
+template<bool local>
+bool CCobThread::RunDecoded()
+{
+	const std::vector<CCobFile::Instr>& instrs = cobFile->decodedCode;
+
+	// every instruction ends inside the code or on the sentinel, so
+	// only entry points (e.g. from savegames) need to be checked
+	if (pc < 0 || static_cast<size_t>(pc) >= instrs.size()) {
+		if constexpr (local)
+			return (StopLocal(pc));
+
+		LOG_L(L_ERROR, "[COBThread::%s] invalid program counter %x (in %s)", __func__, pc, cobFile->name.c_str());
+
+		state = Dead;
+		return false;
+	}
+
+	int r1, r2, r3, r4, r5, r6;
+
+	while (state == Run) {
+		const int instrPC = pc;
+		const CCobFile::Instr& instr = instrs[pc];
+
+		pc += instr.size;
+
+		switch (instr.op) {
+			case CCobFile::OP_PUSH_CONSTANT: {
+				PushDataStack(instr.a);
+			} break;
+			case CCobFile::OP_SLEEP: {
+				if constexpr (local) {
+					if (PeekDataStack(0) < 0)
+						return (StopLocal(instrPC));
+				}
+
+				r1 = PopDataStack();
+				wakeTime = cobEngine->GetCurrTime() + r1;
+				state = Sleep;
+
+				if constexpr (local)
+					return (localResult = LocalSleep, true);
+
+				cobEngine->ScheduleThread(this);
+				return true;
+			} break;
+			case CCobFile::OP_SLEEP_CONST: {
+				if constexpr (local) {
+					if (instr.a < 0)
+						return (StopLocal(instrPC));
+				}
+
+				wakeTime = cobEngine->GetCurrTime() + instr.a;
+				state = Sleep;
+
+				if constexpr (local)
+					return (localResult = LocalSleep, true);
+
+				cobEngine->ScheduleThread(this);
+				return true;
+			} break;
+			case CCobFile::OP_SPIN: {
+				r3 = PopDataStack();         // speed
+				r4 = PopDataStack();         // accel
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_SPIN, {instr.a, instr.b, r3, r4}});
+				} else {
+					cobInst->Spin(instr.a, instr.b, r3, r4);
+				}
+			} break;
+			case CCobFile::OP_STOP_SPIN: {
+				r3 = PopDataStack();         // decel
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_STOP_SPIN, {instr.a, instr.b, r3, 0}});
+				} else {
+					cobInst->StopSpin(instr.a, instr.b, r3);
+				}
+			} break;
+			case CCobFile::OP_RETURN: {
+				if (LocalReturnAddr() == -1) {
+					// thread ends, its callback has to run in order
+					if constexpr (local)
+						return (StopLocal(instrPC));
+
+					retCode = PopDataStack();
+					state = Dead;
+					return false;
+				}
+
+				retCode = PopDataStack();
+
+				// return to caller
+				pc = LocalReturnAddr();
+				if (dataStack.size() > LocalStackFrame())
+					dataStack.resize(LocalStackFrame());
+
+				callStack.pop_back();
+			} break;
+
+			case CCobFile::OP_NOP: {
+			} break;
+
+			case CCobFile::OP_SIGNATURE_LUA: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				LOG_L(L_ERROR, "BAD ACCESS: Entered a lua method reference.");
+				state = Dead;
+				return false;
+			} break;
+
+			case CCobFile::OP_BATCH_LUA: {
+				DeferredCall(instr.a, instr.b, local);
+			} break;
+			case CCobFile::OP_REAL_CALL: {
+				CallInfo& ci = PushCallStackRef();
+				ci.functionId = instr.a;
+				ci.returnAddr = pc;
+				ci.stackTop = dataStack.size() - instr.b;
+
+				paramCount = instr.b;
+
+				// call cobFile->scriptNames[instr.a]
+				pc = cobFile->scriptOffsets[instr.a];
+			} break;
+			case CCobFile::OP_LUA_CALL: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				LuaCall(instr.a, instr.b);
+			} break;
+
+
+			case CCobFile::OP_POP_STATIC: {
+				r2 = PopDataStack();
+
+				if (static_cast<size_t>(instr.a) < cobInst->staticVars.size())
+					cobInst->staticVars[instr.a] = r2;
+			} break;
+			case CCobFile::OP_POP_STACK: {
+				PopDataStack();
+			} break;
+
+
+			case CCobFile::OP_START: {
+				// thread IDs are handed out in order
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				CCobThread t(cobInst);
+
+				t.SetID(cobEngine->GenThreadID());
+				t.InitStack(instr.b, this);
+				t.Start(instr.a, signalMask, {{0}}, true);
+
+				// calling AddThread directly might move <this>, defer it
+				cobEngine->QueueAddThread(std::move(t));
+			} break;
+
+			case CCobFile::OP_CREATE_LOCAL_VAR: {
+				if (paramCount == 0) {
+					PushDataStack(0);
+				} else {
+					paramCount--;
+				}
+			} break;
+			case CCobFile::OP_GET_UNIT_VALUE: {
+				if constexpr (local) {
+					if ((PeekDataStack(0) < LUA0) || (PeekDataStack(0) > LUA9))
+						return (StopLocal(instrPC));
+				}
+
+				r1 = PopDataStack();
+				if ((r1 >= LUA0) && (r1 <= LUA9)) {
+					PushDataStack(luaArgs[r1 - LUA0]);
+					break;
+				}
+				r1 = cobInst->GetUnitVal(r1, 0, 0, 0, 0);
+				PushDataStack(r1);
+			} break;
+
+
+			case CCobFile::OP_JUMP_NOT_EQUAL: {
+				r2 = PopDataStack();
+
+				if (r2 == 0)
+					pc = instr.a;
+			} break;
+			case CCobFile::OP_JUMP: {
+				pc = instr.a;
+			} break;
+
+
+			case CCobFile::OP_POP_LOCAL_VAR: {
+				r2 = PopDataStack();
+				dataStack[LocalStackFrame() + instr.a] = r2;
+			} break;
+			case CCobFile::OP_PUSH_LOCAL_VAR: {
+				r2 = dataStack[LocalStackFrame() + instr.a];
+				PushDataStack(r2);
+			} break;
+
+
+			case CCobFile::OP_BITWISE_AND: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+				PushDataStack(r1 & r2);
+			} break;
+			case CCobFile::OP_BITWISE_OR: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+				PushDataStack(r1 | r2);
+			} break;
+			case CCobFile::OP_BITWISE_XOR: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+				PushDataStack(r1 ^ r2);
+			} break;
+			case CCobFile::OP_BITWISE_NOT: {
+				r1 = PopDataStack();
+				PushDataStack(~r1);
+			} break;
+
+			case CCobFile::OP_EXPLODE: {
+				r2 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_EXPLODE, {instr.a, r2, 0, 0}});
+				} else {
+					cobInst->Explode(instr.a, r2);
+				}
+			} break;
+
+			case CCobFile::OP_PLAY_SOUND: {
+				r2 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_PLAY_SOUND, {instr.a, r2, 0, 0}});
+				} else {
+					cobInst->PlayUnitSound(instr.a, r2);
+				}
+			} break;
+
+			case CCobFile::OP_PUSH_STATIC: {
+				if (static_cast<size_t>(instr.a) < cobInst->staticVars.size())
+					PushDataStack(cobInst->staticVars[instr.a]);
+			} break;
+
+			case CCobFile::OP_SET_NOT_EQUAL: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+
+				PushDataStack(int(r1 != r2));
+			} break;
+			case CCobFile::OP_SET_EQUAL: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+
+				PushDataStack(int(r1 == r2));
+			} break;
+
+			case CCobFile::OP_SET_LESS: {
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+
+				PushDataStack(int(r1 < r2));
+			} break;
+			case CCobFile::OP_SET_LESS_OR_EQUAL: {
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+
+				PushDataStack(int(r1 <= r2));
+			} break;
+
+			case CCobFile::OP_SET_GREATER: {
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+
+				PushDataStack(int(r1 > r2));
+			} break;
+			case CCobFile::OP_SET_GREATER_OR_EQUAL: {
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+
+				PushDataStack(int(r1 >= r2));
+			} break;
+
+			case CCobFile::OP_RAND: {
+				// gsRNG has to be drawn from in order
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+				r3 = gsRNG.NextInt(r2 - r1 + 1) + r1;
+				PushDataStack(r3);
+			} break;
+			case CCobFile::OP_EMIT_SFX: {
+				r1 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_EMIT_SFX, {r1, instr.a, 0, 0}});
+				} else {
+					cobInst->EmitSfx(r1, instr.a);
+				}
+			} break;
+			case CCobFile::OP_MUL: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+				PushDataStack(r1 * r2);
+			} break;
+
+
+			case CCobFile::OP_SIGNAL: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				r1 = PopDataStack();
+				cobInst->Signal(r1);
+			} break;
+			case CCobFile::OP_SET_SIGNAL_MASK: {
+				r1 = PopDataStack();
+				signalMask = r1;
+			} break;
+
+
+			case CCobFile::OP_TURN: {
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_TURN, {instr.a, instr.b, r1, r2}});
+				} else {
+					cobInst->Turn(instr.a, instr.b, r1, r2);
+				}
+			} break;
+			case CCobFile::OP_TURN_CONST: {
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_TURN, {instr.a, instr.b, instr.c, instr.d}});
+				} else {
+					cobInst->Turn(instr.a, instr.b, instr.c, instr.d);
+				}
+			} break;
+			case CCobFile::OP_GET: {
+				if constexpr (local) {
+					if ((PeekDataStack(4) < LUA0) || (PeekDataStack(4) > LUA9))
+						return (StopLocal(instrPC));
+				}
+
+				r5 = PopDataStack();
+				r4 = PopDataStack();
+				r3 = PopDataStack();
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+				if ((r1 >= LUA0) && (r1 <= LUA9)) {
+					PushDataStack(luaArgs[r1 - LUA0]);
+					break;
+				}
+				r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
+				PushDataStack(r6);
+			} break;
+			case CCobFile::OP_ADD: {
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+				PushDataStack(r1 + r2);
+			} break;
+			case CCobFile::OP_SUB: {
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+				PushDataStack(r1 - r2);
+			} break;
+
+			case CCobFile::OP_DIV: {
+				if constexpr (local) {
+					if (PeekDataStack(0) == 0)
+						return (StopLocal(instrPC));
+				}
+
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+
+				if (r2 != 0) {
+					r3 = r1 / r2;
+				} else {
+					r3 = 1000; // infinity!
+					ShowError("division by zero");
+				}
+				PushDataStack(r3);
+			} break;
+			case CCobFile::OP_MOD: {
+				if constexpr (local) {
+					if (PeekDataStack(0) == 0)
+						return (StopLocal(instrPC));
+				}
+
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+
+				if (r2 != 0) {
+					PushDataStack(r1 % r2);
+				} else {
+					PushDataStack(0);
+					ShowError("modulo division by zero");
+				}
+			} break;
+
+
+			case CCobFile::OP_MOVE: {
+				r4 = PopDataStack();
+				r3 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_MOVE, {instr.a, instr.b, r3, r4}});
+				} else {
+					cobInst->Move(instr.a, instr.b, r3, r4);
+				}
+			} break;
+			case CCobFile::OP_MOVE_CONST: {
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_MOVE, {instr.a, instr.b, instr.c, instr.d}});
+				} else {
+					cobInst->Move(instr.a, instr.b, instr.c, instr.d);
+				}
+			} break;
+			case CCobFile::OP_MOVE_NOW: {
+				r3 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_MOVE_NOW, {instr.a, instr.b, r3, 0}});
+				} else {
+					cobInst->MoveNow(instr.a, instr.b, r3);
+				}
+			} break;
+			case CCobFile::OP_MOVE_NOW_CONST: {
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_MOVE_NOW, {instr.a, instr.b, instr.c, 0}});
+				} else {
+					cobInst->MoveNow(instr.a, instr.b, instr.c);
+				}
+			} break;
+			case CCobFile::OP_TURN_NOW: {
+				r3 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_TURN_NOW, {instr.a, instr.b, r3, 0}});
+				} else {
+					cobInst->TurnNow(instr.a, instr.b, r3);
+				}
+			} break;
+			case CCobFile::OP_TURN_NOW_CONST: {
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_TURN_NOW, {instr.a, instr.b, instr.c, 0}});
+				} else {
+					cobInst->TurnNow(instr.a, instr.b, instr.c);
+				}
+			} break;
+			case CCobFile::OP_SCALE: {
+				r3 = PopDataStack();
+				r2 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_SCALE, {instr.a, r2, r3, 0}});
+				} else {
+					cobInst->Scale(instr.a, r2, r3);
+				}
+			} break;
+			case CCobFile::OP_SCALE_NOW: {
+				r2 = PopDataStack();
+
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_SCALE_NOW, {instr.a, r2, 0, 0}});
+				} else {
+					cobInst->ScaleNow(instr.a, r2);
+				}
+			} break;
+
+			// the animation state these depend on is only up to date after deferred ops ran
+			case CCobFile::OP_WAIT_TURN: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				if (cobInst->NeedsWait(CCobInstance::ATurn, instr.a, instr.b)) {
+					state = WaitTurn;
+					waitPiece = instr.a;
+					waitAxis = instr.b;
+					return true;
+				}
+			} break;
+			case CCobFile::OP_WAIT_MOVE: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				if (cobInst->NeedsWait(CCobInstance::AMove, instr.a, instr.b)) {
+					state = WaitMove;
+					waitPiece = instr.a;
+					waitAxis = instr.b;
+					return true;
+				}
+			} break;
+			case CCobFile::OP_WAIT_SCALE: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				if (cobInst->NeedsWait(CCobInstance::AScale, instr.a, -1)) {
+					state = WaitScale;
+					waitPiece = instr.a;
+					waitAxis = -1;
+					return true;
+				}
+			} break;
+
+			case CCobFile::OP_SET: {
+				if constexpr (local) {
+					if ((PeekDataStack(1) < LUA0) || (PeekDataStack(1) > LUA9))
+						return (StopLocal(instrPC));
+				}
+
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+
+				if ((r1 >= LUA0) && (r1 <= LUA9)) {
+					luaArgs[r1 - LUA0] = r2;
+					break;
+				}
+
+				cobInst->SetUnitVal(r1, r2);
+			} break;
+
+
+			case CCobFile::OP_ATTACH: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				r3 = PopDataStack();
+				r2 = PopDataStack();
+				r1 = PopDataStack();
+				cobInst->AttachUnit(r2, r1);
+			} break;
+			case CCobFile::OP_DROP: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				r1 = PopDataStack();
+				cobInst->DropUnit(r1);
+			} break;
+
+			// like bitwise ops, but only on values 1 and 0
+			case CCobFile::OP_LOGICAL_NOT: {
+				r1 = PopDataStack();
+				PushDataStack(int(r1 == 0));
+			} break;
+			case CCobFile::OP_LOGICAL_AND: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+				PushDataStack(int(r1 && r2));
+			} break;
+			case CCobFile::OP_LOGICAL_OR: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+				PushDataStack(int(r1 || r2));
+			} break;
+			case CCobFile::OP_LOGICAL_XOR: {
+				r1 = PopDataStack();
+				r2 = PopDataStack();
+				PushDataStack(int((!!r1) ^ (!!r2)));
+			} break;
+
+
+			case CCobFile::OP_HIDE: {
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_HIDE, {instr.a, 0, 0, 0}});
+				} else {
+					cobInst->SetVisibility(instr.a, false);
+				}
+			} break;
+
+			case CCobFile::OP_SHOW: {
+				int i;
+				for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
+					if (LocalFunctionID() == cobFile->scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i])
+						break;
+
+				// if true, we are in a Fire-script and should show a special flare effect
+				if constexpr (local) {
+					deferredOps.push_back({CCobFile::OP_SHOW, {instr.a, int(i < MAX_WEAPONS_PER_UNIT), 0, 0}});
+				} else if (i < MAX_WEAPONS_PER_UNIT) {
+					cobInst->ShowFlare(instr.a);
+				} else {
+					cobInst->SetVisibility(instr.a, true);
+				}
+			} break;
+
+			case CCobFile::OP_INVALID:
+			default: {
+				if constexpr (local)
+					return (StopLocal(instrPC));
+
+				const char* name = cobFile->name.c_str();
+				const char* func = cobFile->scriptNames[LocalFunctionID()].c_str();
+
+				LOG_L(L_ERROR, "[COBThread::%s] unknown opcode %x (in %s:%s at %x)", __func__, instr.a, name, func, pc - 1);
+
+				state = Dead;
+				return false;
+			} break;
+		}
+	}
+
+	// can arrive here as dead, through CCobInstance::Signal()
+	return (state != Dead);
+}
+
+
+bool CCobThread::TickLocal()
+{
+	assert(localResult == LocalNone);
+
+	if (IsDead() || cobFile->decodedCode.empty())
+		return false;
+
+	state = Run;
+
+	return (RunDecoded<true>());
+}
+
+bool CCobThread::StopLocal(int instrPC)
+{
+	// resumed by FinishTick once everything queued before it has run
+	pc = instrPC;
+	localResult = LocalStopped;
+	return false;
+}
+
+bool CCobThread::FinishTick()
+{
+	const LocalResult result = localResult;
+
+	localResult = LocalNone;
+
+	if (result == LocalNone)
+		return (Tick());
+
+	// killed from outside its own script instance since TickLocal ran
+	if (IsDead()) {
+		deferredOps.clear();
+		deferredCallins.clear();
+		return false;
+	}
+
+	for (const DeferredOp& op: deferredOps) {
+		const int* args = op.args;
+
+		switch (op.op) {
+			case CCobFile::OP_MOVE      : { cobInst->Move(args[0], args[1], args[2], args[3]); } break;
+			case CCobFile::OP_TURN      : { cobInst->Turn(args[0], args[1], args[2], args[3]); } break;
+			case CCobFile::OP_SPIN      : { cobInst->Spin(args[0], args[1], args[2], args[3]); } break;
+			case CCobFile::OP_STOP_SPIN : { cobInst->StopSpin(args[0], args[1], args[2]); } break;
+			case CCobFile::OP_MOVE_NOW  : { cobInst->MoveNow(args[0], args[1], args[2]); } break;
+			case CCobFile::OP_TURN_NOW  : { cobInst->TurnNow(args[0], args[1], args[2]); } break;
+			case CCobFile::OP_SCALE     : { cobInst->Scale(args[0], args[1], args[2]); } break;
+			case CCobFile::OP_SCALE_NOW : { cobInst->ScaleNow(args[0], args[1]); } break;
+			case CCobFile::OP_EXPLODE   : { cobInst->Explode(args[0], args[1]); } break;
+			case CCobFile::OP_PLAY_SOUND: { cobInst->PlayUnitSound(args[0], args[1]); } break;
+			case CCobFile::OP_EMIT_SFX  : { cobInst->EmitSfx(args[0], args[1]); } break;
+			case CCobFile::OP_HIDE      : { cobInst->SetVisibility(args[0], false); } break;
+			case CCobFile::OP_SHOW      : {
+				if (args[1] != 0) {
+					cobInst->ShowFlare(args[0]);
+				} else {
+					cobInst->SetVisibility(args[0], true);
+				}
+			} break;
+			default: {
+				assert(false);
+			} break;
+		}
+	}
+
+	for (CCobDeferredCallin& callin: deferredCallins) {
+		cobEngine->AddDeferredCallin(std::move(callin));
+	}
+
+	deferredOps.clear();
+	deferredCallins.clear();
+
+	// the deferred ops themselves can kill us, e.g. through call-ins
+	if (IsDead())
+		return false;
+
+	if (result == LocalSleep) {
+		cobEngine->ScheduleThread(this);
+		return true;
+	}
+
+	return (RunDecoded<false>());
+}
+
 void CCobThread::ShowError(const char* msg)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -771,10 +1496,10 @@ void CCobThread::ShowError(const char* msg)
 }
 
 
-void CCobThread::DeferredCall(bool synced)
+void CCobThread::DeferredCall(int scriptId, int numArgs, bool local)
 {
-	const int r1 = GET_LONG_PC(); // script id
-	const int r2 = GET_LONG_PC(); // arg count
+	const int r1 = scriptId;
+	const int r2 = numArgs;
 
 	// Make sure to clean args from stack on exit
 	CCobStackGuard guard{&dataStack, r2};
@@ -794,18 +1519,23 @@ void CCobThread::DeferredCall(bool synced)
 	// setup the parameter array
 	auto d = CCobDeferredCallin(cobInst->GetUnit(), cobFile->luaScripts[r1], dataStack, r2);
 
-	cobEngine->AddDeferredCallin(std::move(d));
+	if (local) {
+		// handed to the engine by FinishTick, keeps the batches in thread order
+		deferredCallins.emplace_back(std::move(d));
+	} else {
+		cobEngine->AddDeferredCallin(std::move(d));
+	}
 
 	// always succeeds
 	retCode = 1;
 }
 
 
-void CCobThread::LuaCall()
+void CCobThread::LuaCall(int scriptId, int numArgs)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	const int r1 = GET_LONG_PC(); // script id
-	const int r2 = GET_LONG_PC(); // arg count
+	const int r1 = scriptId;
+	const int r2 = numArgs;
 
 	// Make sure to clean args from stack on exit
 	CCobStackGuard guard{&dataStack, r2};
@@ -6,6 +6,8 @@
 #include <string>
 #include <array>
 
+#include "CobDeferredCallin.h"
+#include "CobFile.h"
 #include "CobInstance.h"
 #include "Lua/LuaRules.h"
 
@@ -59,6 +61,21 @@ public:
 	 * Returns false if this thread is dead and needs to be killed.
 	 */
 	bool Tick();
+	/**
+	 * First half of a tick that can run concurrently with the threads of
+	 * other script instances (see CCobEngine::TickThreadsMT): only runs up
+	 * to the first instruction whose effects reach beyond this thread or
+	 * its instance's static variables, and records animation and effect
+	 * calls instead of making them. Returns true if the thread went to
+	 * sleep without reaching such an instruction.
+	 */
+	bool TickLocal();
+	/**
+	 * Second half, called serially in scheduling order: makes the calls
+	 * recorded by TickLocal and runs the rest of the tick (or all of it if
+	 * TickLocal was not called). Returns false like Tick.
+	 */
+	bool FinishTick();
 	/**
 	 * This function sets the thread in motion. Should only be called once.
 	 * If schedule is false the thread is not added to the scheduler, and thus
@@ -127,8 +144,21 @@ protected:
 		int stackTop = -1;
 	};
 
-	void LuaCall();
-	void DeferredCall(bool synced);
+	enum LocalResult {LocalNone, LocalSleep, LocalStopped};
+
+	struct DeferredOp {
+		CCobFile::Op op;
+		int args[4];
+	};
+
+	/// interprets the raw opcodes in CCobFile::code
+	bool TickRaw();
+	/// runs the pre-decoded instructions in CCobFile::decodedCode
+	template<bool local> bool RunDecoded();
+	bool StopLocal(int instrPC);
+
+	void LuaCall(int scriptId, int numArgs);
+	void DeferredCall(int scriptId, int numArgs, bool local);
 
 	void PushCallStack(CallInfo v) { callStack.push_back(v); }
 	void PushDataStack(int v) { dataStack.push_back(v); }
@@ -138,6 +168,14 @@ protected:
 	int LocalReturnAddr() const { return callStack.back().returnAddr; }
 	int LocalStackFrame() const { return callStack.back().stackTop; }
 
+	/// like PopDataStack, without popping the value <n> places below the top
+	int PeekDataStack(unsigned int n) const {
+		if (n >= dataStack.size()) {
+			return 0;
+		}
+		return dataStack[dataStack.size() - 1 - n];
+	}
+
 	int PopDataStack() {
 		if (dataStack.empty()) {
 			return 0;
@@ -169,6 +207,12 @@ protected:
 	std::vector<int> dataStack;
 	// std::vector<int> execTrace;
 
+	// only non-empty between TickLocal and FinishTick
+	std::vector<DeferredOp> deferredOps;
+	std::vector<CCobDeferredCallin> deferredCallins;
+
+	LocalResult localResult = LocalNone;
+
 	State state = Init;
 
 	CCobInstance::ThreadCallbackType cbType = CCobInstance::CBNone;
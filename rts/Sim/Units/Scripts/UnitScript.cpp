@@ -217,47 +217,8 @@ void CUnitScript::TickAllAnims(int deltaTime)
 	}
 	spring::VectorEraseIfAll(anims, [](const auto& ai) { return ai.done; });
 
-#if 1
-	// BFS pass
-	std::deque<std::pair<LocalModelPiece*, Transform>> q;
-	q.push_front({ rootPiece, Transform{} });
-
-	while (!q.empty()) {
-		// copy
-		auto [lmp, pTra] = q.front();
-		q.pop_front();
-
-		if (lmp->GetDirty()) {
-			lmp->SetDirtyRaw(false);
-			lmp->SetWasUpdatedRaw(true);
-			lmp->UpdatePieceSpaceTransform();
-			lmp->UpdateModelSpaceTransform(pTra);
-		}
-
-		const Transform& modelTra = lmp->GetModelSpaceTransformRaw();
+	unit->localModel.UpdatePieceTransforms();
 
-		for (auto* child : lmp->children) {
-			q.push_back({ child, modelTra });
-		}
-	}
-#else
-	// DFS pass
-	auto WalkDFS = [](this auto&& self, LocalModelPiece* lmp, const Transform& pTra) -> void {
-		if (lmp->GetDirty()) {
-			lmp->SetDirtyRaw(false);
-			lmp->SetWasUpdatedRaw(true);
-			lmp->UpdatePieceSpaceTransform();
-			lmp->UpdateModelSpaceTransform(pTra);
-		}
-
-		const Transform& modelTra = lmp->GetModelSpaceTransformRaw();
-
-		for (auto* p : lmp->children)
-			self(p, modelTra);
-	};
-
-	WalkDFS(rootPiece, Transform{});
-#endif
 #ifdef _DEBUG
 	for (auto* p : pieces) {
 		// NOTE: p can actually be nullptr when the cob script mentions pieces that don't exist in the model!
@@ -127,7 +127,11 @@ void CUnitScriptEngine::Tick(int deltaTime)
 {
 	SCOPED_TIMER("CUnitScriptEngine::Tick");
 
-	cobEngine->Tick(deltaTime);
+	{
+		// separate from Sim::Script so benchmark runs can compare COB interpreters (see CobPreDecode)
+		SCOPED_TIMER("Sim::Script::Cob");
+		cobEngine->Tick(deltaTime);
+	}
 
 	// tick all (COB or LUS) script instances that have registered themselves as animating
 	{
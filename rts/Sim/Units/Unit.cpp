@@ -908,7 +908,7 @@ void CUnit::SetLosStatus(int at, unsigned short newStatus)
 }
 
 
-unsigned short CUnit::CalcLosStatus(int at)
+unsigned short CUnit::CalcLosStatus(int at) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const unsigned short currStatus = losStatus[at];
@@ -11,6 +11,7 @@
 #include "UnitTypes/Factory.h"
 
 #include "CommandAI/BuilderCAI.h"
+#include "Game/GameHelper.h"
 #include "Sim/Ecs/Registry.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/ModInfo.h"
@@ -45,6 +46,9 @@ CR_REG_METADATA(CUnitHandler, (
 	CR_MEMBER(unitsByDefs),
 	CR_MEMBER(activeUnits),
 	CR_MEMBER(unitsToBeRemoved),
+	CR_IGNORED(losStatusChanges),
+	CR_IGNORED(autoTargetWeapons),
+	CR_IGNORED(autoTargetCandidates),
 
 	CR_MEMBER(builderCAIs),
 
@@ -54,7 +58,8 @@ CR_REG_METADATA(CUnitHandler, (
 	CR_MEMBER(maxUnits),
 	CR_MEMBER(maxUnitRadius),
 
-	CR_MEMBER(inUpdateCall)
+	CR_MEMBER(inUpdateCall),
+	CR_IGNORED(deferWeaponAutoTargets)
 ))
 
 
@@ -337,6 +342,11 @@ void CUnitHandler::UpdateUnitMoveTypes()
 void CUnitHandler::UpdateUnitLosStates()
 {
 	ZoneScopedC(tracy::Color::Goldenrod);
+	if (modInfo.mtLosStatusUpdate) {
+		UpdateUnitLosStatesMT();
+		return;
+	}
+
 	for (CUnit* unit: activeUnits) {
 		for (int at = 0; at < teamHandler.ActiveAllyTeams(); ++at) {
 			unit->UpdateLosStatus(at);
@@ -344,6 +354,47 @@ void CUnitHandler::UpdateUnitLosStates()
 	}
 }
 
+void CUnitHandler::UpdateUnitLosStatesMT()
+{
+	ZoneScopedC(tracy::Color::Goldenrod);
+
+	// callins may create units, only visit those which existed on entry
+	const size_t numUnits = activeUnits.size();
+	const size_t numAllyTeams = teamHandler.ActiveAllyTeams();
+
+	losStatusChanges.clear();
+	losStatusChanges.resize(numUnits * numAllyTeams, 0);
+
+	// first pass: find the (unit, allyteam) pairs whose status changes; CalcLosStatus
+	// only reads the LOS maps and the unit's own state so this can run on all threads
+	for_mt_chunk(0, numUnits, [this, numAllyTeams](const int i) {
+		const CUnit* unit = activeUnits[i];
+
+		for (size_t at = 0; at < numAllyTeams; ++at) {
+			const unsigned short currStatus = unit->losStatus[at];
+
+			if ((currStatus & LOS_ALL_MASK_BITS) == LOS_ALL_MASK_BITS)
+				continue;
+
+			losStatusChanges[i * numAllyTeams + at] = (unit->CalcLosStatus(at) != currStatus);
+		}
+	}, 64);
+
+	// second pass: apply changes and run the LOS callins in the same (unit, allyteam)
+	// order as the serial path; the status is recalculated since earlier callins may
+	// have altered it (e.g. through Spring.SetUnitLosState)
+	for (size_t i = 0; i < numUnits; ++i) {
+		CUnit* unit = activeUnits[i];
+
+		for (size_t at = 0; at < numAllyTeams; ++at) {
+			if (losStatusChanges[i * numAllyTeams + at] == 0)
+				continue;
+
+			unit->UpdateLosStatus(at);
+		}
+	}
+}
+
 
 void CUnitHandler::SlowUpdateUnits()
 {
@@ -368,6 +419,8 @@ void CUnitHandler::SlowUpdateUnits()
 	updateBoundingVolumeList.clear();
 	{
 		ZoneScopedN("Sim::Unit::SlowUpdateST");
+		deferWeaponAutoTargets = modInfo.mtWeaponTargeting;
+
 		for (size_t i = idxBeg; i < idxEnd; ++i) {
 			CUnit* unit = activeUnits[i];
 
@@ -379,7 +432,12 @@ void CUnitHandler::SlowUpdateUnits()
 			if (!unit->isDead && unit->localModel.GetBoundariesNeedsRecalc())
 				updateBoundingVolumeList.emplace_back(unit);
 		}
+
+		deferWeaponAutoTargets = false;
 	}
+
+	UpdateWeaponAutoTargets();
+
 	// Since the bounding volumes are calculated from the maximum piecematrix-offset piece vertices
 	// They dont have much of an effect if updated late-ish.
 	{
@@ -427,6 +485,64 @@ void CUnitHandler::UpdateUnitWeapons()
 	}
 }
 
+void CUnitHandler::QueueWeaponAutoTarget(CWeapon* weapon)
+{
+	weapon->autoTargetQueued = true;
+	autoTargetWeapons.push_back(weapon);
+}
+
+void CUnitHandler::UpdateWeaponAutoTargets()
+{
+	if (autoTargetWeapons.empty())
+		return;
+
+	if (autoTargetCandidates.size() < autoTargetWeapons.size())
+		autoTargetCandidates.resize(autoTargetWeapons.size());
+
+	{
+		// score the candidate targets of every queued weapon; this only reads sim state
+		ZoneScopedN("Sim::Unit::WeaponAutoTargetMT");
+		for_mt(0, autoTargetWeapons.size(), [this](const int i) {
+			const CWeapon* weapon = autoTargetWeapons[i];
+
+			if (weapon->slavedTo != nullptr) {
+				autoTargetCandidates[i].clear();
+				return;
+			}
+
+			CGameHelper::GenerateWeaponTargetCandidates(weapon, weapon->GetAutoTargetAvoidUnit(), autoTargetCandidates[i]);
+		});
+	}
+	{
+		// run the call-ins and pick targets in queueing (i.e. unit) order so every client
+		// ends up with the same result regardless of how the scoring was scheduled
+		ZoneScopedN("Sim::Unit::WeaponAutoTargetST");
+		for (size_t i = 0, n = autoTargetWeapons.size(); i < n; ++i) {
+			CWeapon* weapon = autoTargetWeapons[i];
+
+			auto& candidates = autoTargetCandidates[i];
+
+			weapon->autoTargetQueued = false;
+
+			if (weapon->owner->isDead)
+				continue;
+			// queued behind the weapon it is slaved to, whose target is final by now
+			if (weapon->slavedTo != nullptr) {
+				weapon->SetAttackTarget(weapon->slavedTo->GetCurrentTarget());
+				continue;
+			}
+			// Lua might have given the weapon an explicit target since it was queued
+			if (weapon->HaveTarget() && weapon->GetCurrentTarget().isUserTarget)
+				continue;
+
+			CGameHelper::FilterWeaponTargetCandidates(weapon, candidates);
+			weapon->SelectAutoTarget(candidates);
+		}
+	}
+
+	autoTargetWeapons.clear();
+}
+
 void CUnitHandler::UpdatePreFrame()
 {
 	SCOPED_TIMER("Sim::Unit::UpdatePreFrame");
@@ -13,6 +13,7 @@
 struct UnitDef;
 class CUnit;
 class CBuilderCAI;
+class CWeapon;
 
 class CUnitHandler
 {
@@ -76,6 +77,11 @@ public:
 
 	const spring::unordered_map<unsigned int, CBuilderCAI*>& GetBuilderCAIs() const { return builderCAIs; }
 
+	/// true while SlowUpdateUnits batches weapon target acquisition, see UpdateWeaponAutoTargets
+	bool DeferWeaponAutoTargets() const { return deferWeaponAutoTargets; }
+	/// slaved weapons are queued to clone their master's target after it has been picked
+	void QueueWeaponAutoTarget(CWeapon* weapon);
+
 private:
 	void InsertActiveUnit(CUnit* unit);
 	bool QueueDeleteUnit(CUnit* unit);
@@ -86,8 +92,10 @@ private:
 	void UpdateUnitPathing(const size_t idxBeg, const size_t idxEnd);
 	void UpdateUnitMoveTypes();
 	void UpdateUnitLosStates();
+	void UpdateUnitLosStatesMT();
 	void UpdateUnits();
 	void UpdateUnitWeapons();
+	void UpdateWeaponAutoTargets();
 
 	void GetUnitsWithPathRequests(std::vector<CUnit*>& unitsToMove, const size_t idxBeg, const size_t idxEnd);
 	void MultiThreadPathRequests(std::vector<CUnit*>& unitsToMove);
@@ -102,6 +110,15 @@ private:
 	std::vector<CUnit*> activeUnits;                                     ///< used to get all active units
 	std::vector<CUnit*> unitsToBeRemoved;                                ///< units that will be removed at start of next update
 
+	///< scratch for UpdateUnitLosStatesMT, one entry per (active unit, allyteam)
+	///< pair; non-zero if the pair's LOS status changed this frame
+	std::vector<uint8_t> losStatusChanges;
+
+	///< weapons queued by CWeapon::AutoTarget (and slaves of those) during the current
+	///< SlowUpdate batch and the target candidates generated for each of them (same index)
+	std::vector<CWeapon*> autoTargetWeapons;
+	std::vector<std::vector<std::pair<float, CUnit*>>> autoTargetCandidates;
+
 	spring::unordered_map<unsigned int, CBuilderCAI*> builderCAIs;
 
 
@@ -118,6 +135,7 @@ private:
 	float maxUnitRadius = 0.0f;
 
 	bool inUpdateCall = false;
+	bool deferWeaponAutoTargets = false;
 };
 
 extern CUnitHandler unitHandler;
@@ -19,6 +19,7 @@
 CR_BIND_DERIVED(CPlasmaRepulser, CWeapon, )
 CR_REG_METADATA(CPlasmaRepulser, (
 	CR_MEMBER(tempNum),
+	CR_MEMBER(mtTempNum),
 	CR_MEMBER(scIndex),
 
 	CR_MEMBER(hitFrameCount),
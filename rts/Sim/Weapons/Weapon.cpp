@@ -24,6 +24,7 @@
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
 #include "Sim/Weapons/Cannon.h"
 #include "Sim/Weapons/NoWeapon.h"
 #include "System/EventHandler.h"
@@ -73,6 +74,7 @@ CR_REG_METADATA(CWeapon, (
 	CR_MEMBER(doTargetGroundPos),
 	CR_MEMBER(noAutoTarget),
 	CR_MEMBER(alreadyWarnedAboutMissingPieces),
+	CR_IGNORED(autoTargetQueued),
 
 	CR_MEMBER(badTargetCategory),
 	CR_MEMBER(onlyTargetCategory),
@@ -160,6 +162,7 @@ CWeapon::CWeapon(CUnit* owner, const WeaponDef* def):
 	doTargetGroundPos(false),
 	noAutoTarget(false),
 	alreadyWarnedAboutMissingPieces(false),
+	autoTargetQueued(false),
 
 	badTargetCategory(0),
 	onlyTargetCategory(0xffffffff),
@@ -710,7 +713,7 @@ bool CWeapon::AllowWeaponAutoTarget() const
 	return (gs->frameNum > (lastTargetRetry + 65));
 }
 
-bool CWeapon::AutoTarget()
+bool CWeapon::AutoTarget(bool deferred)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (!AllowWeaponAutoTarget())
@@ -719,18 +722,29 @@ bool CWeapon::AutoTarget()
 	// search for other in-range targets
 	lastTargetRetry = gs->frameNum;
 
-	const CUnit* avoidUnit = (avoidTarget && HaveUnitTarget()) ? currentTarget.unit : nullptr;
+	// scripted target weights have to be evaluated here, others can be scored in batch
+	if (deferred && !hasTargetWeight) {
+		unitHandler.QueueWeaponAutoTarget(this);
+		return false;
+	}
+
+	auto& targetPairs = helper->targetPairs;
+
+	CGameHelper::GenerateWeaponTargets(this, GetAutoTargetAvoidUnit(), targetPairs);
+	return SelectAutoTarget(targetPairs);
+}
 
+bool CWeapon::SelectAutoTarget(const std::vector<std::pair<float, CUnit*>>& targetPairs)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
 	CUnit* goodTargetUnit = nullptr;
 	CUnit*  badTargetUnit = nullptr;
 
-	auto& targetPairs = helper->targetPairs;
-
 	// NOTE:
 	//   GenerateWeaponTargets sorts by INCREASING order of priority, so lower equals better
 	//   <targetPairs> is normally sorted such that all bad TargetCategory units live at the
 	//   end, but Lua can mess with the ordering arbitrarily
-	for (size_t i = 0, n = CGameHelper::GenerateWeaponTargets(this, avoidUnit, targetPairs); i < n; i++, assert(n == targetPairs.size())) {
+	for (size_t i = 0, n = targetPairs.size(); i < n; i++, assert(n == targetPairs.size())) {
 		CUnit* unit = targetPairs[i].second;
 
 		// save the "best" bad target in case we have no other
@@ -784,8 +798,14 @@ void CWeapon::SlowUpdate()
 
 	// SlavedWeapon: Update Weapon Target
 	if (slavedTo != nullptr) {
-		// clone targets from the weapon we are slaved to
-		SetAttackTarget(slavedTo->currentTarget);
+		// clone targets from the weapon we are slaved to; if that one is still
+		// waiting for its deferred AutoTarget, clone once it has picked (as it
+		// would have done before us without deferring)
+		if (slavedTo->autoTargetQueued) {
+			unitHandler.QueueWeaponAutoTarget(this);
+		} else {
+			SetAttackTarget(slavedTo->currentTarget);
+		}
 	} else
 	if (weaponDef->interceptor) {
 		// keep track of the closest projectile heading our way (if any)
@@ -801,7 +821,7 @@ void CWeapon::SlowUpdate()
 		Attack(owner->lastAttacker);
 	}
 	// AutoTarget: Find new/better Target
-	AutoTarget();
+	AutoTarget(unitHandler.DeferWeaponAutoTargets());
 }
 
 
@@ -90,7 +90,11 @@ public:
 	virtual void UpdateProjectileSpeed(const float val) { projectileSpeed = val; }
 	virtual void UpdateRange(const float val) { range = val; }
 
-	bool AutoTarget();
+	/// if <deferred>, the weapon is queued for CUnitHandler::UpdateWeaponAutoTargets instead (returns false)
+	bool AutoTarget(bool deferred = false);
+	/// picks the best unit that passes TryTarget from <targetPairs> (sorted by priority, lower is better)
+	bool SelectAutoTarget(const std::vector<std::pair<float, CUnit*>>& targetPairs);
+	const CUnit* GetAutoTargetAvoidUnit() const { return ((avoidTarget && HaveUnitTarget()) ? currentTarget.unit : nullptr); }
 	void AimReady(const int value);
 	void Fire(const bool scriptCall);
 
@@ -179,6 +183,7 @@ public:
 	bool doTargetGroundPos;                 // (used for bombers) target the ground pos under the unit instead of the center aimPos
 	bool noAutoTarget;
 	bool alreadyWarnedAboutMissingPieces;
+	bool autoTargetQueued;                  // set while the weapon waits in CUnitHandler's deferred AutoTarget batch
 
 	unsigned int badTargetCategory;         // targets in this category get a lot lower targeting priority
 	unsigned int onlyTargetCategory;        // only targets in this category can be targeted (default 0xffffffff)
@@ -4,10 +4,12 @@
 #define EVENT_CLIENT_H
 
 #include <algorithm>
+#include <bitset>
 #include <typeinfo>
 #include <string>
 #include <vector>
 
+#include "Sim/Misc/GlobalConstants.h"
 #include "System/float3.h"
 #include "System/Misc/SpringTime.h"
 
@@ -42,6 +44,33 @@ struct WeaponDef;
 #endif
 
 
+/// UnitDamaged as queued for UnitDamagedBatch; captured when the damage happens
+struct UnitDamagedEvent {
+	int unitID;
+	int unitDefID;
+	int unitTeam;
+	int unitAllyTeam;
+
+	int attackerID; ///< -1 if there was no attacker
+	int attackerDefID;
+	int attackerEffectiveDefID; ///< decoy def shown to other allyteams
+	int attackerTeam;
+	int attackerAllyTeam;
+
+	///< per allyteam, whether the attacker was visible (in LOS or radar) and
+	///< its type known when the damage happened; the attacker can move or
+	///< die before the batch goes out
+	std::bitset<MAX_TEAMS> attackerVisible;
+	std::bitset<MAX_TEAMS> attackerTyped;
+
+	int weaponDefID;
+	int projectileID;
+
+	float damage;
+	bool paralyzer;
+};
+
+
 enum DbgTimingInfoType {
 	TIMING_VIDEO,
 	TIMING_SIM,
@@ -145,6 +174,8 @@ class CEventClient
 			int weaponDefID,
 			int projectileID,
 			bool paralyzer) {}
+		/// all UnitDamaged events since the previous batch, see CEventHandler::FlushBatchedEvents
+		virtual void UnitDamagedBatch(const std::vector<UnitDamagedEvent>& events) {}
 		virtual void UnitStunned(const CUnit* unit, bool stunned) {}
 		virtual void UnitExperience(const CUnit* unit, float oldExperience) {}
 		virtual void UnitHarvestStorageFull(const CUnit* unit) {}
@@ -5,6 +5,8 @@
 #include "Lua/LuaCallInCheck.h"
 #include "Lua/LuaOpenGL.h"  // FIXME -- should be moved
 
+#include "Sim/Misc/TeamHandler.h"
+#include "Sim/Units/UnitDef.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Platform/Threading.h"
 #include "System/GlobalConfig.h"
@@ -40,6 +42,8 @@ void CEventHandler::ResetState()
 	handles.clear();
 	handles.reserve(16);
 
+	unitDamagedEvents.clear();
+
 	SetupEvents();
 }
 
@@ -559,6 +563,86 @@ void CEventHandler::GameFramePost(int gameFrame)
 {
 	ZoneScoped;
 	ITERATE_EVENTCLIENTLIST(GameFramePost, gameFrame);
+
+	// last call-in of the frame, so this includes events raised by GameFramePost clients
+	FlushBatchedEvents();
+}
+
+void CEventHandler::QueueUnitDamaged(
+	const CUnit* unit,
+	const CUnit* attacker,
+	float damage,
+	int weaponDefID,
+	int projectileID,
+	bool paralyzer
+) {
+	UnitDamagedEvent event;
+
+	event.unitID = unit->id;
+	event.unitDefID = unit->unitDef->id;
+	event.unitTeam = unit->team;
+	event.unitAllyTeam = unit->allyteam;
+
+	event.attackerID = -1;
+	event.attackerDefID = -1;
+	event.attackerEffectiveDefID = -1;
+	event.attackerTeam = -1;
+	event.attackerAllyTeam = -1;
+
+	if (attacker != nullptr) {
+		const UnitDef* ud = attacker->unitDef;
+
+		event.attackerID = attacker->id;
+		event.attackerDefID = ud->id;
+		event.attackerEffectiveDefID = (ud->decoyDef != nullptr)? ud->decoyDef->id: ud->id;
+		event.attackerTeam = attacker->team;
+		event.attackerAllyTeam = attacker->allyteam;
+
+		// same tests as LuaUtils::IsUnitVisible and IsUnitTyped
+		for (int allyTeam = 0, n = teamHandler.ActiveAllyTeams(); allyTeam < n; allyTeam++) {
+			const uint8_t losStatus = attacker->losStatus[allyTeam];
+			const uint8_t prevMask = (LOS_PREVLOS | LOS_CONTRADAR);
+
+			event.attackerVisible[allyTeam] = ((losStatus & (LOS_INLOS | LOS_INRADAR)) != 0);
+			event.attackerTyped[allyTeam] = ((losStatus & LOS_INLOS) != 0 || (losStatus & prevMask) == prevMask);
+		}
+	}
+
+	event.weaponDefID = weaponDefID;
+	event.projectileID = projectileID;
+
+	event.damage = damage;
+	event.paralyzer = paralyzer;
+
+	unitDamagedEvents.push_back(event);
+}
+
+void CEventHandler::FlushBatchedEvents()
+{
+	ZoneScoped;
+
+	if (unitDamagedEvents.empty())
+		return;
+
+	// clients may deal damage from inside the batch call-in; those events
+	// are queued anew and go out with the next flush instead of being added
+	// to the array that is being delivered
+	std::vector<UnitDamagedEvent> events;
+	std::swap(events, unitDamagedEvents);
+
+	// the call-in groups events by unit, which does not reorder the events
+	// of any one unit
+	std::stable_sort(events.begin(), events.end(), [](const UnitDamagedEvent& a, const UnitDamagedEvent& b) {
+		return (a.unitID < b.unitID);
+	});
+
+	ITERATE_EVENTCLIENTLIST(UnitDamagedBatch, events);
+
+	// hand the storage back unless new events arrived meanwhile
+	if (unitDamagedEvents.empty()) {
+		events.clear();
+		std::swap(events, unitDamagedEvents);
+	}
 }
 
 void CEventHandler::GameProgress(int gameFrame)
@@ -98,6 +98,19 @@ class CEventHandler
 		void UnitExperience(const CUnit* unit, float oldExperience);
 		void UnitHarvestStorageFull(const CUnit* unit);
 
+		/// queues a UnitDamaged event for the UnitDamagedBatch call-in only; like
+		/// UnitDamaged itself this is only raised from the sim thread, so a single
+		/// queue already holds the events in the order they happened
+		void QueueUnitDamaged(
+			const CUnit* unit,
+			const CUnit* attacker,
+			float damage,
+			int weaponDefID,
+			int projectileID,
+			bool paralyzer);
+		/// delivers all queued events to their batch call-ins; sim thread only
+		void FlushBatchedEvents();
+
 		void UnitSeismicPing(const CUnit* unit, int allyTeam,
 		                     const float3& pos, float strength);
 		void UnitEnteredRadar(const CUnit* unit, int allyTeam);
@@ -356,6 +369,9 @@ class CEventHandler
 	private:
 		CEventClient* mouseOwner;
 
+		// filled by Queue*, emptied by FlushBatchedEvents
+		std::vector<UnitDamagedEvent> unitDamagedEvents;
+
 	private:
 		EventMap eventMap;
 
@@ -552,6 +568,9 @@ inline void CEventHandler::UnitDamaged(
 	int projectileID,
 	bool paralyzer)
 {
+	if (!listUnitDamagedBatch.empty())
+		QueueUnitDamaged(unit, attacker, damage, weaponDefID, projectileID, paralyzer);
+
 	ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDamaged, unit, attacker, damage, weaponDefID, projectileID, paralyzer)
 }
 
@@ -2,11 +2,13 @@
 
 #include <algorithm>
 #include <array>
+#include <cstring>
 #include <memory>
 #include <random>
 #include <chrono>
+#include <type_traits>
 
-#include <nowide/cstdio.hpp>
+#include <ostream>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -23,6 +25,7 @@
 #include "DataDirsAccess.h"
 #include "FileSystem.h"
 #include "FileQueryFlags.h"
+#include "MemoryMappedFile.h"
 #include "Lua/LuaParser.h"
 #include "System/ContainerUtil.h"
 #include "System/StringUtil.h"
@@ -619,20 +622,23 @@ void CArchiveScanner::ReadCache()
 {
 	Clear();
 
-    cacheFile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua");
+	const std::string cacheDir = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir());
+	const std::string binCacheFile = cacheDir + IntToString(INTERNAL_VER, "ArchiveCache%i.bin");
 
-	if (!FileSystem::FileExists(cacheFile)) {
+	// no (valid) binary cache yet; the text cache of the same version can
+	// be migrated as-is, it lacks only the size and inode fast-path data
+	if (!ReadCacheData(binCacheFile) && !ReadLuaCacheData(cacheDir + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"))) {
 		// Try to save initial scanning of assets, but will have to redo hashing
 		// as the previous version had bugs in that area
 		// probe two previous versions
 		std::array prevCacheFiles {
-			FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER - 1, "ArchiveCache%i.lua"),
-			FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER - 2, "ArchiveCache%i.lua"),
-			FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER - 3, "ArchiveCache%i.lua")
+			cacheDir + IntToString(INTERNAL_VER - 1, "ArchiveCache%i.lua"),
+			cacheDir + IntToString(INTERNAL_VER - 2, "ArchiveCache%i.lua"),
+			cacheDir + IntToString(INTERNAL_VER - 3, "ArchiveCache%i.lua")
 		};
 
 		for (const auto& prevCacheFile : prevCacheFiles) {
-			if (!ReadCacheData(prevCacheFile, true))
+			if (!ReadLuaCacheData(prevCacheFile, true))
 				continue;
 
 			// nullify hashes, filesInfo
@@ -650,7 +656,7 @@ void CArchiveScanner::ReadCache()
 		}
 	}
 
-	ReadCacheData(GetFilepath());
+	cacheFile = binCacheFile;
 	ScanAllDirs();
 }
 
@@ -693,13 +699,15 @@ CArchiveScanner::BrokenArchive& CArchiveScanner::GetAddBrokenArchive(const std::
 
 void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 {
-	uint32_t modifiedTime = 0;
+	FileSystem::FileStatus archiveStatus;
 
 	assert(!isInScan);
 
-	if (CheckCachedData(fullName, modifiedTime, doChecksum))
+	if (CheckCachedData(fullName, archiveStatus, doChecksum))
 		return;
 
+	const uint32_t modifiedTime = archiveStatus.modTime;
+
 	isDirty = true;
 	isInScan = true;
 
@@ -807,6 +815,8 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 
 	ai.path = fpath;
 	ai.modified = modifiedTime;
+	ai.size = archiveStatus.size;
+	ai.inode = archiveStatus.inode;
 
 	// Store modinfo.lua/mapinfo.lua modified timestamp for directory archives, as only they can change.
 	if (ar->GetType() == ARCHIVE_TYPE_SDD && !luaInfoFile.empty()) {
@@ -825,7 +835,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 }
 
 
-bool CArchiveScanner::CheckCachedData(const std::string& fullName, uint32_t& modified, bool doChecksum)
+bool CArchiveScanner::CheckCachedData(const std::string& fullName, FileSystem::FileStatus& status, bool doChecksum)
 {
 	// virtual archives do not exist on disk, and thus do not have a modification time
 	// they should still be scanned as normal archives so we only skip the cache-check
@@ -835,9 +845,11 @@ bool CArchiveScanner::CheckCachedData(const std::string& fullName, uint32_t& mod
 	// if stat fails, assume the archive is not broken nor cached
 	// it would also fail in the case of virtual archives and cause
 	// warning-spam which is suppressed by the extension-test above
-	if ((modified = FileSystem::GetFileModificationTime(fullName)) == 0)
+	if (!FileSystem::GetFileStatus(fullName, status) || status.modTime == 0)
 		return false;
 
+	const uint32_t modified = status.modTime;
+
 	const std::string& fileName      = FileSystem::GetFilename(fullName);
 	const std::string& filePath      = FileSystem::GetDirectory(fullName);
 	const std::string& fileNameLower = StringToLower(fileName);
@@ -868,7 +880,9 @@ bool CArchiveScanner::CheckCachedData(const std::string& fullName, uint32_t& mod
 	if (!ai.replaced.empty())
 		return true;
 
-	const bool haveValidCacheData = (modified == ai.modified && filePath == ai.path);
+	// size and inode are unknown (0) for entries migrated from a text cache
+	const bool sameFileStatus = (ai.size == 0 || ai.size == static_cast<uint64_t>(status.size)) && (ai.inode == 0 || ai.inode == status.inode);
+	const bool haveValidCacheData = (modified == ai.modified && filePath == ai.path && sameFileStatus);
 	// check if the archive data file (modinfo.lua/mapinfo.lua) has changed
 	const bool archiveDataChanged = (!ai.archiveDataPath.empty() && FileSystem::GetFileModificationTime(ai.archiveDataPath) != ai.modifiedArchiveData);
 
@@ -878,6 +892,8 @@ bool CArchiveScanner::CheckCachedData(const std::string& fullName, uint32_t& mod
 		// not be rewritten even if the hash silently changed,
 		// e.g. after redownload
 		ai.updated = true;
+		ai.size = status.size;
+		ai.inode = status.inode;
 
 		if (doChecksum && !ai.hashed) {
 			isDirty |= (ai.hashed = GetArchiveChecksum(fullName, ai));
@@ -1023,15 +1039,22 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 		if (it == archiveInfo.filesInfo.end())
 			it = archiveInfo.filesInfo.emplace(fi.fileName, {}).first;
 
-		if (fi.modTime != it->second.modTime || fi.size != it->second.size) {
+		// a file replaced by one with equal size and mtime (e.g. rsync -t) still
+		// gets a new inode; inodes are not known for all archive types though
+		const bool inodeChanged = (it->second.inode != 0 && fi.inode != it->second.inode);
+
+		if (fi.modTime != it->second.modTime || fi.size != it->second.size || inodeChanged) {
 			it->second.modTime = fi.modTime;
 			it->second.size = fi.size;
 			it->second.checksum = sha512::NULL_RAW_DIGEST;
 		}
 
+		it->second.inode = fi.inode;
+
 		fileNames.emplace_back(std::move(fi.fileName));
 	}
 
+	// only used as chunk buffers by archive types that stream files into the hasher
 	std::array<std::vector<uint8_t>, ThreadPool::MAX_THREADS> fileBuffers;
 
 	for_mt(0, fileNames.size(), [&ar, &fileNames = std::as_const(fileNames), &fileBuffers, &filesInfo = archiveInfo.filesInfo, this](int i) {
@@ -1125,7 +1148,265 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 }
 
 
-bool CArchiveScanner::ReadCacheData(const std::string& filename, bool loadOldVersion)
+namespace {
+	static constexpr char ARCHIVE_CACHE_MAGIC[8] = {'R', 'C', 'L', 'A', 'R', 'C', 'H', '\0'};
+	// bumped whenever the binary layout changes; the file name keeps using INTERNAL_VER
+	static constexpr uint32_t ARCHIVE_CACHE_VERSION = 22;
+
+	// followed by the archives, the broken archives and the pool files
+	struct ArchiveCacheHeader {
+		char magic[sizeof(ARCHIVE_CACHE_MAGIC)];
+		uint32_t version;
+		uint32_t numArchives;
+		uint32_t numBrokenArchives;
+		uint32_t numPoolFiles;
+	};
+
+	template<typename T> void WriteRaw(std::vector<uint8_t>& buffer, const T* src, size_t count = 1) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		const size_t pos = buffer.size();
+
+		buffer.resize(pos + sizeof(T) * count);
+		std::memcpy(buffer.data() + pos, src, sizeof(T) * count);
+	}
+
+	void WriteStr(std::vector<uint8_t>& buffer, const std::string& str) {
+		const uint32_t len = str.size();
+
+		WriteRaw(buffer, &len);
+		WriteRaw(buffer, str.data(), len);
+	}
+
+	template<typename T> bool ReadRaw(const uint8_t*& data, const uint8_t* dataEnd, T* dst, size_t count = 1) {
+		static_assert(std::is_trivially_copyable_v<T>);
+
+		if (static_cast<size_t>(dataEnd - data) < (sizeof(T) * count))
+			return false;
+
+		std::memcpy(dst, data, sizeof(T) * count);
+		data += (sizeof(T) * count);
+		return true;
+	}
+
+	bool ReadStr(const uint8_t*& data, const uint8_t* dataEnd, std::string& str) {
+		uint32_t len = 0;
+
+		if (!ReadRaw(data, dataEnd, &len) || len > static_cast<size_t>(dataEnd - data))
+			return false;
+
+		str.assign(reinterpret_cast<const char*>(data), len);
+		data += len;
+		return true;
+	}
+}
+
+
+bool CArchiveScanner::ReadCacheData(const std::string& filename)
+{
+	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+	if (!FileSystem::FileExists(filename)) {
+		LOG_L(L_INFO, "[AS::%s] ArchiveCache %s doesn't exist", __func__, filename.c_str());
+		return false;
+	}
+
+	CMemoryMappedFile cacheMap;
+
+	if (!cacheMap.Open(filename))
+		return false;
+
+	const uint8_t* data = cacheMap.GetData();
+	const uint8_t* dataEnd = data + cacheMap.GetSize();
+
+	ArchiveCacheHeader header;
+
+	if (!ReadRaw(data, dataEnd, &header) || std::memcmp(header.magic, ARCHIVE_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != ARCHIVE_CACHE_VERSION) {
+		LOG_L(L_WARNING, "[AS::%s] ignoring ArchiveCache %s of unknown format or version", __func__, filename.c_str());
+		return false;
+	}
+
+	std::string str;
+
+	const auto ReadFileInfoMap = [&](uint32_t numFiles, spring::unordered_map<std::string, FileInfo>& filesInfoMap) {
+		for (uint32_t j = 0; j < numFiles; ++j) {
+			FileInfo fi;
+
+			bool valid = true;
+			valid = valid && ReadStr(data, dataEnd, str);
+			valid = valid && ReadRaw(data, dataEnd, &fi.size);
+			valid = valid && ReadRaw(data, dataEnd, &fi.modTime);
+			valid = valid && ReadRaw(data, dataEnd, &fi.inode);
+			valid = valid && ReadRaw(data, dataEnd, fi.checksum.data(), fi.checksum.size());
+
+			if (!valid)
+				return false;
+
+			filesInfoMap[str] = fi;
+		}
+
+		return true;
+	};
+
+	const auto ReadArchiveData = [&](ArchiveData& ad) {
+		uint32_t numItems = 0;
+		uint32_t numDeps = 0;
+
+		if (!ReadRaw(data, dataEnd, &numItems))
+			return false;
+
+		for (uint32_t j = 0; j < numItems; ++j) {
+			uint8_t valueType = INFO_VALUE_TYPE_STRING;
+
+			if (!ReadStr(data, dataEnd, str) || !ReadRaw(data, dataEnd, &valueType))
+				return false;
+			if (ArchiveData::IsReservedKey(StringToLower(str)))
+				return false;
+
+			switch (valueType) {
+				case INFO_VALUE_TYPE_STRING: {
+					std::string value;
+
+					if (!ReadStr(data, dataEnd, value))
+						return false;
+
+					ad.SetInfoItemValueString(str, value);
+				} break;
+				case INFO_VALUE_TYPE_INTEGER: {
+					int32_t value = 0;
+
+					if (!ReadRaw(data, dataEnd, &value))
+						return false;
+
+					ad.SetInfoItemValueInteger(str, value);
+				} break;
+				case INFO_VALUE_TYPE_FLOAT: {
+					float value = 0.0f;
+
+					if (!ReadRaw(data, dataEnd, &value))
+						return false;
+
+					ad.SetInfoItemValueFloat(str, value);
+				} break;
+				case INFO_VALUE_TYPE_BOOL: {
+					uint8_t value = 0;
+
+					if (!ReadRaw(data, dataEnd, &value))
+						return false;
+
+					ad.SetInfoItemValueBool(str, value != 0);
+				} break;
+				default: {
+					return false;
+				} break;
+			}
+		}
+
+		if (!ReadRaw(data, dataEnd, &numDeps))
+			return false;
+
+		// unlike the text cache, this includes the dependencies added by the scanner
+		for (uint32_t j = 0; j < numDeps; ++j) {
+			if (!ReadStr(data, dataEnd, str))
+				return false;
+
+			ad.GetDependencies().push_back(str);
+		}
+
+		return true;
+	};
+
+	const auto ReadArchiveInfo = [&]() {
+		std::string origName;
+		std::string path;
+		std::string archiveDataPath;
+		std::string replaced;
+
+		uint32_t modified = 0;
+		uint32_t modifiedArchiveData = 0;
+		uint32_t numFiles = 0;
+
+		uint64_t size = 0;
+		uint64_t inode = 0;
+
+		sha512::raw_digest checksum;
+
+		bool valid = true;
+		valid = valid && ReadStr(data, dataEnd, origName);
+		valid = valid && ReadStr(data, dataEnd, path);
+		valid = valid && ReadStr(data, dataEnd, archiveDataPath);
+		valid = valid && ReadStr(data, dataEnd, replaced);
+		valid = valid && ReadRaw(data, dataEnd, &modified);
+		valid = valid && ReadRaw(data, dataEnd, &modifiedArchiveData);
+		valid = valid && ReadRaw(data, dataEnd, &size);
+		valid = valid && ReadRaw(data, dataEnd, &inode);
+		valid = valid && ReadRaw(data, dataEnd, checksum.data(), checksum.size());
+		valid = valid && ReadRaw(data, dataEnd, &numFiles);
+
+		if (!valid)
+			return false;
+
+		ArchiveInfo& ai = GetAddArchiveInfo(StringToLower(origName));
+
+		ai.origName            = std::move(origName);
+		ai.path                = std::move(path);
+		ai.archiveDataPath     = std::move(archiveDataPath);
+		ai.replaced            = std::move(replaced);
+		ai.modified            = modified;
+		ai.modifiedArchiveData = modifiedArchiveData;
+		ai.size                = size;
+		ai.inode               = inode;
+		ai.checksum            = checksum;
+
+		ai.updated = false;
+		ai.hashed = (ai.checksum != sha512::NULL_RAW_DIGEST);
+		ai.archiveData = {};
+
+		return (ReadFileInfoMap(numFiles, ai.filesInfo) && ReadArchiveData(ai.archiveData));
+	};
+
+	const auto ReadBrokenArchive = [&]() {
+		BrokenArchive ba;
+
+		bool valid = true;
+		valid = valid && ReadStr(data, dataEnd, ba.name);
+		valid = valid && ReadStr(data, dataEnd, ba.path);
+		valid = valid && ReadStr(data, dataEnd, ba.problem);
+		valid = valid && ReadRaw(data, dataEnd, &ba.modified);
+
+		if (!valid)
+			return false;
+
+		BrokenArchive& cba = GetAddBrokenArchive(ba.name);
+
+		cba = std::move(ba);
+		cba.updated = false;
+		return true;
+	};
+
+	bool valid = true;
+
+	for (uint32_t i = 0; valid && i < header.numArchives; ++i) {
+		valid = ReadArchiveInfo();
+	}
+	for (uint32_t i = 0; valid && i < header.numBrokenArchives; ++i) {
+		valid = ReadBrokenArchive();
+	}
+
+	valid = valid && ReadFileInfoMap(header.numPoolFiles, poolFilesInfo);
+
+	if (!valid || data != dataEnd) {
+		LOG_L(L_ERROR, "[AS::%s] ignoring corrupt ArchiveCache %s", __func__, filename.c_str());
+
+		// do not keep anything from a partially read cache
+		Clear();
+		return false;
+	}
+
+	isDirty = false;
+
+	return true;
+}
+
+bool CArchiveScanner::ReadLuaCacheData(const std::string& filename, bool loadOldVersion)
 {
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
 	if (!FileSystem::FileExists(filename)) {
@@ -1176,6 +1457,7 @@ bool CArchiveScanner::ReadCacheData(const std::string& filename, bool loadOldVer
 		ai.origName 	   = curArchiveName;
 		ai.path     	   = FileSystem::ForwardSlashes(curArchiveTbl.GetString("path", ""));
 		ai.archiveDataPath = FileSystem::ForwardSlashes(curArchiveTbl.GetString("archiveDataPath", ""));
+		ai.replaced        = curArchiveTbl.GetString("replaced", "");
 
 		// do not use LuaTable.GetInt() for integers: the engine's lua
 		// library uses 32-bit floats to represent numbers, which can only
@@ -1220,24 +1502,6 @@ bool CArchiveScanner::ReadCacheData(const std::string& filename, bool loadOldVer
 	return true;
 }
 
-static inline void SafeStr(FILE* out, const char* prefix, const std::string& str)
-{
-	if (str.empty())
-		return;
-
-	if ((str.find_first_of("\\\"") != std::string::npos) || (str.find_first_of('\n') != std::string::npos )) {
-		fprintf(out, "%s[[%s]],\n", prefix, str.c_str());
-	} else {
-		fprintf(out, "%s\"%s\",\n", prefix, str.c_str());
-	}
-}
-
-void FilterDep(std::vector<std::string>& deps, const std::string& exclude)
-{
-	auto it = std::remove_if(deps.begin(), deps.end(), [&](const std::string& dep) { return (dep == exclude); });
-	deps.erase(it, deps.end());
-}
-
 void CArchiveScanner::WriteCacheData(const std::string& filename)
 {
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
@@ -1320,109 +1584,94 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 		}
 	}
 
-	FILE* out = nowide::fopen(filename.c_str(), "wt");
-	if (out == nullptr) {
-		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
-		return;
-	}
+	std::vector<uint8_t> buffer;
+	ArchiveCacheHeader header;
 
-	auto WriteFileInfoMapBody = [out](const spring::unordered_map<std::string, FileInfo>& filesInfoMap, size_t numTabs) {
-		const auto tabs = std::string(numTabs, '\t');
-		for (const auto& [fn, fi] : filesInfoMap) {
-			std::string tbl = fmt::format("{}{{ fileName = \"{}\", size = \"{}\", modTime = \"{}\", checksum = \"{}\" }},\n", tabs, fn, fi.size, fi.modTime, sha512::dump_digest(fi.checksum));
-			fputs(tbl.c_str(), out);
-		}
-	};
+	std::memcpy(header.magic, ARCHIVE_CACHE_MAGIC, sizeof(header.magic));
 
+	header.version = ARCHIVE_CACHE_VERSION;
+	header.numArchives = archiveInfos.size();
+	header.numBrokenArchives = brokenArchives.size();
+	header.numPoolFiles = poolFilesInfo.size();
 
-	fprintf(out, "local archiveCache = {\n\n");
-	fprintf(out, "\tinternalver = %i,\n\n", INTERNAL_VER);
-	fprintf(out, "\tarchives = {  -- count = %u\n", uint32_t(archiveInfos.size()));
+	// pool files alone take ~100 bytes each
+	buffer.reserve(sizeof(header) + (archiveInfos.size() + poolFilesInfo.size()) * 128);
 
-	for (const ArchiveInfo& arcInfo: archiveInfos) {
-		sha512::raw_digest rawDigest;
-		sha512::hex_digest hexDigest;
-
-		rawDigest = arcInfo.checksum;
-		sha512::dump_digest(rawDigest, hexDigest);
-
-		fprintf(out, "\t\t{\n");
-		SafeStr(out, "\t\t\tname = ",              arcInfo.origName);
-		SafeStr(out, "\t\t\tpath = ",              arcInfo.path    );
-		fprintf(out, "\t\t\tmodified = \"%u\",\n", arcInfo.modified);
-		fprintf(out, "\t\t\tchecksum = \"%s\",\n", hexDigest.data());
-		SafeStr(out, "\t\t\treplaced = ",          arcInfo.replaced);
-
-		if (!arcInfo.archiveDataPath.empty()) {
-			SafeStr(out, "\t\t\tarchiveDataPath = ",              arcInfo.archiveDataPath);
-			fprintf(out, "\t\t\tmodifiedArchiveData = \"%u\",\n", arcInfo.modifiedArchiveData);
-		}
+	WriteRaw(buffer, &header);
 
-		if (!arcInfo.filesInfo.empty()) {
-			fprintf(out, "\t\t\tfilesInfo = {\n");
-			WriteFileInfoMapBody(arcInfo.filesInfo, 4);
-			fprintf(out, "\t\t\t},\n");
+	const auto WriteFileInfoMap = [&buffer](const spring::unordered_map<std::string, FileInfo>& filesInfoMap) {
+		for (const auto& [fn, fi] : filesInfoMap) {
+			WriteStr(buffer, fn);
+			WriteRaw(buffer, &fi.size);
+			WriteRaw(buffer, &fi.modTime);
+			WriteRaw(buffer, &fi.inode);
+			WriteRaw(buffer, fi.checksum.data(), fi.checksum.size());
 		}
+	};
 
-		// mod info?
+	for (const ArchiveInfo& arcInfo: archiveInfos) {
+		const uint32_t numFiles = arcInfo.filesInfo.size();
+
+		WriteStr(buffer, arcInfo.origName);
+		WriteStr(buffer, arcInfo.path);
+		WriteStr(buffer, arcInfo.archiveDataPath);
+		WriteStr(buffer, arcInfo.replaced);
+		WriteRaw(buffer, &arcInfo.modified);
+		WriteRaw(buffer, &arcInfo.modifiedArchiveData);
+		WriteRaw(buffer, &arcInfo.size);
+		WriteRaw(buffer, &arcInfo.inode);
+		WriteRaw(buffer, arcInfo.checksum.data(), arcInfo.checksum.size());
+		WriteRaw(buffer, &numFiles);
+		WriteFileInfoMap(arcInfo.filesInfo);
+
+		// mod info
 		const ArchiveData& archData = arcInfo.archiveData;
-		if (!archData.GetName().empty()) {
-			fprintf(out, "\t\t\tarchivedata = {\n");
-
-			for (const auto& ii: archData.GetInfo()) {
-				if (ii.second.valueType == INFO_VALUE_TYPE_STRING) {
-					SafeStr(out, std::string("\t\t\t\t" + ii.first + " = ").c_str(), ii.second.valueTypeString);
-				} else {
-					fprintf(out, "\t\t\t\t%s = %s,\n", ii.first.c_str(), ii.second.GetValueAsString(false).c_str());
-				}
-			}
+		const uint32_t numItems = archData.GetInfo().size();
+		const uint32_t numDeps = archData.GetDependencies().size();
 
-			std::vector<std::string> deps = archData.GetDependencies();
-			if (archData.IsMap()) {
-				FilterDep(deps, GetMapHelperContentName());
-			} else if (archData.IsGame()) {
-				FilterDep(deps, GetSpringBaseContentName());
-			}
+		WriteRaw(buffer, &numItems);
 
-			if (!deps.empty()) {
-				fprintf(out, "\t\t\t\tdepend = {\n");
-				for (const auto& dep: deps) {
-					SafeStr(out, "\t\t\t\t\t", dep);
-				}
-				fprintf(out, "\t\t\t\t},\n");
+		for (const auto& ii: archData.GetInfo()) {
+			const InfoItem& item = ii.second;
+			const uint8_t valueType = item.valueType;
+
+			WriteStr(buffer, item.key);
+			WriteRaw(buffer, &valueType);
+
+			switch (item.valueType) {
+				case INFO_VALUE_TYPE_STRING : { WriteStr(buffer, item.valueTypeString); } break;
+				case INFO_VALUE_TYPE_INTEGER: { const int32_t value = item.value.typeInteger; WriteRaw(buffer, &value); } break;
+				case INFO_VALUE_TYPE_FLOAT  : { WriteRaw(buffer, &item.value.typeFloat); } break;
+				case INFO_VALUE_TYPE_BOOL   : { const uint8_t value = item.value.typeBool; WriteRaw(buffer, &value); } break;
 			}
-			fprintf(out, "\t\t\t},\n");
 		}
 
-		fprintf(out, "\t\t},\n");
-	}
+		WriteRaw(buffer, &numDeps);
 
-	fprintf(out, "\t},\n\n"); // close 'archives'
-	fprintf(out, "\tbrokenArchives = {  -- count = %u\n", uint32_t(brokenArchives.size()));
+		for (const auto& dep: archData.GetDependencies()) {
+			WriteStr(buffer, dep);
+		}
+	}
 
 	for (const BrokenArchive& ba: brokenArchives) {
-		fprintf(out, "\t\t{\n");
-		SafeStr(out, "\t\t\tname = ", ba.name);
-		SafeStr(out, "\t\t\tpath = ", ba.path);
-		fprintf(out, "\t\t\tmodified = \"%u\",\n", ba.modified);
-		SafeStr(out, "\t\t\tproblem = ", ba.problem);
-		fprintf(out, "\t\t},\n");
+		WriteStr(buffer, ba.name);
+		WriteStr(buffer, ba.path);
+		WriteStr(buffer, ba.problem);
+		WriteRaw(buffer, &ba.modified);
 	}
 
-	fprintf(out, "\t},\n"); // close 'brokenArchives'
-
 	// Information about files in the pool
-	if (!poolFilesInfo.empty()) {
-		fprintf(out, "\tpoolFiles = {  -- count = %u\n", uint32_t(poolFilesInfo.size()));
-		WriteFileInfoMapBody(poolFilesInfo, 2);
-		fprintf(out, "\t},\n"); // close 'poolFiles'
-	}
+	WriteFileInfoMap(poolFilesInfo);
 
-	fprintf(out, "}\n\n"); // close 'archiveCache'
-	fprintf(out, "return archiveCache\n");
+	// readers must never map a half-written cache
+	const auto WriteBuffer = [&buffer](std::ostream& os) {
+		os.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+	};
 
-	if (fclose(out) == EOF)
+	if (!FileSystem::WriteFileViaTemp(filename, WriteBuffer)) {
 		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+		return;
+	}
 
 	isDirty = false;
 }
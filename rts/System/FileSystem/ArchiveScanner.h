@@ -10,6 +10,7 @@
 #include <atomic>
 
 #include "System/Info.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/Sync/SHA512.hpp"
 #include "System/UnorderedMap.hpp"
 
@@ -164,6 +165,7 @@ private:
 	struct FileInfo {
 		int32_t size = -1;
 		uint32_t modTime = 0;
+		uint64_t inode = 0; // 0 if unknown, e.g. for entries migrated from a text cache
 		sha512::raw_digest checksum = sha512::NULL_RAW_DIGEST;
 	};
 	struct ArchiveInfo {
@@ -182,6 +184,8 @@ private:
 
 		uint32_t modified = 0;
 		uint32_t modifiedArchiveData = 0;
+		uint64_t size = 0;  // of the archive file, 0 if unknown
+		uint64_t inode = 0; // of the archive file, 0 if unknown
 		sha512::raw_digest checksum;
 
 		bool updated = false;
@@ -215,7 +219,10 @@ private:
 	std::string SearchMapFile(const IArchive* ar, std::string& error);
 
 
-	bool ReadCacheData(const std::string& filename, bool loadOldVersion = false);
+	/// binary cache, mapped into memory and parsed in a single pass
+	bool ReadCacheData(const std::string& filename);
+	/// text cache written by earlier engine versions, only read to migrate it
+	bool ReadLuaCacheData(const std::string& filename, bool loadOldVersion = false);
 	void WriteCacheData(const std::string& filename);
 
 	IFileFilter* CreateIgnoreFilter(IArchive* ar);
@@ -226,7 +233,7 @@ private:
 	 */
 	bool GetArchiveChecksum(const std::string& filename, ArchiveInfo& archiveInfo);
 
-	bool CheckCachedData(const std::string& fullName, unsigned& modified, bool doChecksum);
+	bool CheckCachedData(const std::string& fullName, FileSystem::FileStatus& status, bool doChecksum);
 
 	/**
 	 * Returns a value > 0 if the file is rated as a meta-file.
@@ -97,19 +97,51 @@ IArchive::SFileInfo CDirArchive::FileInfo(uint32_t fid) const
 	auto& file = files[fid];
 	fi.fileName = file.fileName;
 
-	// check if not cached, file.size and file.modTime are mutable
-	if (auto ifs = (file.size == -1), ifm = (file.modTime == 0); ifs || ifm) {
+	// check if not cached, file.size, file.modTime and file.inode are mutable
+	// a single stat() per file keeps rescans of large directories cheap
+	if (file.size == -1 || file.modTime == 0) {
 		auto scopedSemAcq = AcquireSemaphoreScoped();
-		if (ifs)
-			file.size = FileSystem::GetFileSize(file.rawFileName);
+		FileSystem::FileStatus status;
 
-		if (ifm)
-			file.modTime = FileSystem::GetFileModificationTime(file.rawFileName);
+		if (FileSystem::GetFileStatus(file.rawFileName, status)) {
+			file.size = static_cast<int32_t>(status.size);
+			file.modTime = status.modTime;
+			file.inode = status.inode;
+		}
 	}
 
 	fi.specialFileName = file.rawFileName;
 	fi.size = file.size;
 	fi.modTime = file.modTime;
+	fi.inode = file.inode;
 
 	return fi;
+}
+
+bool CDirArchive::CalcHash(uint32_t fid, sha512::raw_digest& hash, std::vector<std::uint8_t>& fb)
+{
+	assert(IsFileId(fid));
+
+	auto scopedSemAcq = AcquireSemaphoreScoped();
+
+	nowide::ifstream ifs(files[fid].rawFileName, std::ios::in | std::ios::binary);
+
+	if (ifs.bad() || !ifs.is_open())
+		return false;
+
+	// stream the file through the hasher instead of reading it whole
+	sha512::msg_state msg;
+	sha512::init_digest(msg);
+
+	fb.resize(HASH_CHUNK_SIZE);
+
+	while (ifs.read(reinterpret_cast<char*>(fb.data()), fb.size()) || ifs.gcount() > 0) {
+		sha512::update_digest(msg, fb.data(), ifs.gcount());
+	}
+
+	if (ifs.bad() || msg.len == 0)
+		return false;
+
+	sha512::final_digest(msg, hash);
+	return true;
 }
\ No newline at end of file
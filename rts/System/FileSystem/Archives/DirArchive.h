@@ -40,6 +40,7 @@ public:
 	const std::string& FileName(uint32_t fid) const override;
 	int32_t FileSize(uint32_t fid) const override;
 	SFileInfo FileInfo(uint32_t fid) const override;
+	bool CalcHash(uint32_t fid, sha512::raw_digest& hash, std::vector<std::uint8_t>& fb) override;
 private:
 	/// "ExampleArchive.sdd/"
 	const std::string dirName;
@@ -49,6 +50,7 @@ private:
 		std::string rawFileName;
 		mutable int32_t size = -1;
 		mutable uint32_t modTime = 0;
+		mutable uint64_t inode = 0;
 	};
 
 	std::vector<Files> files;
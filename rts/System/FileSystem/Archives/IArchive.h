@@ -30,6 +30,7 @@ public:
 		std::string specialFileName; // overloaded meaning
 		int32_t size = -1;
 		uint32_t modTime = 0;
+		uint64_t inode = 0; // only known for files that exist on disk by themselves
 	};
 protected:
 	IArchive(const std::string& archiveFile);
@@ -136,9 +137,13 @@ public:
 	virtual bool CheckForSolid() const { return false; }
 	/**
 	 * Fetches the (SHA512) hash of a file by its ID.
+	 * @param fb scratch buffer; implementations that can stream the file
+	 *        only grow it to HASH_CHUNK_SIZE instead of the file's size
 	 */
 	virtual bool CalcHash(uint32_t fid, sha512::raw_digest& hash, std::vector<std::uint8_t>& fb);
 protected:
+	static constexpr size_t HASH_CHUNK_SIZE = 256 * 1024;
+
 	static uint32_t GetSpinningDiskParallelAccessNum();
 	auto AcquireSemaphoreScoped() const { // fake const
 		return spring::ScopedNullResource(
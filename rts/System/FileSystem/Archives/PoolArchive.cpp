@@ -90,6 +90,7 @@ CPoolArchive::CPoolArchive(const std::string& name)
 		f.crc32 = parse_uint32(c_crc32);
 		f.size = parse_uint32(c_size);
 		f.modTime = 0; // it's expensive and wasteful to set it here, set in FileInfo() instead
+		f.inode = 0;
 
 		s.fileIndx = files.size() - 1;
 		s.readTime = 0;
@@ -145,14 +146,21 @@ IArchive::SFileInfo CPoolArchive::FileInfo(uint32_t fid) const
 
 	if (file.modTime == 0) {
 		auto scopedSemAcq = AcquireSemaphoreScoped();
-		file.modTime = FileSystem::GetFileModificationTime(GetPoolFilePath(poolRootDir, file.md5sum)); // file.modTime is mutable
+		FileSystem::FileStatus status;
+
+		// file.modTime and file.inode are mutable
+		if (FileSystem::GetFileStatus(GetPoolFilePath(poolRootDir, file.md5sum), status)) {
+			file.modTime = status.modTime;
+			file.inode = status.inode;
+		}
 	}
 
 	return IArchive::SFileInfo{
 		.fileName = file.name,
 		.specialFileName = GetPoolFileName(file.md5sum),
 		.size = static_cast<int32_t>(file.size),
-		.modTime = file.modTime
+		.modTime = file.modTime,
+		.inode = file.inode
 	};
 }
 
@@ -160,10 +168,38 @@ bool CPoolArchive::CalcHash(uint32_t fid, sha512::raw_digest& hash, std::vector<
 {
 	assert(IsFileId(fid));
 
-	const FileData& fd = files[fid];
+	FileData& fd = files[fid];
+
+	// decompress the entry in chunks straight into the hasher, only
+	// when that fails retry via GetFileImpl which reads it as a whole
+	const auto GzHash = [&fd, &fb, path = GetPoolFilePath(poolRootDir, fd.md5sum)]() {
+		gzFile in = gzopen(path.c_str(), "rb");
+
+		if (in == nullptr)
+			return false;
+
+		sha512::msg_state msg;
+		sha512::init_digest(msg);
+
+		fb.resize(HASH_CHUNK_SIZE);
+
+		int bytesRead = 0;
+
+		while ((bytesRead = gzread(in, reinterpret_cast<char*>(fb.data()), fb.size())) > 0) {
+			sha512::update_digest(msg, fb.data(), bytesRead);
+		}
+
+		gzclose(in);
+
+		if (bytesRead < 0 || msg.len != fd.size)
+			return false;
+
+		sha512::final_digest(msg, fd.shasum);
+		return true;
+	};
 
 	// pool-entry hashes are not calculated until GetFileImpl, must check JIT
-	if (fd.shasum == sha512::NULL_RAW_DIGEST)
+	if (fd.shasum == sha512::NULL_RAW_DIGEST && !GzHash())
 		GetFileImpl(fid, fb);
 
 	hash = fd.shasum;
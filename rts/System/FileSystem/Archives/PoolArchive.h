@@ -114,6 +114,7 @@ private:
 		uint32_t crc32;
 		uint32_t size;
 		mutable uint32_t modTime;
+		mutable uint64_t inode;
 	};
 	struct FileStat {
 		// inverted cmp for descending order
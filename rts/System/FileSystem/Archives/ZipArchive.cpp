@@ -113,6 +113,53 @@ IArchive::SFileInfo CZipArchive::FileInfo(uint32_t fid) const
 	};
 }
 
+bool CZipArchive::CalcHash(uint32_t fid, sha512::raw_digest& hash, std::vector<std::uint8_t>& fb)
+{
+	assert(IsFileId(fid));
+
+	// bypasses the file-cache and inflates in chunks, hashing
+	// every file of a large archive should not keep it in memory
+	auto scopedSemAcq = AcquireSemaphoreScoped();
+
+	const auto tnum = afi.AcquireScoped();
+	assert(tnum < parallelAccessNum);
+	unzFile& thisThreadZip = zipPerThread[tnum];
+
+	if (!thisThreadZip) {
+		thisThreadZip = unzOpen(GetArchiveFile().c_str());
+	}
+
+	if (thisThreadZip == nullptr)
+		return false;
+
+	unzGoToFilePos(thisThreadZip, &fileEntries[fid].fp);
+
+	if (unzOpenCurrentFile(thisThreadZip) != UNZ_OK)
+		return false;
+
+	sha512::msg_state msg;
+	sha512::init_digest(msg);
+
+	fb.resize(HASH_CHUNK_SIZE);
+
+	int bytesRead = 0;
+
+	while ((bytesRead = unzReadCurrentFile(thisThreadZip, fb.data(), fb.size())) > 0) {
+		sha512::update_digest(msg, fb.data(), bytesRead);
+	}
+
+	// also verifies the CRC once the whole entry was read
+	if (unzCloseCurrentFile(thisThreadZip) == UNZ_CRCERROR || bytesRead < 0)
+		return false;
+
+	// same as IArchive::CalcHash, empty files do not count
+	if (msg.len == 0)
+		return false;
+
+	sha512::final_digest(msg, hash);
+	return true;
+}
+
 // To simplify things, files are always read completely into memory from
 // the zip-file, since zlib does not provide any way of reading more
 // than one file at a time
@@ -41,6 +41,7 @@ public:
 	const std::string& FileName(uint32_t fid) const override;
 	int32_t FileSize(uint32_t fid) const override;
 	SFileInfo FileInfo(uint32_t fid) const override;
+	bool CalcHash(uint32_t fid, sha512::raw_digest& hash, std::vector<std::uint8_t>& fb) override;
 
 	#if 0
 	uint32_t GetCrc32(uint32_t fid) {
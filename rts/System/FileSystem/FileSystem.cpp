@@ -6,12 +6,14 @@
 
 #include "FileSystem.h"
 
+#include <atomic>
 #include <cassert>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <cerrno>
 #include <cstring>
 #include <filesystem>
+#include <random>
 #include <variant>
 
 #include <unistd.h>
@@ -217,6 +219,44 @@ uint32_t FileSystem::GetFileModificationTime(const std::string& file)
 #endif
 }
 
+bool FileSystem::GetFileStatus(const std::string& file, FileStatus& status)
+{
+#ifdef _WIN32
+	auto h = CreateFile(nowide::widen(file).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+	if (h == INVALID_HANDLE_VALUE) {
+		LOG_L(L_WARNING, "[FSA::%s] error '%s' getting status of file '%s'", __func__, Platform::GetLastErrorAsString().c_str(), file.c_str());
+		return false;
+	}
+
+	BY_HANDLE_FILE_INFORMATION info;
+
+	if (!GetFileInformationByHandle(h, &info)) {
+		LOG_L(L_WARNING, "[FSA::%s] error '%s' getting status of file '%s'", __func__, Platform::GetLastErrorAsString().c_str(), file.c_str());
+		CloseHandle(h);
+		return false;
+	}
+
+	CloseHandle(h);
+
+	status.size = (static_cast<int64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+	status.modTime = static_cast<uint32_t>(CTimeUtil::NTFSTimeToTime64(info.ftLastWriteTime.dwLowDateTime, info.ftLastWriteTime.dwHighDateTime));
+	status.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+	return true;
+#else
+	struct stat info;
+
+	if (stat(file.c_str(), &info) != 0) {
+		LOG_L(L_WARNING, "[FSA::%s] error '%s' getting status of file '%s'", __func__, strerror(errno), file.c_str());
+		return false;
+	}
+
+	status.size = info.st_size;
+	status.modTime = info.st_mtime;
+	status.inode = info.st_ino;
+	return true;
+#endif
+}
+
 std::string FileSystem::GetFileModificationDate(const std::string& file)
 {
 	const std::time_t t = GetFileModificationTime(file);
@@ -395,6 +435,51 @@ bool FileSystem::DeleteFile(const std::string& fileStr)
 
 }
 
+bool FileSystem::RenameFile(const std::string& fileStr, const std::string& newFileStr)
+{
+	std::error_code ec;
+	fs::rename(Recoil::filesystem::u8path(fileStr), Recoil::filesystem::u8path(newFileStr), ec);
+
+	return (!ec);
+}
+
+std::string FileSystem::GetUniqueTempName(const std::string& fileStr)
+{
+	// random per process and counted per call, s.t. neither concurrent
+	// processes nor threads of this one ever write the same temporary
+	static const uint32_t processToken = std::random_device{}();
+	static std::atomic<uint32_t> numTempNames = {0};
+
+	return fmt::format("{}.{:08x}{:08x}.tmp", fileStr, processToken, numTempNames.fetch_add(1));
+}
+
+bool FileSystem::WriteFileViaTemp(const std::string& fileStr, const std::function<void(std::ostream&)>& writeFunc)
+{
+	const std::string tempFileStr = GetUniqueTempName(fileStr);
+
+	{
+		nowide::ofstream ofs(tempFileStr.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!ofs.is_open())
+			return false;
+
+		writeFunc(ofs);
+
+		if (!ofs.good()) {
+			ofs.close();
+			DeleteFile(tempFileStr);
+			return false;
+		}
+	}
+
+	if (!RenameFile(tempFileStr, fileStr)) {
+		DeleteFile(tempFileStr);
+		return false;
+	}
+
+	return true;
+}
+
 bool FileSystem::FileExists(const fs::path& path)
 {
 	return fs::exists(path) && !fs::is_directory(path);
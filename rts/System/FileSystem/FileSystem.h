@@ -7,7 +7,9 @@
 #include <string_view>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <initializer_list>
+#include <iosfwd>
 
 /**
  * Native file-system handling abstraction.
@@ -21,6 +23,17 @@ class FileSystem
 public:
 	static bool MkDir(const std::string& dir);
 	static bool DeleteFile(const std::string& file);
+	/// Moves file to newFile, replacing newFile if it already exists
+	static bool RenameFile(const std::string& file, const std::string& newFile);
+	/// Returns a name next to file that no other writer (process or thread) uses, for writing file via RenameFile
+	static std::string GetUniqueTempName(const std::string& file);
+	/**
+	 * Writes file by letting writeFunc fill a unique temporary (binary mode)
+	 * and renaming it over file, s.t. readers only ever see the previous or
+	 * the complete new content. Returns false and removes the temporary if
+	 * it could not be opened, the stream went bad or the rename failed.
+	 */
+	static bool WriteFileViaTemp(const std::string& file, const std::function<void(std::ostream&)>& writeFunc);
 
 	/// Returns true if the file exists, and is not a directory
 	static bool FileExists(const std::filesystem::path& file);
@@ -105,6 +118,20 @@ public:
 	static bool IsReadableFile(const std::string& file);
 
 	static uint32_t GetFileModificationTime(const std::string& file);
+
+	struct FileStatus {
+		int64_t size = -1;
+		uint32_t modTime = 0;
+		uint64_t inode = 0; ///< file index on Windows, 0 if unknown
+	};
+	/**
+	 * @brief get size, modification time and inode in one query
+	 *
+	 * Cheaper than calling GetFileSize and GetFileModificationTime
+	 * separately when (re)scanning many files.
+	 * @return false if the file could not be queried
+	 */
+	static bool GetFileStatus(const std::string& file, FileStatus& status);
 	/**
 	 * Returns the last file modification time formatted in a sort friendly
 	 * way, with second resolution.
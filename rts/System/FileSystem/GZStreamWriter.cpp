@@ -0,0 +1,291 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "GZStreamWriter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <zlib.h>
+#include <nowide/cstdio.hpp>
+
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
+#include "System/Threading/ThreadPool.h"
+
+
+namespace {
+	// gzip member header with a single "RD" extra subfield (RFC 1952)
+	static constexpr size_t MEMBER_HEADER_SIZE = 10 + 2 + 2 + 2 + 4;
+	static constexpr size_t MEMBER_TRAILER_SIZE = 4 + 4;
+
+	void PutLE32(std::uint8_t* dst, std::uint32_t v) {
+		dst[0] = (v >>  0) & 0xFF;
+		dst[1] = (v >>  8) & 0xFF;
+		dst[2] = (v >> 16) & 0xFF;
+		dst[3] = (v >> 24) & 0xFF;
+	}
+}
+
+
+CGZStreamWriter::~CGZStreamWriter()
+{
+	assert(!worker.valid());
+
+	if (file != nullptr)
+		std::fclose(file);
+}
+
+
+bool CGZStreamWriter::Open(const std::string& name, bool viaTempFile)
+{
+	assert(file == nullptr);
+
+	fileName = name;
+	writeName = viaTempFile? FileSystem::GetUniqueTempName(name): name;
+
+	if ((file = nowide::fopen(writeName.c_str(), "wb")) == nullptr) {
+		LOG_L(L_ERROR, "[GZStreamWriter::%s] could not open \"%s\" for writing", __func__, writeName.c_str());
+		return false;
+	}
+
+	curBlock.reserve(BLOCK_SIZE);
+
+	worker = std::async(std::launch::async, [self = shared_from_this()]() { self->WorkerLoop(); });
+	return true;
+}
+
+void CGZStreamWriter::Close(bool keepFile)
+{
+	if (!worker.valid())
+		return;
+
+	QueueBlock();
+	QueueJob(keepFile? JOB_FINISH: JOB_DISCARD, 0, {});
+
+	// NOTE: can not use ThreadPool workers for this, they might already be gone
+	ThreadPool::AddExtJob(std::move(worker));
+}
+
+
+void CGZStreamWriter::Write(const void* data, size_t size)
+{
+	const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+
+	streamSize += size;
+
+	while (size > 0) {
+		const size_t n = std::min(size, BLOCK_SIZE - curBlock.size());
+
+		curBlock.insert(curBlock.end(), bytes, bytes + n);
+
+		bytes += n;
+		size -= n;
+
+		if (curBlock.size() >= BLOCK_SIZE)
+			QueueBlock();
+	}
+}
+
+size_t CGZStreamWriter::WritePatchable(const void* data, size_t size)
+{
+	const size_t streamOffset = streamSize;
+
+	std::vector<std::uint8_t> region(size);
+	std::memcpy(region.data(), data, size);
+
+	// keep the order of the stream
+	QueueBlock();
+	QueueJob(JOB_WRITE_STORED, streamOffset, std::move(region));
+
+	streamSize += size;
+	return streamOffset;
+}
+
+void CGZStreamWriter::Patch(size_t streamOffset, const void* data, size_t size)
+{
+	std::vector<std::uint8_t> region(size);
+	std::memcpy(region.data(), data, size);
+
+	QueueJob(JOB_PATCH_STORED, streamOffset, std::move(region));
+}
+
+
+void CGZStreamWriter::QueueBlock()
+{
+	if (curBlock.empty())
+		return;
+
+	std::vector<std::uint8_t> block;
+
+	{
+		std::lock_guard<spring::mutex> lock(jobMutex);
+
+		if (!freeBlocks.empty()) {
+			block = std::move(freeBlocks.back());
+			freeBlocks.pop_back();
+		}
+	}
+
+	block.clear();
+	block.reserve(BLOCK_SIZE);
+
+	std::swap(block, curBlock);
+	QueueJob(JOB_WRITE_BLOCK, 0, std::move(block));
+}
+
+void CGZStreamWriter::QueueJob(JobType type, size_t streamOffset, std::vector<std::uint8_t>&& data)
+{
+	std::unique_lock<spring::mutex> lock(jobMutex);
+
+	// bounds memory use if compression or disk can not keep up
+	jobCond.wait(lock, [&]() { return (jobs.size() < MAX_QUEUED_BLOCKS); });
+	jobs.push_back({type, streamOffset, std::move(data)});
+	jobCond.notify_all();
+}
+
+
+void CGZStreamWriter::WorkerLoop()
+{
+	Threading::SetThreadName("gzwriter");
+
+	while (true) {
+		Job job;
+
+		{
+			std::unique_lock<spring::mutex> lock(jobMutex);
+
+			jobCond.wait(lock, [&]() { return (!jobs.empty()); });
+			job = std::move(jobs.front());
+			jobs.pop_front();
+			jobCond.notify_all();
+		}
+
+		switch (job.type) {
+			case JOB_WRITE_BLOCK: {
+				WriteMember(job.data, compressionLevel);
+
+				std::lock_guard<spring::mutex> lock(jobMutex);
+				freeBlocks.emplace_back(std::move(job.data));
+			} break;
+
+			case JOB_WRITE_STORED: {
+				const long memberPos = std::ftell(file);
+
+				WriteMember(job.data, Z_NO_COMPRESSION);
+				storedMembers[job.streamOffset] = {memberPos, std::ftell(file) - memberPos};
+			} break;
+
+			case JOB_PATCH_STORED: {
+				const auto it = storedMembers.find(job.streamOffset);
+
+				if (it == storedMembers.end()) {
+					LOG_L(L_ERROR, "[GZStreamWriter::%s] no patchable region at offset %u in \"%s\"", __func__, unsigned(job.streamOffset), fileName.c_str());
+					writeError = true;
+					break;
+				}
+
+				// stored members only depend on the size of their data
+				const long endPos = std::ftell(file);
+
+				std::fseek(file, it->second.first, SEEK_SET);
+				WriteMember(job.data, Z_NO_COMPRESSION);
+
+				if (std::ftell(file) != (it->second.first + it->second.second)) {
+					LOG_L(L_ERROR, "[GZStreamWriter::%s] patch at offset %u changed size in \"%s\"", __func__, unsigned(job.streamOffset), fileName.c_str());
+					writeError = true;
+				}
+
+				std::fseek(file, endPos, SEEK_SET);
+			} break;
+
+			case JOB_FINISH:
+			case JOB_DISCARD: {
+				Finish(job.type == JOB_FINISH);
+				return;
+			} break;
+		}
+	}
+}
+
+void CGZStreamWriter::Finish(bool keepFile)
+{
+	if (std::fclose(file) != 0)
+		writeError = true;
+
+	file = nullptr;
+
+	if (writeError)
+		LOG_L(L_ERROR, "[GZStreamWriter::%s] error writing \"%s\"", __func__, writeName.c_str());
+
+	bool written = (keepFile && !writeError);
+
+	if (writeName != fileName) {
+		if (!written) {
+			FileSystem::DeleteFile(writeName);
+		} else if (!FileSystem::RenameFile(writeName, fileName)) {
+			// replaces any previous file, e.g. an older autosave
+			LOG_L(L_ERROR, "[GZStreamWriter::%s] could not rename \"%s\" to \"%s\"", __func__, writeName.c_str(), fileName.c_str());
+			written = false;
+		}
+	}
+
+	if (finishCallback)
+		finishCallback(written);
+}
+
+
+bool CGZStreamWriter::WriteMember(const std::vector<std::uint8_t>& data, int level)
+{
+	z_stream zs;
+	std::memset(&zs, 0, sizeof(zs));
+
+	// raw deflate, the gzip framing is written below
+	if (deflateInit2(&zs, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return (writeError = true, false);
+
+	memberBuffer.resize(MEMBER_HEADER_SIZE + deflateBound(&zs, data.size()) + MEMBER_TRAILER_SIZE);
+
+	zs.next_in = const_cast<Bytef*>(data.data());
+	zs.avail_in = data.size();
+	zs.next_out = memberBuffer.data() + MEMBER_HEADER_SIZE;
+	zs.avail_out = memberBuffer.size() - MEMBER_HEADER_SIZE - MEMBER_TRAILER_SIZE;
+
+	const int ret = deflate(&zs, Z_FINISH);
+	const size_t deflatedSize = zs.total_out;
+
+	deflateEnd(&zs);
+
+	if (ret != Z_STREAM_END)
+		return (writeError = true, false);
+
+	const size_t memberSize = MEMBER_HEADER_SIZE + deflatedSize + MEMBER_TRAILER_SIZE;
+
+	std::uint8_t* hdr = memberBuffer.data();
+	std::uint8_t* trl = memberBuffer.data() + MEMBER_HEADER_SIZE + deflatedSize;
+
+	hdr[0] = 0x1f; // ID1
+	hdr[1] = 0x8b; // ID2
+	hdr[2] = 8;    // CM=deflate
+	hdr[3] = 4;    // FLG=FEXTRA
+	PutLE32(&hdr[4], 0); // MTIME
+	hdr[8] = 0;    // XFL
+	hdr[9] = 255;  // OS=unknown
+	hdr[10] = 8;   // XLEN
+	hdr[11] = 0;
+	hdr[12] = 'R'; // SI1
+	hdr[13] = 'D'; // SI2
+	hdr[14] = 4;   // LEN
+	hdr[15] = 0;
+	PutLE32(&hdr[16], memberSize);
+
+	PutLE32(&trl[0], crc32(crc32(0, nullptr, 0), data.data(), data.size()));
+	PutLE32(&trl[4], data.size());
+
+	// flushed per member, a crash loses at most the blocks still in memory
+	if (std::fwrite(memberBuffer.data(), 1, memberSize, file) != memberSize || std::fflush(file) != 0)
+		return (writeError = true, false);
+
+	return true;
+}
@@ -0,0 +1,119 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef GZ_STREAM_WRITER_H
+#define GZ_STREAM_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "System/UnorderedMap.hpp"
+#include "System/Threading/SpringThreading.h"
+
+/**
+ * @brief Writes a gzip file from a background thread while data is produced
+ *
+ * Data is collected into blocks of BLOCK_SIZE bytes which a background thread
+ * deflates and appends to the file, each as a separate gzip member. zlib (and
+ * any gunzip) reads such a file as one continuous stream; unlike one single
+ * gzip stream it is readable up to the last written block if the process dies
+ * and it can be seeked block-wise: every member carries an "RD" extra-field
+ * holding its own compressed size, which lets tools walk the members without
+ * inflating them.
+ *
+ * Regions written by WritePatchable become members of their own which are
+ * stored uncompressed, so they keep their size and can be rewritten in place
+ * by Patch at any later time (e.g. headers whose contents are only known at
+ * the end). At most MAX_QUEUED_BLOCKS blocks are waiting for the background
+ * thread at any time, Write blocks when it falls behind.
+ */
+class CGZStreamWriter : public std::enable_shared_from_this<CGZStreamWriter>
+{
+public:
+	static constexpr size_t BLOCK_SIZE = 256 * 1024;
+	static constexpr size_t MAX_QUEUED_BLOCKS = 16;
+
+	CGZStreamWriter(int compressionLevel): compressionLevel(compressionLevel) {}
+	~CGZStreamWriter();
+
+	/**
+	 * creates the file and starts the background thread; if <viaTempFile> is
+	 * true data goes to a uniquely named temporary next to <fileName> which only
+	 * replaces <fileName> when the writer is closed with keepFile=true and no
+	 * error occurred
+	 */
+	bool Open(const std::string& fileName, bool viaTempFile = false);
+	/// flushes pending data and lets the background thread finish writing on its own
+	void Close(bool keepFile = true);
+
+	/// <cb> is called from the background thread after the file was finished, with
+	/// true iff it was kept and written (and renamed, if via a temporary file) without errors
+	void SetFinishCallback(std::function<void(bool)>&& cb) { finishCallback = std::move(cb); }
+
+	bool IsOpen() const { return (file != nullptr); }
+
+	/// appends to the uncompressed stream
+	void Write(const void* data, size_t size);
+	/// appends <data> as a stored region, returns its offset for Patch
+	size_t WritePatchable(const void* data, size_t size);
+	/// replaces a region previously written by WritePatchable, <size> must match
+	void Patch(size_t streamOffset, const void* data, size_t size);
+
+	/// total size of the uncompressed stream so far
+	size_t GetStreamSize() const { return streamSize; }
+
+private:
+	enum JobType {
+		JOB_WRITE_BLOCK  = 0,
+		JOB_WRITE_STORED = 1,
+		JOB_PATCH_STORED = 2,
+		JOB_FINISH       = 3,
+		JOB_DISCARD      = 4,
+	};
+
+	struct Job {
+		JobType type;
+		size_t streamOffset;
+		std::vector<std::uint8_t> data;
+	};
+
+	void QueueJob(JobType type, size_t streamOffset, std::vector<std::uint8_t>&& data);
+	void QueueBlock();
+	void WorkerLoop();
+	void Finish(bool keepFile);
+
+	bool WriteMember(const std::vector<std::uint8_t>& data, int level);
+
+private:
+	std::FILE* file = nullptr;
+	std::string fileName;
+	std::string writeName;
+
+	// only touched by the producing thread
+	std::vector<std::uint8_t> curBlock;
+	size_t streamSize = 0;
+
+	// only touched by the background thread
+	std::vector<std::uint8_t> memberBuffer;
+	// stream offset of each stored member to its file offset and size
+	spring::unordered_map<size_t, std::pair<long, long>> storedMembers;
+	bool writeError = false;
+
+	spring::mutex jobMutex;
+	spring::condition_variable jobCond;
+
+	std::deque<Job> jobs;
+	std::vector< std::vector<std::uint8_t> > freeBlocks;
+
+	std::future<void> worker;
+	std::function<void(bool)> finishCallback;
+
+	int compressionLevel = 9;
+};
+
+#endif // GZ_STREAM_WRITER_H
@@ -0,0 +1,164 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MemoryMappedFile.h"
+
+#include "System/Log/ILog.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+	#include <nowide/convert.hpp>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+#endif
+
+
+CMemoryMappedFile& CMemoryMappedFile::operator = (CMemoryMappedFile&& mmf) noexcept
+{
+	if (this == &mmf)
+		return *this;
+
+	Close();
+
+	std::swap(data, mmf.data);
+	std::swap(size, mmf.size);
+	std::swap(mapMode, mmf.mapMode);
+
+	#ifdef _WIN32
+	std::swap(fileHandle, mmf.fileHandle);
+	std::swap(mappingHandle, mmf.mappingHandle);
+	#endif
+
+	return *this;
+}
+
+
+std::size_t CMemoryMappedFile::GetPageSize()
+{
+	#ifdef _WIN32
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	// views have to start at multiples of this, not just of dwPageSize
+	return si.dwAllocationGranularity;
+	#else
+	return sysconf(_SC_PAGESIZE);
+	#endif
+}
+
+
+#ifdef _WIN32
+bool CMemoryMappedFile::Open(const std::string& path, MapMode mode)
+{
+	Close();
+
+	HANDLE hFile = CreateFileW(nowide::widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (hFile == INVALID_HANDLE_VALUE) {
+		LOG_L(L_WARNING, "[MemoryMappedFile::%s] could not open \"%s\" (error %lu)", __func__, path.c_str(), GetLastError());
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart <= 0) {
+		CloseHandle(hFile);
+		return false;
+	}
+
+	// PAGE_WRITECOPY + FILE_MAP_COPY gives a private view backed by the file
+	const DWORD protect = (mode == MAP_COPY_ON_WRITE)? PAGE_WRITECOPY: PAGE_READONLY;
+	const DWORD access = (mode == MAP_COPY_ON_WRITE)? FILE_MAP_COPY: FILE_MAP_READ;
+
+	HANDLE hMapping = CreateFileMappingW(hFile, nullptr, protect, 0, 0, nullptr);
+
+	if (hMapping == nullptr) {
+		LOG_L(L_WARNING, "[MemoryMappedFile::%s] could not create mapping for \"%s\" (error %lu)", __func__, path.c_str(), GetLastError());
+		CloseHandle(hFile);
+		return false;
+	}
+
+	void* view = MapViewOfFile(hMapping, access, 0, 0, 0);
+
+	if (view == nullptr) {
+		LOG_L(L_WARNING, "[MemoryMappedFile::%s] could not map \"%s\" (error %lu)", __func__, path.c_str(), GetLastError());
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+
+	data = static_cast<std::uint8_t*>(view);
+	size = static_cast<std::size_t>(fileSize.QuadPart);
+	mapMode = mode;
+
+	fileHandle = hFile;
+	mappingHandle = hMapping;
+	return true;
+}
+
+void CMemoryMappedFile::Close()
+{
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mappingHandle != nullptr)
+		CloseHandle(mappingHandle);
+	if (fileHandle != nullptr)
+		CloseHandle(fileHandle);
+
+	data = nullptr;
+	size = 0;
+
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+}
+
+#else
+
+bool CMemoryMappedFile::Open(const std::string& path, MapMode mode)
+{
+	Close();
+
+	const int fd = open(path.c_str(), O_RDONLY);
+
+	if (fd < 0) {
+		LOG_L(L_WARNING, "[MemoryMappedFile::%s] could not open \"%s\" (%s)", __func__, path.c_str(), strerror(errno));
+		return false;
+	}
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	// MAP_PRIVATE with PROT_WRITE makes written pages private copies
+	const int prot = (mode == MAP_COPY_ON_WRITE)? (PROT_READ | PROT_WRITE): PROT_READ;
+	void* view = mmap(nullptr, st.st_size, prot, MAP_PRIVATE, fd, 0);
+
+	// the mapping keeps its own reference to the file
+	close(fd);
+
+	if (view == MAP_FAILED) {
+		LOG_L(L_WARNING, "[MemoryMappedFile::%s] could not map \"%s\" (%s)", __func__, path.c_str(), strerror(errno));
+		return false;
+	}
+
+	data = static_cast<std::uint8_t*>(view);
+	size = static_cast<std::size_t>(st.st_size);
+	mapMode = mode;
+	return true;
+}
+
+void CMemoryMappedFile::Close()
+{
+	if (data != nullptr)
+		munmap(data, size);
+
+	data = nullptr;
+	size = 0;
+}
+#endif
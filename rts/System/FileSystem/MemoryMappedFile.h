@@ -0,0 +1,62 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _MEMORY_MAPPED_FILE_H
+#define _MEMORY_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/**
+ * Maps an entire raw file (no VFS) into the address space of this process.
+ *
+ * READ_ONLY views share their pages with the OS file-cache, so multiple
+ * processes mapping the same file only pay for it once. COPY_ON_WRITE views
+ * are private: pages stay shared until written to, at which point only the
+ * touched page gets duplicated; writes never reach the file on disk.
+ */
+class CMemoryMappedFile
+{
+public:
+	enum MapMode {
+		MAP_READ_ONLY     = 0,
+		MAP_COPY_ON_WRITE = 1,
+	};
+
+	CMemoryMappedFile() = default;
+	CMemoryMappedFile(const CMemoryMappedFile&) = delete;
+	CMemoryMappedFile(CMemoryMappedFile&& mmf) noexcept { *this = std::move(mmf); }
+	~CMemoryMappedFile() { Close(); }
+
+	CMemoryMappedFile& operator = (const CMemoryMappedFile&) = delete;
+	CMemoryMappedFile& operator = (CMemoryMappedFile&& mmf) noexcept;
+
+	/// @param path absolute path of the file; empty files can not be mapped
+	bool Open(const std::string& path, MapMode mode = MAP_READ_ONLY);
+	void Close();
+
+	bool IsOpen() const { return (data != nullptr); }
+	bool IsWritable() const { return (IsOpen() && mapMode == MAP_COPY_ON_WRITE); }
+
+	const std::uint8_t* GetData() const { return data; }
+	      std::uint8_t* GetWritableData() { return (IsWritable()? data: nullptr); }
+
+	std::size_t GetSize() const { return size; }
+
+	/// granularity at which data can be mapped, useful to align file sections
+	static std::size_t GetPageSize();
+
+private:
+	std::uint8_t* data = nullptr;
+	std::size_t size = 0;
+
+	MapMode mapMode = MAP_READ_ONLY;
+
+	#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+	#endif
+};
+
+#endif // _MEMORY_MAPPED_FILE_H
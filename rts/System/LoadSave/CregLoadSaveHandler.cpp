@@ -1,7 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
-#include <zlib.h>
 
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "ExternalAI/EngineOutHandler.h"
@@ -40,11 +41,12 @@
 #include "Sim/Units/Scripts/NullUnitScript.h"
 #include "Sim/Weapons/PlasmaRepulser.h"
 #include "System/SafeUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Platform/errorhandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/GZFileHandler.h"
-#include "System/Threading/ThreadPool.h"
+#include "System/FileSystem/GZStreamWriter.h"
 #include "System/creg/SerializeLuaState.h"
 #include "System/creg/Serializer.h"
 #include "System/Exceptions.h"
@@ -52,6 +54,8 @@
 
 #define MAX_STRING_SIZE (1 << 19) // 512kB excluding null-term
 
+CONFIG(int, SaveGameCompressionLevel).defaultValue(5).minimumValue(0).maximumValue(9).description("zlib compression level of savegames, higher levels produce smaller files but take longer to write.");
+
 
 CCregLoadSaveHandler::CCregLoadSaveHandler()
 {}
@@ -214,6 +218,216 @@ static void PrintSize(const char* txt, int size)
 		LOG("%s %u B",    txt, size);
 	}
 }
+
+
+namespace {
+	/**
+	 * Feeds the serialized game directly into a CGZStreamWriter so it never
+	 * has to be held in memory as a whole. Apart from tellp, the only seeks
+	 * creg does are back to a package header and forward to the end again;
+	 * such headers must be announced with ReservePatchable beforehand and
+	 * are written as regions the writer can still overwrite.
+	 */
+	class CSaveGameStreamBuf: public std::streambuf {
+	public:
+		CSaveGameStreamBuf(std::shared_ptr<CGZStreamWriter> w): writer(std::move(w)) {
+			putBuffer.resize(PUT_BUFFER_SIZE);
+			ResetPutArea();
+		}
+		~CSaveGameStreamBuf() override {
+			// no-op unless an exception skipped Close
+			writer->Close(false);
+		}
+
+		/// the next <size> bytes written can be overwritten after seeking back to them
+		void ReservePatchable(size_t size) {
+			FinishPatch();
+			FlushPutArea();
+
+			regions.push_back({writer->GetStreamSize(), {}});
+			regions.back().data.reserve(reserveSize = size);
+
+			mode = MODE_RESERVE;
+			setp(nullptr, nullptr);
+		}
+
+		void Close(bool keepFile) {
+			FinishPatch();
+			FlushPutArea();
+
+			writer->Close(keepFile && mode == MODE_WRITE);
+		}
+
+	protected:
+		int_type overflow(int_type c) override {
+			if (traits_type::eq_int_type(c, traits_type::eof()))
+				return (traits_type::not_eof(c));
+
+			const char_type ch = traits_type::to_char_type(c);
+			return ((xsputn(&ch, 1) == 1)? c: traits_type::eof());
+		}
+
+		std::streamsize xsputn(const char_type* s, std::streamsize n) override {
+			switch (mode) {
+				case MODE_WRITE: {
+					if (n <= (epptr() - pptr())) {
+						std::memcpy(pptr(), s, n);
+						pbump(n);
+						return n;
+					}
+
+					FlushPutArea();
+					writer->Write(s, n);
+					return n;
+				} break;
+
+				case MODE_RESERVE: {
+					Region& region = regions.back();
+
+					const std::streamsize k = std::min<std::streamsize>(n, reserveSize - region.data.size());
+
+					region.data.insert(region.data.end(), s, s + k);
+
+					if (region.data.size() < reserveSize)
+						return k;
+
+					writer->WritePatchable(region.data.data(), region.data.size());
+
+					mode = MODE_WRITE;
+					ResetPutArea();
+
+					return (k + ((k < n)? xsputn(s + k, n - k): 0));
+				} break;
+
+				case MODE_PATCH: {
+					Region& region = regions[patchRegion];
+
+					if ((patchPos + n) > region.data.size())
+						return 0;
+
+					std::memcpy(region.data.data() + patchPos, s, n);
+					patchPos += n;
+					return n;
+				} break;
+			}
+
+			return 0;
+		}
+
+		pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+			switch (dir) {
+				case std::ios_base::beg: { return (seekpos(off, which)); } break;
+				case std::ios_base::cur: { return ((off == 0)? pos_type(Tell()): seekpos(Tell() + off, which)); } break;
+				case std::ios_base::end: { return (seekpos(EndPos() + off, which)); } break;
+				default: break;
+			}
+
+			return pos_type(off_type(-1));
+		}
+
+		pos_type seekpos(pos_type sp, std::ios_base::openmode which) override {
+			const off_type pos = sp;
+
+			if ((which & std::ios_base::out) == 0)
+				return pos_type(off_type(-1));
+			if (pos == Tell())
+				return sp;
+			if (mode == MODE_RESERVE)
+				return pos_type(off_type(-1));
+
+			FinishPatch();
+
+			if (pos == EndPos())
+				return sp;
+
+			FlushPutArea();
+
+			for (size_t i = 0; i < regions.size(); i++) {
+				const Region& region = regions[i];
+
+				if (pos < off_type(region.offset) || pos >= off_type(region.offset + region.data.size()))
+					continue;
+
+				mode = MODE_PATCH;
+				patchRegion = i;
+				patchPos = pos - region.offset;
+
+				setp(nullptr, nullptr);
+				return sp;
+			}
+
+			// everything else has already been handed to the writer
+			return pos_type(off_type(-1));
+		}
+
+		int sync() override {
+			if (mode == MODE_WRITE)
+				FlushPutArea();
+
+			return 0;
+		}
+
+	private:
+		enum Mode {
+			MODE_WRITE   = 0,
+			MODE_RESERVE = 1,
+			MODE_PATCH   = 2,
+		};
+
+		struct Region {
+			size_t offset;
+			std::vector<std::uint8_t> data;
+		};
+
+		static constexpr size_t PUT_BUFFER_SIZE = 64 * 1024;
+
+		off_type Tell() const {
+			switch (mode) {
+				case MODE_WRITE  : { return (writer->GetStreamSize() + (pptr() - pbase())); } break;
+				case MODE_RESERVE: { return (regions.back().offset + regions.back().data.size()); } break;
+				case MODE_PATCH  : { return (regions[patchRegion].offset + patchPos); } break;
+			}
+
+			return 0;
+		}
+		off_type EndPos() const {
+			// the put area is always flushed while patching
+			return ((mode == MODE_PATCH)? writer->GetStreamSize(): Tell());
+		}
+
+		void ResetPutArea() { setp(putBuffer.data(), putBuffer.data() + putBuffer.size()); }
+		void FlushPutArea() {
+			if (mode != MODE_WRITE)
+				return;
+
+			writer->Write(pbase(), pptr() - pbase());
+			ResetPutArea();
+		}
+		void FinishPatch() {
+			if (mode != MODE_PATCH)
+				return;
+
+			const Region& region = regions[patchRegion];
+
+			writer->Patch(region.offset, region.data.data(), region.data.size());
+
+			mode = MODE_WRITE;
+			ResetPutArea();
+		}
+
+	private:
+		std::shared_ptr<CGZStreamWriter> writer;
+
+		std::vector<char> putBuffer;
+		std::vector<Region> regions;
+
+		Mode mode = MODE_WRITE;
+
+		size_t reserveSize = 0;
+		size_t patchRegion = 0;
+		size_t patchPos = 0;
+	};
+}
 #endif //USING_CREG
 
 static void ReadString(std::istream& s, std::string& str)
@@ -225,10 +439,11 @@ static void ReadString(std::istream& s, std::string& str)
 }
 
 
-static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer& os, std::stringstream& oss)
+static void SaveLuaState(CSplitLuaHandle* handle, creg::COutputStreamSerializer& os, std::ostream& oss, CSaveGameStreamBuf& sbuf)
 {
 	CLuaStateCollector lsc;
 	lsc.Read(handle);
+	sbuf.ReservePatchable(creg::COutputStreamSerializer::GetPackageHeaderSize());
 	os.SavePackage(&oss, &lsc, lsc.GetClass());
 }
 
@@ -261,7 +476,22 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 	selectedUnitsHandler.ClearSelected();
 
 	try {
-		std::stringstream oss;
+		const std::string fileName = dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE);
+		const auto writer = std::make_shared<CGZStreamWriter>(configHandler->GetInt("SaveGameCompressionLevel"));
+
+		// written to a temporary file first, a failed save must not destroy an older one
+		if (!writer->Open(fileName, true)) {
+			LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
+			NotifyWritten(false);
+			return;
+		}
+
+		// the save is only complete once the writer has renamed the file
+		writer->SetFinishCallback(std::move(writtenCallback));
+
+		// compression and disk I/O happen on the writer's thread while serializing
+		CSaveGameStreamBuf sbuf(writer);
+		std::ostream oss(&sbuf);
 
 		// write our own header. SavePackage() will add its own
 		WriteString(oss, SpringVersion::GetSync());
@@ -277,13 +507,14 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 
 			// save lua state first as lua unit scripts depend on it
 			const int luaStart = oss.tellp();
-			SaveLuaState(luaGaia, os, oss);
-			SaveLuaState(luaRules, os, oss);
+			SaveLuaState(luaGaia, os, oss, sbuf);
+			SaveLuaState(luaRules, os, oss, sbuf);
 			PrintSize("Lua", ((int)oss.tellp()) - luaStart);
 
 			// save creg state
 			const int gameStart = oss.tellp();
 			CGameStateCollector gsc;
+			sbuf.ReservePatchable(creg::COutputStreamSerializer::GetPackageHeaderSize());
 			os.SavePackage(&oss, &gsc, gsc.GetClass());
 			PrintSize("Game", ((int)oss.tellp()) - gameStart);
 
@@ -303,25 +534,12 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 			PrintSize("AIs", ((int)oss.tellp()) - aiStart);
 		}
 
-		{
-			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb5");
+		oss.flush();
 
-			if (file == nullptr) {
-				LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
-				return;
-			}
-
-			std::string data = oss.str();
-			std::function<void(gzFile, std::string&&)> func = [](gzFile file, std::string&& data) {
-				gzwrite(file, data.c_str(), data.size());
-				gzflush(file, Z_FINISH);
-				gzclose(file);
-			};
+		if (!oss.good())
+			LOG_L(L_ERROR, "[LSH::%s] error writing save-file", __func__);
 
-			// gzFile is just a plain typedef (struct gzFile_s {}* gzFile), can be copied
-			// need to keep a reference to the future around or its destructor will block
-			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
-		}
+		sbuf.Close(oss.good());
 
 		//FIXME add lua state
 	} catch (const content_error& ex) {
@@ -335,8 +553,12 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 	} catch (...) {
 		LOG_L(L_ERROR, "[LSH::%s] unknown error", __func__);
 	}
+
+	// not handed to the writer if an exception was thrown before
+	NotifyWritten(false);
 #else //USING_CREG
 	LOG_L(L_ERROR, "[LSH::%s] creg is disabled", __func__);
+	NotifyWritten(false);
 #endif //USING_CREG
 }
 
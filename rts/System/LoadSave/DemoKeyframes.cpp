@@ -0,0 +1,131 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoKeyframes.h"
+
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef CreateDirectory
+#undef CreateDirectory
+#endif
+
+
+CDemoKeyframeIndex::CDemoKeyframeIndex(const std::string& demoName, const DemoFileHeader& demoHeader)
+{
+	keyframeDir = dataDirsAccess.LocateDir("demos/keyframes/" + FileSystem::GetBasename(demoName), FileQueryFlags::WRITE);
+	keyframeDir = FileSystem::EnsurePathSepAtEnd(keyframeDir);
+
+	char buf[sizeof(demoHeader.gameID) * 2 + 1] = {0};
+
+	for (size_t i = 0; i < sizeof(demoHeader.gameID); i++) {
+		snprintf(&buf[i * 2], 3, "%02x", demoHeader.gameID[i]);
+	}
+
+	gameIDStr = buf;
+}
+
+
+bool CDemoKeyframeIndex::Load()
+{
+	keyframes.clear();
+
+	std::ifstream ifs(GetIndexFileName());
+
+	if (!ifs.is_open())
+		return false;
+
+	std::string line;
+	std::string tag;
+	std::string fileID;
+
+	// header line: "gameid <hex>"
+	if (!std::getline(ifs, line))
+		return false;
+
+	std::istringstream(line) >> tag >> fileID;
+
+	if (tag != "gameid" || fileID != gameIDStr) {
+		LOG_L(L_WARNING, "[DemoKeyframeIndex::%s] ignoring stale keyframe index \"%s\" (gameid %s, expected %s)", __func__, GetIndexFileName().c_str(), fileID.c_str(), gameIDStr.c_str());
+		return false;
+	}
+
+	// keyframe lines: "<frame> <filePos> <bytesRemaining> <saveFile>"
+	while (std::getline(ifs, line)) {
+		DemoKeyframe kf;
+		std::string saveName;
+		std::istringstream iss(line);
+
+		if (!(iss >> kf.pos.frameNum >> kf.pos.filePos >> kf.pos.bytesRemaining >> saveName))
+			continue;
+
+		kf.saveFile = keyframeDir + saveName;
+
+		// a keyframe whose savegame never made it to disk is useless
+		if (!FileSystem::FileExists(kf.saveFile))
+			continue;
+
+		keyframes.push_back(std::move(kf));
+	}
+
+	std::sort(keyframes.begin(), keyframes.end(), [](const DemoKeyframe& a, const DemoKeyframe& b) { return (a.pos.frameNum < b.pos.frameNum); });
+
+	LOG("[DemoKeyframeIndex::%s] loaded %u keyframes from \"%s\"", __func__, static_cast<unsigned>(keyframes.size()), GetIndexFileName().c_str());
+	return (!keyframes.empty());
+}
+
+
+bool CDemoKeyframeIndex::Append(const DemoKeyframe& keyframe)
+{
+	if (!FileSystem::CreateDirectory(keyframeDir))
+		return false;
+
+	const bool newIndex = !FileSystem::FileExists(GetIndexFileName());
+
+	// (re)start the index if it belongs to another demo
+	std::ofstream ofs(GetIndexFileName(), (newIndex || keyframes.empty())? std::ios::trunc: std::ios::app);
+
+	if (!ofs.is_open()) {
+		LOG_L(L_ERROR, "[DemoKeyframeIndex::%s] could not open \"%s\" for writing", __func__, GetIndexFileName().c_str());
+		return false;
+	}
+
+	if (newIndex || keyframes.empty())
+		ofs << "gameid " << gameIDStr << "\n";
+
+	ofs << keyframe.pos.frameNum << " " << keyframe.pos.filePos << " " << keyframe.pos.bytesRemaining << " " << FileSystem::GetFilename(keyframe.saveFile) << "\n";
+
+	const auto pred = [](const DemoKeyframe& a, const DemoKeyframe& b) { return (a.pos.frameNum < b.pos.frameNum); };
+	const auto iter = std::upper_bound(keyframes.begin(), keyframes.end(), keyframe, pred);
+
+	keyframes.insert(iter, keyframe);
+	return true;
+}
+
+
+const DemoKeyframe* CDemoKeyframeIndex::FindNearest(int minFrameNum, int maxFrameNum) const
+{
+	for (auto it = keyframes.rbegin(); it != keyframes.rend(); ++it) {
+		if (it->pos.frameNum > maxFrameNum)
+			continue;
+		if (it->pos.frameNum <= minFrameNum)
+			break;
+
+		return &(*it);
+	}
+
+	return nullptr;
+}
+
+
+std::string CDemoKeyframeIndex::GetSaveFileName(int frameNum) const
+{
+	return (keyframeDir + IntToString(frameNum) + ".ssf");
+}
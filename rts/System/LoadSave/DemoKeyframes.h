@@ -0,0 +1,79 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_KEYFRAMES_H
+#define DEMO_KEYFRAMES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "demofile.h"
+
+/**
+ * @brief Position of the demo stream just after a NETMSG_{NEW,KEY}FRAME packet
+ *
+ * Enough to make CDemoReader resume reading the stream at the chunk which
+ * follows the frame packet, see CDemoReader::{Get,Seek}StreamPos.
+ */
+struct DemoStreamPos
+{
+	int frameNum = -1;
+	std::int64_t filePos = 0;        ///< offset of the DemoStreamChunkHeader of the next chunk
+	std::int64_t bytesRemaining = 0; ///< stream bytes left, including the next chunk header
+};
+
+
+/**
+ * @brief Keyframe stored alongside a demo
+ *
+ * Pairs a creg savegame taken at the end of <pos.frameNum> with the position
+ * of the demo stream at that frame, so playback can start from the savegame
+ * and only needs to resimulate the frames after it.
+ */
+struct DemoKeyframe
+{
+	DemoStreamPos pos;
+	std::string saveFile; ///< absolute path of the keyframe's savegame
+};
+
+
+/**
+ * @brief Sidecar index of keyframes for one demo
+ *
+ * Keyframes live in demos/keyframes/<demo basename>/ inside the write-dir;
+ * the directory holds a plain-text "index.txt" and one <frame>.ssf savegame
+ * per keyframe. The index is tied to the demo through its game-ID so stale
+ * sidecars (e.g. from a re-recorded demo of the same name) are ignored.
+ */
+class CDemoKeyframeIndex
+{
+public:
+	CDemoKeyframeIndex(const std::string& demoName, const DemoFileHeader& demoHeader);
+
+	/// read the index from disk; returns false if absent or not matching the demo
+	bool Load();
+	/// append a keyframe to the on-disk index (savegame must be written by caller)
+	bool Append(const DemoKeyframe& keyframe);
+
+	/// @return latest keyframe with minFrameNum < frameNum <= maxFrameNum, or nullptr
+	const DemoKeyframe* FindNearest(int minFrameNum, int maxFrameNum) const;
+
+	std::string GetSaveFileName(int frameNum) const;
+
+	bool Empty() const { return keyframes.empty(); }
+
+	const std::string& GetDirectory() const { return keyframeDir; }
+	const std::vector<DemoKeyframe>& GetKeyframes() const { return keyframes; }
+
+private:
+	std::string GetIndexFileName() const { return (keyframeDir + "index.txt"); }
+
+private:
+	std::string keyframeDir;
+	std::string gameIDStr;
+
+	// sorted by frame
+	std::vector<DemoKeyframe> keyframes;
+};
+
+#endif // DEMO_KEYFRAMES_H
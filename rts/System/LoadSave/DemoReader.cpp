@@ -153,6 +153,51 @@ bool CDemoReader::ReachedEnd()
 }
 
 
+DemoStreamPos CDemoReader::GetStreamPos(int frameNum)
+{
+	DemoStreamPos pos;
+
+	if (ReachedEnd())
+		return pos;
+
+	// the header of the next chunk has already been consumed
+	pos.frameNum = frameNum;
+	pos.filePos = playbackDemo->GetPos() - sizeof(chunkHeader);
+	pos.bytesRemaining = bytesRemaining + sizeof(chunkHeader);
+	return pos;
+}
+
+bool CDemoReader::SeekStreamPos(const DemoStreamPos& pos, float curTime)
+{
+	const std::int64_t streamStart = fileHeader.headerSize + fileHeader.scriptSize;
+
+	if (pos.filePos < streamStart || pos.bytesRemaining <= 0)
+		return false;
+	if ((pos.filePos + static_cast<std::int64_t>(sizeof(chunkHeader))) > playbackDemoSize)
+		return false;
+	if (pos.bytesRemaining > (playbackDemoSize - pos.filePos))
+		return false;
+
+	DemoStreamChunkHeader posChunkHeader;
+
+	const int curPos = playbackDemo->GetPos();
+	playbackDemo->Seek(pos.filePos);
+
+	if (playbackDemo->Read((char*)&posChunkHeader, sizeof(posChunkHeader)) < sizeof(posChunkHeader)) {
+		playbackDemo->Seek(curPos);
+		return false;
+	}
+
+	chunkHeader = posChunkHeader;
+	chunkHeader.swab();
+	bytesRemaining = pos.bytesRemaining - sizeof(chunkHeader);
+
+	demoTimeOffset = curTime - chunkHeader.modGameTime;
+	nextDemoReadTime = curTime;
+	return true;
+}
+
+
 void CDemoReader::LoadStats()
 {
 	// Stats are not available if Spring crashed while writing the demo.
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "Demo.h"
+#include "DemoKeyframes.h"
 
 #include "Game/Players/PlayerStatistics.h"
 #include "Sim/Misc/TeamStatistics.h"
@@ -39,6 +40,19 @@ public:
 	*/
 	bool ReachedEnd();
 
+	/**
+	@brief position of the chunk that will be returned by the next GetData call
+	@param frameNum frame the stream position belongs to
+	*/
+	DemoStreamPos GetStreamPos(int frameNum);
+
+	/**
+	@brief make the next GetData call return the chunk at <pos>
+	@param curTime time at which that chunk should become readable
+	@return false if <pos> does not point at a valid chunk
+	*/
+	bool SeekStreamPos(const DemoStreamPos& pos, float curTime);
+
 	float GetModGameTime() const { return chunkHeader.modGameTime; }
 	float GetDemoTimeOffset() const { return demoTimeOffset; }
 	float GetNextDemoReadTime() const { return nextDemoReadTime; }
@@ -26,20 +26,32 @@ ILoadSaveHandler* ILoadSaveHandler::CreateHandler(const std::string& saveFile)
 
 bool ILoadSaveHandler::CreateSave(
 	const std::string& saveFile,
-	const std::string& saveArgs
+	const std::string& saveArgs,
+	std::function<void(bool)>&& onWritten
 ) {
-	if (!FileSystem::CreateDirectory("Saves"))
+	if (!FileSystem::CreateDirectory("Saves")) {
+		if (onWritten)
+			onWritten(false);
+
 		return false;
+	}
 
 	if (saveArgs != "-y" && FileSystem::FileExists(saveFile)) {
 		LOG_L(L_WARNING, "[ILoadSaveHandler::%s] file \"%s\" already exists (use /save <filename> -y to override)", __func__, saveFile.c_str());
+
+		if (onWritten)
+			onWritten(false);
+
 		return false;
 	}
 
 	ILoadSaveHandler* ls = CreateHandler(saveFile);
 
+	ls->writtenCallback = std::move(onWritten);
 	ls->SaveInfo(gameSetup->mapName, gameSetup->mapName);
 	ls->SaveGame(saveFile);
+	// handlers that write synchronously are done at this point
+	ls->NotifyWritten(true);
 	LOG("[ILoadSaveHandler::%s] saved game to file \"%s\"", __func__, saveFile.c_str());
 	delete ls;
 	return true;
@@ -3,12 +3,18 @@
 #ifndef _LOAD_SAVE_HANDLER_H
 #define _LOAD_SAVE_HANDLER_H
 
+#include <functional>
 #include <string>
+#include <utility>
 
 
 struct SaveFileData {
 	std::string name; // "saves/quicksave.ssf"
 	std::string args; // "-y"
+
+	// called once the file is complete (true) or the save failed (false),
+	// possibly from the thread writing it
+	std::function<void(bool)> onWritten;
 };
 
 class ILoadSaveHandler
@@ -16,12 +22,12 @@ class ILoadSaveHandler
 public:
 	static ILoadSaveHandler* CreateHandler(const std::string& saveFile);
 
-	static bool CreateSave(const std::string& saveFile, const std::string& saveArgs);
+	static bool CreateSave(const std::string& saveFile, const std::string& saveArgs, std::function<void(bool)>&& onWritten = {});
 	static bool CreateSave(SaveFileData fileData) {
 		if (fileData.name.empty())
 			return false;
 
-		return (CreateSave(fileData.name, fileData.args));
+		return (CreateSave(fileData.name, fileData.args, std::move(fileData.onWritten)));
 	}
 
 protected:
@@ -43,10 +49,19 @@ public:
 
 	const std::string& GetScriptText() const { return scriptText; }
 
+protected:
+	/// no-op if the callback was already handed on, e.g. to a background writer
+	void NotifyWritten(bool written) {
+		if (writtenCallback)
+			std::exchange(writtenCallback, {})(written);
+	}
+
 protected:
 	std::string scriptText;
 	std::string mapName;
 	std::string modName;
+
+	std::function<void(bool)> writtenCallback;
 };
 
 
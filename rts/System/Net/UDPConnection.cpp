@@ -27,6 +27,9 @@ using namespace asio;
 static constexpr unsigned udpMaxPacketSize = 4096;
 static constexpr int maxChunkSize = 254;
 static constexpr int chunksPerSec = 30;
+// packets made of more buffers than this are copied into one before sending;
+// asio passes at most 16 (64 on some platforms) buffers per call to the OS
+static constexpr size_t maxSendBuffers = 16;
 
 
 
@@ -96,9 +99,12 @@ public:
 		pos += sizeof(t);
 	}
 
-	void Unpack(std::vector<std::uint8_t>& t, unsigned unpackLength) {
-		std::copy(data + pos, data + pos + unpackLength, std::back_inserter(t));
-		pos += unpackLength;
+	void Skip(unsigned skipLength) {
+		pos += skipLength;
+	}
+
+	const unsigned char* Pos() const {
+		return (data + pos);
 	}
 
 	unsigned Remaining() const {
@@ -119,16 +125,20 @@ public:
 	}
 
 	template<typename T>
-	void Pack(T& t) {
+	void Pack(const T& t) {
 		const size_t pos = data.size();
 		data.resize(pos + sizeof(T));
 		*reinterpret_cast<T*>(&data[pos]) = t;
 	}
 
-	void Pack(std::vector<std::uint8_t>& _data) {
+	void Pack(const std::vector<std::uint8_t>& _data) {
 		std::copy(_data.begin(), _data.end(), std::back_inserter(data));
 	}
 
+	void Pack(const std::uint8_t* _data, unsigned length) {
+		std::copy(_data, _data + length, std::back_inserter(data));
+	}
+
 private:
 	std::vector<std::uint8_t>& data;
 };
@@ -140,9 +150,65 @@ void Chunk::UpdateChecksum(CRC& crc) const {
 	crc << chunkNumber;
 	crc << (unsigned int)chunkSize;
 
-	if (!data.empty()) {
-		crc.Update(&data[0], data.size());
+	if (chunkSize > 0) {
+		crc.Update(GetData(), chunkSize);
+	}
+}
+
+
+
+void ChunkBuffer::PushBack(std::int32_t chunkNumber, const std::uint8_t* data, unsigned length)
+{
+	assert(length <= Chunk::maxSize);
+	assert(empty() || chunkNumber == (frontNumber + static_cast<std::int32_t>(numChunks)));
+
+	if (numChunks == capacity())
+		Grow();
+
+	if (empty())
+		frontNumber = chunkNumber;
+
+	std::uint8_t* slot = GetSlot(numChunks++);
+	const std::uint8_t chunkSize = length;
+
+	memcpy(slot, &chunkNumber, sizeof(chunkNumber));
+	memcpy(slot + sizeof(chunkNumber), &chunkSize, sizeof(chunkSize));
+	memcpy(slot + Chunk::headerSize, data, length);
+}
+
+void ChunkBuffer::PopFront()
+{
+	assert(!empty());
+
+	head = (head + 1) & (capacity() - 1);
+	numChunks -= 1;
+	frontNumber += 1;
+}
+
+Chunk ChunkBuffer::operator [] (size_t i) const
+{
+	assert(i < numChunks);
+
+	const std::uint8_t* slot = GetSlot(i);
+
+	Chunk chunk;
+	chunk.chunkNumber = frontNumber + i;
+	chunk.chunkSize = slot[sizeof(chunk.chunkNumber)];
+	chunk.bytes = slot;
+	return chunk;
+}
+
+void ChunkBuffer::Grow()
+{
+	std::vector<std::uint8_t> newSlots(std::max(capacity() * 2, minCapacity) * slotSize);
+
+	// unroll the ring, oldest chunk first
+	for (size_t i = 0; i < numChunks; i++) {
+		memcpy(&newSlots[i * slotSize], GetSlot(i), slotSize);
 	}
+
+	slots.swap(newSlots);
+	head = 0;
 }
 
 
@@ -171,15 +237,16 @@ Packet::Packet(const unsigned char* data, unsigned length)
 	chunks.reserve(buf.Remaining() / Chunk::headerSize);
 
 	while (buf.Remaining() > Chunk::headerSize) {
-		ChunkPtr temp(new Chunk);
-		buf.Unpack(temp->chunkNumber);
-		buf.Unpack(temp->chunkSize);
+		Chunk temp;
+		temp.bytes = buf.Pos();
+		buf.Unpack(temp.chunkNumber);
+		buf.Unpack(temp.chunkSize);
 
 		// defective, ignore
-		if (buf.Remaining() < temp->chunkSize)
+		if (buf.Remaining() < temp.chunkSize)
 			break;
 
-		buf.Unpack(temp->data, temp->chunkSize);
+		buf.Skip(temp.chunkSize);
 		chunks.push_back(temp);
 	}
 }
@@ -189,8 +256,8 @@ unsigned Packet::GetSize() const
 {
 	unsigned size = headerSize + naks.size();
 
-	for (auto chk = chunks.begin(); chk != chunks.end(); ++chk)
-		size += (*chk)->GetSize();
+	for (const Chunk& chunk: chunks)
+		size += chunk.GetSize();
 
 	return size;
 }
@@ -204,27 +271,31 @@ std::uint8_t Packet::GetChecksum() const
 	if (!naks.empty())
 		crc.Update(&naks[0], naks.size());
 
-	for (auto chk = chunks.begin(); chk != chunks.end(); ++chk)
-		(*chk)->UpdateChecksum(crc);
+	for (const Chunk& chunk: chunks)
+		chunk.UpdateChecksum(crc);
 
 	return (std::uint8_t)crc.GetDigest();
 }
 
-void Packet::Serialize(std::vector<std::uint8_t>& data)
+void Packet::SerializeHeader(std::vector<std::uint8_t>& data) const
 {
 	data.clear();
-	data.reserve(GetSize());
 
 	Packer buf(data);
 	buf.Pack(lastContinuous);
 	buf.Pack(nakType);
 	buf.Pack(checksum);
 	buf.Pack(naks);
+}
 
-	for (auto ci = chunks.begin(); ci != chunks.end(); ++ci) {
-		buf.Pack((*ci)->chunkNumber);
-		buf.Pack((*ci)->chunkSize);
-		buf.Pack((*ci)->data);
+void Packet::Serialize(std::vector<std::uint8_t>& data) const
+{
+	data.reserve(GetSize());
+	SerializeHeader(data);
+
+	// chunks are already in wire representation
+	for (const Chunk& chunk: chunks) {
+		std::copy(chunk.bytes, chunk.bytes + chunk.GetSize(), std::back_inserter(data));
 	}
 }
 
@@ -489,8 +560,8 @@ void UDPConnection::UpdateResendRequests()
 {
 	using P = decltype(resendRequested)::value_type;
 
-	const auto cmpPred = [](const P& a, const P& b) { return (a.first <  b.first); };
-	const auto dupPred = [](const P& a, const P& b) { return (a.first == b.first); };
+	const auto cmpPred = [](const P& a, const P& b) { return (a <  b); };
+	const auto dupPred = [](const P& a, const P& b) { return (a == b); };
 
 	// sort by chunk-number
 	std::sort(resendRequested.begin(), resendRequested.end(), cmpPred);
@@ -508,7 +579,7 @@ void UDPConnection::UpdateResendRequests()
 		return;
 
 	{
-		const auto pred = [&](const std::pair<std::int32_t, ChunkPtr>& p) { return (erasedResendChunks.find(p.first) != erasedResendChunks.end()); };
+		const auto pred = [&](const std::int32_t chunkNumber) { return (erasedResendChunks.find(chunkNumber) != erasedResendChunks.end()); };
 
 		const auto beg = resendRequested.begin();
 		const auto end = resendRequested.end();
@@ -542,7 +613,7 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	}
 
 	if (incoming.lastContinuous < 0 && lastInOrder >= 0 &&
-		(unackedChunks.empty() || unackedChunks[0]->chunkNumber > 0)) {
+		(numUnackedChunks == 0 || chunkBuffer[0].chunkNumber > 0)) {
 		LOG_L(L_WARNING, "\t[%s] discarding superfluous reconnection attempt", __func__);
 		return;
 	}
@@ -551,18 +622,18 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	AckChunks(incoming.lastContinuous);
 	UpdateResendRequests();
 
-	if (!unackedChunks.empty()) {
+	if (numUnackedChunks > 0) {
 		const int nextCont = incoming.lastContinuous + 1;
-		const int unAckDiff = unackedChunks[0]->chunkNumber - nextCont;
+		const int unAckDiff = chunkBuffer[0].chunkNumber - nextCont;
 
 		if (-256 <= unAckDiff && unAckDiff <= 256) {
 			if (incoming.nakType < 0) {
 				for (int i = 0; i != -incoming.nakType; ++i) {
 					const int unAckPos = i + unAckDiff;
 
-					if (unAckPos >= 0 && unAckPos < unackedChunks.size()) {
-						assert(unackedChunks[unAckPos]->chunkNumber == nextCont + i);
-						RequestResend(unackedChunks[unAckPos], true);
+					if (unAckPos >= 0 && unAckPos < numUnackedChunks) {
+						assert(chunkBuffer[unAckPos].chunkNumber == nextCont + i);
+						RequestResend(chunkBuffer[unAckPos].chunkNumber, true);
 					}
 				}
 			} else if (incoming.nakType > 0) {
@@ -574,15 +645,15 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 					while (unAckPos < (unAckDiff + incoming.naks[i])) {
 						// if there are gaps in the array, assume that further resends are not needed
-						if (unAckPos < unackedChunks.size())
-							erasedResendChunks.insert(unackedChunks[unAckPos]->chunkNumber);
+						if (unAckPos < numUnackedChunks)
+							erasedResendChunks.insert(chunkBuffer[unAckPos].chunkNumber);
 
 						++unAckPos;
 					}
 
-					if (unAckPos < unackedChunks.size()) {
-						assert(unackedChunks[unAckPos]->chunkNumber == (nextCont + incoming.naks[i]));
-						RequestResend(unackedChunks[unAckPos], true);
+					if (unAckPos < numUnackedChunks) {
+						assert(chunkBuffer[unAckPos].chunkNumber == (nextCont + incoming.naks[i]));
+						RequestResend(chunkBuffer[unAckPos].chunkNumber, true);
 					}
 
 					++unAckPos;
@@ -594,14 +665,14 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	}
 
 
-	for (const std::shared_ptr<netcode::Chunk>& c: incoming.chunks) {
-		if ((lastInOrder >= c->chunkNumber) || incomingChunkNums.find(c->chunkNumber) != incomingChunkNums.end()) {
+	for (const Chunk& c: incoming.chunks) {
+		if ((lastInOrder >= c.chunkNumber) || incomingChunkNums.find(c.chunkNumber) != incomingChunkNums.end()) {
 			++droppedChunks;
 			continue;
 		}
 
-		waitingPackets.emplace_back(c->chunkNumber, RawPacket(&c->data[0], c->data.size()));
-		incomingChunkNums.insert(c->chunkNumber);
+		waitingPackets.emplace_back(c.chunkNumber, RawPacket(c.GetData(), c.chunkSize));
+		incomingChunkNums.insert(c.chunkNumber);
 	}
 
 
@@ -835,11 +906,7 @@ void UDPConnection::SetMTU(unsigned mtu2)
 void UDPConnection::CreateChunk(const unsigned char* data, const unsigned length, const int packetNum)
 {
 	assert((length > 0) && (length < 255));
-	ChunkPtr buf(new Chunk);
-	buf->chunkNumber = packetNum;
-	buf->chunkSize = length;
-	std::copy(data, data + length, std::back_inserter(buf->data));
-	newChunks.push_back(buf);
+	chunkBuffer.PushBack(packetNum, data, length);
 	lastChunkCreatedTime = spring_gettime();
 }
 
@@ -890,20 +957,23 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		}
 	}
 
-	if (!unackedChunks.empty() &&
+	// chunks past the unacked ones have not been sent yet
+	const auto HaveNewChunks = [&]() { return (chunkBuffer.size() > numUnackedChunks); };
+
+	if (numUnackedChunks > 0 &&
 		(curTime - lastChunkCreatedTime) > unackTime &&
 		(curTime - lastUnackResentTime) > unackTime) {
 
 		// resend last packet if we didn't get an ack within reasonable time
 		// and don't plan sending out a new chunk either
-		if (newChunks.empty())
-			RequestResend(*unackedChunks.rbegin(), false);
+		if (!HaveNewChunks())
+			RequestResend(chunkBuffer[numUnackedChunks - 1].chunkNumber, false);
 
 		lastUnackResentTime = curTime;
 	}
 
 
-	const bool flushSend = (flushed || !newChunks.empty());
+	const bool flushSend = (flushed || HaveNewChunks());
 	const bool otherSend = (UseMinLossFactor() && !resendRequested.empty());
 	const bool unackSend = (nak > 0) || (difTime > (unackTime * 0.5f));
 
@@ -911,7 +981,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		return;
 
 	int maxResend = resendRequested.size();
-	int unackPrevSize = unackedChunks.size();
+	int unackPrevSize = numUnackedChunks;
 
 	decltype(resendRequested)::iterator resFwdIter = resendRequested.begin();
 	decltype(resendRequested)::iterator resMidIter;
@@ -921,7 +991,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 	// resend chunk size
 	const auto CalcResendSize = [&]() {
-		return ((UseMinLossFactor() || (rev == 0)) ? resFwdIter->second->GetSize() : ((rev == 1) ? resRevIter->second->GetSize() : resMidIter->second->GetSize()));
+		return chunkBuffer.Find((UseMinLossFactor() || (rev == 0)) ? *resFwdIter : ((rev == 1) ? *resRevIter : *resMidIter)).GetSize();
 	};
 
 	if (!UseMinLossFactor()) {
@@ -938,22 +1008,23 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 		std::advance(resMidIterStart, resMidStart);
 
-		if (resMidIterStart != resendRequested.end() && lastMidChunk < resMidIterStart->first)
-			lastMidChunk = resMidIterStart->first - 1;
+		if (resMidIterStart != resendRequested.end() && lastMidChunk < *resMidIterStart)
+			lastMidChunk = *resMidIterStart - 1;
 
 		std::advance(resMidIterEnd, -resMidEnd);
 
-		while (resMidIter != resendRequested.end() && resMidIter->first <= lastMidChunk) {
+		while (resMidIter != resendRequested.end() && *resMidIter <= lastMidChunk) {
 			++resMidIter;
 		}
 
-		if (resMidIter == resendRequested.end() || resMidIterEnd == resendRequested.end() || resMidIter->first >= resMidIterEnd->first)
+		if (resMidIter == resendRequested.end() || resMidIterEnd == resendRequested.end() || *resMidIter >= *resMidIterEnd)
 			resMidIter = resMidIterStart;
 	}
 
 
 	while (((outgoing.GetAverage() <= globalConfig.linkOutgoingBandwidth) || (globalConfig.linkOutgoingBandwidth <= 0))) {
-		Packet buf(lastInOrder, nak);
+		Packet& buf = sendPacket;
+		buf.Reset(lastInOrder, nak);
 
 		if (nak > 0) {
 			buf.naks.resize(nak);
@@ -972,7 +1043,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		while (true) {
 			// NB: if maxResend equals 0, then resendRequested is empty and iterators will be invalid
 			const bool canResend = (maxResend > 0) && ((buf.GetSize() + CalcResendSize()) <= mtu);
-			const bool canSendNew = !newChunks.empty() && ((buf.GetSize() + newChunks[0]->GetSize()) <= mtu);
+			const bool canSendNew = HaveNewChunks() && ((buf.GetSize() + chunkBuffer[numUnackedChunks].GetSize()) <= mtu);
 
 			if (!canResend && !canSendNew)
 				break;
@@ -982,26 +1053,26 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 			if (resend && canResend) {
 				if (UseMinLossFactor()) {
-					if (erasedResendChunks.find(resFwdIter->first) == erasedResendChunks.end())
-						buf.chunks.push_back(resFwdIter->second);
+					if (erasedResendChunks.find(*resFwdIter) == erasedResendChunks.end())
+						buf.chunks.push_back(chunkBuffer.Find(*resFwdIter));
 
-					erasedResendChunks.insert((resFwdIter++)->first);
+					erasedResendChunks.insert(*(resFwdIter++));
 				} else {
 					// on a lossy connection, just keep resending until it is acked
 					// alternate between sending from front, middle and back of requested
 					// chunks, since this improves performance on high latency connections
 					switch (rev) {
 						case 0: {
-							buf.chunks.push_back((resFwdIter++)->second);
+							buf.chunks.push_back(chunkBuffer.Find(*(resFwdIter++)));
 						} break;
 						case 1: {
-							buf.chunks.push_back((resRevIter++)->second);
+							buf.chunks.push_back(chunkBuffer.Find(*(resRevIter++)));
 						} break;
 						case 2:
 						case 3: {
-							buf.chunks.push_back(resMidIter->second);
+							buf.chunks.push_back(chunkBuffer.Find(*resMidIter));
 
-							lastMidChunk = resMidIter->first;
+							lastMidChunk = *resMidIter;
 
 							if ((++resMidIter) == resMidIterEnd)
 								resMidIter = resMidIterStart;
@@ -1016,9 +1087,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 				sent = true;
 			} else if (!resend && canSendNew) {
-				buf.chunks.push_back(newChunks[0]);
-				unackedChunks.push_back(newChunks[0]);
-				newChunks.pop_front();
+				buf.chunks.push_back(chunkBuffer[numUnackedChunks++]);
 				sent = true;
 			}
 		}
@@ -1028,7 +1097,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 		SendPacket(buf);
 
-		if (!sent || (maxResend == 0 && newChunks.empty()))
+		if (!sent || (maxResend == 0 && !HaveNewChunks()))
 			break;
 	}
 
@@ -1039,8 +1108,8 @@ void UDPConnection::SendIfNecessary(bool flushed)
 	}
 
 	// on a lossy connection chunks can be sent multiple times, see switch above
-	for (int i = unackPrevSize; i < unackedChunks.size(); ++i) {
-		RequestResend(unackedChunks[i], true);
+	for (int i = unackPrevSize; i < numUnackedChunks; ++i) {
+		RequestResend(chunkBuffer[i].chunkNumber, true);
 	}
 
 	UpdateResendRequests();
@@ -1048,50 +1117,67 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 void UDPConnection::SendPacket(Packet& pkt)
 {
-	pkt.Serialize(sendBuffer);
+	sendBuffers.clear();
+
+	if ((pkt.chunks.size() + 1) <= maxSendBuffers) {
+		// gather the chunks straight from chunkBuffer (or the received
+		// packet), only the header is serialized
+		pkt.SerializeHeader(sendBuffer);
+		sendBuffers.emplace_back(sendBuffer.data(), sendBuffer.size());
+
+		for (const Chunk& chunk: pkt.chunks) {
+			sendBuffers.emplace_back(chunk.bytes, chunk.GetSize());
+		}
+	} else {
+		pkt.Serialize(sendBuffer);
+		sendBuffers.emplace_back(sendBuffer.data(), sendBuffer.size());
+	}
+
+	const size_t packetSize = asio::buffer_size(sendBuffers);
 
-	outgoing.DataSent(sendBuffer.size());
+	outgoing.DataSent(packetSize);
 	lastPacketSendTime = spring_gettime();
 
 	ip::udp::socket::message_flags flags = 0;
 	asio::error_code err;
 
 	EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
-		mySocket->send_to(buffer(sendBuffer), addr, flags, err);
+		mySocket->send_to(sendBuffers, addr, flags, err);
 	}
 
 	if (CheckErrorCode(err))
 		return;
 
-	dataSent += sendBuffer.size();
+	dataSent += packetSize;
 	sentPackets += 1;
 }
 
 void UDPConnection::AckChunks(int lastAck)
 {
-	while (!unackedChunks.empty() && (lastAck >= (*unackedChunks.begin())->chunkNumber)) {
-		unackedChunks.pop_front();
+	while (numUnackedChunks > 0 && (lastAck >= chunkBuffer[0].chunkNumber)) {
+		chunkBuffer.PopFront();
+		numUnackedChunks--;
 	}
 
 	// resend requested and later acked, happens every now and then
 	for (size_t i = 0, n = resendRequested.size(); i < n; i++) {
-		if (lastAck < resendRequested[i].first)
+		if (lastAck < resendRequested[i])
 			break;
 
-		erasedResendChunks.insert(resendRequested[i].first);
+		erasedResendChunks.insert(resendRequested[i]);
 	}
 }
 
-void UDPConnection::RequestResend(ChunkPtr ptr, bool noSort)
+void UDPConnection::RequestResend(std::int32_t chunkNumber, bool noSort)
 {
-	resendRequested.emplace_back(ptr->chunkNumber, ptr);
+	resendRequested.push_back(chunkNumber);
 
 	if (noSort)
 		return;
 
 	// swap into position; duplicates are filtered out later
 	for (size_t i = resendRequested.size() - 1; i > 0; i--) {
-		if (resendRequested[i - 1].first < resendRequested[i].first)
+		if (resendRequested[i - 1] < resendRequested[i])
 			break;
 
 		std::swap(resendRequested[i - 1], resendRequested[i]);
@@ -6,6 +6,7 @@
 #include <asio/ip/udp.hpp>
 #include <memory>
 #include <deque>
+#include <vector>
 
 #include "Connection.h"
 #include "System/Misc/SpringTime.h"
@@ -26,35 +27,93 @@ namespace netcode {
 #define PACKET_MAX_LATENCY 1250               // in [milliseconds] maximum latency
 #define ENABLE_DEBUG_STATS
 
+/**
+ * @brief view of a chunk in its wire representation
+ *
+ * The bytes are not owned; they live in the ChunkBuffer of the sending
+ * connection or in the buffer the containing packet was received into.
+ */
 class Chunk
 {
 public:
-	unsigned GetSize() const { return (data.size() + headerSize); }
+	unsigned GetSize() const { return (chunkSize + headerSize); }
+	const std::uint8_t* GetData() const { return (bytes + headerSize); }
 	void UpdateChecksum(CRC& crc) const;
 	static constexpr unsigned maxSize = 254;
 	static constexpr unsigned headerSize = 5;
 	std::int32_t chunkNumber;
 	std::uint8_t chunkSize;
-	std::vector<std::uint8_t> data;
+	/// header followed by <chunkSize> bytes of data
+	const std::uint8_t* bytes;
+};
+
+
+/**
+ * @brief ring buffer of consecutively numbered outgoing chunks
+ *
+ * Holds every chunk from the oldest unacknowledged one up to the newest,
+ * in fixed-size slots that are reused once a chunk has been acknowledged,
+ * so creating chunks does not allocate after the buffer has grown to the
+ * connection's largest backlog. Packets are sent straight from the slots.
+ */
+class ChunkBuffer
+{
+public:
+	void PushBack(std::int32_t chunkNumber, const std::uint8_t* data, unsigned length);
+	void PopFront();
+
+	/// i-th oldest chunk
+	Chunk operator [] (size_t i) const;
+	Chunk Find(std::int32_t chunkNumber) const { return (*this)[chunkNumber - frontNumber]; }
+
+	bool empty() const { return (numChunks == 0); }
+	size_t size() const { return numChunks; }
+	size_t capacity() const { return (slots.size() / slotSize); }
+
+private:
+	void Grow();
+
+	std::uint8_t* GetSlot(size_t i) { return &slots[((head + i) & (capacity() - 1)) * slotSize]; }
+	const std::uint8_t* GetSlot(size_t i) const { return &slots[((head + i) & (capacity() - 1)) * slotSize]; }
+
+private:
+	static constexpr size_t slotSize = Chunk::headerSize + Chunk::maxSize;
+	static constexpr size_t minCapacity = 64;
+
+	// <capacity> slots, always a power of two
+	std::vector<std::uint8_t> slots;
+
+	size_t head = 0;
+	size_t numChunks = 0;
+
+	std::int32_t frontNumber = 0;
 };
-typedef std::shared_ptr<Chunk> ChunkPtr;
 
 
 class Packet
 {
 public:
 	static constexpr unsigned headerSize = 6;
+	/// parse a received packet, chunks point into <data>
 	Packet(const unsigned char* data, unsigned length);
-	Packet(int _lastCont, int _nakType) {
+	Packet(int _lastCont, int _nakType) { Reset(_lastCont, _nakType); }
+
+	void Reset(int _lastCont, int _nakType) {
 		lastContinuous = _lastCont;
 		nakType = _nakType;
+
+		// keep the capacity, packets are built over and over
+		naks.clear();
+		chunks.clear();
 	}
 
 	unsigned GetSize() const;
 
 	std::uint8_t GetChecksum() const;
 
-	void Serialize(std::vector<std::uint8_t>& data);
+	/// header and naks only
+	void SerializeHeader(std::vector<std::uint8_t>& data) const;
+	void Serialize(std::vector<std::uint8_t>& data) const;
 
 	std::int32_t lastContinuous;
 	/// if < 0, we lost -x packets since lastContinuous
@@ -63,7 +122,7 @@ public:
 	std::uint8_t checksum;
 
 	std::vector<std::uint8_t> naks;
-	std::vector<ChunkPtr> chunks;
+	std::vector<Chunk> chunks;
 };
 
 
@@ -149,7 +208,7 @@ private:
 	void SendIfNecessary(bool flushed);
 	void AckChunks(int lastAck);
 
-	void RequestResend(ChunkPtr ptr, bool noSort);
+	void RequestResend(std::int32_t chunkNumber, bool noSort);
 	void SendPacket(Packet& pkt);
 
 	void UpdateWaitingPackets();
@@ -190,24 +249,27 @@ private:
 	spring::unordered_set<int> incomingChunkNums;
 
 
-	/// Newly created and not yet sent
-	std::deque<ChunkPtr> newChunks;
-	/// packets the other side did not ack'ed until now
-	std::deque<ChunkPtr> unackedChunks;
+	/// chunks the other side did not ack'ed until now (the first
+	/// <numUnackedChunks>), followed by those not yet sent
+	ChunkBuffer chunkBuffer;
+	size_t numUnackedChunks = 0;
 
-	/// Packets the other side missed
-	std::vector< std::pair<std::int32_t, ChunkPtr> > resendRequested;
+	/// numbers of the chunks the other side missed
+	std::vector<std::int32_t> resendRequested;
 	spring::unordered_set<std::int32_t> erasedResendChunks;
 
 	/// complete packets we received but did not yet consume
 	std::deque< std::shared_ptr<const RawPacket> > msgQueue;
 
 	std::vector<std::uint8_t> sendBuffer;
+	std::vector<asio::const_buffer> sendBuffers;
 	std::vector<std::uint8_t> recvBuffer;
 	std::vector<std::uint8_t> waitBuffer;
 
 	std::vector<int> droppedPackets;
 
+	Packet sendPacket{-1, 0};
+
 	std::int32_t lastMidChunk;
 
 #if	NETWORK_TEST
@@ -153,7 +153,7 @@ void UDPListener::Update(int loopSleepTime) {
 
 		// unknown connection but still have the packet, maybe a new client wants to connect from sender's address
 		if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
-			if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
+			if (!data.chunks.empty() && data.chunks[0].chunkNumber == 0) {
 				std::shared_ptr<UDPConnection> incoming(new UDPConnection(socket, udpEndPoint));
 				waiting.push(incoming);
 				connMap[udpEndPoint] = incoming;
@@ -106,6 +106,7 @@
 
 CONFIG(unsigned, SetCoreAffinity).defaultValue(0).safemodeValue(1).description("Defines a bitmask indicating which CPU cores the main-thread should use.");
 CONFIG(unsigned, TextureMemPoolSize).defaultValue(512).minimumValue(0).description("Set to 0 to disable, otherwise specify a predefined memory to serve Bitmap allocation requests");
+CONFIG(unsigned, TextureMemBudget).defaultValue(0).minimumValue(0).description("Set to 0 to disable, otherwise the amount of Bitmap memory in MB above which unmodified file-loaded bitmaps unused for a second are released and decoded again on their next access. Mainly useful for headless hosts.");
 CONFIG(bool, UseLuaMemPools).defaultValue(true).description("Whether Lua VM memory allocations are made from pools.");
 CONFIG(bool, UseHighResTimer).defaultValue(false).description("On Windows, sets whether Spring will use low- or high-resolution timer functions for tasks like graphical interpolation between game frames.");
 CONFIG(bool, UseFontConfigLib).defaultValue(true).description("Whether the system fontconfig library (if present and enabled at compile-time) should be used for handling fonts.");
@@ -157,6 +158,8 @@ DEFINE_string_EX(calc_checksum,      "calc-checksum",      "",    "Calculate nam
  * parallel because they both try to open the same port. This makes automated replay parsing difficult when
  * the same port number is heavily reused across many replays. Forcing onlyLocal solves this. */
 DEFINE_bool_EX  (onlyLocal,              "only-local",     false, "Force OnlyLocal mode (no network listening sockets). Use for parallelized watching of multiplayer replays");
+DEFINE_VARIABLE_EX(GFLAGS_NAMESPACE::int32, I, demo_seek, "demo-seek", 0, "Fast-forward demo playback to the given frame, starting from the nearest saved keyframe (see DemoKeyframeInterval) if there is one");
+DEFINE_string   (benchmark,                                "",    "Replay the given demo as fast as possible and write per-frame sim timings (JSON) to this file, then quit; meant for headless builds");
 
 
 
@@ -270,7 +273,7 @@ bool SpringApp::Init()
 	globalRendering->InitGLState();
 
 	CCameraHandler::InitStatic();
-	CBitmap::InitPool(configHandler->GetInt("TextureMemPoolSize"));
+	CBitmap::InitPool(configHandler->GetInt("TextureMemPoolSize"), configHandler->GetInt("TextureMemBudget"));
 
 	UpdateInterfaceGeometry();
 	InitFonts();
@@ -730,6 +733,8 @@ void SpringApp::Startup()
 		return;
 	}
 	if (extension == "sdfz") {
+		clientSetup->demoSeekFrame = FLAGS_demo_seek;
+		clientSetup->benchmarkFile = FLAGS_benchmark;
 		LoadDemoFile(inputFile);
 		return;
 	}
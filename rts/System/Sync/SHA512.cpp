@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <cstdio> // snprintf
@@ -110,6 +111,70 @@ void sha512::calc_digest(const uint8_t msg_bytes[], size_t len, uint8_t sha_byte
 }
 
 
+void sha512::init_digest(msg_state& msg) {
+	std::memcpy(&msg.state[0], &STATE_CONSTS[0], sizeof(STATE_CONSTS));
+	std::memset(&msg.block[0], 0, sizeof(msg.block));
+
+	msg.len = 0;
+}
+
+void sha512::update_digest(msg_state& msg, const uint8_t msg_bytes[], size_t len) {
+	size_t blk_ofs = msg.len & (BLK_LEN - 1);
+	size_t msg_ofs = 0;
+
+	msg.len += len;
+
+	// top up a partially filled block first
+	if (blk_ofs > 0) {
+		const size_t n = std::min(len, BLK_LEN - blk_ofs);
+
+		std::memcpy(&msg.block[blk_ofs], &msg_bytes[0], n);
+
+		if ((blk_ofs += n) < BLK_LEN)
+			return;
+
+		dm_compress(msg.state, msg.block, BLK_LEN);
+		msg_ofs = n;
+	}
+
+	// whole blocks can be compressed in-place
+	const size_t num_blk_bytes = (len - msg_ofs) & (~static_cast<size_t>(BLK_LEN - 1));
+
+	dm_compress(msg.state, &msg_bytes[msg_ofs], num_blk_bytes);
+	msg_ofs += num_blk_bytes;
+
+	if (msg_ofs < len)
+		std::memcpy(&msg.block[0], &msg_bytes[msg_ofs], len - msg_ofs);
+}
+
+void sha512::final_digest(msg_state& msg, raw_digest& sha_bytes) {
+	uint64_t len = msg.len;
+	size_t ofs = (len & (BLK_LEN - 1)) + 1;
+
+	// same padding as calc_digest
+	std::memset(&msg.block[ofs - 1], 0, BLK_LEN - (ofs - 1));
+	msg.block[ofs - 1] = 0x80;
+
+	if ((ofs + 16) > BLK_LEN) {
+		dm_compress(msg.state, msg.block, BLK_LEN);
+		std::memset(msg.block, 0, BLK_LEN);
+	}
+
+	msg.block[BLK_LEN - 1] = static_cast<uint8_t>((len & 0x1Fu) << 3);
+	len >>= 5;
+
+	for (uint8_t i = 1; i < 16; i++, len >>= 8) {
+		msg.block[BLK_LEN - 1 - i] = static_cast<uint8_t>(len);
+	}
+
+	dm_compress(msg.state, msg.block, BLK_LEN);
+
+	for (uint8_t i = 0; i < SHA_LEN; i++) {
+		sha_bytes[i] = static_cast<uint8_t>(msg.state[i >> 3] >> ((7 - (i & 7)) << 3));
+	}
+}
+
+
 void sha512::dm_compress(uint64_t state[NUM_STATE_CONSTS], const uint8_t blocks[], size_t len) {
 	assert(len == 0 || (len % BLK_LEN) == 0);
 
@@ -54,6 +54,13 @@ namespace sha512 {
 	using raw_digest = std::array<uint8_t, SHA_LEN        >;
 	using hex_digest = std::array<   char, SHA_LEN * 2 + 1>; // null-terminated
 
+	// for messages fed in pieces; produces the same digest as calc_digest
+	struct msg_state {
+		uint64_t state[NUM_STATE_CONSTS];
+		uint8_t block[BLK_LEN];
+		uint64_t len;
+	};
+
 	void read_digest(const std::string& hex, raw_digest& sha_bytes); // hex to raw
 	raw_digest read_digest(const std::string& hex); // hex to raw
 	void read_digest(const hex_digest& hex_chars, raw_digest& sha_bytes); // hex to raw
@@ -61,6 +68,9 @@ namespace sha512 {
 	std::string dump_digest(const raw_digest& sha_bytes); // raw to hex
 	void calc_digest(const std::vector<uint8_t>& msg_bytes, raw_digest& sha_bytes);
 	void calc_digest(const uint8_t msg_bytes[], size_t len, uint8_t sha_bytes[SHA_LEN]);
+	void init_digest(msg_state& msg);
+	void update_digest(msg_state& msg, const uint8_t msg_bytes[], size_t len);
+	void final_digest(msg_state& msg, raw_digest& sha_bytes);
 	void dm_compress(uint64_t state[NUM_STATE_CONSTS], const uint8_t blocks[], size_t len);
 
 	bool unit_test(const char* msg_str = TEST_STR_PAIR[0], const char* sha_str = TEST_STR_PAIR[1]);
@@ -181,6 +181,19 @@ bool CTimeProfiler::UnRegisterTimer(const char* timerName)
 }
 
 
+std::string CTimeProfiler::GetTimerName(unsigned nameHash)
+{
+	std::lock_guard<HashNamMutexType> lock(hashToNameMutex);
+
+	const auto iter = hashToName.find(nameHash);
+
+	if (iter == hashToName.end())
+		return "???";
+
+	return iter->second;
+}
+
+
 void CTimeProfiler::ResetState() {
 	// grab lock; ThreadPool workers might already be running SCOPED_MT_TIMER
 	std::lock_guard<ProfileMutexType> lock(profileMutex);
@@ -425,6 +438,21 @@ void CTimeProfiler::AddTimeRaw(
 	}
 }
 
+void CTimeProfiler::GetTimerTotals(std::vector< std::pair<unsigned, spring_time> >& totals) const
+{
+	// same reasoning as GetTimeRecord; only special timers pass AddTime when disabled
+	std::unique_lock<ProfileMutexType> lock(profileMutex, std::defer_lock);
+
+	if (enabled)
+		lock.lock();
+
+	totals.reserve(totals.size() + profiles.size());
+
+	for (const auto& profile: profiles) {
+		totals.emplace_back(profile.first, profile.second.total);
+	}
+}
+
 void CTimeProfiler::PrintProfilingInfo() const
 {
 	if (sortedProfiles.empty())
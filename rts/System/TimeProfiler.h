@@ -107,6 +107,7 @@ public:
 
 	static bool RegisterTimer(const char* name);
 	static bool UnRegisterTimer(const char* name);
+	static std::string GetTimerName(unsigned nameHash);
 
 	struct TimeRecord {
 		TimeRecord() {
@@ -187,7 +188,11 @@ public:
 	void RefreshProfilesRaw();
 	void CleanupOldThreadProfiles();
 
+	/// appends (nameHash, total) of every timer that has recorded time so far
+	void GetTimerTotals(std::vector< std::pair<unsigned, spring_time> >& totals) const;
+
 	void SetEnabled(bool b) { enabled = b; }
+	bool IsEnabled() const { return enabled; }
 	void PrintProfilingInfo() const;
 
 	void AddTime(
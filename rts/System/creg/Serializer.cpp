@@ -277,6 +277,11 @@ struct COutputStreamSerializer::ClassRef
 	creg::Class* class_;
 };
 
+size_t COutputStreamSerializer::GetPackageHeaderSize()
+{
+	return sizeof(PackageHeader);
+}
+
 void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class* rootObjClass)
 {
 	PackageHeader ph;
@@ -107,6 +107,11 @@ namespace creg {
 		 */
 		void SavePackage(std::ostream* s, void* rootObj, Class* cls);
 
+		/** SavePackage writes this many bytes at the package start first and
+		 * overwrites them (by seeking back) once the package is complete
+		 */
+		static size_t GetPackageHeaderSize();
+
 		/** @see ISerializer::IsWriting */
 		bool IsWriting();
 
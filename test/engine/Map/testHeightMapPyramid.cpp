@@ -0,0 +1,99 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Map/HeightMapPyramid.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+// brute-force bounds of the squares in [x1,x2) x [z1,z2)
+static float2 CalcBounds(const std::vector<float>& heights, int sizeX, int x1, int z1, int x2, int z2)
+{
+	float2 bounds = {heights[z1 * (sizeX + 1) + x1], heights[z1 * (sizeX + 1) + x1]};
+
+	for (int z = z1; z <= z2; z++) {
+		for (int x = x1; x <= x2; x++) {
+			bounds.x = std::min(bounds.x, heights[z * (sizeX + 1) + x]);
+			bounds.y = std::max(bounds.y, heights[z * (sizeX + 1) + x]);
+		}
+	}
+
+	return bounds;
+}
+
+static bool CheckPyramid(const CHeightMapPyramid& pyramid, const std::vector<float>& heights, int sizeX, int sizeZ)
+{
+	for (int level = 0; level < pyramid.GetNumLevels(); level++) {
+		for (int z = 0; z < sizeZ; z += (1 << level)) {
+			for (int x = 0; x < sizeX; x += (1 << level)) {
+				const SRectangle rect = pyramid.GetCellRect(level, x, z);
+				// corner vertices of the last square are at x2 and z2
+				const float2 bounds = CalcBounds(heights, sizeX, rect.x1, rect.z1, rect.x2, rect.z2);
+				const float2& cell = pyramid.GetBounds(level, x, z);
+
+				if (cell.x != bounds.x || cell.y != bounds.y)
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+TEST_CASE("HeightMapPyramid")
+{
+	// odd sizes to cover cells with a single child along the edges
+	static constexpr int SIZE_X = 45;
+	static constexpr int SIZE_Z = 29;
+
+	std::mt19937 rng(12345);
+	std::uniform_real_distribution<float> heightDist(-200.0f, 500.0f);
+
+	std::vector<float> heights((SIZE_X + 1) * (SIZE_Z + 1));
+	std::generate(heights.begin(), heights.end(), [&]() { return heightDist(rng); });
+
+	CHeightMapPyramid pyramid;
+	pyramid.Init(SIZE_X, SIZE_Z);
+	pyramid.Update(heights.data(), {0, 0, SIZE_X - 1, SIZE_Z - 1});
+
+	CHECK(pyramid.GetNumLevels() == 7);
+	CHECK(pyramid.GetCellRect(pyramid.GetNumLevels() - 1, 0, 0) == SRectangle(0, 0, SIZE_X, SIZE_Z));
+	CHECK(CheckPyramid(pyramid, heights, SIZE_X, SIZE_Z));
+
+	// deform random areas and only update the affected squares, like UpdateHeightMapSynced does
+	for (int n = 0; n < 200; n++) {
+		const int x1 = rng() % (SIZE_X + 1);
+		const int z1 = rng() % (SIZE_Z + 1);
+		const int x2 = std::min(x1 + int(rng() % 8), SIZE_X);
+		const int z2 = std::min(z1 + int(rng() % 8), SIZE_Z);
+		const float delta = heightDist(rng);
+
+		for (int z = z1; z <= z2; z++) {
+			for (int x = x1; x <= x2; x++) {
+				heights[z * (SIZE_X + 1) + x] += delta;
+			}
+		}
+
+		// squares sharing a changed corner vertex
+		pyramid.Update(heights.data(), {x1 - 1, z1 - 1, x2, z2});
+	}
+
+	CHECK(CheckPyramid(pyramid, heights, SIZE_X, SIZE_Z));
+
+	// every level above the one found must reach <height>, the one found must not
+	for (int n = 0; n < 1000; n++) {
+		const int x = rng() % SIZE_X;
+		const int z = rng() % SIZE_Z;
+		const float height = heightDist(rng);
+		const int level = pyramid.FindLevelBelow(x, z, height);
+
+		if (level >= 0)
+			CHECK(pyramid.GetBounds(level, x, z).y < height);
+		if ((level + 1) < pyramid.GetNumLevels())
+			CHECK(pyramid.GetBounds(level + 1, x, z).y >= height);
+	}
+}
@@ -0,0 +1,162 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Map/ReadMap.h"
+#include "Rendering/Models/LocalModelPiece.hpp"
+#include "Sim/Misc/CollisionHandler.h"
+#include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Misc/CollisionVolumeBatch.h"
+#include "Sim/Misc/GroundBlockingObjectMap.h"
+#include "Sim/Units/Unit.h"
+#include "System/Matrix44f.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+// CollisionHandler.cpp is linked for its scalar tests, which do not touch these
+MapDimensions mapDims;
+CGroundBlockingObjectMap groundBlockingObjectMap;
+
+const CMatrix44f& LocalModelPiece::GetModelSpaceMatrix() const { static const CMatrix44f m; return m; }
+CMatrix44f CUnit::GetTransformMatrix(bool synced, bool fullread) const { return {}; }
+
+
+using BatchIntersectFunc = void(*)(const CollisionVolumeBatch&, CollisionQuery*, std::uint8_t*, bool);
+using IntersectFunc = bool(*)(const CollisionVolume*, const float3&, const float3&, CollisionQuery*);
+
+struct BatchTest {
+	int volumeType;
+	BatchIntersectFunc batchIntersect;
+	IntersectFunc intersect;
+};
+
+static constexpr BatchTest BATCH_TESTS[] = {
+	{CollisionVolume::COLVOL_TYPE_ELLIPSOID, CCollisionHandler::IntersectEllipsoids, CCollisionHandler::IntersectEllipsoid},
+	{CollisionVolume::COLVOL_TYPE_CYLINDER , CCollisionHandler::IntersectCylinders , CCollisionHandler::IntersectCylinder },
+	{CollisionVolume::COLVOL_TYPE_BOX      , CCollisionHandler::IntersectBoxes     , CCollisionHandler::IntersectBox      },
+};
+
+
+struct BatchInput {
+	std::vector<CollisionVolume> volumes;
+	std::vector<float3> pi0s;
+	std::vector<float3> pi1s;
+
+	CollisionVolumeBatch batch;
+};
+
+static void FillBatch(BatchInput& input, int volumeType, size_t numVolumes, float spread, std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> posDist(-spread, spread);
+	std::uniform_real_distribution<float> scaleDist(2.0f, 120.0f);
+
+	input.volumes.resize(numVolumes);
+	input.pi0s.resize(numVolumes);
+	input.pi1s.resize(numVolumes);
+	input.batch.Clear();
+
+	for (size_t i = 0; i < numVolumes; i++) {
+		CollisionVolume& v = input.volumes[i];
+
+		v.InitShape({scaleDist(rng), scaleDist(rng), scaleDist(rng)}, ZeroVector, volumeType, CollisionVolume::COLVOL_HITTEST_CONT, rng() % 3);
+
+		input.pi0s[i] = {posDist(rng), posDist(rng), posDist(rng)};
+		input.pi1s[i] = {posDist(rng), posDist(rng), posDist(rng)};
+		input.batch.Add(&v, input.pi0s[i], input.pi1s[i]);
+	}
+}
+
+// per-volume reference: the bounding-box early-out of CCollisionHandler::Intersect,
+// then the sync-critical scalar test; neither query is transformed into world-space
+static bool IntersectScalar(IntersectFunc intersect, const CollisionVolume* v, const float3& pi0, const float3& pi1, CollisionQuery* cq)
+{
+	const float3 rmin = float3::min(pi0, pi1);
+	const float3 rmax = float3::max(pi0, pi1);
+	const float3 vmin = -v->GetHScales();
+	const float3 vmax =  v->GetHScales();
+
+	if (rmax.x < vmin.x || rmin.x > vmax.x)
+		return false;
+	if (rmax.y < vmin.y || rmin.y > vmax.y)
+		return false;
+	if (rmax.z < vmin.z || rmin.z > vmax.z)
+		return false;
+
+	return (intersect(v, pi0, pi1, cq));
+}
+
+// every lane of the batch test must write exactly what the scalar test writes
+static bool CompareLanes(const BatchTest& test, const BatchInput& input, bool vectorize)
+{
+	const size_t numVolumes = input.batch.Size();
+
+	std::vector<CollisionQuery> batchQueries(numVolumes);
+	std::vector<CollisionQuery> scalarQueries(numVolumes);
+	std::vector<std::uint8_t> batchHits(numVolumes);
+	std::vector<std::uint8_t> scalarHits(numVolumes);
+
+	test.batchIntersect(input.batch, batchQueries.data(), batchHits.data(), vectorize);
+
+	for (size_t i = 0; i < numVolumes; i++) {
+		scalarHits[i] = IntersectScalar(test.intersect, &input.volumes[i], input.pi0s[i], input.pi1s[i], &scalarQueries[i]);
+	}
+
+	if (batchHits != scalarHits)
+		return false;
+
+	return (std::memcmp(batchQueries.data(), scalarQueries.data(), sizeof(CollisionQuery) * numVolumes) == 0);
+}
+
+
+TEST_CASE("CollisionVolumeBatchLanes")
+{
+	std::mt19937 rng(1234);
+	BatchInput input;
+
+	// odd sizes exercise the scalar tail, large spreads the bounding-box early-out
+	for (const BatchTest& test: BATCH_TESTS) {
+		for (const size_t numVolumes: {1, 3, 4, 7, 16, 61, 256}) {
+			for (const float spread: {20.0f, 100.0f, 400.0f}) {
+				FillBatch(input, test.volumeType, numVolumes, spread, rng);
+
+				CHECK(CompareLanes(test, input, true));
+				CHECK(CompareLanes(test, input, false));
+			}
+		}
+	}
+}
+
+TEST_CASE("CollisionVolumeBatchHits")
+{
+	const float3 hs = {10.0f, 10.0f, 10.0f};
+	const float3 his = {0.1f, 0.1f, 0.1f};
+
+	CollisionVolumeBatch batch;
+
+	// through the center, starting inside, passing beside and stopping short
+	batch.Add({-20.0f, 0.0f, 0.0f}, {20.0f, 0.0f, 0.0f}, hs, his, hs * hs);
+	batch.Add({  0.0f, 0.0f, 0.0f}, {20.0f, 0.0f, 0.0f}, hs, his, hs * hs);
+	batch.Add({-20.0f, 15.0f, 0.0f}, {20.0f, 15.0f, 0.0f}, hs, his, hs * hs);
+	batch.Add({-20.0f, 0.0f, 0.0f}, {-15.0f, 0.0f, 0.0f}, hs, his, hs * hs);
+
+	for (const BatchTest& test: BATCH_TESTS) {
+		CollisionQuery cqs[4];
+		std::uint8_t hits[4];
+
+		test.batchIntersect(batch, cqs, hits, true);
+
+		CHECK(hits[0]);
+		CHECK(cqs[0].IngressHit());
+		CHECK(cqs[0].GetIngressPos().x == Catch::Approx(-10.0f));
+
+		CHECK(hits[1]);
+		CHECK(cqs[1].InsideHit());
+
+		CHECK(!hits[2]);
+		CHECK(!hits[3]);
+	}
+}
@@ -1,3 +1,4 @@
+#include <ostream>
 #include <string>
 #include <nowide/cstdio.hpp>
 #include <sys/stat.h>
@@ -121,6 +122,26 @@ TEST_CASE("CreateDirectory")
 }
 
 
+TEST_CASE("WriteFileViaTemp")
+{
+	CHECK(FileSystem::WriteFileViaTemp("testWrite.bin", [](std::ostream& os) { os << "abc"; }));
+	CHECK(FileSystem::GetFileSize("testWrite.bin") == 3);
+
+	// replaces existing files
+	CHECK(FileSystem::WriteFileViaTemp("testWrite.bin", [](std::ostream& os) { os << "abcdef"; }));
+	CHECK(FileSystem::GetFileSize("testWrite.bin") == 6);
+
+	// a failed write keeps the old content
+	CHECK_FALSE(FileSystem::WriteFileViaTemp("testWrite.bin", [](std::ostream& os) { os << "a"; os.setstate(std::ios::badbit); }));
+	CHECK(FileSystem::GetFileSize("testWrite.bin") == 6);
+
+	CHECK_FALSE(FileSystem::WriteFileViaTemp("testDir99/testWrite.bin", [](std::ostream& os) { os << "abc"; }));
+	CHECK_FALSE(FileSystem::FileExists("testDir99/testWrite.bin"));
+
+	CHECK(FileSystem::DeleteFile("testWrite.bin"));
+}
+
+
 TEST_CASE("GetDirectory")
 {
 #define CHECK_DIR_EXTRACTION(path, dir) \
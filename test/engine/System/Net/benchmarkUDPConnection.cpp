@@ -0,0 +1,106 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Net/UDPConnection.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/Socket.h"
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/GlobalConfig.h"
+#include "System/Misc/SpringTime.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <memory>
+
+namespace streflop {
+	template<typename T> inline void streflop_init() {
+		// Do nothing by default, or for unknown types
+	}
+}
+
+InitSpringTime ist;
+
+namespace {
+	constexpr int senderPort = 18451;
+	constexpr int receiverPort = 18452;
+
+	// variable-length message as sent by clients and relayed by the server
+	std::shared_ptr<const netcode::RawPacket> MakeCommandPacket(unsigned length)
+	{
+		netcode::RawPacket* packet = new netcode::RawPacket(length);
+
+		std::memset(packet->data, 0, length);
+		packet->data[0] = NETMSG_COMMAND;
+		packet->data[1] = length & 0xFF;
+		packet->data[2] = length >> 8;
+
+		return std::shared_ptr<const netcode::RawPacket>(packet);
+	}
+}
+
+static void BenchLoopbackThroughput(benchmark::State& state) {
+	// measure the connection itself rather than the configured link
+	globalConfig.linkOutgoingBandwidth = 0;
+
+	netcode::UDPConnection sender(senderPort, "127.0.0.1", receiverPort);
+	netcode::UDPConnection receiver(receiverPort, "127.0.0.1", senderPort);
+
+	sender.Unmute();
+	receiver.Unmute();
+
+	const unsigned msgLength = state.range(0);
+	const unsigned numMsgs = state.range(1);
+
+	const std::shared_ptr<const netcode::RawPacket> msg = MakeCommandPacket(msgLength);
+	const std::shared_ptr<const netcode::RawPacket> reply = MakeCommandPacket(8);
+
+	// handshake; until a peer has received something its packets look like
+	// reconnection attempts and are dropped after the first one
+	sender.SendData(reply);
+	sender.Flush(true);
+
+	while (receiver.GetData() == nullptr) {
+		receiver.Update();
+	}
+
+	receiver.SendData(reply);
+	receiver.Flush(true);
+
+	while (sender.GetData() == nullptr) {
+		sender.Update();
+	}
+
+	size_t numReceived = 0;
+
+	for (auto _ : state) {
+		for (unsigned n = 0; n < numMsgs; n++) {
+			sender.SendData(msg);
+		}
+
+		sender.Flush(true);
+
+		for (unsigned n = 0; n < numMsgs; ) {
+			receiver.Update();
+
+			while (receiver.GetData() != nullptr) {
+				n++;
+			}
+		}
+
+		// reply like a client does to keyframes, which also acks the chunks
+		receiver.SendData(reply);
+		receiver.Flush(true);
+
+		while (sender.GetData() == nullptr) {
+			sender.Update();
+		}
+
+		numReceived += numMsgs;
+	}
+
+	state.SetItemsProcessed(numReceived);
+	state.SetBytesProcessed(numReceived * msgLength);
+}
+
+// {message length, messages per flush}
+BENCHMARK(BenchLoopbackThroughput)->ArgsProduct({{8, 64, 512}, {16, 128}});
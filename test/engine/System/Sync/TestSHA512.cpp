@@ -0,0 +1,48 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Sync/SHA512.hpp"
+
+#include <random>
+
+#include <catch_amalgamated.hpp>
+
+
+TEST_CASE("KnownDigest")
+{
+	CHECK(sha512::unit_test());
+	CHECK(sha512::unit_test("abc", "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"));
+}
+
+TEST_CASE("IncrementalDigest")
+{
+	std::mt19937 rng(12345);
+	std::vector<uint8_t> msg;
+
+	// covers empty messages and all padding cases around block boundaries
+	for (size_t len = 0; len <= 3 * sha512::BLK_LEN + 1; len++) {
+		msg.resize(len);
+
+		for (uint8_t& b: msg) {
+			b = rng();
+		}
+
+		sha512::raw_digest expected;
+		sha512::calc_digest(msg, expected);
+
+		for (size_t chunkSize: {size_t(1), size_t(7), size_t(sha512::BLK_LEN - 1), size_t(sha512::BLK_LEN), size_t(sha512::BLK_LEN + 1), size_t(1000)}) {
+			sha512::msg_state state;
+			sha512::raw_digest actual;
+
+			sha512::init_digest(state);
+
+			for (size_t ofs = 0; ofs < len; ofs += chunkSize) {
+				sha512::update_digest(state, msg.data() + ofs, std::min(chunkSize, len - ofs));
+			}
+
+			sha512::final_digest(state, actual);
+
+			CAPTURE(len, chunkSize);
+			CHECK(actual == expected);
+		}
+	}
+}
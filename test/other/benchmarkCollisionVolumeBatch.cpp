@@ -0,0 +1,245 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/CollisionHandler.h"
+#include "Sim/Misc/CollisionVolumeBatch.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+	// share of ellipsoids, cylinders and boxes among the candidates of a typical
+	// game's projectiles: mostly default unit volumes, cylinders for the odd tower
+	// or tree, boxes for buildings and features
+	constexpr std::array<float, 3> typeShares = {0.6f, 0.15f, 0.25f};
+
+	struct UnitMix {
+		// ellipsoids, cylinders, boxes
+		std::array<CollisionVolumeBatch, 3> batches;
+		std::array<std::vector<CollisionQuery>, 3> queries;
+		std::array<std::vector<std::uint8_t>, 3> hits;
+	};
+
+	// candidates as returned by the quadfield for one projectile, segments
+	// of projectile-like length which start up to a few volumes away
+	UnitMix MakeUnitMix(size_t numVolumes, float spread)
+	{
+		std::mt19937 rng(numVolumes);
+		std::uniform_real_distribution<float> typeDist(0.0f, 1.0f);
+		std::uniform_real_distribution<float> scaleDist(8.0f, 40.0f);
+		std::uniform_real_distribution<float> posDist(-spread, spread);
+		std::uniform_real_distribution<float> dirDist(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> speedDist(5.0f, 30.0f);
+
+		UnitMix mix;
+
+		for (size_t i = 0; i < numVolumes; i++) {
+			const float share = typeDist(rng);
+			const size_t type = (share < typeShares[0])? 0: ((share < (typeShares[0] + typeShares[1]))? 1: 2);
+
+			// ground units are flatter than they are long
+			const float3 hs = {scaleDist(rng), scaleDist(rng) * 0.5f, scaleDist(rng)};
+			const float3 pi0 = {posDist(rng), posDist(rng) * 0.5f, posDist(rng)};
+			const float3 pi1 = pi0 + float3(dirDist(rng), dirDist(rng), dirDist(rng)).SafeNormalize() * speedDist(rng);
+
+			mix.batches[type].Add(pi0, pi1, hs, {1.0f / hs.x, 1.0f / hs.y, 1.0f / hs.z}, hs * hs, (type == 1)? (rng() % 3): 0);
+		}
+
+		for (size_t n = 0; n < mix.batches.size(); n++) {
+			mix.queries[n].resize(mix.batches[n].Size());
+			mix.hits[n].resize(mix.batches[n].Size());
+		}
+
+		return mix;
+	}
+}
+
+static void BenchIntersectUnitMix(benchmark::State& state) {
+	UnitMix mix = MakeUnitMix(state.range(0), state.range(1));
+
+	const bool vectorize = (state.range(2) != 0);
+
+	for (auto _ : state) {
+		CCollisionHandler::IntersectEllipsoids(mix.batches[0], mix.queries[0].data(), mix.hits[0].data(), vectorize);
+		CCollisionHandler::IntersectCylinders (mix.batches[1], mix.queries[1].data(), mix.hits[1].data(), vectorize);
+		CCollisionHandler::IntersectBoxes     (mix.batches[2], mix.queries[2].data(), mix.hits[2].data(), vectorize);
+
+		benchmark::DoNotOptimize(mix.hits[0].data());
+		benchmark::DoNotOptimize(mix.hits[1].data());
+		benchmark::DoNotOptimize(mix.hits[2].data());
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// {candidates, spread, vectorize}
+BENCHMARK(BenchIntersectUnitMix)->ArgsProduct({{8, 32, 128}, {40, 200}, {0, 1}});
+
+
+namespace {
+	// candidates of one TraceRay call: volumes spread along a long ray
+	// (e.g. a beam laser) in arbitrary quadfield order, many of them hit
+	struct RayMix {
+		std::vector<float3> centers;
+		std::vector<float3> scales;
+		std::vector<size_t> types;
+		std::vector<int> axes;
+
+		std::vector<CollisionQuery> queries;
+		std::vector<std::uint8_t> hits;
+	};
+
+	constexpr float rayLength = 2000.0f;
+
+	RayMix MakeRayMix(size_t numVolumes)
+	{
+		std::mt19937 rng(numVolumes);
+		std::uniform_real_distribution<float> typeDist(0.0f, 1.0f);
+		std::uniform_real_distribution<float> scaleDist(8.0f, 40.0f);
+		std::uniform_real_distribution<float> rayDist(0.0f, rayLength);
+		std::uniform_real_distribution<float> offDist(-30.0f, 30.0f);
+
+		RayMix mix;
+
+		for (size_t i = 0; i < numVolumes; i++) {
+			const float share = typeDist(rng);
+
+			mix.types.push_back((share < typeShares[0])? 0: ((share < (typeShares[0] + typeShares[1]))? 1: 2));
+			mix.centers.push_back({rayDist(rng), offDist(rng), offDist(rng)});
+			mix.scales.push_back({scaleDist(rng), scaleDist(rng) * 0.5f, scaleDist(rng)});
+			mix.axes.push_back((mix.types.back() == 1)? (rng() % 3): 0);
+		}
+
+		mix.queries.resize(numVolumes);
+		mix.hits.resize(numVolumes);
+		return mix;
+	}
+
+	// batch hit-tests volumes [first, last) against the ray <length> elmos long
+	// from the origin along +x, the volumes being translated only (centers)
+	void IntersectRange(RayMix& mix, size_t first, size_t last, float length)
+	{
+		static std::array<CollisionVolumeBatch, 3> batches;
+		static std::array<std::vector<size_t>, 3> indices;
+		static std::vector<CollisionQuery> queries;
+		static std::vector<std::uint8_t> hits;
+
+		for (size_t n = 0; n < batches.size(); n++) {
+			batches[n].Clear();
+			indices[n].clear();
+		}
+
+		for (size_t i = first; i < last; i++) {
+			const float3& hs = mix.scales[i];
+			const float3 pi0 = -mix.centers[i];
+			const float3 pi1 = pi0 + float3(length, 0.0f, 0.0f);
+
+			batches[mix.types[i]].Add(pi0, pi1, hs, {1.0f / hs.x, 1.0f / hs.y, 1.0f / hs.z}, hs * hs, mix.axes[i]);
+			indices[mix.types[i]].push_back(i);
+		}
+
+		for (size_t n = 0; n < batches.size(); n++) {
+			queries.clear();
+			queries.resize(batches[n].Size());
+			hits.resize(batches[n].Size());
+
+			switch (n) {
+				case 0: { CCollisionHandler::IntersectEllipsoids(batches[n], queries.data(), hits.data()); } break;
+				case 1: { CCollisionHandler::IntersectCylinders (batches[n], queries.data(), hits.data()); } break;
+				case 2: { CCollisionHandler::IntersectBoxes     (batches[n], queries.data(), hits.data()); } break;
+			}
+
+			for (size_t j = 0; j < indices[n].size(); j++) {
+				mix.queries[indices[n][j]] = queries[j];
+				mix.queries[indices[n][j]].SwapParams();
+				mix.hits[indices[n][j]] = hits[j];
+			}
+		}
+	}
+
+	float HitDist(const RayMix& mix, size_t i)
+	{
+		return mix.queries[i].GetHitPosDist(-mix.centers[i], {1.0f, 0.0f, 0.0f});
+	}
+
+	// previous TraceRay scheme: test the remaining candidates again after each closer hit
+	size_t ClosestHitRerun(RayMix& mix, float& length)
+	{
+		size_t closest = mix.centers.size();
+
+		for (size_t first = 0; first < mix.centers.size(); ) {
+			IntersectRange(mix, first, mix.centers.size(), length);
+
+			size_t next = mix.centers.size();
+
+			for (size_t i = first; i < mix.centers.size(); i++) {
+				if (!mix.hits[i] || HitDist(mix, i) >= length)
+					continue;
+
+				length = HitDist(mix, i);
+				closest = i;
+				next = i + 1;
+				break;
+			}
+
+			first = next;
+		}
+
+		return closest;
+	}
+
+	// CCollisionHandler::DetectClosestHit: one batch, near hits re-tested once the ray got shorter
+	size_t ClosestHitSinglePass(RayMix& mix, float& length)
+	{
+		size_t closest = mix.centers.size();
+
+		IntersectRange(mix, 0, mix.centers.size(), length);
+
+		for (size_t i = 0; i < mix.centers.size(); i++) {
+			if (!mix.hits[i])
+				continue;
+
+			if (closest != mix.centers.size()) {
+				if (mix.queries[i].IngressHit() && HitDist(mix, i) >= length)
+					continue;
+
+				IntersectRange(mix, i, i + 1, length);
+
+				if (!mix.hits[i])
+					continue;
+			}
+
+			if (HitDist(mix, i) >= length)
+				continue;
+
+			length = HitDist(mix, i);
+			closest = i;
+		}
+
+		return closest;
+	}
+}
+
+static void BenchTraceRayClosestHit(benchmark::State& state) {
+	RayMix mix = MakeRayMix(state.range(0));
+
+	const bool singlePass = (state.range(1) != 0);
+
+	for (auto _ : state) {
+		float length = rayLength;
+
+		const size_t closest = singlePass? ClosestHitSinglePass(mix, length): ClosestHitRerun(mix, length);
+
+		benchmark::DoNotOptimize(closest);
+		benchmark::DoNotOptimize(length);
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// {candidates, singlePass}
+BENCHMARK(BenchTraceRayClosestHit)->ArgsProduct({{16, 64, 256}, {0, 1}});
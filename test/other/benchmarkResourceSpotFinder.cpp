@@ -0,0 +1,102 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/ResourceSpotFinder.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+	// metal map layouts as found among the usual maps; the resource map has
+	// half the resolution of the heightmap, so a 16x16 map is 512x512 cells
+	enum MapLayout {
+		// a few dozen 3-spot clusters of high metal (most 1v1 and team maps)
+		LAYOUT_CLASSIC = 0,
+		// metal on every cell (speedmetal and other metal maps)
+		LAYOUT_METAL_FIELD = 1,
+		// low-grade metal scattered all over (maps with a noisy metal texture)
+		LAYOUT_NOISY = 2,
+		// no metal at all (water or energy-only maps)
+		LAYOUT_EMPTY = 3,
+	};
+
+	std::vector<unsigned char> MakeResourceMap(int mapWidth, int mapHeight, int layout)
+	{
+		std::mt19937 rng(mapWidth * 31 + layout);
+		std::vector<unsigned char> resourceMap(mapWidth * mapHeight, 0);
+
+		switch (layout) {
+			case LAYOUT_CLASSIC: {
+				const int numClusters = (mapWidth * mapHeight) / (64 * 64);
+
+				for (int n = 0; n < numClusters; n++) {
+					const int cx = rng() % mapWidth;
+					const int cz = rng() % mapHeight;
+
+					for (int s = 0; s < 3; s++) {
+						const int sx = cx + int(rng() % 17) - 8;
+						const int sz = cz + int(rng() % 17) - 8;
+
+						for (int z = sz - 2; z <= sz + 2; z++) {
+							for (int x = sx - 2; x <= sx + 2; x++) {
+								if (x >= 0 && x < mapWidth && z >= 0 && z < mapHeight)
+									resourceMap[z * mapWidth + x] = 200 + rng() % 56;
+							}
+						}
+					}
+				}
+			} break;
+			case LAYOUT_METAL_FIELD: {
+				std::fill(resourceMap.begin(), resourceMap.end(), 255);
+			} break;
+			case LAYOUT_NOISY: {
+				for (unsigned char& value: resourceMap) {
+					value = ((rng() % 8) == 0)? (rng() % 64): 0;
+				}
+			} break;
+			default: {
+			} break;
+		}
+
+		return resourceMap;
+	}
+}
+
+static void BenchFindSpots(benchmark::State& state) {
+	const int mapSize = state.range(0);
+	const std::vector<unsigned char> resourceMap = MakeResourceMap(mapSize, mapSize, state.range(1));
+
+	CResourceSpotFinder spotFinder;
+
+	for (auto _ : state) {
+		// default extractor radius of the usual games
+		spotFinder.FindSpots(resourceMap.data(), mapSize, mapSize, 64.0f, 0.002f);
+
+		benchmark::DoNotOptimize(spotFinder.GetSpots().data());
+		benchmark::ClobberMemory();
+	}
+
+	state.counters["spots"] = spotFinder.GetSpots().size();
+	state.SetItemsProcessed(state.iterations() * mapSize * mapSize);
+}
+
+// {resource map size, layout}
+BENCHMARK(BenchFindSpots)->ArgsProduct({{256, 512, 1024}, {LAYOUT_CLASSIC, LAYOUT_METAL_FIELD, LAYOUT_NOISY, LAYOUT_EMPTY}})->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv)
+{
+	benchmark::Initialize(&argc, argv);
+
+	if (benchmark::ReportUnrecognizedArguments(argc, argv))
+		return 1;
+
+	// FindSpots splits its passes over for_mt, which runs serially without workers
+	ThreadPool::SetThreadCount(ThreadPool::GetMaxThreads());
+	benchmark::RunSpecifiedBenchmarks();
+	ThreadPool::SetThreadCount(0);
+
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,100 @@
+function widget:GetInfo()
+return {
+	name    = "Benchmark-UnitAccessors",
+	desc    = "Compares per-unit and bulk unit state reads",
+	date    = "Oct. 2026",
+	license = "GNU GPL, v2 or later",
+	layer   = 0,
+	enabled = false,
+}
+end
+
+-- Reference numbers from a standalone harness (Lua 5.1 of this tree, 5000 units,
+-- best of 6 runs) with the bulk calls filling their tables through lua_rawseti:
+--   the three bulk calls alone       1.37ms  vs 1.0ms for the 15000 per-unit calls
+--   bulk calls + reading the arrays  2.0ms   vs 1.25ms for the per-unit reads
+-- i.e. reading every value of every unit is about 1.6x slower in bulk; the bulk
+-- calls only avoid the per-call garbage and help when few values are read back.
+
+local interval = 300 -- frames between measurements
+local repeats = 20 -- reads of all units per measurement
+
+local spGetAllUnits = Spring.GetAllUnits
+local spGetUnitPosition = Spring.GetUnitPosition
+local spGetUnitHealth = Spring.GetUnitHealth
+local spGetUnitVelocity = Spring.GetUnitVelocity
+local spGetUnitArrayPositions = Spring.GetUnitArrayPositions
+local spGetUnitArrayHealths = Spring.GetUnitArrayHealths
+local spGetUnitArrayVelocities = Spring.GetUnitArrayVelocities
+local spGetTimer = Spring.GetTimer
+local spDiffTimers = Spring.DiffTimers
+
+-- reused across measurements, as a widget would keep them across frames
+local positions = {}
+local healths = {}
+local velocities = {}
+
+local function ReadPerUnit(unitIDs)
+	local sum = 0
+
+	for i = 1, #unitIDs do
+		local unitID = unitIDs[i]
+		local x, y, z = spGetUnitPosition(unitID)
+		local health, maxHealth = spGetUnitHealth(unitID)
+		local vx, vy, vz, speed = spGetUnitVelocity(unitID)
+
+		if x and health and vx then
+			sum = sum + x + z + health + speed
+		end
+	end
+
+	return sum
+end
+
+local function ReadBulk(unitIDs)
+	local sum = 0
+
+	spGetUnitArrayPositions(unitIDs, positions)
+	spGetUnitArrayHealths(unitIDs, healths)
+	spGetUnitArrayVelocities(unitIDs, velocities)
+
+	for i = 1, #unitIDs do
+		local x = positions[i * 3 - 2]
+		local health = healths[i * 5 - 4]
+		local speed = velocities[i * 4]
+
+		if x and health and speed then
+			sum = sum + x + positions[i * 3] + health + speed
+		end
+	end
+
+	return sum
+end
+
+local function Measure(func, unitIDs)
+	local timer = spGetTimer()
+
+	for _ = 1, repeats do
+		func(unitIDs)
+	end
+
+	return spDiffTimers(spGetTimer(), timer, true) / repeats
+end
+
+function widget:GameFrame(n)
+	if n % interval ~= 0 then
+		return
+	end
+
+	local unitIDs = spGetAllUnits()
+
+	if #unitIDs == 0 then
+		return
+	end
+
+	local perUnitTime = Measure(ReadPerUnit, unitIDs)
+	local bulkTime = Measure(ReadBulk, unitIDs)
+
+	Spring.Echo(string.format("[Benchmark-UnitAccessors] %i units: per-unit %.3fms bulk %.3fms (%.2fx)",
+		#unitIDs, perUnitTime, bulkTime, perUnitTime / math.max(bulkTime, 0.001)))
+end
@@ -0,0 +1,72 @@
+function widget:GetInfo()
+return {
+	name    = "Test-WeaponTargets",
+	desc    = "Logs a digest of all weapon targets to compare serial and mtWeaponTargeting runs",
+	date    = "Oct. 2026",
+	license = "GNU GPL, v2 or later",
+	layer   = 0,
+	enabled = false,
+}
+end
+
+-- Run the same start script (with GAME\FixedRNGSeed set) once with the
+-- game's system.mtWeaponTargeting modrule off and once with it on, then
+-- diff the "[Test-WeaponTargets]" lines of both infologs: every digest
+-- has to match, including those of units with slaved weapons.
+
+local interval = 30 -- frames per logged digest
+
+local spGetAllUnits = Spring.GetAllUnits
+local spGetUnitDefID = Spring.GetUnitDefID
+local spGetUnitWeaponTarget = Spring.GetUnitWeaponTarget
+
+local MOD = 2147483647
+
+local digest = 0
+local numTargets = 0
+
+local function Mix(value)
+	digest = (digest * 31 + math.floor(value)) % MOD
+end
+
+function widget:GameFrame(n)
+	local unitIDs = spGetAllUnits()
+
+	-- weapon targets change in the staggered SlowUpdates, so fold in every frame
+	for i = 1, #unitIDs do
+		local unitID = unitIDs[i]
+		local unitDef = UnitDefs[spGetUnitDefID(unitID)]
+
+		for weaponNum = 1, #unitDef.weapons do
+			local targetType, isUserTarget, target = spGetUnitWeaponTarget(unitID, weaponNum)
+
+			Mix(unitID)
+			Mix(weaponNum)
+			Mix(targetType or 0)
+			Mix(isUserTarget and 1 or 0)
+
+			if targetType == 2 then
+				-- ground position, compare at elmo resolution
+				Mix(target[1])
+				Mix(target[2])
+				Mix(target[3])
+				numTargets = numTargets + 1
+			elseif targetType ~= nil and targetType ~= 0 then
+				Mix(target)
+				numTargets = numTargets + 1
+			end
+		end
+	end
+
+	if n % interval ~= 0 then
+		return
+	end
+
+	Spring.Echo(string.format("[Test-WeaponTargets] frame %i units %i targets %i digest %08x", n, #unitIDs, numTargets, digest))
+end
+
+function widget:Initialize()
+	if not Spring.GetSpectatingState() then
+		Spring.Log("test_weapon_targets.lua", LOG.WARNING, "not spectating, digests only cover visible units")
+	end
+end